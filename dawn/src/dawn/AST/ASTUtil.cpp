@@ -462,6 +462,7 @@ public:
       result_ = std::atoi(expr->getValue().c_str());
       break;
     case BuiltinTypeID::Float:
+    case BuiltinTypeID::Double:
       result_ = std::atof(expr->getValue().c_str());
       break;
     default:
@@ -136,6 +136,15 @@ bool dimension_isa(HorizontalFieldDimension const& dimension) {
   return static_cast<bool>(dynamic_cast<PlainT*>(dimension.impl_.get()));
 }
 
+/// @brief Floating point precision of the values of a field
+///
+/// @ingroup sir
+enum class FieldPrecision {
+  Default, ///< Precision of the generated code (`::dawn::float_type`)
+  Single,  ///< `float`
+  Double   ///< `double`
+};
+
 class FieldDimensions {
 public:
   FieldDimensions(HorizontalFieldDimension&& horizontalFieldDimension, bool maskK)
@@ -157,7 +166,9 @@ public:
   FieldDimensions& operator=(FieldDimensions&&) = default;
 
   bool operator==(const FieldDimensions& other) const {
-    return (maskK_ == other.maskK_ && horizontalFieldDimension_ == other.horizontalFieldDimension_);
+    return (maskK_ == other.maskK_ &&
+            horizontalFieldDimension_ == other.horizontalFieldDimension_ &&
+            precision_ == other.precision_);
   }
 
   bool K() const { return maskK_; }
@@ -166,6 +177,11 @@ public:
     return horizontalFieldDimension_.value();
   }
   bool isVertical() const { return !horizontalFieldDimension_.has_value(); }
+
+  /// @brief Precision in which the values of the field are stored
+  FieldPrecision getPrecision() const { return precision_; }
+  void setPrecision(FieldPrecision precision) { precision_ = precision; }
+
   std::string toString() const;
 
   // returns number of dimensions (1-3)
@@ -177,6 +193,7 @@ public:
 private:
   std::optional<HorizontalFieldDimension> horizontalFieldDimension_;
   bool maskK_;
+  FieldPrecision precision_ = FieldPrecision::Default;
 };
 
 } // namespace ast
@@ -180,5 +180,18 @@ const char* ASTCodeGenCXX::builtinTypeIDToCXXType(const BuiltinTypeID& builtinTy
   }
 }
 
+const char* ASTCodeGenCXX::fieldPrecisionToCXXType(ast::FieldPrecision precision) {
+  switch(precision) {
+  case ast::FieldPrecision::Default:
+    return "::dawn::float_type";
+  case ast::FieldPrecision::Single:
+    return "float";
+  case ast::FieldPrecision::Double:
+    return "double";
+  default:
+    dawn_unreachable("invalid field precision");
+  }
+}
+
 } // namespace codegen
 } // namespace dawn
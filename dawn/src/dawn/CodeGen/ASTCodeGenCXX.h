@@ -15,6 +15,7 @@
 #pragma once
 
 #include "dawn/AST/ASTVisitor.h"
+#include "dawn/AST/FieldDimension.h"
 #include "dawn/Support/NonCopyable.h"
 #include "dawn/Support/Type.h"
 #include <sstream>
@@ -72,6 +73,9 @@ public:
 
   /// @brief Convert builtin type to the corresponding C++ type
   static const char* builtinTypeIDToCXXType(const BuiltinTypeID& builtinTypeID, bool isAutoAllowed);
+
+  /// @brief Convert the precision of a field to the C++ type of its values
+  static const char* fieldPrecisionToCXXType(ast::FieldPrecision precision);
 };
 
 } // namespace codegen
@@ -16,8 +16,10 @@
 #include "dawn/AST/Offsets.h"
 #include "dawn/CodeGen/CXXNaive-ico/ASTStencilFunctionParamVisitor.h"
 #include "dawn/CodeGen/CXXUtil.h"
+#include "dawn/CodeGen/IcoChainSizes.h"
 #include "dawn/IIR/AST.h"
 #include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/Stage.h"
 #include "dawn/IIR/StencilFunctionInstantiation.h"
 #include "dawn/SIR/SIR.h"
 #include "dawn/Support/Unreachable.h"
@@ -130,6 +132,25 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::LoopStmt>& stmt) {
   ss_ << "}";
 }
 
+void ASTStencilBody::visit(const std::shared_ptr<ast::VarDeclStmt>& stmt) {
+  if(!simdWidth_) {
+    Base::visit(stmt);
+    return;
+  }
+  // local variables hold the values of all levels
+  DAWN_ASSERT(!stmt->isArray());
+  if(scopeDepth_ == 0)
+    ss_ << std::string(indent_, ' ');
+  if(stmt->getType().isConst())
+    ss_ << "const ";
+  ss_ << getSimdType() << " " << getName(stmt);
+  if(stmt->hasInit()) {
+    ss_ << " " << stmt->getOp() << " ";
+    stmt->getInitList().front()->accept(*this);
+  }
+  ss_ << ";\n";
+}
+
 void ASTStencilBody::visit(const std::shared_ptr<ast::VerticalRegionDeclStmt>& stmt) {
   DAWN_ASSERT_MSG(0, "VerticalRegionDeclStmt not allowed in this context");
 }
@@ -263,6 +284,14 @@ std::string ASTStencilBody::makeIndexString(const std::shared_ptr<ast::FieldAcce
   return "BAD_FIELD_CONFIG";
 }
 
+void ASTStencilBody::visit(const std::shared_ptr<ast::AssignmentExpr>& expr) {
+  isAssignmentTarget_ = true;
+  expr->getLeft()->accept(*this);
+  isAssignmentTarget_ = false;
+  ss_ << " " << expr->getOp() << " ";
+  expr->getRight()->accept(*this);
+}
+
 void ASTStencilBody::visit(const std::shared_ptr<ast::FieldAccessExpr>& expr) {
 
   if(currentFunction_) {
@@ -331,7 +360,16 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::FieldAccessExpr>& expr) {
       // accessName));
     }
   } else {
-    if(!expr->getOffset().hasVerticalIndirection()) {
+    if(simdWidth_ && !expr->getOffset().hasVerticalIndirection() &&
+       metadata_.getFieldDimensions(iir::getAccessID(expr)).K()) {
+      // the field is accessed at the level of each lane by a lambda, which is passed to
+      // `::dawn::simd_load` (reads) or `::dawn::simd_ref` (writes)
+      ss_ << "::dawn::" << (isAssignmentTarget_ ? "simd_ref" : "simd_load") << "<" << simdWidth_
+          << ">([&](int lane) -> auto& { return m_" << expr->getName() << "("
+          << makeIndexString(expr, "(k + " + std::to_string(expr->getOffset().verticalShift()) +
+                                       " + lane)")
+          << "); })";
+    } else if(!expr->getOffset().hasVerticalIndirection()) {
       ss_ << "m_"
           << expr->getName() + "(" +
                  makeIndexString(expr, "(k + " + std::to_string(expr->getOffset().verticalShift()) +
@@ -353,6 +391,10 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::FieldAccessExpr>& expr) {
 }
 
 void ASTStencilBody::visit(const std::shared_ptr<ast::ReductionOverNeighborExpr>& expr) {
+  if(fusedReductions_.count(expr->getID())) {
+    ss_ << "lhs_" << expr->getID();
+    return;
+  }
   bool hasWeights = expr->getWeights().has_value();
 
   std::string sigArg;
@@ -366,8 +408,21 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::ReductionOverNeighborExpr>
     }
   }
 
-  ss_ << std::string(indent_, ' ') << "reduce(LibTag{}, m_mesh," << sigArg << ", ";
-  expr->getInit()->accept(*this);
+  ss_ << std::string(indent_, ' ') << "reduce(LibTag{}, ";
+  // nested reductions start from neighbors, which may lie outside of the interior
+  if(completeNeighborhoods_ && reductionDepth_ == 0 &&
+     ICOChainIsFullInInterior(expr->getNbhChain())) {
+    ss_ << "::dawn::complete_neighborhood<"
+        << ICOChainSize(expr->getNbhChain()) + (expr->getIncludeCenter() ? 1 : 0) << ">{}, ";
+  }
+  ss_ << "m_mesh," << sigArg << ", ";
+  if(simdWidth_) {
+    ss_ << getSimdType() << "(";
+    expr->getInit()->accept(*this);
+    ss_ << ")";
+  } else {
+    expr->getInit()->accept(*this);
+  }
 
   ss_ << ", " << nbhChainToVectorString(expr->getNbhChain());
   if(hasWeights) {
@@ -382,14 +437,42 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::ReductionOverNeighborExpr>
         << ASTStencilBody::ReductionIndexVarName(reductionDepth_ + 1) << ") mutable { ";
   }
 
+  generateAccumulation(expr, "lhs", hasWeights ? "weight" : "");
+  ss_ << ASTStencilBody::ReductionSparseIndexVarName(reductionDepth_) << "++;\n";
+  ss_ << "return lhs;\n";
+  ss_ << "}";
+  if(hasWeights) {
+    auto weights = expr->getWeights().value();
+    bool first = true;
+
+    ss_ << ", std::vector<::dawn::float_type>({";
+    for(auto const& weight : weights) {
+      if(!first) {
+        ss_ << ", ";
+      }
+      weight->accept(*this);
+      first = false;
+    }
+
+    ss_ << "})";
+  }
+  if(expr->getIncludeCenter()) {
+    ss_ << ", /*include center*/ true";
+  }
+  ss_ << ")";
+}
+
+void ASTStencilBody::generateAccumulation(
+    const std::shared_ptr<ast::ReductionOverNeighborExpr>& expr, const std::string& lhs,
+    const std::string& weight) {
   if(!expr->isArithmetic()) {
-    ss_ << "lhs = " << expr->getOp() << "(lhs, ";
+    ss_ << lhs << " = " << expr->getOp() << "(" << lhs << ", ";
   } else {
-    ss_ << "lhs " << expr->getOp() << "= ";
+    ss_ << lhs << " " << expr->getOp() << "= ";
   }
 
-  if(hasWeights) {
-    ss_ << "weight * ";
+  if(!weight.empty()) {
+    ss_ << weight << " * ";
   }
 
   auto argName = denseArgName_;
@@ -418,28 +501,71 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::ReductionOverNeighborExpr>
     ss_ << ")";
   }
   ss_ << ";\n";
-  ss_ << ASTStencilBody::ReductionSparseIndexVarName(reductionDepth_) << "++;\n";
-  ss_ << "return lhs;\n";
-  ss_ << "}";
-  if(hasWeights) {
-    auto weights = expr->getWeights().value();
-    bool first = true;
+}
 
-    ss_ << ", std::vector<::dawn::float_type>({";
-    for(auto const& weight : weights) {
-      if(!first) {
-        ss_ << ", ";
+std::string ASTStencilBody::getSimdType() const {
+  return "::dawn::float_simd<" + std::to_string(simdWidth_) + ">";
+}
+
+void ASTStencilBody::generateFusedReductions(
+    const std::vector<std::shared_ptr<ast::ReductionOverNeighborExpr>>& reductions) {
+  DAWN_ASSERT(!reductions.empty() && reductionDepth_ == 0);
+  const auto& space = reductions.front()->getIterSpace();
+
+  for(const auto& expr : reductions) {
+    DAWN_ASSERT(expr->getIterSpace() == space);
+    ss_ << std::string(indent_, ' ') << "auto lhs_" << expr->getID() << " = ";
+    if(simdWidth_) {
+      ss_ << getSimdType() << "(";
+      expr->getInit()->accept(*this);
+      ss_ << ")";
+    } else {
+      expr->getInit()->accept(*this);
+    }
+    ss_ << ";\n";
+    if(expr->getWeights().has_value()) {
+      ss_ << "const ::dawn::float_type weights_" << expr->getID() << "[] = {";
+      bool first = true;
+      for(const auto& weight : *expr->getWeights()) {
+        if(!first) {
+          ss_ << ", ";
+        }
+        weight->accept(*this);
+        first = false;
       }
-      weight->accept(*this);
-      first = false;
+      ss_ << "};\n";
     }
+  }
 
-    ss_ << "})";
+  ss_ << std::string(indent_, ' ') << "reduce(LibTag{}, ";
+  if(completeNeighborhoods_ && ICOChainIsFullInInterior(space.Chain)) {
+    ss_ << "::dawn::complete_neighborhood<"
+        << ICOChainSize(space.Chain) + (space.IncludeCenter ? 1 : 0) << ">{}, ";
   }
-  if(expr->getIncludeCenter()) {
+  ss_ << "m_mesh,"
+      << (parentIsForLoop_ ? ASTStencilBody::LoopNeighborIndexVarName()
+                           : ASTStencilBody::StageIndexVarName())
+      << ", int(0), " << nbhChainToVectorString(space.Chain) << ", [&, "
+      << ASTStencilBody::ReductionSparseIndexVarName(0) << " = int(0)](auto& lhs, auto "
+      << ASTStencilBody::ReductionIndexVarName(1) << ") mutable {\n";
+  for(const auto& expr : reductions) {
+    generateAccumulation(expr, "lhs_" + std::to_string(expr->getID()),
+                         expr->getWeights().has_value()
+                             ? "weights_" + std::to_string(expr->getID()) + "[" +
+                                   ASTStencilBody::ReductionSparseIndexVarName(0) + "]"
+                             : "");
+  }
+  ss_ << ASTStencilBody::ReductionSparseIndexVarName(0) << "++;\n";
+  ss_ << "return lhs;\n";
+  ss_ << "}";
+  if(space.IncludeCenter) {
     ss_ << ", /*include center*/ true";
   }
-  ss_ << ")";
+  ss_ << ");\n";
+
+  for(const auto& expr : reductions) {
+    fusedReductions_.insert(expr->getID());
+  }
 }
 
 void ASTStencilBody::setCurrentStencilFunction(
@@ -447,6 +573,87 @@ void ASTStencilBody::setCurrentStencilFunction(
   currentFunction_ = currentFunction;
 }
 
+namespace {
+class SimdVectorizationChecker : public ast::ASTVisitorForwardingNonConst {
+  const iir::StencilMetaInformation& metadata_;
+  bool vectorizable_ = true;
+  // the weights of reductions are passed to `reduce` as scalars
+  bool inWeights_ = false;
+
+public:
+  SimdVectorizationChecker(const iir::StencilMetaInformation& metadata) : metadata_(metadata) {}
+
+  bool isVectorizable() const { return vectorizable_; }
+
+  void visit(const std::shared_ptr<ast::IfStmt>& stmt) override { vectorizable_ = false; }
+  void visit(const std::shared_ptr<ast::LoopStmt>& stmt) override { vectorizable_ = false; }
+  void visit(const std::shared_ptr<ast::TernaryOperator>& expr) override { vectorizable_ = false; }
+  void visit(const std::shared_ptr<ast::FunCallExpr>& expr) override { vectorizable_ = false; }
+  void visit(const std::shared_ptr<ast::StencilFunCallExpr>& expr) override {
+    vectorizable_ = false;
+  }
+
+  void visit(const std::shared_ptr<ast::VarDeclStmt>& stmt) override {
+    const auto& type = stmt->getType();
+    vectorizable_ = vectorizable_ && !stmt->isArray() && type.isBuiltinType() &&
+                    (type.getBuiltinTypeID() == BuiltinTypeID::Auto ||
+                     type.getBuiltinTypeID() == BuiltinTypeID::Float ||
+                     type.getBuiltinTypeID() == BuiltinTypeID::Double);
+    ast::ASTVisitorForwardingNonConst::visit(stmt);
+  }
+
+  void visit(const std::shared_ptr<ast::UnaryOperator>& expr) override {
+    vectorizable_ = vectorizable_ && (expr->getOp() == "-" || expr->getOp() == "+");
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+
+  void visit(const std::shared_ptr<ast::BinaryOperator>& expr) override {
+    const auto& op = expr->getOp();
+    vectorizable_ = vectorizable_ && (op == "+" || op == "-" || op == "*" || op == "/");
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+
+  void visit(const std::shared_ptr<ast::AssignmentExpr>& expr) override {
+    const auto& op = expr->getOp();
+    vectorizable_ =
+        vectorizable_ && (op == "=" || op == "+=" || op == "-=" || op == "*=" || op == "/=");
+    // all lanes would store to the same element of a field without vertical dimension
+    if(auto field = std::dynamic_pointer_cast<ast::FieldAccessExpr>(expr->getLeft()))
+      vectorizable_ = vectorizable_ && metadata_.getFieldDimensions(iir::getAccessID(field)).K();
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+
+  void visit(const std::shared_ptr<ast::VarAccessExpr>& expr) override {
+    vectorizable_ = vectorizable_ && !expr->isArrayAccess() &&
+                    (!inWeights_ || metadata_.isAccessType(iir::FieldAccessType::GlobalVariable,
+                                                           iir::getAccessID(expr)));
+  }
+
+  void visit(const std::shared_ptr<ast::FieldAccessExpr>& expr) override {
+    vectorizable_ = vectorizable_ && !inWeights_ && !expr->getOffset().hasVerticalIndirection();
+  }
+
+  void visit(const std::shared_ptr<ast::ReductionOverNeighborExpr>& expr) override {
+    vectorizable_ = vectorizable_ && expr->isArithmetic();
+    expr->getInit()->accept(*this);
+    expr->getRhs()->accept(*this);
+    if(expr->getWeights().has_value()) {
+      inWeights_ = true;
+      for(const auto& weight : *expr->getWeights())
+        weight->accept(*this);
+      inWeights_ = false;
+    }
+  }
+};
+} // namespace
+
+bool isSimdVectorizable(const iir::Stage& stage, const iir::StencilMetaInformation& metadata) {
+  SimdVectorizationChecker checker(metadata);
+  for(const auto& doMethod : stage.getChildren())
+    doMethod->getAST().accept(checker);
+  return checker.isVectorizable();
+}
+
 } // namespace cxxnaiveico
 } // namespace codegen
 } // namespace dawn
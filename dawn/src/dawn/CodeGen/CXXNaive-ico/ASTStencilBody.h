@@ -19,12 +19,14 @@
 #include "dawn/IIR/Interval.h"
 #include "dawn/Support/StringUtil.h"
 #include "driver-includes/unstructured_interface.hpp"
+#include <set>
 #include <stack>
 #include <unordered_map>
 
 namespace dawn {
 
 namespace iir {
+class Stage;
 class StencilFunctionInstantiation;
 class StencilMetaInformation;
 } // namespace iir
@@ -48,6 +50,12 @@ public:
   }
 };
 
+/// @brief Check if the statements of `stage` can be generated as SIMD code computing consecutive
+/// levels at once (@see ASTStencilBody::setSimdWidth), i.e. they only contain arithmetic on
+/// floating point values without control flow or function calls, write to fields with a vertical
+/// dimension and reduce arithmetically with weights independent of the level
+bool isSimdVectorizable(const iir::Stage& stage, const iir::StencilMetaInformation& metadata);
+
 /// @brief ASTVisitor to generate C++ naive code for the stencil and stencil function bodies
 /// @ingroup cxxnaiveico
 class ASTStencilBody : public ASTCodeGenCXX {
@@ -65,6 +73,20 @@ protected:
 
   size_t reductionDepth_ = 0;
 
+  /// Whether the elements have complete neighborhoods (generating the loop over the interior)
+  bool completeNeighborhoods_ = false;
+
+  /// IDs of the reductions computed by `generateFusedReductions`, which are accessed by the name of
+  /// their accumulator
+  std::set<int> fusedReductions_;
+
+  /// Number of consecutive vertical levels computed at once with `::dawn::float_simd`, 0 for
+  /// scalar code
+  int simdWidth_ = 0;
+
+  /// Whether the field access being generated is assigned to
+  bool isAssignmentTarget_ = false;
+
   /// The stencil function we are currently generating or NULL
   std::shared_ptr<iir::StencilFunctionInstantiation> currentFunction_;
 
@@ -97,6 +119,13 @@ protected:
   std::string makeIndexString(const std::shared_ptr<ast::FieldAccessExpr>& expr,
                               std::string kiterStr);
 
+  /// @brief Generate `lhs op= [weight *] rhs` for the neighbor `ReductionIndexVarName(depth + 1)`
+  void generateAccumulation(const std::shared_ptr<ast::ReductionOverNeighborExpr>& expr,
+                            const std::string& lhs, const std::string& weight);
+
+  /// @brief Type of the SIMD values, e.g. `::dawn::float_simd<4>`
+  std::string getSimdType() const;
+
 public:
   using Base = ASTCodeGenCXX;
   using Base::visit;
@@ -120,6 +149,7 @@ public:
   /// @{
   void visit(const std::shared_ptr<ast::BlockStmt>& stmt) override;
   void visit(const std::shared_ptr<ast::ReturnStmt>& stmt) override;
+  void visit(const std::shared_ptr<ast::VarDeclStmt>& stmt) override;
   void visit(const std::shared_ptr<ast::LoopStmt>& stmt) override;
   void visit(const std::shared_ptr<ast::VerticalRegionDeclStmt>& stmt) override;
   void visit(const std::shared_ptr<ast::StencilCallDeclStmt>& stmt) override;
@@ -131,10 +161,28 @@ public:
   void visit(const std::shared_ptr<ast::StencilFunCallExpr>& expr) override;
   void visit(const std::shared_ptr<ast::StencilFunArgExpr>& expr) override;
   void visit(const std::shared_ptr<ast::VarAccessExpr>& expr) override;
+  void visit(const std::shared_ptr<ast::AssignmentExpr>& expr) override;
   void visit(const std::shared_ptr<ast::FieldAccessExpr>& expr) override;
   void visit(const std::shared_ptr<ast::ReductionOverNeighborExpr>& expr) override;
   /// @}
 
+  /// @brief Reduce over `ICOChainSize` neighbors without missing values (for the chains which allow
+  /// it), set while generating the loop over the interior elements
+  void setCompleteNeighborhoods(bool complete) { completeNeighborhoods_ = complete; }
+
+  /// @brief Generate SIMD code computing `width` consecutive levels `k, ..., k + width - 1` (scalar
+  /// code if `width` is smaller than 2). The fields with a vertical dimension are loaded and stored
+  /// through `::dawn::simd_load` and `::dawn::simd_ref`, local variables and accumulators of
+  /// reductions are `::dawn::float_simd`. Only statements accepted by `isSimdVectorizable` are
+  /// supported.
+  void setSimdWidth(int width) { simdWidth_ = width > 1 ? width : 0; }
+
+  /// @brief Compute `reductions` (over the same iteration space) in a single call to `reduce`, with
+  /// an accumulator `lhs_<ID>` per reduction. The reductions are subsequently generated as the name
+  /// of their accumulator.
+  void generateFusedReductions(
+      const std::vector<std::shared_ptr<ast::ReductionOverNeighborExpr>>& reductions);
+
   /// @brief Set the current stencil function (can be NULL)
   void setCurrentStencilFunction(
       const std::shared_ptr<iir::StencilFunctionInstantiation>& currentFunction);
@@ -92,6 +92,42 @@ std::string makeKLoop(bool isBackward, iir::Interval const& interval) {
   return isBackward ? makeLoopImpl(0, 0, "k", upper, lower, ">=", "--")
                     : makeLoopImpl(0, 0, "k", lower, upper, "<=", "++");
 }
+
+// loop over the levels of `interval` in steps of `width` levels, as long as `width` levels are left
+std::string makeSimdKLoop(iir::Interval const& interval, int width) {
+  const std::string lower = makeIntervalBound(interval, iir::Interval::Bound::lower);
+  const std::string upper = makeIntervalBound(interval, iir::Interval::Bound::upper);
+
+  return "for(int k = " + lower + "; k + " + std::to_string(width - 1) + " <= " + upper +
+         "; k += " + std::to_string(width) + ")";
+}
+
+// loop over the levels of `interval` which are left over by `makeSimdKLoop`
+std::string makeSimdRemainderKLoop(iir::Interval const& interval, int width) {
+  const std::string lower = makeIntervalBound(interval, iir::Interval::Bound::lower);
+  const std::string upper = makeIntervalBound(interval, iir::Interval::Bound::upper);
+  const std::string numLevels = "((" + upper + ") - (" + lower + ") + 1)";
+
+  return "for(int k = " + lower + " + " + numLevels + " / " + std::to_string(width) + " * " +
+         std::to_string(width) + "; k <= " + upper + "; ++k)";
+}
+
+// whether `stage` reduces over a chain whose neighborhoods are complete in the interior subdomain
+bool hasFullInteriorReductions(const iir::Stage& stage) {
+  class FindFullInteriorReduction : public ast::ASTVisitorForwardingNonConst {
+    bool found_ = false;
+
+  public:
+    void visit(const std::shared_ptr<ast::ReductionOverNeighborExpr>& expr) override {
+      found_ = found_ || ICOChainIsFullInInterior(expr->getNbhChain());
+    }
+    bool found() const { return found_; }
+  } finder;
+  for(const auto& doMethod : stage.getChildren()) {
+    doMethod->getAST().accept(finder);
+  }
+  return finder.found();
+}
 } // namespace
 
 std::unique_ptr<TranslationUnit>
@@ -100,13 +136,16 @@ run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
     const Options& options) {
   CXXNaiveIcoCodeGen CG(
       stencilInstantiationMap, options.MaxHaloSize,
-      Padding{options.paddingCells, options.paddingEdges, options.paddingVertices});
+      Padding{options.paddingCells, options.paddingEdges, options.paddingVertices},
+      options.UnrollInteriorReductions, options.SimdWidth);
   return CG.generateCode();
 } // namespace cxxnaiveico
 
 CXXNaiveIcoCodeGen::CXXNaiveIcoCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint,
-                                       Padding padding)
-    : CodeGen(ctx, maxHaloPoint, padding) {}
+                                       Padding padding, bool unrollInteriorReductions,
+                                       int simdWidth)
+    : CodeGen(ctx, maxHaloPoint, padding), unrollInteriorReductions_(unrollInteriorReductions),
+      simdWidth_(simdWidth) {}
 
 CXXNaiveIcoCodeGen::~CXXNaiveIcoCodeGen() {}
 
@@ -588,33 +627,172 @@ void CXXNaiveIcoCodeGen::generateStencilClasses(
         }
       };
 
-      for(auto interval : partitionIntervals) {
-        StencilRunMethod.addBlockStatement(
-            makeKLoop((multiStage.getLoopOrder() == iir::LoopOrderKind::Backward), interval), [&] {
-              // for each interval, we generate naive nested loops
-              for(const auto& stagePtr : multiStage.getChildren()) {
-                const iir::Stage& stage = *stagePtr;
-
-                DAWN_ASSERT_MSG(stage.getLocationType().has_value(),
-                                "Stage must have a location type");
-                std::string loopCode =
-                    getLoop(*stage.getLocationType(), stage.getUnstructuredIterationSpace());
-                StencilRunMethod.addBlockStatement(loopCode, [&] {
-                  // Generate Do-Method
-                  for(const auto& doMethodPtr : stage.getChildren()) {
-                    const iir::DoMethod& doMethod = *doMethodPtr;
-                    if(!doMethod.getInterval().overlaps(interval))
-                      continue;
-
-                    for(const auto& stmt : doMethod.getAST().getStatements()) {
-                      stmt->accept(stencilBodyCXXVisitor);
-                      StencilRunMethod << stencilBodyCXXVisitor.getCodeAndResetStream();
-                    }
+      auto getDomainIndex = [](ast::LocationType type, const std::string& subdomain,
+                               int offset) -> std::string {
+        std::string loc;
+        switch(type) {
+        case ast::LocationType::Cells:
+          loc = "::dawn::LocationType::Cells";
+          break;
+        case ast::LocationType::Edges:
+          loc = "::dawn::LocationType::Edges";
+          break;
+        case ast::LocationType::Vertices:
+          loc = "::dawn::LocationType::Vertices";
+          break;
+        default:
+          dawn_unreachable("invalid type");
+        }
+        return "m_unstructured_domain({" + loc + "," + subdomain + "," + std::to_string(offset) +
+               "})";
+      };
+      auto getNumElements = [](ast::LocationType type) -> std::string {
+        switch(type) {
+        case ast::LocationType::Cells:
+          return "numCells(LibTag{}, m_mesh)";
+        case ast::LocationType::Edges:
+          return "numEdges(LibTag{}, m_mesh)";
+        case ast::LocationType::Vertices:
+          return "numVertices(LibTag{}, m_mesh)";
+        default:
+          dawn_unreachable("invalid type");
+          return "";
+        }
+      };
+      auto getRangeLoop = [](ast::LocationType type, const std::string& lo,
+                             const std::string& hi) -> std::string {
+        switch(type) {
+        case ast::LocationType::Cells:
+          return "for(auto const& loc : getCells(LibTag{}, m_mesh, " + lo + ", " + hi + "))";
+        case ast::LocationType::Edges:
+          return "for(auto const& loc : getEdges(LibTag{}, m_mesh, " + lo + ", " + hi + "))";
+        case ast::LocationType::Vertices:
+          return "for(auto const& loc : getVertices(LibTag{}, m_mesh, " + lo + ", " + hi + "))";
+        default:
+          dawn_unreachable("invalid type");
+          return "";
+        }
+      };
+
+      // parallel multi-stages compute `simdWidth_` consecutive levels at once if all stages can be
+      // vectorized, followed by a scalar loop over the remaining levels of each interval
+      const bool isSimd =
+          simdWidth_ > 1 && multiStage.getLoopOrder() == iir::LoopOrderKind::Parallel &&
+          std::all_of(multiStage.getChildren().begin(), multiStage.getChildren().end(),
+                      [&](const auto& stage) {
+                        return isSimdVectorizable(*stage, stencilInstantiation->getMetaData());
+                      });
+      struct KLoop {
+        iir::Interval interval;
+        std::string header;
+        int simdWidth;
+      };
+      std::vector<KLoop> kLoops;
+      for(const auto& interval : partitionIntervals) {
+        if(isSimd) {
+          kLoops.push_back({interval, makeSimdKLoop(interval, simdWidth_), simdWidth_});
+          kLoops.push_back({interval, makeSimdRemainderKLoop(interval, simdWidth_), 0});
+        } else {
+          kLoops.push_back(
+              {interval,
+               makeKLoop((multiStage.getLoopOrder() == iir::LoopOrderKind::Backward), interval),
+               0});
+        }
+      }
+
+      for(const auto& kLoop : kLoops) {
+        const iir::Interval& interval = kLoop.interval;
+        stencilBodyCXXVisitor.setSimdWidth(kLoop.simdWidth);
+        StencilRunMethod.addBlockStatement(kLoop.header, [&] {
+          // for each interval, we generate naive nested loops
+          for(const auto& stagePtr : multiStage.getChildren()) {
+            const iir::Stage& stage = *stagePtr;
+
+            DAWN_ASSERT_MSG(stage.getLocationType().has_value(), "Stage must have a location type");
+            auto generateStageBody = [&] {
+              // Generate Do-Method
+              for(const auto& doMethodPtr : stage.getChildren()) {
+                const iir::DoMethod& doMethod = *doMethodPtr;
+                if(!doMethod.getInterval().overlaps(interval))
+                  continue;
+
+                std::vector<std::shared_ptr<ast::Stmt>> stmts;
+                for(const auto& stmt : doMethod.getAST().getStatements())
+                  if(!isHoistedVarDecl(stmt, stencilInstantiation->getMetaData()))
+                    stmts.push_back(stmt);
+
+                // reductions over the same neighbors declared in a row share one loop
+                for(const auto& block : groupFusedReductions(stmts)) {
+                  if(block.size() > 1) {
+                    std::vector<std::shared_ptr<ast::ReductionOverNeighborExpr>> reductions;
+                    for(const auto& stmt : block)
+                      reductions.push_back(getDeclaredReduction(stmt));
+                    stencilBodyCXXVisitor.generateFusedReductions(reductions);
                   }
-                });
+                  for(const auto& stmt : block)
+                    stmt->accept(stencilBodyCXXVisitor);
+                  StencilRunMethod << stencilBodyCXXVisitor.getCodeAndResetStream();
+                }
               }
+            };
+
+            // loop invariant declarations are evaluated once per k-level before the
+            // horizontal loops
+            for(const auto& doMethodPtr : stage.getChildren()) {
+              if(!doMethodPtr->getInterval().overlaps(interval))
+                continue;
+              for(const auto& stmt : doMethodPtr->getAST().getStatements()) {
+                if(isHoistedVarDecl(stmt, stencilInstantiation->getMetaData())) {
+                  stmt->accept(stencilBodyCXXVisitor);
+                  StencilRunMethod << stencilBodyCXXVisitor.getCodeAndResetStream();
+                }
+              }
+            }
+
+            if(!unrollInteriorReductions_ || !hasFullInteriorReductions(stage)) {
+              std::string loopCode =
+                  getLoop(*stage.getLocationType(), stage.getUnstructuredIterationSpace());
+              StencilRunMethod.addBlockStatement(loopCode, generateStageBody);
+              continue;
+            }
+
+            // split the elements at the interior subdomain: [lo, interiorLo) and
+            // [interiorHi, hi) keep the general reductions, the interior elements reduce over
+            // complete neighborhoods
+            StencilRunMethod.addBlockStatement("", [&] {
+              auto loc = *stage.getLocationType();
+              auto iterSpace = stage.getUnstructuredIterationSpace();
+              StencilRunMethod.addStatement(
+                  "const int lo = " +
+                  (iterSpace.has_value()
+                       ? getDomainIndex(loc, spaceMagicNumToEnum(iterSpace->lowerBound()),
+                                        iterSpace->lowerOffset())
+                       : std::string("0")));
+              StencilRunMethod.addStatement(
+                  "const int hi = " +
+                  (iterSpace.has_value()
+                       ? getDomainIndex(loc, spaceMagicNumToEnum(iterSpace->upperBound()),
+                                        iterSpace->upperOffset())
+                       : getNumElements(loc)));
+              StencilRunMethod.addStatement(
+                  "const int interiorLo = std::min(std::max(" +
+                  getDomainIndex(loc, "::dawn::UnstructuredSubdomain::Interior", 0) + ", lo), hi)");
+              StencilRunMethod.addStatement(
+                  "const int interiorHi = std::min(std::max(" +
+                  getDomainIndex(loc, "::dawn::UnstructuredSubdomain::Halo", 0) + ", lo), hi)");
+              StencilRunMethod.addBlockStatement(getRangeLoop(loc, "lo", "interiorLo"),
+                                                 generateStageBody);
+              stencilBodyCXXVisitor.setCompleteNeighborhoods(true);
+              StencilRunMethod.addBlockStatement(getRangeLoop(loc, "interiorLo", "interiorHi"),
+                                                 generateStageBody);
+              stencilBodyCXXVisitor.setCompleteNeighborhoods(false);
+              StencilRunMethod.addBlockStatement(getRangeLoop(loc, "interiorHi", "hi"),
+                                                 generateStageBody);
             });
+          }
+        });
       }
+      stencilBodyCXXVisitor.setSimdWidth(0);
       StencilRunMethod.ss() << "}";
     }
     StencilRunMethod.addStatement("sync_storages()");
@@ -744,6 +922,8 @@ std::unique_ptr<TranslationUnit> CXXNaiveIcoCodeGen::generateCode() {
   ppDefines.push_back("#include <driver-includes/unstructured_interface.hpp>");
   ppDefines.push_back("#include <driver-includes/unstructured_domain.hpp>");
   ppDefines.push_back("#include <driver-includes/math.hpp>");
+  if(simdWidth_ > 1)
+    ppDefines.push_back("#include <driver-includes/unstructured_simd.hpp>");
   DAWN_LOG(INFO) << "Done generating code";
 
   std::string filename = generateFileName(context_);
@@ -43,11 +43,19 @@ run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
 class CXXNaiveIcoCodeGen : public CodeGen {
 public:
   ///@brief constructor
-  CXXNaiveIcoCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint, Padding padding);
+  CXXNaiveIcoCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint, Padding padding,
+                     bool unrollInteriorReductions = false, int simdWidth = 0);
   virtual ~CXXNaiveIcoCodeGen();
   virtual std::unique_ptr<TranslationUnit> generateCode() override;
 
 private:
+  // the loops over the elements are split at the interior subdomain, whose elements reduce over
+  // complete neighborhoods
+  bool unrollInteriorReductions_;
+  // consecutive levels computed at once by the SIMD code of the parallel multi-stages, scalar code
+  // if smaller than 2
+  int simdWidth_;
+
   std::string generateStencilInstantiation(
       const std::shared_ptr<iir::StencilInstantiation> stencilInstantiation);
 
@@ -45,6 +45,13 @@ std::string ASTStencilBody::getName(const std::shared_ptr<ast::Expr>& expr) cons
     return metadata_.getFieldNameFromAccessID(iir::getAccessID(expr));
 }
 
+ast::FieldPrecision
+ASTStencilBody::getFieldPrecision(const std::shared_ptr<ast::Expr>& expr) const {
+  if(currentFunction_ || expr->getKind() != ast::Expr::Kind::FieldAccessExpr)
+    return ast::FieldPrecision::Default;
+  return metadata_.getFieldPrecision(iir::getAccessID(expr));
+}
+
 //===------------------------------------------------------------------------------------------===//
 //     Stmt
 //===------------------------------------------------------------------------------------------===//
@@ -99,6 +106,33 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::StencilFunCallExpr>& expr)
   ss_ << ")";
 }
 
+// fields which are not stored in the default precision are converted explicitly, i.e. the stencil
+// computes in `::dawn::float_type` and the result is converted to the type of the field
+void ASTStencilBody::visit(const std::shared_ptr<ast::AssignmentExpr>& expr) {
+  const auto precision = getFieldPrecision(expr->getLeft());
+  isAssignmentTarget_ = true;
+  expr->getLeft()->accept(*this);
+  isAssignmentTarget_ = false;
+  if(precision == ast::FieldPrecision::Default) {
+    ss_ << " " << expr->getOp() << " ";
+    expr->getRight()->accept(*this);
+    return;
+  }
+
+  // compound assignments are expanded, `out op= x` becomes `out = out op (x)`, as the operation has
+  // to be carried out in `::dawn::float_type` as well
+  const std::string op = expr->getOp();
+  ss_ << " = static_cast<" << fieldPrecisionToCXXType(precision) << ">(";
+  if(op != "=") {
+    expr->getLeft()->accept(*this);
+    ss_ << " " << op.substr(0, op.size() - 1) << " (";
+  }
+  expr->getRight()->accept(*this);
+  if(op != "=")
+    ss_ << ")";
+  ss_ << ")";
+}
+
 void ASTStencilBody::visit(const std::shared_ptr<ast::StencilFunArgExpr>& expr) {}
 
 void ASTStencilBody::visit(const std::shared_ptr<ast::VarAccessExpr>& expr) {
@@ -173,8 +207,19 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::FieldAccessExpr>& expr) {
           << ijkfyOffset(currentFunction_->evalOffsetOfFieldAccessExpr(expr, false), accessName);
     }
   } else {
+    const bool isConverted =
+        !isAssignmentTarget_ && getFieldPrecision(expr) != ast::FieldPrecision::Default;
+    if(isConverted)
+      ss_ << "static_cast<::dawn::float_type>(";
     std::string accessName = getName(expr);
-    ss_ << accessName << ijkfyOffset(expr->getOffset(), accessName);
+    auto window = tmpWindows_.find(iir::getAccessID(expr));
+    if(window != tmpWindows_.end()) {
+      ss_ << accessName << ijkfyWindowOffset(expr->getOffset(), window->second);
+    } else {
+      ss_ << accessName << ijkfyOffset(expr->getOffset(), accessName);
+    }
+    if(isConverted)
+      ss_ << ")";
   }
 }
 
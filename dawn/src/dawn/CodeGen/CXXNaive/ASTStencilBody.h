@@ -18,6 +18,7 @@
 #include "dawn/CodeGen/CodeGenProperties.h"
 #include "dawn/IIR/Interval.h"
 #include "dawn/Support/StringUtil.h"
+#include <map>
 #include <stack>
 #include <unordered_map>
 
@@ -45,6 +46,16 @@ protected:
 
   StencilContext stencilContext_;
 
+  /// Number of levels of the temporaries stored as a rolling window of ij-planes, by AccessID
+  std::map<int, int> tmpWindows_;
+
+  /// Whether the next field access is the left hand side of an assignment
+  bool isAssignmentTarget_ = false;
+
+  /// @brief Precision of the field accessed by `expr` in the stencil body, the default precision
+  /// for any other expression and in stencil functions
+  ast::FieldPrecision getFieldPrecision(const std::shared_ptr<ast::Expr>& expr) const;
+
   ///
   /// @brief produces a string of (i,j,k) accesses for the C++ generated naive code,
   /// from an array of offseted accesses
@@ -63,6 +74,25 @@ protected:
            ")";
   }
 
+  ///
+  /// @brief produces the (i,j,k) access of a temporary stored as a rolling window of `numLevels`
+  /// ij-planes, i.e. the level `k` is stored in the plane `k mod numLevels`
+  ///
+  std::string ijkfyWindowOffset(const ast::Offsets& offsets, int numLevels) {
+    return "(" +
+           to_string(ast::cartesian, offsets, ", ",
+                     [&](std::string const& name, int offset) {
+                       std::string ret = name + "+" + std::to_string(offset);
+                       if(name != "k")
+                         return ret;
+                       if(numLevels == 1)
+                         return std::string("0");
+                       const std::string n = std::to_string(numLevels);
+                       return "((" + ret + ") % " + n + " + " + n + ") % " + n;
+                     }) +
+           ")";
+  }
+
 public:
   using Base = ASTCodeGenCXX;
   using Base::visit;
@@ -82,6 +112,7 @@ public:
 
   /// @name Expression implementation
   /// @{
+  virtual void visit(const std::shared_ptr<ast::AssignmentExpr>& expr) override;
   virtual void visit(const std::shared_ptr<ast::StencilFunCallExpr>& expr) override;
   virtual void visit(const std::shared_ptr<ast::StencilFunArgExpr>& expr) override;
   virtual void visit(const std::shared_ptr<ast::VarAccessExpr>& expr) override;
@@ -92,6 +123,9 @@ public:
   void setCurrentStencilFunction(
       const std::shared_ptr<iir::StencilFunctionInstantiation>& currentFunction);
 
+  /// @brief Set the temporaries stored as a rolling window of ij-planes
+  void setTmpWindows(const std::map<int, int>& tmpWindows) { tmpWindows_ = tmpWindows; }
+
   /// @brief Mapping of VarDeclStmt and Var/FieldAccessExpr to their name
   std::string getName(const std::shared_ptr<ast::Expr>& expr) const override;
   std::string getName(const std::shared_ptr<ast::VarDeclStmt>& stmt) const override;
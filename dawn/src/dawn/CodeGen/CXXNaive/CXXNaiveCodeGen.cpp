@@ -89,13 +89,18 @@ std::unique_ptr<TranslationUnit>
 run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
         stencilInstantiationMap,
     const Options& options) {
-  CXXNaiveCodeGen CG(stencilInstantiationMap, options.MaxHaloSize);
+  const Array3i domainSize{options.DomainSizeI, options.DomainSizeJ, options.DomainSizeK};
+  CXXNaiveCodeGen CG(stencilInstantiationMap, options.MaxHaloSize, options.TemporaryArena,
+                     domainSize, options.FuseBoundaryConditions);
 
   return CG.generateCode();
 }
 
-CXXNaiveCodeGen::CXXNaiveCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint)
-    : CodeGen(ctx, maxHaloPoint) {}
+CXXNaiveCodeGen::CXXNaiveCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint,
+                                 bool temporaryArena, const Array3i& domainSize,
+                                 bool fuseBoundaryConditions)
+    : CodeGen(ctx, maxHaloPoint), useTemporaryArena_(temporaryArena), domainSize_(domainSize),
+      fuseBoundaryConditions_(fuseBoundaryConditions) {}
 
 CXXNaiveCodeGen::~CXXNaiveCodeGen() {}
 
@@ -115,8 +120,13 @@ std::string CXXNaiveCodeGen::generateStencilInstantiation(
 
   CodeGenProperties codeGenProperties = computeCodeGenProperties(stencilInstantiation.get());
 
+  planTemporaryArena(*stencilInstantiation);
+
   generateStencilFunctions(stencilWrapperClass, stencilInstantiation, codeGenProperties);
 
+  if(fuseBoundaryConditions_)
+    generateBoundaryConditionFunctions(stencilWrapperClass, stencilInstantiation);
+
   generateStencilClasses(stencilInstantiation, stencilWrapperClass, codeGenProperties);
 
   generateStencilWrapperMembers(stencilWrapperClass, stencilInstantiation, codeGenProperties);
@@ -125,6 +135,8 @@ std::string CXXNaiveCodeGen::generateStencilInstantiation(
 
   generateGlobalsAPI(stencilWrapperClass, globalsMap, codeGenProperties);
 
+  generateStencilWrapperHaloExchange(stencilWrapperClass, stencilInstantiation, codeGenProperties);
+
   generateStencilWrapperRun(stencilWrapperClass, stencilInstantiation, codeGenProperties);
 
   stencilWrapperClass.commit();
@@ -135,6 +147,101 @@ std::string CXXNaiveCodeGen::generateStencilInstantiation(
   return ssSW.str();
 }
 
+bool CXXNaiveCodeGen::hasFixedDomainSize() const {
+  return std::all_of(domainSize_.begin(), domainSize_.end(), [](int size) { return size > 0; });
+}
+
+void CXXNaiveCodeGen::generateLoopBounds(MemberFunction& stencilRunMethod) const {
+  if(!hasFixedDomainSize()) {
+    stencilRunMethod.addStatement("int iMin = m_dom.iminus()");
+    stencilRunMethod.addStatement("int iMax = m_dom.isize() - m_dom.iplus() - 1");
+    stencilRunMethod.addStatement("int jMin = m_dom.jminus()");
+    stencilRunMethod.addStatement("int jMax = m_dom.jsize() - m_dom.jplus() - 1");
+    stencilRunMethod.addStatement("int kMin = m_dom.kminus()");
+    stencilRunMethod.addStatement("int kMax = m_dom.ksize() - m_dom.kplus() - 1");
+    return;
+  }
+  // the domain (and its default halos) is checked by the constructor of the stencil wrapper
+  const std::string halo = "GRIDTOOLS_DAWN_HALO_EXTENT";
+  stencilRunMethod.addStatement("constexpr int iMin = " + halo);
+  stencilRunMethod.addStatement("constexpr int iMax = " + std::to_string(domainSize_[0] - 1) +
+                                " - " + halo);
+  stencilRunMethod.addStatement("constexpr int jMin = " + halo);
+  stencilRunMethod.addStatement("constexpr int jMax = " + std::to_string(domainSize_[1] - 1) +
+                                " - " + halo);
+  stencilRunMethod.addStatement("constexpr int kMin = 0");
+  stencilRunMethod.addStatement("constexpr int kMax = " + std::to_string(domainSize_[2] - 1));
+}
+
+void CXXNaiveCodeGen::planTemporaryArena(const iir::StencilInstantiation& stencilInstantiation) {
+  temporaryArena_.reset();
+  if(!useTemporaryArena_)
+    return;
+  // temporaries stored as rolling windows of ij-planes or in a precision other than the one of
+  // the arena are not allocated in the arena
+  const auto& metadata = stencilInstantiation.getMetaData();
+  std::set<int> ignoredAccessIDs;
+  for(const auto& stencil : stencilInstantiation.getStencils()) {
+    for(const auto& tmpWindow : getTmpWindows(*stencil))
+      ignoredAccessIDs.insert(tmpWindow.first);
+    for(const auto& fieldPair : stencil->getFields())
+      if(metadata.getFieldPrecision(fieldPair.first) != ast::FieldPrecision::Default)
+        ignoredAccessIDs.insert(fieldPair.first);
+  }
+  TemporaryArena arena(stencilInstantiation, ignoredAccessIDs);
+  if(arena.empty())
+    return;
+  // size of a full 3D storage in the default precision (double), per grid point or for the domain
+  // size the code is specialized for (without the padding of the storages)
+  std::size_t storageBytes = sizeof(double);
+  std::string unit = " bytes per grid point";
+  if(hasFixedDomainSize()) {
+    storageBytes *= std::size_t(domainSize_[0]) * domainSize_[1] * (domainSize_[2] + 1);
+    unit = " bytes";
+  }
+  DAWN_LOG(INFO) << stencilInstantiation.getName() << ": temporary arena of " << arena.getNumSlots()
+                 << " storages for " << arena.getNumTemporaries()
+                 << " temporaries, peak memory of the temporaries reduced from "
+                 << arena.getNumTemporaries() * storageBytes << " to "
+                 << arena.getNumSlots() * storageBytes << unit;
+  temporaryArena_ = arena;
+}
+
+bool CXXNaiveCodeGen::hasTemporaryArena(const iir::Stencil& stencil) const {
+  const auto& fields = stencil.getFields();
+  return temporaryArena_ && std::any_of(fields.begin(), fields.end(), [&](const auto& fieldPair) {
+           return fieldPair.second.IsTemporary && temporaryArena_->contains(fieldPair.first);
+         });
+}
+
+std::map<int, int> CXXNaiveCodeGen::getTmpWindows(const iir::Stencil& stencil) const {
+  const auto& metadata = stencil.getMetadata();
+  std::map<int, int> tmpWindows;
+  for(const auto& [accessID, field] : stencil.getFields()) {
+    if(field.IsTemporary && metadata.getTemporaryNumLevels(accessID) > 0 &&
+       field.field.getFieldDimensions().getPrecision() == ast::FieldPrecision::Default)
+      tmpWindows.emplace(accessID, metadata.getTemporaryNumLevels(accessID));
+  }
+  return tmpWindows;
+}
+
+std::map<int, std::vector<CodeGen::FusedBoundaryCondition>>
+CXXNaiveCodeGen::getFusedBoundaryConditions(const iir::StencilInstantiation& stencilInstantiation,
+                                            const iir::Stencil& stencil) const {
+  if(!fuseBoundaryConditions_)
+    return {};
+  return computeFusedBoundaryConditions(stencilInstantiation, stencil);
+}
+
+void CXXNaiveCodeGen::generateFusedBoundaryConditions(
+    MemberFunction& stencilRunMethod, const iir::StencilMetaInformation& metadata,
+    const iir::MultiStage& multiStage, const iir::Interval& interval,
+    const std::vector<FusedBoundaryCondition>& bcs) const {
+  for(const auto& bc : bcs)
+    if(writesField(multiStage, interval, bc.accessID))
+      generateBoundaryConditionLoops(stencilRunMethod, metadata, bc);
+}
+
 void CXXNaiveCodeGen::generateStencilWrapperRun(
     Class& stencilWrapperClass,
     const std::shared_ptr<iir::StencilInstantiation> stencilInstantiation,
@@ -183,6 +290,12 @@ void CXXNaiveCodeGen::generateStencilWrapperCtr(
   StencilWrapperConstructor.addArg("int xcols = 1");
   StencilWrapperConstructor.addArg("int ycols = 1");
 
+  // the arena is allocated before the stencils, which take their temporaries from it
+  if(temporaryArena_) {
+    StencilWrapperConstructor.addInit(
+        "m_tmp_arena(" + std::to_string(temporaryArena_->getNumSlots()) + " * tmp_slot_size(dom))");
+  }
+
   // add the ctr initialization of each stencil
   for(const auto& stencilPtr : stencils) {
     iir::Stencil& stencil = *stencilPtr;
@@ -201,22 +314,39 @@ void CXXNaiveCodeGen::generateStencilWrapperCtr(
     initCtr += ", rank";
     initCtr += ", xcols";
     initCtr += ", ycols";
+    if(hasTemporaryArena(stencil)) {
+      initCtr += ", m_tmp_arena.data(), tmp_slot_size(dom)";
+    }
     initCtr += ")";
     StencilWrapperConstructor.addInit(initCtr);
   }
 
   if(metadata.hasAccessesOfType<iir::FieldAccessType::InterStencilTemporary>()) {
     std::vector<std::string> tempFields;
+    std::vector<int> arenaSlots;
     for(auto accessID : metadata.getAccessesOfType<iir::FieldAccessType::InterStencilTemporary>()) {
       tempFields.push_back(metadata.getFieldNameFromAccessID(accessID));
+      if(temporaryArena_)
+        arenaSlots.push_back(temporaryArena_->getSlot(accessID));
     }
-    addTmpStorageInitStencilWrapperCtr(StencilWrapperConstructor, stencils, tempFields);
+    addTmpStorageInitStencilWrapperCtr(StencilWrapperConstructor, stencils, tempFields, arenaSlots);
   }
   StencilWrapperConstructor.startBody();
   StencilWrapperConstructor.addStatement("assert(dom.isize() >= dom.iminus() + dom.iplus())");
   StencilWrapperConstructor.addStatement("assert(dom.jsize() >= dom.jminus() + dom.jplus())");
   StencilWrapperConstructor.addStatement("assert(dom.ksize() >= dom.kminus() + dom.kplus())");
   StencilWrapperConstructor.addStatement("assert(dom.ksize() >= 1)");
+  if(hasFixedDomainSize()) {
+    // the loop bounds of the stencils are specialized for this domain
+    StencilWrapperConstructor.addStatement(
+        "assert(dom.isize() == " + std::to_string(domainSize_[0]) +
+        " && dom.jsize() == " + std::to_string(domainSize_[1]) +
+        " && dom.ksize() == " + std::to_string(domainSize_[2]) + ")");
+    StencilWrapperConstructor.addStatement(
+        "assert(dom.iminus() == GRIDTOOLS_DAWN_HALO_EXTENT && dom.iplus() == "
+        "GRIDTOOLS_DAWN_HALO_EXTENT && dom.jminus() == GRIDTOOLS_DAWN_HALO_EXTENT && dom.jplus() "
+        "== GRIDTOOLS_DAWN_HALO_EXTENT && dom.kminus() == 0 && dom.kplus() == 0)");
+  }
   StencilWrapperConstructor.commit();
 
   StencilWrapperConstructor.commit();
@@ -236,6 +366,32 @@ void CXXNaiveCodeGen::generateStencilWrapperMembers(
     stencilWrapperClass.addMember("globals", "m_globals");
   }
 
+  // arena of the temporaries (declared before the stencils, which are initialized with it)
+  if(temporaryArena_) {
+    stencilWrapperClass.addMember("std::vector<::dawn::float_type>", "m_tmp_arena");
+
+    auto slotSizeMethod =
+        stencilWrapperClass.addMemberFunction("static std::size_t", "tmp_slot_size");
+    slotSizeMethod.addArg("const " + c_dgt + "domain& dom");
+    slotSizeMethod.startBody();
+    std::vector<std::string> sizes;
+    for(const auto& stencil : stencilInstantiation->getStencils()) {
+      if(!stencil->isEmpty() && hasTemporaryArena(*stencil)) {
+        sizes.push_back(
+            codeGenProperties.getStencilName(StencilContext::SC_Stencil, stencil->getStencilID()) +
+            "::tmp_storage_size(dom)");
+      }
+    }
+    if(metadata.hasAccessesOfType<iir::FieldAccessType::InterStencilTemporary>()) {
+      sizes.push_back("std::size_t(" + c_dgt +
+                      "meta_data_t(dom.isize(), dom.jsize(), dom.ksize() + 1)" +
+                      ".padded_total_length())");
+    }
+    slotSizeMethod.addStatement("return std::max<std::size_t>({" +
+                                RangeToString(", ", "", "")(sizes) + "})");
+    slotSizeMethod.commit();
+  }
+
   for(auto stencilPropertiesPair :
       codeGenProperties.stencilProperties(StencilContext::SC_Stencil)) {
     stencilWrapperClass.addMember(stencilPropertiesPair.second->name_,
@@ -286,15 +442,22 @@ void CXXNaiveCodeGen::generateStencilClasses(
         makeRange(stencilFields, [](std::pair<int, iir::Stencil::FieldInfo> const& p) {
           return !p.second.IsTemporary;
         });
+    // temporaries stored as rolling windows of ij-planes are allocated separately
+    const auto tmpWindows = getTmpWindows(stencil);
     auto tempFields =
-        makeRange(stencilFields, [](std::pair<int, iir::Stencil::FieldInfo> const& p) {
-          return p.second.IsTemporary;
+        makeRange(stencilFields, [&](std::pair<int, iir::Stencil::FieldInfo> const& p) {
+          return p.second.IsTemporary && !tmpWindows.count(p.first);
+        });
+    auto windowFields =
+        makeRange(stencilFields, [&](std::pair<int, iir::Stencil::FieldInfo> const& p) {
+          return p.second.IsTemporary && tmpWindows.count(p.first);
         });
 
     Structure stencilClass = stencilWrapperClass.addStruct(stencilName);
 
     ASTStencilBody stencilBodyCXXVisitor(stencilInstantiation->getMetaData(),
                                          StencilContext::SC_Stencil);
+    stencilBodyCXXVisitor.setTmpWindows(tmpWindows);
 
     stencilClass.addComment("Members");
     bool iterationSpaceSet = hasGlobalIndices(stencil);
@@ -304,6 +467,9 @@ void CXXNaiveCodeGen::generateStencilClasses(
 
     stencilClass.addComment("Temporary storages");
     addTempStorageTypedef(stencilClass, stencil);
+    if(!windowFields.empty()) {
+      addTmpWindowStorageTypedef(stencilClass);
+    }
 
     stencilClass.addMember("const " + c_dgt + "domain", "m_dom");
 
@@ -314,6 +480,7 @@ void CXXNaiveCodeGen::generateStencilClasses(
     stencilClass.addComment("Input/Output storages");
 
     addTmpStorageDeclaration(stencilClass, tempFields);
+    addTmpWindowStorageDeclaration(stencilClass, windowFields, tmpWindows);
 
     stencilClass.changeAccessibility("public");
 
@@ -326,6 +493,10 @@ void CXXNaiveCodeGen::generateStencilClasses(
     stencilClassCtr.addArg("int rank");
     stencilClassCtr.addArg("int xcols");
     stencilClassCtr.addArg("int ycols");
+    if(hasTemporaryArena(stencil)) {
+      stencilClassCtr.addArg("::dawn::float_type* tmp_arena");
+      stencilClassCtr.addArg("std::size_t tmp_slot_size");
+    }
 
     stencilClassCtr.addInit("m_dom(dom_)");
     if(!globalsMap.empty()) {
@@ -358,9 +529,18 @@ void CXXNaiveCodeGen::generateStencilClasses(
       stencilClassCtr.addInit("globalOffsets({computeGlobalOffsets(rank, m_dom, xcols, ycols)})");
     }
 
-    addTmpStorageInit(stencilClassCtr, stencil, tempFields);
+    if(hasTemporaryArena(stencil)) {
+      addTmpArenaStorageInit(stencilClassCtr, stencil, tempFields, *temporaryArena_);
+    } else {
+      addTmpStorageInit(stencilClassCtr, stencil, tempFields);
+    }
+    addTmpWindowStorageInit(stencilClassCtr, stencil, windowFields, tmpWindows);
     stencilClassCtr.commit();
 
+    if(hasTemporaryArena(stencil)) {
+      addTmpStorageSizeMethod(stencilClass, stencil);
+    }
+
     // virtual dtor
 
     // synchronize storages method
@@ -368,6 +548,9 @@ void CXXNaiveCodeGen::generateStencilClasses(
     // accumulated extents of API fields
     generateFieldExtentsInfo(stencilClass, nonTempFields, ast::GridType::Cartesian);
 
+    // halo regions of API fields required by each multi-stage
+    generateHaloExchangeInfo(stencilClass, stencil);
+
     //
     // Run-Method
     //
@@ -379,21 +562,32 @@ void CXXNaiveCodeGen::generateStencilClasses(
 
     stencilRunMethod.startBody();
     // Compute the loop bounds for readability
-    stencilRunMethod.addStatement("int iMin = m_dom.iminus()");
-    stencilRunMethod.addStatement("int iMax = m_dom.isize() - m_dom.iplus() - 1");
-    stencilRunMethod.addStatement("int jMin = m_dom.jminus()");
-    stencilRunMethod.addStatement("int jMax = m_dom.jsize() - m_dom.jplus() - 1");
-    stencilRunMethod.addStatement("int kMin = m_dom.kminus()");
-    stencilRunMethod.addStatement("int kMax = m_dom.ksize() - m_dom.kplus() - 1");
+    generateLoopBounds(stencilRunMethod);
 
     for(const auto& fieldPair : nonTempFields) {
       stencilRunMethod.addStatement(fieldPair.second.Name + "_" + ".sync()");
     }
+    const auto fusedBCs = getFusedBoundaryConditions(*stencilInstantiation, stencil);
+    int multiStageIdx = 0;
     for(const auto& multiStagePtr : stencil.getChildren()) {
+      // the halo exchanges are started after the producing multi-stages and only completed
+      // before the first multi-stage reading the halos, which overlaps them with the multi-stages
+      // in between
+      generateHaloExchangeWait(stencilRunMethod, stencil, multiStageIdx);
 
       stencilRunMethod.ss() << "{";
 
       const iir::MultiStage& multiStage = *multiStagePtr;
+      const bool sweepColumns =
+          multiStage.getLoopOrder() != iir::LoopOrderKind::Parallel && canSweepColumns(multiStage);
+
+      // boundary conditions of the fields produced by this multi-stage, applied at each k-level
+      // after the stages (while the level is in cache) or after the loop nest if the functor
+      // accesses other levels or the columns are swept
+      std::vector<FusedBoundaryCondition> levelBCs, deferredBCs;
+      if(fusedBCs.count(multiStage.getID()))
+        for(const auto& bc : fusedBCs.at(multiStage.getID()))
+          (bc.isLevelwise && !sweepColumns ? levelBCs : deferredBCs).push_back(bc);
 
       // create all the data views
       for(auto it = nonTempFields.begin(); it != nonTempFields.end(); ++it) {
@@ -405,8 +599,16 @@ void CXXNaiveCodeGen::generateStencilClasses(
       }
       for(const auto& fieldPair : tempFields) {
         const auto fieldName = fieldPair.second.Name;
-        stencilRunMethod.addStatement(c_gt + "data_view<tmp_storage_t> " + fieldName + "= " + c_gt +
-                                      "make_host_view(m_" + fieldName + ")");
+        stencilRunMethod.addStatement(c_gt + "data_view<" + getTmpStorageType(fieldPair.second) +
+                                      "> " + fieldName + "= " + c_gt + "make_host_view(m_" +
+                                      fieldName + ")");
+        stencilRunMethod.addStatement("std::array<int,3> " + fieldName + "_offsets{0,0,0}");
+      }
+      for(const auto& fieldPair : windowFields) {
+        const auto fieldName = fieldPair.second.Name;
+        stencilRunMethod.addStatement(c_gt + "data_view<" + tmpWindowStorageTypename_ + "> " +
+                                      fieldName + "= " + c_gt + "make_host_view(m_" + fieldName +
+                                      ")");
         stencilRunMethod.addStatement("std::array<int,3> " + fieldName + "_offsets{0,0,0}");
       }
 
@@ -419,75 +621,129 @@ void CXXNaiveCodeGen::generateStencilClasses(
       if((multiStage.getLoopOrder() == iir::LoopOrderKind::Backward))
         std::reverse(partitionIntervals.begin(), partitionIntervals.end());
 
-      for(auto interval : partitionIntervals) {
-
-        // for each interval, we generate naive nested loops
-        stencilRunMethod.addBlockStatement(
-            makeKLoop((multiStage.getLoopOrder() == iir::LoopOrderKind::Backward), interval),
-            [&]() {
-              for(const auto& stagePtr : multiStage.getChildren()) {
-                iir::Stage& stage = *stagePtr;
-
-                auto const& extents = iir::extent_cast<iir::CartesianExtent const&>(
-                    stage.getExtents().horizontalExtent());
-
-                // Check if we need to execute this statement:
-                bool hasOverlappingInterval = false;
-                for(const auto& doMethodPtr : stage.getChildren()) {
-                  hasOverlappingInterval |= (doMethodPtr->getInterval().overlaps(interval));
-                }
-
-                if(hasOverlappingInterval) {
-                  auto doMethodGenerator = [&]() {
-                    // Generate Do-Method
-                    for(const auto& doMethodPtr : stage.getChildren()) {
-                      const iir::DoMethod& doMethod = *doMethodPtr;
-                      if(!doMethod.getInterval().overlaps(interval))
-                        continue;
-                      for(const auto& stmt : doMethod.getAST().getStatements()) {
-                        stmt->accept(stencilBodyCXXVisitor);
-                        stencilRunMethod << stencilBodyCXXVisitor.getCodeAndResetStream();
-                      }
-                    }
-                  };
-
-                  stencilRunMethod.addBlockStatement(
-                      makeIJLoop(extents.iMinus(), extents.iPlus(), "m_dom", "i"), [&]() {
-                        stencilRunMethod.addBlockStatement(
-                            makeIJLoop(extents.jMinus(), extents.jPlus(), "m_dom", "j"), [&] {
-                              if(std::any_of(stage.getIterationSpace().cbegin(),
-                                             stage.getIterationSpace().cend(),
-                                             [](const auto& p) -> bool { return p.has_value(); })) {
-                                std::string conditional = "if(";
-                                if(stage.getIterationSpace()[0]) {
-                                  conditional += "checkOffset(stage" +
-                                                 std::to_string(stage.getStageID()) +
-                                                 "GlobalIIndices[0], stage" +
-                                                 std::to_string(stage.getStageID()) +
-                                                 "GlobalIIndices[1], globalOffsets[0] + i)";
-                                }
-                                if(stage.getIterationSpace()[1]) {
-                                  if(stage.getIterationSpace()[0]) {
-                                    conditional += " && ";
-                                  }
-                                  conditional += "checkOffset(stage" +
-                                                 std::to_string(stage.getStageID()) +
-                                                 "GlobalJIndices[0], stage" +
-                                                 std::to_string(stage.getStageID()) +
-                                                 "GlobalJIndices[1], globalOffsets[1] + j)";
-                                }
-                                conditional += ")";
-                                stencilRunMethod.addBlockStatement(conditional, doMethodGenerator);
-                              } else {
-                                doMethodGenerator();
-                              }
-                            });
-                      });
+      // generates the loop invariant declarations of a stage for the given interval, which are
+      // evaluated once per k-level before the horizontal loops
+      auto generateHoistedVarDecls = [&](const iir::Stage& stage, const iir::Interval& interval) {
+        for(const auto& doMethodPtr : stage.getChildren()) {
+          if(!doMethodPtr->getInterval().overlaps(interval))
+            continue;
+          for(const auto& stmt : doMethodPtr->getAST().getStatements()) {
+            if(isHoistedVarDecl(stmt, stencilInstantiation->getMetaData())) {
+              stmt->accept(stencilBodyCXXVisitor);
+              stencilRunMethod << stencilBodyCXXVisitor.getCodeAndResetStream();
+            }
+          }
+        }
+      };
+
+      // generates the statements of a stage for the given interval, the loops are generated by
+      // the caller (as well as the loop invariant declarations if `skipHoistedVarDecls`)
+      auto generateStage = [&](const iir::Stage& stage, const iir::Interval& interval,
+                               bool skipHoistedVarDecls) {
+        auto doMethodGenerator = [&]() {
+          // Generate Do-Method
+          for(const auto& doMethodPtr : stage.getChildren()) {
+            const iir::DoMethod& doMethod = *doMethodPtr;
+            if(!doMethod.getInterval().overlaps(interval))
+              continue;
+            for(const auto& stmt : doMethod.getAST().getStatements()) {
+              if(skipHoistedVarDecls && isHoistedVarDecl(stmt, stencilInstantiation->getMetaData()))
+                continue;
+              stmt->accept(stencilBodyCXXVisitor);
+              stencilRunMethod << stencilBodyCXXVisitor.getCodeAndResetStream();
+            }
+          }
+        };
+
+        if(std::any_of(stage.getIterationSpace().cbegin(), stage.getIterationSpace().cend(),
+                       [](const auto& p) -> bool { return p.has_value(); })) {
+          std::string conditional = "if(";
+          if(stage.getIterationSpace()[0]) {
+            conditional += "checkOffset(stage" + std::to_string(stage.getStageID()) +
+                           "GlobalIIndices[0], stage" + std::to_string(stage.getStageID()) +
+                           "GlobalIIndices[1], globalOffsets[0] + i)";
+          }
+          if(stage.getIterationSpace()[1]) {
+            if(stage.getIterationSpace()[0]) {
+              conditional += " && ";
+            }
+            conditional += "checkOffset(stage" + std::to_string(stage.getStageID()) +
+                           "GlobalJIndices[0], stage" + std::to_string(stage.getStageID()) +
+                           "GlobalJIndices[1], globalOffsets[1] + j)";
+          }
+          conditional += ")";
+          stencilRunMethod.addBlockStatement(conditional, doMethodGenerator);
+        } else {
+          doMethodGenerator();
+        }
+      };
+
+      // Check if we need to execute this stage
+      auto hasOverlappingInterval = [](const iir::Stage& stage, const iir::Interval& interval) {
+        return std::any_of(stage.childrenBegin(), stage.childrenEnd(),
+                           [&](const std::unique_ptr<iir::DoMethod>& doMethodPtr) {
+                             return doMethodPtr->getInterval().overlaps(interval);
+                           });
+      };
+
+      const bool isBackward = multiStage.getLoopOrder() == iir::LoopOrderKind::Backward;
+      if(sweepColumns) {
+        // vertical sweeps are computed column by column (k innermost) which keeps the column in
+        // cache
+        stencilRunMethod.addBlockStatement(makeIJLoop(0, 0, "m_dom", "i"), [&]() {
+          stencilRunMethod.addBlockStatement(makeIJLoop(0, 0, "m_dom", "j"), [&]() {
+            for(auto interval : partitionIntervals) {
+              stencilRunMethod.addBlockStatement(makeKLoop(isBackward, interval), [&]() {
+                for(const auto& stagePtr : multiStage.getChildren()) {
+                  if(hasOverlappingInterval(*stagePtr, interval)) {
+                    generateStage(*stagePtr, interval, false);
+                  }
                 }
+              });
+            }
+          });
+        });
+      } else {
+        for(auto interval : partitionIntervals) {
+
+          // for each interval, we generate naive nested loops
+          stencilRunMethod.addBlockStatement(makeKLoop(isBackward, interval), [&]() {
+            for(const auto& stagePtr : multiStage.getChildren()) {
+              const iir::Stage& stage = *stagePtr;
+              if(!hasOverlappingInterval(stage, interval)) {
+                continue;
               }
-            });
+
+              auto const& extents = iir::extent_cast<iir::CartesianExtent const&>(
+                  stage.getExtents().horizontalExtent());
+
+              generateHoistedVarDecls(stage, interval);
+              stencilRunMethod.addBlockStatement(
+                  makeIJLoop(extents.iMinus(), extents.iPlus(), "m_dom", "i"), [&]() {
+                    stencilRunMethod.addBlockStatement(
+                        makeIJLoop(extents.jMinus(), extents.jPlus(), "m_dom", "j"),
+                        [&] { generateStage(stage, interval, true); });
+                  });
+            }
+            generateFusedBoundaryConditions(stencilRunMethod, stencilInstantiation->getMetaData(),
+                                            multiStage, interval, levelBCs);
+          });
+        }
+      }
+      if(!deferredBCs.empty()) {
+        for(auto interval : partitionIntervals) {
+          if(std::none_of(deferredBCs.begin(), deferredBCs.end(), [&](const auto& bc) {
+               return writesField(multiStage, interval, bc.accessID);
+             }))
+            continue;
+          stencilRunMethod.addBlockStatement(makeKLoop(false, interval), [&]() {
+            generateFusedBoundaryConditions(stencilRunMethod, stencilInstantiation->getMetaData(),
+                                            multiStage, interval, deferredBCs);
+          });
+        }
       }
       stencilRunMethod.ss() << "}";
+      generateHaloExchangeStart(stencilRunMethod, stencil, multiStageIdx++);
     }
     for(const auto& fieldPair : nonTempFields) {
       stencilRunMethod.addStatement(fieldPair.second.Name + "_" + ".sync()");
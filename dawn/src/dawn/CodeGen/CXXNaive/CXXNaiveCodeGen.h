@@ -18,7 +18,10 @@
 #include "dawn/CodeGen/CodeGenProperties.h"
 #include "dawn/CodeGen/Options.h"
 #include "dawn/IIR/Interval.h"
+#include "dawn/Support/Array.h"
 #include "dawn/Support/IndexRange.h"
+#include <map>
+#include <optional>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -43,7 +46,9 @@ run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
 class CXXNaiveCodeGen : public CodeGen {
 public:
   ///@brief constructor
-  CXXNaiveCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint);
+  CXXNaiveCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint,
+                  bool temporaryArena = false, const Array3i& domainSize = {0, 0, 0},
+                  bool fuseBoundaryConditions = false);
   virtual ~CXXNaiveCodeGen();
   virtual std::unique_ptr<TranslationUnit> generateCode() override;
 
@@ -73,6 +78,45 @@ protected:
   generateStencilWrapperRun(Class& stencilWrapperClass,
                             const std::shared_ptr<iir::StencilInstantiation> stencilInstantiation,
                             const CodeGenProperties& codeGenProperties) const;
+
+  /// @brief Declare the loop bounds `iMin`, `iMax`, ... of the run method of a stencil, as
+  /// `constexpr` if the domain size is fixed
+  void generateLoopBounds(MemberFunction& stencilRunMethod) const;
+
+  /// @brief Whether the domain size is known at code generation time (all dimensions are set)
+  bool hasFixedDomainSize() const;
+
+  /// @brief Plan the `TemporaryArena` of the stencil instantiation (if enabled)
+  void planTemporaryArena(const iir::StencilInstantiation& stencilInstantiation);
+
+  /// @brief Whether the stencil classes get their temporaries from the arena of the wrapper
+  bool hasTemporaryArena(const iir::Stencil& stencil) const;
+
+  /// @brief Number of ij-planes of the temporaries of `stencil` which are stored as a rolling
+  /// window (@see iir::StencilMetaInformation::getTemporaryNumLevels), by AccessID. Only
+  /// temporaries in the default precision are stored as windows.
+  virtual std::map<int, int> getTmpWindows(const iir::Stencil& stencil) const;
+
+  /// @brief Boundary conditions fused into the multi-stages of `stencil` (if enabled)
+  std::map<int, std::vector<FusedBoundaryCondition>>
+  getFusedBoundaryConditions(const iir::StencilInstantiation& stencilInstantiation,
+                             const iir::Stencil& stencil) const;
+
+  /// @brief Generate the boundary conditions `bcs` at the level `k` of `interval`, for the fields
+  /// which `multiStage` writes in `interval`
+  void generateFusedBoundaryConditions(MemberFunction& stencilRunMethod,
+                                       const iir::StencilMetaInformation& metadata,
+                                       const iir::MultiStage& multiStage,
+                                       const iir::Interval& interval,
+                                       const std::vector<FusedBoundaryCondition>& bcs) const;
+
+  const bool useTemporaryArena_;
+  /// Size of the domain (including the halos) the code is specialized for, 0 if not fixed
+  const Array3i domainSize_;
+  /// Apply the boundary conditions in the multi-stages producing the fields
+  const bool fuseBoundaryConditions_;
+  /// Arena of the stencil instantiation being generated, empty if disabled or without temporaries
+  std::optional<TemporaryArena> temporaryArena_;
 };
 } // namespace cxxnaive
 } // namespace codegen
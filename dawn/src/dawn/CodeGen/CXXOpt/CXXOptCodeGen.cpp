@@ -94,16 +94,31 @@ std::string makeKLoop(bool isBackward, iir::Interval const& interval, bool isPar
 std::unique_ptr<TranslationUnit>
 run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
         stencilInstantiationMap, const Options& options) {
-  CXXOptCodeGen CG(stencilInstantiationMap, options.MaxHaloSize);
+  const Array3i domainSize{options.DomainSizeI, options.DomainSizeJ, options.DomainSizeK};
+  CXXOptCodeGen CG(stencilInstantiationMap, options.MaxHaloSize, options.TemporaryArena, domainSize,
+                   options.FuseBoundaryConditions);
 
   return CG.generateCode();
 }
 
-CXXOptCodeGen::CXXOptCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint)
-    : CXXNaiveCodeGen(ctx, maxHaloPoint) {}
+CXXOptCodeGen::CXXOptCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint,
+                             bool temporaryArena, const Array3i& domainSize,
+                             bool fuseBoundaryConditions)
+    : CXXNaiveCodeGen(ctx, maxHaloPoint, temporaryArena, domainSize, fuseBoundaryConditions) {}
 
 CXXOptCodeGen::~CXXOptCodeGen() {}
 
+std::map<int, int> CXXOptCodeGen::getTmpWindows(const iir::Stencil& stencil) const {
+  auto tmpWindows = CXXNaiveCodeGen::getTmpWindows(stencil);
+  for(const auto& multiStage : stencil.getChildren()) {
+    if(multiStage->getLoopOrder() != iir::LoopOrderKind::Parallel)
+      continue;
+    for(const auto& fieldPair : multiStage->getFields())
+      tmpWindows.erase(fieldPair.first);
+  }
+  return tmpWindows;
+}
+
 std::string CXXOptCodeGen::generateStencilInstantiation(
     const std::shared_ptr<iir::StencilInstantiation> stencilInstantiation) {
   using namespace codegen;
@@ -120,8 +135,13 @@ std::string CXXOptCodeGen::generateStencilInstantiation(
 
   CodeGenProperties codeGenProperties = computeCodeGenProperties(stencilInstantiation.get());
 
+  planTemporaryArena(*stencilInstantiation);
+
   generateStencilFunctions(stencilWrapperClass, stencilInstantiation, codeGenProperties);
 
+  if(fuseBoundaryConditions_)
+    generateBoundaryConditionFunctions(stencilWrapperClass, stencilInstantiation);
+
   generateStencilClasses(stencilInstantiation, stencilWrapperClass, codeGenProperties);
 
   generateStencilWrapperMembers(stencilWrapperClass, stencilInstantiation, codeGenProperties);
@@ -130,6 +150,8 @@ std::string CXXOptCodeGen::generateStencilInstantiation(
 
   generateGlobalsAPI(stencilWrapperClass, globalsMap, codeGenProperties);
 
+  generateStencilWrapperHaloExchange(stencilWrapperClass, stencilInstantiation, codeGenProperties);
+
   generateStencilWrapperRun(stencilWrapperClass, stencilInstantiation, codeGenProperties);
 
   stencilWrapperClass.commit();
@@ -168,15 +190,22 @@ void CXXOptCodeGen::generateStencilClasses(
         makeRange(stencilFields, [](std::pair<int, iir::Stencil::FieldInfo> const& p) {
           return !p.second.IsTemporary;
         });
+    // temporaries stored as rolling windows of ij-planes are allocated separately
+    const auto tmpWindows = getTmpWindows(stencil);
     auto tempFields =
-        makeRange(stencilFields, [](std::pair<int, iir::Stencil::FieldInfo> const& p) {
-          return p.second.IsTemporary;
+        makeRange(stencilFields, [&](std::pair<int, iir::Stencil::FieldInfo> const& p) {
+          return p.second.IsTemporary && !tmpWindows.count(p.first);
+        });
+    auto windowFields =
+        makeRange(stencilFields, [&](std::pair<int, iir::Stencil::FieldInfo> const& p) {
+          return p.second.IsTemporary && tmpWindows.count(p.first);
         });
 
     Structure stencilClass = stencilWrapperClass.addStruct(stencilName);
 
     ASTStencilBody stencilBodyCXXVisitor(stencilInstantiation->getMetaData(),
                                          StencilContext::SC_Stencil);
+    stencilBodyCXXVisitor.setTmpWindows(tmpWindows);
 
     stencilClass.addComment("Members");
     bool iterationSpaceSet = hasGlobalIndices(stencil);
@@ -186,6 +215,9 @@ void CXXOptCodeGen::generateStencilClasses(
 
     stencilClass.addComment("Temporary storages");
     addTempStorageTypedef(stencilClass, stencil);
+    if(!windowFields.empty()) {
+      addTmpWindowStorageTypedef(stencilClass);
+    }
 
     stencilClass.addMember("const " + c_dgt + "domain", "m_dom");
 
@@ -196,6 +228,7 @@ void CXXOptCodeGen::generateStencilClasses(
     stencilClass.addComment("Input/Output storages");
 
     addTmpStorageDeclaration(stencilClass, tempFields);
+    addTmpWindowStorageDeclaration(stencilClass, windowFields, tmpWindows);
 
     stencilClass.changeAccessibility("public");
 
@@ -208,6 +241,10 @@ void CXXOptCodeGen::generateStencilClasses(
     stencilClassCtr.addArg("int rank");
     stencilClassCtr.addArg("int xcols");
     stencilClassCtr.addArg("int ycols");
+    if(hasTemporaryArena(stencil)) {
+      stencilClassCtr.addArg("::dawn::float_type* tmp_arena");
+      stencilClassCtr.addArg("std::size_t tmp_slot_size");
+    }
 
     stencilClassCtr.addInit("m_dom(dom_)");
     if(!globalsMap.empty()) {
@@ -240,9 +277,18 @@ void CXXOptCodeGen::generateStencilClasses(
       stencilClassCtr.addInit("globalOffsets({computeGlobalOffsets(rank, m_dom, xcols, ycols)})");
     }
 
-    addTmpStorageInit(stencilClassCtr, stencil, tempFields);
+    if(hasTemporaryArena(stencil)) {
+      addTmpArenaStorageInit(stencilClassCtr, stencil, tempFields, *temporaryArena_);
+    } else {
+      addTmpStorageInit(stencilClassCtr, stencil, tempFields);
+    }
+    addTmpWindowStorageInit(stencilClassCtr, stencil, windowFields, tmpWindows);
     stencilClassCtr.commit();
 
+    if(hasTemporaryArena(stencil)) {
+      addTmpStorageSizeMethod(stencilClass, stencil);
+    }
+
     // virtual dtor
 
     // synchronize storages method
@@ -250,6 +296,9 @@ void CXXOptCodeGen::generateStencilClasses(
     // accumulated extents of API fields
     generateFieldExtentsInfo(stencilClass, nonTempFields, ast::GridType::Cartesian);
 
+    // halo regions of API fields required by each multi-stage
+    generateHaloExchangeInfo(stencilClass, stencil);
+
     //
     // Run-Method
     //
@@ -261,21 +310,32 @@ void CXXOptCodeGen::generateStencilClasses(
 
     stencilRunMethod.startBody();
     // Compute the loop bounds for readability
-    stencilRunMethod.addStatement("int iMin = m_dom.iminus()");
-    stencilRunMethod.addStatement("int iMax = m_dom.isize() - m_dom.iplus() - 1");
-    stencilRunMethod.addStatement("int jMin = m_dom.jminus()");
-    stencilRunMethod.addStatement("int jMax = m_dom.jsize() - m_dom.jplus() - 1");
-    stencilRunMethod.addStatement("int kMin = m_dom.kminus()");
-    stencilRunMethod.addStatement("int kMax = m_dom.ksize() - m_dom.kplus() - 1");
+    generateLoopBounds(stencilRunMethod);
 
     for(const auto& fieldPair : nonTempFields) {
       stencilRunMethod.addStatement(fieldPair.second.Name + "_" + ".sync()");
     }
+    const auto fusedBCs = getFusedBoundaryConditions(*stencilInstantiation, stencil);
+    int multiStageIdx = 0;
     for(const auto& multiStagePtr : stencil.getChildren()) {
+      // the halo exchanges are started after the producing multi-stages and only completed
+      // before the first multi-stage reading the halos, which overlaps them with the multi-stages
+      // in between
+      generateHaloExchangeWait(stencilRunMethod, stencil, multiStageIdx);
 
       stencilRunMethod.ss() << "{";
 
       const iir::MultiStage& multiStage = *multiStagePtr;
+      const bool sweepColumns =
+          multiStage.getLoopOrder() != iir::LoopOrderKind::Parallel && canSweepColumns(multiStage);
+
+      // boundary conditions of the fields produced by this multi-stage, applied at each k-level
+      // after the stages (while the level is in cache) or after the loop nest if the functor
+      // accesses other levels or the columns are swept
+      std::vector<FusedBoundaryCondition> levelBCs, deferredBCs;
+      if(fusedBCs.count(multiStage.getID()))
+        for(const auto& bc : fusedBCs.at(multiStage.getID()))
+          (bc.isLevelwise && !sweepColumns ? levelBCs : deferredBCs).push_back(bc);
 
       // create all the data views
       for(auto it = nonTempFields.begin(); it != nonTempFields.end(); ++it) {
@@ -287,8 +347,16 @@ void CXXOptCodeGen::generateStencilClasses(
       }
       for(const auto& fieldPair : tempFields) {
         const auto fieldName = fieldPair.second.Name;
-        stencilRunMethod.addStatement(c_gt + "data_view<tmp_storage_t> " + fieldName + "= " +
-                                      c_gt + "make_host_view(m_" + fieldName + ")");
+        stencilRunMethod.addStatement(c_gt + "data_view<" + getTmpStorageType(fieldPair.second) +
+                                      "> " + fieldName + "= " + c_gt + "make_host_view(m_" +
+                                      fieldName + ")");
+        stencilRunMethod.addStatement("std::array<int,3> " + fieldName + "_offsets{0,0,0}");
+      }
+      for(const auto& fieldPair : windowFields) {
+        const auto fieldName = fieldPair.second.Name;
+        stencilRunMethod.addStatement(c_gt + "data_view<" + tmpWindowStorageTypename_ + "> " +
+                                      fieldName + "= " + c_gt + "make_host_view(m_" + fieldName +
+                                      ")");
         stencilRunMethod.addStatement("std::array<int,3> " + fieldName + "_offsets{0,0,0}");
       }
 
@@ -301,77 +369,135 @@ void CXXOptCodeGen::generateStencilClasses(
       if((multiStage.getLoopOrder() == iir::LoopOrderKind::Backward))
         std::reverse(partitionIntervals.begin(), partitionIntervals.end());
 
-      for(auto interval : partitionIntervals) {
-
-        // for each interval, we generate naive nested loops
+      // generates the loop invariant declarations of a stage for the given interval, which are
+      // evaluated once per k-level before the horizontal loops
+      auto generateHoistedVarDecls = [&](const iir::Stage& stage, const iir::Interval& interval) {
+        for(const auto& doMethodPtr : stage.getChildren()) {
+          if(!doMethodPtr->getInterval().overlaps(interval))
+            continue;
+          for(const auto& stmt : doMethodPtr->getAST().getStatements()) {
+            if(isHoistedVarDecl(stmt, stencilInstantiation->getMetaData())) {
+              stmt->accept(stencilBodyCXXVisitor);
+              stencilRunMethod << stencilBodyCXXVisitor.getCodeAndResetStream();
+            }
+          }
+        }
+      };
+
+      // generates the statements of a stage for the given interval, the loops are generated by
+      // the caller (as well as the loop invariant declarations if `skipHoistedVarDecls`)
+      auto generateStage = [&](const iir::Stage& stage, const iir::Interval& interval,
+                               bool skipHoistedVarDecls) {
+        auto doMethodGenerator = [&]() {
+          // Generate Do-Method
+          for(const auto& doMethodPtr : stage.getChildren()) {
+            const iir::DoMethod& doMethod = *doMethodPtr;
+            if(!doMethod.getInterval().overlaps(interval))
+              continue;
+            for(const auto& stmt : doMethod.getAST().getStatements()) {
+              if(skipHoistedVarDecls && isHoistedVarDecl(stmt, stencilInstantiation->getMetaData()))
+                continue;
+              stmt->accept(stencilBodyCXXVisitor);
+              stencilRunMethod << stencilBodyCXXVisitor.getCodeAndResetStream();
+            }
+          }
+        };
+
+        if(std::any_of(stage.getIterationSpace().cbegin(), stage.getIterationSpace().cend(),
+                       [](const auto& p) -> bool { return p.has_value(); })) {
+          std::string conditional = "if(";
+          if(stage.getIterationSpace()[0]) {
+            conditional += "checkOffset(stage" + std::to_string(stage.getStageID()) +
+                           "GlobalIIndices[0], stage" + std::to_string(stage.getStageID()) +
+                           "GlobalIIndices[1], globalOffsets[0] + i)";
+          }
+          if(stage.getIterationSpace()[1]) {
+            if(stage.getIterationSpace()[0]) {
+              conditional += " && ";
+            }
+            conditional += "checkOffset(stage" + std::to_string(stage.getStageID()) +
+                           "GlobalJIndices[0], stage" + std::to_string(stage.getStageID()) +
+                           "GlobalJIndices[1], globalOffsets[1] + j)";
+          }
+          conditional += ")";
+          stencilRunMethod.addBlockStatement(conditional, doMethodGenerator);
+        } else {
+          doMethodGenerator();
+        }
+      };
+
+      // Check if we need to execute this stage
+      auto hasOverlappingInterval = [](const iir::Stage& stage, const iir::Interval& interval) {
+        return std::any_of(stage.childrenBegin(), stage.childrenEnd(),
+                           [&](const std::unique_ptr<iir::DoMethod>& doMethodPtr) {
+                             return doMethodPtr->getInterval().overlaps(interval);
+                           });
+      };
+
+      const bool isBackward = multiStage.getLoopOrder() == iir::LoopOrderKind::Backward;
+      if(sweepColumns) {
+        // vertical sweeps are computed column by column (k innermost) which keeps the column in
+        // cache, the columns are distributed among the threads
         stencilRunMethod.addBlockStatement(
-            makeKLoop((multiStage.getLoopOrder() == iir::LoopOrderKind::Backward), interval,
-                      (multiStage.getLoopOrder() == iir::LoopOrderKind::Parallel)),
-            [&]() {
-              for(const auto& stagePtr : multiStage.getChildren()) {
-                iir::Stage& stage = *stagePtr;
-
-                auto const& extents = iir::extent_cast<iir::CartesianExtent const&>(
-                    stage.getExtents().horizontalExtent());
-
-                // Check if we need to execute this statement:
-                bool hasOverlappingInterval = false;
-                for(const auto& doMethodPtr : stage.getChildren()) {
-                  hasOverlappingInterval |= (doMethodPtr->getInterval().overlaps(interval));
-                }
-
-                if(hasOverlappingInterval) {
-                  auto doMethodGenerator = [&]() {
-                    // Generate Do-Method
-                    for(const auto& doMethodPtr : stage.getChildren()) {
-                      const iir::DoMethod& doMethod = *doMethodPtr;
-                      if(!doMethod.getInterval().overlaps(interval))
-                        continue;
-                      for(const auto& stmt : doMethod.getAST().getStatements()) {
-                        stmt->accept(stencilBodyCXXVisitor);
-                        stencilRunMethod << stencilBodyCXXVisitor.getCodeAndResetStream();
+            makeLoopImpl(0, 0, "i", "iMin", "iMax", " <= ", "++", /*isParallel*/ true), [&]() {
+              stencilRunMethod.addBlockStatement(makeIJLoop(0, 0, "m_dom", "j"), [&]() {
+                for(auto interval : partitionIntervals) {
+                  stencilRunMethod.addBlockStatement(makeKLoop(isBackward, interval), [&]() {
+                    for(const auto& stagePtr : multiStage.getChildren()) {
+                      if(hasOverlappingInterval(*stagePtr, interval)) {
+                        generateStage(*stagePtr, interval, false);
                       }
                     }
-                  };
-
+                  });
+                }
+              });
+            });
+      } else {
+        for(auto interval : partitionIntervals) {
+
+          // for each interval, we generate naive nested loops (the k-levels of parallel
+          // multi-stages are distributed among the threads)
+          stencilRunMethod.addBlockStatement(
+              makeKLoop(isBackward, interval,
+                        (multiStage.getLoopOrder() == iir::LoopOrderKind::Parallel)),
+              [&]() {
+                for(const auto& stagePtr : multiStage.getChildren()) {
+                  const iir::Stage& stage = *stagePtr;
+                  if(!hasOverlappingInterval(stage, interval)) {
+                    continue;
+                  }
+
+                  auto const& extents = iir::extent_cast<iir::CartesianExtent const&>(
+                      stage.getExtents().horizontalExtent());
+
+                  generateHoistedVarDecls(stage, interval);
                   stencilRunMethod.addBlockStatement(
                       makeIJLoop(extents.iMinus(), extents.iPlus(), "m_dom", "i"), [&]() {
                         stencilRunMethod.addBlockStatement(
                             makeIJLoop(extents.jMinus(), extents.jPlus(), "m_dom", "j", true),
-                            [&] {
-                              if(std::any_of(stage.getIterationSpace().cbegin(),
-                                             stage.getIterationSpace().cend(),
-                                             [](const auto& p) -> bool { return p.has_value(); })) {
-                                std::string conditional = "if(";
-                                if(stage.getIterationSpace()[0]) {
-                                  conditional += "checkOffset(stage" +
-                                                 std::to_string(stage.getStageID()) +
-                                                 "GlobalIIndices[0], stage" +
-                                                 std::to_string(stage.getStageID()) +
-                                                 "GlobalIIndices[1], globalOffsets[0] + i)";
-                                }
-                                if(stage.getIterationSpace()[1]) {
-                                  if(stage.getIterationSpace()[0]) {
-                                    conditional += " && ";
-                                  }
-                                  conditional += "checkOffset(stage" +
-                                                 std::to_string(stage.getStageID()) +
-                                                 "GlobalJIndices[0], stage" +
-                                                 std::to_string(stage.getStageID()) +
-                                                 "GlobalJIndices[1], globalOffsets[1] + j)";
-                                }
-                                conditional += ")";
-                                stencilRunMethod.addBlockStatement(conditional, doMethodGenerator);
-                              } else {
-                                doMethodGenerator();
-                              }
-                            });
+                            [&] { generateStage(stage, interval, true); });
                       });
                 }
-              }
-            });
+                generateFusedBoundaryConditions(stencilRunMethod,
+                                                stencilInstantiation->getMetaData(), multiStage,
+                                                interval, levelBCs);
+              });
+        }
+      }
+      if(!deferredBCs.empty()) {
+        for(auto interval : partitionIntervals) {
+          if(std::none_of(deferredBCs.begin(), deferredBCs.end(), [&](const auto& bc) {
+               return writesField(multiStage, interval, bc.accessID);
+             }))
+            continue;
+          stencilRunMethod.addBlockStatement(makeKLoop(false, interval), [&]() {
+            generateFusedBoundaryConditions(stencilRunMethod, stencilInstantiation->getMetaData(),
+                                            multiStage, interval, deferredBCs);
+          });
+        }
       }
       stencilRunMethod.ss() << "}";
+      generateHaloExchangeStart(stencilRunMethod, stencil, multiStageIdx++);
     }
     for(const auto& fieldPair : nonTempFields) {
       stencilRunMethod.addStatement(fieldPair.second.Name + "_" + ".sync()");
@@ -45,10 +45,17 @@ run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
 class CXXOptCodeGen : public CXXNaiveCodeGen {
 public:
   ///@brief constructor
-  CXXOptCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint);
+  CXXOptCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoint,
+                bool temporaryArena = false, const Array3i& domainSize = {0, 0, 0},
+                bool fuseBoundaryConditions = false);
   virtual ~CXXOptCodeGen();
   virtual std::unique_ptr<TranslationUnit> generateCode() override;
 
+protected:
+  /// @brief The k-levels of parallel multi-stages are distributed among the threads, hence their
+  /// temporaries are not stored as rolling windows
+  std::map<int, int> getTmpWindows(const iir::Stencil& stencil) const override;
+
 private:
   std::string generateStencilInstantiation(
       const std::shared_ptr<iir::StencilInstantiation> stencilInstantiation);
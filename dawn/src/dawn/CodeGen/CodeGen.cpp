@@ -13,9 +13,15 @@
 //===------------------------------------------------------------------------------------------===//
 
 #include "dawn/CodeGen/CodeGen.h"
+#include "dawn/CodeGen/ASTCodeGenCXX.h"
 #include "dawn/CodeGen/StencilFunctionAsBCGenerator.h"
+#include "dawn/AST/ASTVisitor.h"
 #include "dawn/IIR/Extents.h"
+#include "dawn/IIR/IIRNodeIterator.h"
+#include <algorithm>
+#include <functional>
 #include <optional>
+#include <set>
 
 namespace dawn {
 namespace codegen {
@@ -310,6 +316,9 @@ std::string CodeGen::getStorageType(const ast::FieldDimensions& dimensions) {
   storageType += cartesianDimensions.I() ? "i" : "";
   storageType += cartesianDimensions.J() ? "j" : "";
   storageType += dimensions.K() ? "k" : "";
+  if(dimensions.getPrecision() != ast::FieldPrecision::Default)
+    storageType +=
+        std::string("_") + ASTCodeGenCXX::fieldPrecisionToCXXType(dimensions.getPrecision());
   storageType += "_t";
   return storageType;
 }
@@ -332,6 +341,25 @@ void CodeGen::addTempStorageTypedef(Structure& stencilClass, iir::Stencil const&
 
   stencilClass.addTypeDef(tmpStorageTypename_)
       .addType("storage_traits_t::data_store_t< ::dawn::float_type, " + tmpMetadataTypename_ + ">");
+
+  std::set<ast::FieldPrecision> precisions;
+  for(const auto& fieldPair : stencil.getFields())
+    if(fieldPair.second.IsTemporary)
+      precisions.insert(fieldPair.second.field.getFieldDimensions().getPrecision());
+  for(auto precision : precisions) {
+    if(precision == ast::FieldPrecision::Default)
+      continue;
+    const std::string type = ASTCodeGenCXX::fieldPrecisionToCXXType(precision);
+    stencilClass.addTypeDef("tmp_storage_" + type + "_t")
+        .addType("storage_traits_t::data_store_t< " + type + ", " + tmpMetadataTypename_ + ">");
+  }
+}
+
+std::string CodeGen::getTmpStorageType(const iir::Stencil::FieldInfo& field) const {
+  const auto precision = field.field.getFieldDimensions().getPrecision();
+  if(precision == ast::FieldPrecision::Default)
+    return tmpStorageTypename_;
+  return std::string("tmp_storage_") + ASTCodeGenCXX::fieldPrecisionToCXXType(precision) + "_t";
 }
 
 void CodeGen::addTmpStorageDeclaration(
@@ -341,55 +369,138 @@ void CodeGen::addTmpStorageDeclaration(
     stencilClass.addMember(tmpMetadataTypename_, tmpMetadataName_);
 
     for(const auto& field : tempFields) {
-      stencilClass.addMember(tmpStorageTypename_, "m_" + field.second.Name);
+      stencilClass.addMember(getTmpStorageType(field.second), "m_" + field.second.Name);
     }
   }
 }
 
+std::string CodeGen::makeTmpMetadataArgs(const iir::Stencil& stencil, int numLevels) const {
+  iir::Extents maxExtents{ast::cartesian};
+  for(const auto& multiStage : stencil.getChildren())
+    for(const auto& stage : multiStage->getChildren())
+      maxExtents.merge(stage->getExtents());
+
+  int iMax, jMax;
+  try {
+    iir::CartesianExtent hMaxExtents =
+        iir::extent_cast<iir::CartesianExtent const&>(maxExtents.horizontalExtent());
+    iMax = hMaxExtents.iPlus();
+    jMax = hMaxExtents.jPlus();
+  } catch(const std::bad_cast& error) {
+    iMax = jMax = 0;
+  }
+
+  std::string args = "dom_.isize()";
+  if(iMax > 0)
+    args += " + " + std::to_string(iMax);
+  args += ", dom_.jsize()";
+  if(jMax > 0)
+    args += " + " + std::to_string(jMax);
+  if(numLevels > 0)
+    args += ", " + std::to_string(numLevels);
+  else
+    args += ", dom_.ksize() + 2*" + std::to_string(getVerticalTmpHaloSize(stencil));
+  return args;
+}
+
 void CodeGen::addTmpStorageInit(
     MemberFunction& ctr, iir::Stencil const& stencil,
     IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& tempFields) const {
   if(!(tempFields.empty())) {
-    iir::Extents maxExtents{ast::cartesian};
-    for(const auto& multiStage : stencil.getChildren())
-      for(const auto& stage : multiStage->getChildren())
-        maxExtents.merge(stage->getExtents());
-
-    int iMax, jMax;
-    try {
-      iir::CartesianExtent hMaxExtents =
-          iir::extent_cast<iir::CartesianExtent const&>(maxExtents.horizontalExtent());
-      iMax = hMaxExtents.iPlus();
-      jMax = hMaxExtents.jPlus();
-    } catch(const std::bad_cast& error) {
-      iMax = jMax = 0;
+    ctr.addInit(tmpMetadataName_ + "(" + makeTmpMetadataArgs(stencil) + ")");
+    for(const auto& field : tempFields) {
+      ctr.addInit("m_" + field.second.Name + "(" + tmpMetadataName_ + ")");
     }
+  }
+}
+
+void CodeGen::addTmpWindowStorageTypedef(Structure& stencilClass) const {
+  stencilClass.addTypeDef("tmp_window_halo_t")
+      .addType("gridtools::halo< GRIDTOOLS_DAWN_HALO_EXTENT, GRIDTOOLS_DAWN_HALO_EXTENT, 0>");
 
-    std::string tmpMetadataInit = tmpMetadataName_ + "(dom_.isize()";
-    if(iMax > 0)
-      tmpMetadataInit += " + " + std::to_string(iMax);
-    tmpMetadataInit += ", dom_.jsize()";
-    if(jMax > 0)
-      tmpMetadataInit += " + " + std::to_string(jMax);
-    tmpMetadataInit +=
-        ", dom_.ksize() + 2*" + std::to_string(getVerticalTmpHaloSize(stencil)) + ")";
+  stencilClass.addTypeDef(tmpWindowMetadataTypename_)
+      .addType("storage_traits_t::storage_info_t< 1, 3, tmp_window_halo_t >");
 
-    ctr.addInit(tmpMetadataInit);
+  stencilClass.addTypeDef(tmpWindowStorageTypename_)
+      .addType("storage_traits_t::data_store_t< ::dawn::float_type, " + tmpWindowMetadataTypename_ +
+               ">");
+}
+
+void CodeGen::addTmpWindowStorageDeclaration(
+    Structure& stencilClass, IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& windowFields,
+    const std::map<int, int>& tmpWindows) const {
+  // one meta data for each number of planes
+  std::set<int> numLevels;
+  for(const auto& field : windowFields)
+    numLevels.insert(tmpWindows.at(field.first));
+  for(int n : numLevels)
+    stencilClass.addMember(tmpWindowMetadataTypename_, tmpWindowMetadataName_ + std::to_string(n));
+
+  for(const auto& field : windowFields) {
+    stencilClass.addMember(tmpWindowStorageTypename_, "m_" + field.second.Name);
+  }
+}
+
+void CodeGen::addTmpWindowStorageInit(
+    MemberFunction& ctr, const iir::Stencil& stencil,
+    IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& windowFields,
+    const std::map<int, int>& tmpWindows) const {
+  std::set<int> numLevels;
+  for(const auto& field : windowFields)
+    numLevels.insert(tmpWindows.at(field.first));
+  for(int n : numLevels)
+    ctr.addInit(tmpWindowMetadataName_ + std::to_string(n) + "(" + makeTmpMetadataArgs(stencil, n) +
+                ")");
+
+  for(const auto& field : windowFields) {
+    ctr.addInit("m_" + field.second.Name + "(" + tmpWindowMetadataName_ +
+                std::to_string(tmpWindows.at(field.first)) + ")");
+  }
+}
+
+void CodeGen::addTmpArenaStorageInit(
+    MemberFunction& ctr, const iir::Stencil& stencil,
+    IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& tempFields,
+    const TemporaryArena& arena) const {
+  if(!(tempFields.empty())) {
+    ctr.addInit(tmpMetadataName_ + "(" + makeTmpMetadataArgs(stencil) + ")");
     for(const auto& field : tempFields) {
-      ctr.addInit("m_" + field.second.Name + "(" + tmpMetadataName_ + ")");
+      if(!arena.contains(field.first)) {
+        ctr.addInit("m_" + field.second.Name + "(" + tmpMetadataName_ + ")");
+        continue;
+      }
+      ctr.addInit("m_" + field.second.Name + "(" + tmpMetadataName_ + ", tmp_arena + " +
+                  std::to_string(arena.getSlot(field.first)) + " * tmp_slot_size, " + c_gt +
+                  "ownership::external_cpu)");
     }
   }
 }
 
+void CodeGen::addTmpStorageSizeMethod(Structure& stencilClass, const iir::Stencil& stencil) const {
+  auto sizeMethod = stencilClass.addMemberFunction("static std::size_t", "tmp_storage_size");
+  sizeMethod.addArg("const " + c_dgt + "domain& dom_");
+  sizeMethod.startBody();
+  sizeMethod.addStatement("return " + tmpMetadataTypename_ + "(" + makeTmpMetadataArgs(stencil) +
+                          ").padded_total_length()");
+  sizeMethod.commit();
+}
+
 void CodeGen::addTmpStorageInitStencilWrapperCtr(
     MemberFunction& ctr, const std::vector<std::unique_ptr<iir::Stencil>>& stencils,
-    const std::vector<std::string>& tempFields) const {
+    const std::vector<std::string>& tempFields, const std::vector<int>& arenaSlots) const {
   if(!(tempFields.empty())) {
     auto verticalExtent = getVerticalTmpHaloSizeForMultipleStencils(stencils);
     ctr.addInit(bigWrapperMetadata_ + "(dom.isize(), dom.jsize(), dom.ksize() /*+ 2 *" +
                 std::to_string(verticalExtent) + "*/ + 1)");
-    for(auto fieldName : tempFields) {
-      ctr.addInit("m_" + fieldName + " (" + bigWrapperMetadata_ + ", \"" + fieldName + "\")");
+    for(std::size_t i = 0; i < tempFields.size(); ++i) {
+      const auto& fieldName = tempFields[i];
+      if(arenaSlots.empty()) {
+        ctr.addInit("m_" + fieldName + " (" + bigWrapperMetadata_ + ", \"" + fieldName + "\")");
+      } else {
+        ctr.addInit("m_" + fieldName + " (" + bigWrapperMetadata_ + ", m_tmp_arena.data() + " +
+                    std::to_string(arenaSlots[i]) + " * tmp_slot_size(dom), " + c_gt +
+                    "ownership::external_cpu, \"" + fieldName + "\")");
+      }
     }
   }
 }
@@ -444,6 +555,82 @@ bool CodeGen::hasGlobalIndices(const iir::Stencil& stencil) const {
   return false;
 }
 
+bool CodeGen::canSweepColumns(const iir::MultiStage& multiStage) {
+  for(const auto& stage : multiStage.getChildren()) {
+    if(!stage->getExtents().isHorizontalPointwise()) {
+      return false;
+    }
+  }
+  for(const auto& fieldPair : multiStage.getFields()) {
+    const iir::Field& field = fieldPair.second;
+    if(field.getIntend() == iir::Field::IntendKind::Input) {
+      continue;
+    }
+    const auto& readExtents = field.getReadExtents();
+    if(readExtents && !readExtents->isHorizontalPointwise()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CodeGen::isHoistedVarDecl(const std::shared_ptr<ast::Stmt>& stmt,
+                               const iir::StencilMetaInformation& metadata) {
+  const auto varDeclStmt = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmt);
+  if(!varDeclStmt)
+    return false;
+  const auto& localVariables = metadata.getAccessIDToLocalVariableDataMap();
+  auto it = localVariables.find(iir::getAccessID(varDeclStmt));
+  return it != localVariables.end() && it->second.isHoisted();
+}
+
+std::shared_ptr<ast::ReductionOverNeighborExpr>
+CodeGen::getDeclaredReduction(const std::shared_ptr<ast::Stmt>& stmt) {
+  const auto varDeclStmt = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmt);
+  if(!varDeclStmt || varDeclStmt->isArray() || varDeclStmt->getInitList().size() != 1)
+    return nullptr;
+  auto reduction =
+      std::dynamic_pointer_cast<ast::ReductionOverNeighborExpr>(varDeclStmt->getInitList().front());
+  if(!reduction)
+    return nullptr;
+  std::function<bool(const std::shared_ptr<ast::Expr>&)> containsReduction =
+      [&](const std::shared_ptr<ast::Expr>& expr) {
+        return expr->getKind() == ast::Expr::Kind::ReductionOverNeighborExpr ||
+               std::any_of(expr->getChildren().begin(), expr->getChildren().end(),
+                           containsReduction);
+      };
+  if(containsReduction(reduction->getRhs()) || containsReduction(reduction->getInit()))
+    return nullptr;
+  return reduction;
+}
+
+std::vector<std::vector<std::shared_ptr<ast::Stmt>>>
+CodeGen::groupFusedReductions(const std::vector<std::shared_ptr<ast::Stmt>>& stmts) {
+  std::vector<std::vector<std::shared_ptr<ast::Stmt>>> blocks;
+  std::set<int> declaredAccessIDs;
+  for(const auto& stmt : stmts) {
+    auto reduction = getDeclaredReduction(stmt);
+    bool join = reduction && !blocks.empty();
+    if(join) {
+      auto first = getDeclaredReduction(blocks.back().front());
+      join = first && first->getIterSpace() == reduction->getIterSpace();
+    }
+    if(join) {
+      // the reductions of a block are computed at once, they can't use each other's results
+      for(const auto& access : stmt->getData<iir::IIRStmtData>().CallerAccesses->getReadAccesses())
+        join = join && !declaredAccessIDs.count(access.first);
+    }
+    if(!join) {
+      blocks.emplace_back();
+      declaredAccessIDs.clear();
+    }
+    blocks.back().push_back(stmt);
+    if(reduction)
+      declaredAccessIDs.insert(iir::getAccessID(std::static_pointer_cast<ast::VarDeclStmt>(stmt)));
+  }
+  return blocks;
+}
+
 void CodeGen::generateGlobalIndices(const iir::Stencil& stencil, Structure& stencilClass,
                                     bool genCheckOffset) const {
   for(auto& stage : iterateIIROver<iir::Stage>(stencil)) {
@@ -521,5 +708,290 @@ void CodeGen::generateFieldExtentsInfo(
   }
 }
 
+std::map<int, iir::Extents> CodeGen::computeHaloRegions(const iir::Stencil& stencil,
+                                                        const iir::MultiStage& multiStage) {
+  const auto& stencilFields = stencil.getFields();
+  std::map<int, iir::Extents> haloRegions;
+  for(const auto& stage : multiStage.getChildren()) {
+    for(const auto& [accessID, field] : stage->getFields()) {
+      auto it = stencilFields.find(accessID);
+      if(it == stencilFields.end() || it->second.IsTemporary || !field.getReadExtents())
+        continue;
+
+      iir::Extents readRegion = *field.getReadExtents();
+      readRegion += stage->getExtents();
+      if(readRegion.isHorizontalPointwise())
+        continue;
+      // the region is relative to the compute domain and thus always contains it
+      iir::Extents haloRegion(ast::cartesian);
+      haloRegion.merge(readRegion);
+
+      auto regionIt = haloRegions.find(accessID);
+      if(regionIt == haloRegions.end())
+        haloRegions.emplace(accessID, haloRegion);
+      else
+        regionIt->second.merge(haloRegion);
+    }
+  }
+  return haloRegions;
+}
+
+namespace {
+
+/// @brief Initializer of the `::dawn::driver::halo_region` of field `name`
+std::string makeHaloRegion(const std::string& name, const iir::Extents& haloRegion) {
+  auto const& hExtents =
+      iir::extent_cast<iir::CartesianExtent const&>(haloRegion.horizontalExtent());
+  const auto& vExtents = haloRegion.verticalExtent();
+  return "{\"" + name + "\", {{{" + std::to_string(hExtents.iMinus()) + ", " +
+         std::to_string(hExtents.iPlus()) + "}, {" + std::to_string(hExtents.jMinus()) + ", " +
+         std::to_string(hExtents.jPlus()) + "}, {" +
+         (vExtents.isUndefined()
+              ? "0, 0"
+              : std::to_string(vExtents.minus()) + ", " + std::to_string(vExtents.plus())) +
+         "}}}}";
+}
+
+} // namespace
+
+std::vector<CodeGen::HaloExchange> CodeGen::computeHaloExchanges(const iir::Stencil& stencil) {
+  const auto& stencilFields = stencil.getFields();
+  std::vector<HaloExchange> exchanges;
+  // multi-stage which last wrote each API field and the exchange of that value, if any
+  std::map<int, int> lastProducer;
+  std::map<int, std::size_t> openExchanges;
+  int multiStageIdx = 0;
+  for(const auto& multiStage : stencil.getChildren()) {
+    for(const auto& [accessID, haloRegion] : computeHaloRegions(stencil, *multiStage)) {
+      auto producerIt = lastProducer.find(accessID);
+      if(producerIt == lastProducer.end())
+        continue;
+      auto exchangeIt = openExchanges.find(accessID);
+      if(exchangeIt == openExchanges.end()) {
+        openExchanges.emplace(accessID, exchanges.size());
+        exchanges.push_back({accessID, haloRegion, producerIt->second, multiStageIdx});
+      } else {
+        // later consumers of the same value are served by the first exchange
+        exchanges[exchangeIt->second].region.merge(haloRegion);
+      }
+    }
+    for(const auto& [accessID, field] : multiStage->getFields()) {
+      auto it = stencilFields.find(accessID);
+      if(it == stencilFields.end() || it->second.IsTemporary ||
+         field.getIntend() == iir::Field::IntendKind::Input)
+        continue;
+      lastProducer[accessID] = multiStageIdx;
+      openExchanges.erase(accessID);
+    }
+    ++multiStageIdx;
+  }
+  return exchanges;
+}
+
+void CodeGen::generateHaloExchangeInfo(Structure& stencilClass, const iir::Stencil& stencil) const {
+  const auto& stencilFields = stencil.getFields();
+
+  stencilClass.addMember("::dawn::driver::halo_exchange_hooks", "m_haloExchange");
+
+  auto setter = stencilClass.addMemberFunction("void", "set_halo_exchange");
+  setter.addArg("const ::dawn::driver::halo_exchange_hooks& haloExchange");
+  setter.startBody();
+  setter.addStatement("m_haloExchange = haloExchange");
+  setter.commit();
+
+  auto haloRegionsFunc = stencilClass.addMemberFunction(
+      "static std::vector<::dawn::driver::halo_region>", "halo_regions");
+  haloRegionsFunc.addArg("int multiStageIdx");
+  haloRegionsFunc.startBody();
+  haloRegionsFunc.addStatement("std::vector<::dawn::driver::halo_region> regions");
+  int multiStageIdx = 0;
+  for(const auto& multiStage : stencil.getChildren()) {
+    const auto haloRegions = computeHaloRegions(stencil, *multiStage);
+    if(!haloRegions.empty()) {
+      haloRegionsFunc.addBlockStatement(
+          "if(multiStageIdx == " + std::to_string(multiStageIdx) + ")", [&]() {
+            for(const auto& [accessID, haloRegion] : haloRegions) {
+              haloRegionsFunc.addStatement(
+                  "regions.push_back(" +
+                  makeHaloRegion(stencilFields.at(accessID).Name, haloRegion) + ")");
+            }
+          });
+    }
+    ++multiStageIdx;
+  }
+  haloRegionsFunc.addStatement("return regions");
+  haloRegionsFunc.commit();
+}
+
+void CodeGen::generateHaloExchangeWait(MemberFunction& stencilRunMethod,
+                                       const iir::Stencil& stencil, int multiStageIdx) const {
+  const auto& stencilFields = stencil.getFields();
+  for(const auto& exchange : computeHaloExchanges(stencil)) {
+    if(exchange.consumerIdx != multiStageIdx)
+      continue;
+    stencilRunMethod.addStatement(
+        "m_haloExchange.wait_exchange(" +
+        makeHaloRegion(stencilFields.at(exchange.accessID).Name, exchange.region) + ")");
+  }
+}
+
+void CodeGen::generateHaloExchangeStart(MemberFunction& stencilRunMethod,
+                                        const iir::Stencil& stencil, int multiStageIdx) const {
+  const auto& stencilFields = stencil.getFields();
+  for(const auto& exchange : computeHaloExchanges(stencil)) {
+    if(exchange.producerIdx != multiStageIdx)
+      continue;
+    stencilRunMethod.addStatement(
+        "m_haloExchange.start_exchange(" +
+        makeHaloRegion(stencilFields.at(exchange.accessID).Name, exchange.region) + ")");
+  }
+}
+
+void CodeGen::generateStencilWrapperHaloExchange(
+    Class& stencilWrapperClass,
+    const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+    const CodeGenProperties& codeGenProperties) const {
+  auto setter = stencilWrapperClass.addMemberFunction("void", "set_halo_exchange");
+  setter.addArg("const ::dawn::driver::halo_exchange_hooks& haloExchange");
+  setter.startBody();
+  for(const auto& stencil : stencilInstantiation->getStencils()) {
+    if(stencil->isEmpty())
+      continue;
+    setter.addStatement(
+        "m_" +
+        codeGenProperties.getStencilName(StencilContext::SC_Stencil, stencil->getStencilID()) +
+        ".set_halo_exchange(haloExchange)");
+  }
+  setter.commit();
+}
+
+namespace {
+
+/// @brief Check if an AST accesses a field at a vertical offset
+class VerticalOffsetFinder : public ast::ASTVisitorForwarding {
+  bool found_ = false;
+
+public:
+  using ast::ASTVisitorForwarding::visit;
+
+  void visit(const std::shared_ptr<const ast::FieldAccessExpr>& expr) override {
+    found_ = found_ || expr->getOffset().verticalShift() != 0 ||
+             expr->getOffset().hasVerticalIndirection();
+    ast::ASTVisitorForwarding::visit(expr);
+  }
+
+  bool hasFound() const { return found_; }
+};
+
+} // namespace
+
+std::map<int, std::vector<CodeGen::FusedBoundaryCondition>>
+CodeGen::computeFusedBoundaryConditions(const iir::StencilInstantiation& stencilInstantiation,
+                                        const iir::Stencil& stencil) {
+  std::map<std::string, int> apiFieldIDs;
+  for(const auto& [accessID, fieldInfo] : stencil.getFields())
+    if(!fieldInfo.IsTemporary)
+      apiFieldIDs.emplace(fieldInfo.Name, accessID);
+
+  // ordered by field name such that the generated code is deterministic
+  const auto& bcMap = stencilInstantiation.getMetaData().getFieldNameToBCMap();
+  const std::map<std::string, std::shared_ptr<ast::BoundaryConditionDeclStmt>> bcs(bcMap.begin(),
+                                                                                   bcMap.end());
+  const auto& stencilFunctions = stencilInstantiation.getIIR()->getStencilFunctions();
+
+  std::map<int, std::vector<FusedBoundaryCondition>> fusedBCs;
+  for(const auto& [fieldName, bc] : bcs) {
+    if(!std::all_of(bc->getFields().begin(), bc->getFields().end(),
+                    [&](const std::string& name) { return apiFieldIDs.count(name); }))
+      continue;
+    const int accessID = apiFieldIDs.at(fieldName);
+
+    // the last multi-stages writing the field and any of the fields passed to the functor, the
+    // boundary condition would read stale values if the latter came after the producer
+    const iir::MultiStage* producer = nullptr;
+    int producerIdx = -1, lastWriterIdx = -1, multiStageIdx = 0;
+    for(const auto& multiStage : stencil.getChildren()) {
+      const auto writes = [&](int id) {
+        auto fieldIt = multiStage->getFields().find(id);
+        return fieldIt != multiStage->getFields().end() &&
+               fieldIt->second.getIntend() != iir::Field::IntendKind::Input;
+      };
+      if(writes(accessID)) {
+        producer = multiStage.get();
+        producerIdx = multiStageIdx;
+      }
+      if(std::any_of(bc->getFields().begin(), bc->getFields().end(),
+                     [&](const std::string& name) { return writes(apiFieldIDs.at(name)); }))
+        lastWriterIdx = multiStageIdx;
+      ++multiStageIdx;
+    }
+    if(!producer || lastWriterIdx > producerIdx)
+      continue;
+
+    auto function = std::find_if(stencilFunctions.begin(), stencilFunctions.end(),
+                                 [&](const std::shared_ptr<sir::StencilFunction>& function) {
+                                   return function->Name == bc->getFunctor();
+                                 });
+    DAWN_ASSERT(function != stencilFunctions.end());
+    VerticalOffsetFinder finder;
+    for(const auto& ast : (*function)->Asts)
+      ast->accept(finder);
+
+    fusedBCs[producer->getID()].push_back({bc, accessID, !finder.hasFound()});
+  }
+  return fusedBCs;
+}
+
+bool CodeGen::writesField(const iir::MultiStage& multiStage, const iir::Interval& interval,
+                          int accessID) {
+  for(const auto& doMethod : iterateIIROver<iir::DoMethod>(multiStage)) {
+    if(!doMethod->getInterval().overlaps(interval))
+      continue;
+    auto fieldIt = doMethod->getFields().find(accessID);
+    if(fieldIt != doMethod->getFields().end() &&
+       fieldIt->second.getIntend() != iir::Field::IntendKind::Input)
+      return true;
+  }
+  return false;
+}
+
+void CodeGen::generateBoundaryConditionLoops(MemberFunction& method,
+                                             const iir::StencilMetaInformation& metadata,
+                                             const FusedBoundaryCondition& bc) const {
+  std::string iMinus = "m_dom.iminus()", iPlus = "m_dom.iplus()", jMinus = "m_dom.jminus()",
+              jPlus = "m_dom.jplus()";
+  if(metadata.hasBoundaryConditionStmtToExtent(bc.stmt)) {
+    const auto& hExtents = iir::extent_cast<iir::CartesianExtent const&>(
+        metadata.getBoundaryConditionExtentsFromBCStmt(bc.stmt).horizontalExtent());
+    iMinus = std::to_string(std::abs(hExtents.iMinus()));
+    iPlus = std::to_string(std::abs(hExtents.iPlus()));
+    jMinus = std::to_string(std::abs(hExtents.jMinus()));
+    jPlus = std::to_string(std::abs(hExtents.jPlus()));
+  }
+
+  // the generated functors ignore the direction
+  std::string apply = bc.stmt->getFunctor() + "()(0";
+  for(const auto& field : bc.stmt->getFields())
+    apply += ", " + field;
+  apply += ", i, j, k)";
+
+  method.addComment("boundary condition of " + metadata.getFieldNameFromAccessID(bc.accessID));
+  // the strips below and above the compute domain in j (including the corners)
+  method.addBlockStatement(
+      "for(int i = iMin - " + iMinus + "; i <= iMax + " + iPlus + "; ++i)", [&]() {
+        method.addBlockStatement("for(int j = jMin - " + jMinus + "; j < jMin; ++j)",
+                                 [&]() { method.addStatement(apply); });
+        method.addBlockStatement("for(int j = jMax + 1; j <= jMax + " + jPlus + "; ++j)",
+                                 [&]() { method.addStatement(apply); });
+      });
+  // the strips left and right of the compute domain in i
+  method.addBlockStatement("for(int j = jMin; j <= jMax; ++j)", [&]() {
+    method.addBlockStatement("for(int i = iMin - " + iMinus + "; i < iMin; ++i)",
+                             [&]() { method.addStatement(apply); });
+    method.addBlockStatement("for(int i = iMax + 1; i <= iMax + " + iPlus + "; ++i)",
+                             [&]() { method.addStatement(apply); });
+  });
+}
+
 } // namespace codegen
 } // namespace dawn
@@ -18,6 +18,7 @@
 #include "dawn/CodeGen/CXXUtil.h"
 #include "dawn/CodeGen/CodeGenProperties.h"
 #include "dawn/CodeGen/Options.h"
+#include "dawn/CodeGen/TemporaryArena.h"
 #include "dawn/CodeGen/TranslationUnit.h"
 #include "dawn/IIR/StencilInstantiation.h"
 #include "dawn/Support/IndexRange.h"
@@ -43,16 +44,44 @@ protected:
   size_t getVerticalTmpHaloSizeForMultipleStencils(
       const std::vector<std::unique_ptr<iir::Stencil>>& stencils) const;
   virtual void addTempStorageTypedef(Structure& stencilClass, iir::Stencil const& stencil) const;
+  /// @brief Type of the storage of the temporary `field`. Temporaries which are not stored in the
+  /// default precision have a storage typedef of their own, e.g. `tmp_storage_float_t`.
+  virtual std::string getTmpStorageType(const iir::Stencil::FieldInfo& field) const;
   void addTmpStorageDeclaration(
       Structure& stencilClass,
       IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& tmpFields) const;
+  /// @brief Arguments of the constructor of the meta data of the temporaries of `stencil`, with
+  /// `numLevels` vertical levels if not 0
+  std::string makeTmpMetadataArgs(const iir::Stencil& stencil, int numLevels = 0) const;
   virtual void
   addTmpStorageInit(MemberFunction& ctr, const iir::Stencil& stencil,
                     IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& tempFields) const;
+  /// @brief Allocate the temporaries of `stencil` in the slots of a `TemporaryArena`, the
+  /// constructor takes the arena as arguments `tmp_arena` and `tmp_slot_size` (elements per slot).
+  /// Temporaries which are not planned in the arena own their storage.
+  void addTmpArenaStorageInit(MemberFunction& ctr, const iir::Stencil& stencil,
+                              IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& tempFields,
+                              const TemporaryArena& arena) const;
+  /// @brief Typedefs of the storages of the temporaries stored as rolling windows of ij-planes
+  void addTmpWindowStorageTypedef(Structure& stencilClass) const;
+  /// @brief Declare the temporaries `windowFields` stored as rolling windows of ij-planes, the
+  /// number of planes of each temporary is given by `tmpWindows`
+  void addTmpWindowStorageDeclaration(
+      Structure& stencilClass,
+      IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& windowFields,
+      const std::map<int, int>& tmpWindows) const;
   void
-  addTmpStorageInitStencilWrapperCtr(MemberFunction& ctr,
-                                     const std::vector<std::unique_ptr<iir::Stencil>>& stencils,
-                                     const std::vector<std::string>& tempFields) const;
+  addTmpWindowStorageInit(MemberFunction& ctr, const iir::Stencil& stencil,
+                          IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& windowFields,
+                          const std::map<int, int>& tmpWindows) const;
+  /// @brief Add the static method `tmp_storage_size(dom)` returning the number of elements of a
+  /// temporary storage of `stencil`
+  void addTmpStorageSizeMethod(Structure& stencilClass, const iir::Stencil& stencil) const;
+  /// @brief Initialize the inter-stencil temporaries `tempFields`. If `arenaSlots` is not empty,
+  /// they are allocated in the given slots of the arena `m_tmp_arena`.
+  void addTmpStorageInitStencilWrapperCtr(
+      MemberFunction& ctr, const std::vector<std::unique_ptr<iir::Stencil>>& stencils,
+      const std::vector<std::string>& tempFields, const std::vector<int>& arenaSlots = {}) const;
 
   void generateStencilWrapperSyncMethod(Class& stencilWrapperClass) const;
 
@@ -62,6 +91,29 @@ protected:
   hasGlobalIndices(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation) const;
   bool hasGlobalIndices(const iir::Stencil& stencil) const;
 
+  /// @brief Check if the multi-stage can be executed column by column (i.e. with the k-loop
+  /// innermost). This is the case if no stage reads data computed within the multi-stage at a
+  /// horizontal offset.
+  static bool canSweepColumns(const iir::MultiStage& multiStage);
+
+  /// @brief Check if `stmt` declares a loop invariant variable hoisted by
+  /// `PassLoopInvariantCodeMotion`. Such declarations can be generated once per k-level before the
+  /// horizontal loops.
+  static bool isHoistedVarDecl(const std::shared_ptr<ast::Stmt>& stmt,
+                               const iir::StencilMetaInformation& metadata);
+
+  /// @brief Get the reduction initializing the variable declared by `stmt`, nullptr if `stmt` is
+  /// not a declaration initialized by a reduction (without nested reductions)
+  static std::shared_ptr<ast::ReductionOverNeighborExpr>
+  getDeclaredReduction(const std::shared_ptr<ast::Stmt>& stmt);
+
+  /// @brief Split `stmts` into blocks which are generated together. Consecutive declarations
+  /// initialized by reductions over the same iteration space (e.g. grouped by
+  /// `PassReductionFusion`) form one block and can be computed in a single loop over the neighbors,
+  /// all other statements form a block of their own.
+  static std::vector<std::vector<std::shared_ptr<ast::Stmt>>>
+  groupFusedReductions(const std::vector<std::shared_ptr<ast::Stmt>>& stmts);
+
   void generateGlobalIndices(const iir::Stencil& stencil, Structure& stencilClass,
                              bool genCheckOffset = true) const;
 
@@ -70,9 +122,82 @@ protected:
                            IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& nonTempFields,
                            ast::GridType const& gridType) const;
 
+  /// @brief Halo regions of the API fields which have to be valid before `multiStage` is executed,
+  /// i.e. the read extents of the fields grown by the extents of the reading stages. Fields which
+  /// are only accessed pointwise in the horizontal are omitted.
+  static std::map<int, iir::Extents> computeHaloRegions(const iir::Stencil& stencil,
+                                                        const iir::MultiStage& multiStage);
+
+  /// @brief Generate the halo exchange hooks of a stencil class, i.e. a `set_halo_exchange` setter
+  /// and a static `halo_regions(multiStageIdx)` method listing the halo regions of each multi-stage
+  void generateHaloExchangeInfo(Structure& stencilClass, const iir::Stencil& stencil) const;
+
+  /// @brief Halo exchange of an API field produced by a multi-stage of the stencil
+  struct HaloExchange {
+    int accessID;
+    // union of the halo regions read by the consumers
+    iir::Extents region;
+    // index of the multi-stage producing the field, the exchange is started after it
+    int producerIdx;
+    // index of the first multi-stage reading the halo, the exchange is completed before it
+    int consumerIdx;
+  };
+
+  /// @brief Halo exchanges of `stencil`. Only fields produced by an earlier multi-stage are
+  /// exchanged, the halos of the inputs of the stencil have to be valid when it is run.
+  static std::vector<HaloExchange> computeHaloExchanges(const iir::Stencil& stencil);
+
+  /// @brief Generate the completion of the halo exchanges required by the `multiStageIdx`-th
+  /// multi-stage of `stencil`, which precedes the multi-stage
+  void generateHaloExchangeWait(MemberFunction& stencilRunMethod, const iir::Stencil& stencil,
+                                int multiStageIdx) const;
+
+  /// @brief Generate the start of the halo exchanges of the fields produced by the
+  /// `multiStageIdx`-th multi-stage of `stencil`, which follows the multi-stage
+  void generateHaloExchangeStart(MemberFunction& stencilRunMethod, const iir::Stencil& stencil,
+                                 int multiStageIdx) const;
+
+  /// @brief Generate `set_halo_exchange` of the stencil wrapper forwarding to all stencils
+  void generateStencilWrapperHaloExchange(
+      Class& stencilWrapperClass,
+      const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+      const CodeGenProperties& codeGenProperties) const;
+
+  /// @brief Boundary condition applied by the multi-stage producing its field
+  struct FusedBoundaryCondition {
+    std::shared_ptr<ast::BoundaryConditionDeclStmt> stmt;
+    // field the boundary condition is applied to
+    int accessID;
+    // the functor only accesses the k-level it writes, i.e. it can be applied level by level
+    bool isLevelwise;
+  };
+
+  /// @brief Boundary conditions fused into the multi-stages of `stencil` (by multi-stage ID). The
+  /// boundary condition of an API field is fused into the last multi-stage of the stencil writing
+  /// the field, if all fields passed to the functor are fields of the stencil and none of them is
+  /// written by a later multi-stage.
+  static std::map<int, std::vector<FusedBoundaryCondition>>
+  computeFusedBoundaryConditions(const iir::StencilInstantiation& stencilInstantiation,
+                                 const iir::Stencil& stencil);
+
+  /// @brief Check if a stage of `multiStage` writes the field `accessID` in `interval`
+  static bool writesField(const iir::MultiStage& multiStage, const iir::Interval& interval,
+                          int accessID);
+
+  /// @brief Generate the loops applying the boundary condition `bc` to the boundary region of its
+  /// field at the level `k`, i.e. the halo points around the compute domain (`iMin`, `iMax`,
+  /// `jMin`, `jMax`). The width of the region are the extents computed by
+  /// `PassSetBoundaryCondition`, or the full halo of the storages if the pass did not run.
+  void generateBoundaryConditionLoops(MemberFunction& method,
+                                      const iir::StencilMetaInformation& metadata,
+                                      const FusedBoundaryCondition& bc) const;
+
   const std::string tmpStorageTypename_ = "tmp_storage_t";
   const std::string tmpMetadataTypename_ = "tmp_meta_data_t";
   const std::string tmpMetadataName_ = "m_tmp_meta_data";
+  const std::string tmpWindowStorageTypename_ = "tmp_window_storage_t";
+  const std::string tmpWindowMetadataTypename_ = "tmp_window_meta_data_t";
+  const std::string tmpWindowMetadataName_ = "m_tmp_window_meta_data_";
   const std::string tmpStorageName_ = "m_tmp_storage";
   const std::string bigWrapperMetadata_ = "m_meta_data";
 
@@ -14,8 +14,10 @@
 
 #include "ASTStencilBody.h"
 #include "dawn/AST/LocationType.h"
+#include "dawn/CodeGen/IcoChainSizes.h"
 #include "dawn/IIR/AST.h"
 #include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/Stage.h"
 #include <memory>
 #include <sstream>
 #include <string>
@@ -24,6 +26,44 @@ namespace dawn {
 namespace codegen {
 namespace cudaico {
 
+namespace {
+
+/// @brief Check if an expression has the same value on every level of a stage, i.e. only accesses
+/// literals, globals and dense horizontal fields at the current element which the stage doesn't
+/// write
+class KInvarianceChecker : public ast::ASTVisitorForwardingNonConst {
+  const iir::StencilMetaInformation& metadata_;
+  const iir::Stage& stage_;
+  bool isKInvariant_ = true;
+
+public:
+  KInvarianceChecker(const iir::StencilMetaInformation& metadata, const iir::Stage& stage)
+      : metadata_(metadata), stage_(stage) {}
+
+  void visit(const std::shared_ptr<ast::FieldAccessExpr>& expr) override {
+    const int accessID = iir::getAccessID(expr);
+    const auto& dims = metadata_.getFieldDimensions(accessID);
+    if(stage_.getFields().at(accessID).getIntend() != iir::Field::IntendKind::Input || dims.K() ||
+       !ast::dimension_cast<const ast::UnstructuredFieldDimension&>(
+            dims.getHorizontalFieldDimension())
+            .isDense() ||
+       ast::offset_cast<const ast::UnstructuredOffset&>(expr->getOffset().horizontalOffset())
+           .hasOffset())
+      isKInvariant_ = false;
+  }
+  void visit(const std::shared_ptr<ast::VarAccessExpr>& expr) override {
+    if(!metadata_.isAccessType(iir::FieldAccessType::GlobalVariable, iir::getAccessID(expr)))
+      isKInvariant_ = false;
+  }
+  void visit(const std::shared_ptr<ast::ReductionOverNeighborExpr>& expr) override {
+    isKInvariant_ = false;
+  }
+
+  bool isKInvariant() const { return isKInvariant_; }
+};
+
+} // namespace
+
 void ASTStencilBody::visit(const std::shared_ptr<ast::BlockStmt>& stmt) {
   indent_ += DAWN_PRINT_INDENT;
   auto indent = std::string(indent_, ' ');
@@ -40,19 +80,34 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::LoopStmt>& stmt) {
   DAWN_ASSERT_MSG(maybeChainPtr, "general loop concept not implemented yet!\n");
 
   parentIsForLoop_ = true;
-  ss_ << "for (int nbhIter = 0; nbhIter < "
-      << chainToSparseSizeString(maybeChainPtr->getIterSpace()) << "; nbhIter++)";
-
-  ss_ << "{\n";
-  ss_ << "int nbhIdx = " << chainToTableString(maybeChainPtr->getIterSpace()) << "["
-      << "pidx * " << chainToSparseSizeString(maybeChainPtr->getIterSpace()) << " + nbhIter"
-      << "];\n";
-  ss_ << "if (nbhIdx == DEVICE_MISSING_VALUE) { continue; }";
+  generateNeighborLoop(maybeChainPtr->getIterSpace(),
+                       [&]() { stmt->getBlockStmt()->accept(*this); });
+  parentIsForLoop_ = false;
+}
 
-  stmt->getBlockStmt()->accept(*this);
+void ASTStencilBody::generateNeighborLoop(const ast::UnstructuredIterationSpace& space,
+                                          const std::function<void()>& body) {
+  auto loop = [&](bool checkMissing) {
+    ss_ << "for (int nbhIter = 0; nbhIter < " << chainToSparseSizeString(space) << "; nbhIter++)";
+    ss_ << "{\n";
+    ss_ << "int nbhIdx = " << makeNeighborIndexString(space) << ";\n";
+    if(checkMissing) {
+      ss_ << "if (nbhIdx == DEVICE_MISSING_VALUE) { continue; }";
+    }
+    body();
+    ss_ << "}\n";
+  };
 
+  if(!unrollInteriorReductions_ || !ICOChainIsFullInInterior(space.Chain)) {
+    loop(/*checkMissing*/ true);
+    return;
+  }
+  ss_ << "if (interior) {\n";
+  ss_ << "#pragma unroll\n";
+  loop(/*checkMissing*/ false);
+  ss_ << "} else {\n";
+  loop(/*checkMissing*/ true);
   ss_ << "}\n";
-  parentIsForLoop_ = false;
 }
 void ASTStencilBody::visit(const std::shared_ptr<ast::VerticalRegionDeclStmt>& stmt) {
   DAWN_ASSERT_MSG(0, "VerticalRegionDeclStmt not allowed in this context");
@@ -213,46 +268,41 @@ void ASTStencilBody::visit(const std::shared_ptr<ast::ReductionOverNeighborExpr>
     return;
   }
 
+  generateFusedReductions({expr});
+}
+
+void ASTStencilBody::generateFusedReductions(
+    const std::vector<std::shared_ptr<ast::ReductionOverNeighborExpr>>& reductions) {
+  DAWN_ASSERT(!reductions.empty());
   parentIsReduction_ = true;
 
-  std::string weights_name = "weights_" + std::to_string(expr->getID());
-  ss_ << "::dawn::float_type " << lhs_name << " = ";
-  expr->getInit()->accept(*this);
-  ss_ << ";\n";
-  auto weights = expr->getWeights();
-  if(weights.has_value()) {
-    ss_ << "::dawn::float_type " << weights_name << "[" << weights->size() << "] = {";
-    bool first = true;
-    for(auto weight : *weights) {
-      if(!first) {
-        ss_ << ", ";
-      }
-      weight->accept(*this);
-      first = false;
+  for(const auto& expr : reductions) {
+    DAWN_ASSERT(expr->getIterSpace() == reductions.front()->getIterSpace());
+    ss_ << "::dawn::float_type lhs_" << expr->getID() << " = ";
+    expr->getInit()->accept(*this);
+    ss_ << ";\n";
+    if(expr->getWeights().has_value() && !hoistedWeights_.count(expr->getID())) {
+      generateWeights(expr);
     }
-    ss_ << "};\n";
   }
-  ss_ << "for (int nbhIter = 0; nbhIter < " << chainToSparseSizeString(expr->getIterSpace())
-      << "; nbhIter++)";
-
-  ss_ << "{\n";
-  ss_ << "int nbhIdx = " << chainToTableString(expr->getIterSpace()) << "["
-      << "pidx * " << chainToSparseSizeString(expr->getIterSpace()) << " + nbhIter"
-      << "];\n";
-  ss_ << "if (nbhIdx == DEVICE_MISSING_VALUE) { continue; }";
-  if(!expr->isArithmetic()) {
-    ss_ << lhs_name << " = " << expr->getOp() << "(" << lhs_name << ", ";
-  } else {
-    ss_ << lhs_name << " " << expr->getOp() << "= ";
-  }
-  if(weights.has_value()) {
-    ss_ << weights_name << "[nbhIter] * ";
-  }
-  expr->getRhs()->accept(*this);
-  if(!expr->isArithmetic()) {
-    ss_ << ")";
-  }
-  ss_ << ";}\n";
+  generateNeighborLoop(reductions.front()->getIterSpace(), [&]() {
+    for(const auto& expr : reductions) {
+      std::string lhs_name = "lhs_" + std::to_string(expr->getID());
+      if(!expr->isArithmetic()) {
+        ss_ << lhs_name << " = " << expr->getOp() << "(" << lhs_name << ", ";
+      } else {
+        ss_ << lhs_name << " " << expr->getOp() << "= ";
+      }
+      if(expr->getWeights().has_value()) {
+        ss_ << "weights_" << expr->getID() << "[nbhIter] * ";
+      }
+      expr->getRhs()->accept(*this);
+      if(!expr->isArithmetic()) {
+        ss_ << ")";
+      }
+      ss_ << ";";
+    }
+  });
   parentIsReduction_ = false;
 }
 
@@ -263,8 +313,76 @@ std::string ASTStencilBody::getName(const std::shared_ptr<ast::Expr>& expr) cons
   return metadata_.getFieldNameFromAccessID(iir::getAccessID(expr));
 }
 
-ASTStencilBody::ASTStencilBody(const iir::StencilMetaInformation& metadata, const Padding& padding)
-    : metadata_(metadata), padding_(padding) {}
+std::string
+ASTStencilBody::makeTableIndexString(const ast::UnstructuredIterationSpace& space) const {
+  if(neighborMajorTables_) {
+    return "nbhIter * tableStride + pidx";
+  }
+  return "pidx * " + chainToSparseSizeString(space) + " + nbhIter";
+}
+
+std::string
+ASTStencilBody::makeNeighborIndexString(const ast::UnstructuredIterationSpace& space) const {
+  const std::string table = chainToTableString(space);
+  if(hoistedTables_.count(table)) {
+    return "nbhIdx_" + table + "[nbhIter]";
+  }
+  return table + "[" + makeTableIndexString(space) + "]";
+}
+
+void ASTStencilBody::generateWeights(const std::shared_ptr<ast::ReductionOverNeighborExpr>& expr) {
+  auto weights = expr->getWeights();
+  ss_ << "::dawn::float_type weights_" << expr->getID() << "[" << weights->size() << "] = {";
+  bool first = true;
+  for(auto weight : *weights) {
+    if(!first) {
+      ss_ << ", ";
+    }
+    weight->accept(*this);
+    first = false;
+  }
+  ss_ << "};\n";
+}
+
+void ASTStencilBody::generateKInvariantLoads(
+    const iir::Stage& stage,
+    const std::vector<std::shared_ptr<ast::ReductionOverNeighborExpr>>& reductions) {
+  hoistedTables_.clear();
+  hoistedWeights_.clear();
+
+  for(const auto& expr : reductions) {
+    const auto& space = expr->getIterSpace();
+    const std::string table = chainToTableString(space);
+    if(!hoistedTables_.count(table)) {
+      const std::string size = chainToSparseSizeString(space);
+      ss_ << "int nbhIdx_" << table << "[" << size << "];\n";
+      ss_ << "for (int nbhIter = 0; nbhIter < " << size << "; nbhIter++)";
+      ss_ << "{\n";
+      ss_ << "nbhIdx_" << table << "[nbhIter] = " << table << "[" << makeTableIndexString(space)
+          << "];\n";
+      ss_ << "}\n";
+      hoistedTables_.insert(table);
+    }
+
+    auto weights = expr->getWeights();
+    if(!weights.has_value() || hoistedWeights_.count(expr->getID())) {
+      continue;
+    }
+    KInvarianceChecker checker(metadata_, stage);
+    for(const auto& weight : *weights) {
+      weight->accept(checker);
+    }
+    if(checker.isKInvariant()) {
+      generateWeights(expr);
+      hoistedWeights_.insert(expr->getID());
+    }
+  }
+}
+
+ASTStencilBody::ASTStencilBody(const iir::StencilMetaInformation& metadata, const Padding& padding,
+                               bool neighborMajorTables, bool unrollInteriorReductions)
+    : metadata_(metadata), padding_(padding), neighborMajorTables_(neighborMajorTables),
+      unrollInteriorReductions_(unrollInteriorReductions) {}
 ASTStencilBody::~ASTStencilBody() {}
 
 } // namespace cudaico
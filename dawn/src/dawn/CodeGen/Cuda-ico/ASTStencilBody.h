@@ -19,6 +19,8 @@
 #include "dawn/IIR/Interval.h"
 #include "dawn/Support/StringUtil.h"
 
+#include <functional>
+#include <set>
 #include <stack>
 #include <unordered_map>
 
@@ -27,6 +29,7 @@
 namespace dawn {
 
 namespace iir {
+class Stage;
 class StencilFunctionInstantiation;
 class StencilMetaInformation;
 } // namespace iir
@@ -55,6 +58,8 @@ class ASTStencilBody : public ASTCodeGenCXX {
 protected:
   const iir::StencilMetaInformation& metadata_;
   const Padding& padding_;
+  const bool neighborMajorTables_;
+  const bool unrollInteriorReductions_;
 
   // arg names for field access exprs
   std::string denseArgName_ = "loc";
@@ -65,23 +70,57 @@ protected:
 
   bool firstPass_ = true;
 
+  /// Neighbor tables whose indices were loaded into `nbhIdx_<table>` ahead of the k-loop
+  std::set<std::string> hoistedTables_;
+  /// IDs of the reductions whose weights were computed ahead of the k-loop
+  std::set<int> hoistedWeights_;
+
   /// Nesting level of argument lists of stencil function *calls*
   int nestingOfStencilFunArgLists_;
 
   std::string makeIndexString(const std::shared_ptr<ast::FieldAccessExpr>& expr, std::string kiter);
 
+  /// Index of neighbor `nbhIter` of element `pidx` in the neighbor table of `space`
+  std::string makeTableIndexString(const ast::UnstructuredIterationSpace& space) const;
+
+  /// Index of neighbor `nbhIter` of element `pidx` in `space`, read from the table or from the
+  /// indices loaded ahead of the k-loop
+  std::string makeNeighborIndexString(const ast::UnstructuredIterationSpace& space) const;
+
+  /// Declare and initialize the array of weights of `expr`
+  void generateWeights(const std::shared_ptr<ast::ReductionOverNeighborExpr>& expr);
+
+  /// Generate the loop over the neighbors of `space` with `body`. If `space` has complete
+  /// neighborhoods in the interior, the interior elements (flagged by `interior` in the kernel)
+  /// run an unrolled loop without missing value checks.
+  void generateNeighborLoop(const ast::UnstructuredIterationSpace& space,
+                            const std::function<void()>& body);
+
 public:
   using Base = ASTCodeGenCXX;
   using Base::visit;
 
   /// @brief constructor
-  ASTStencilBody(const iir::StencilMetaInformation& metadata, const Padding& padding);
+  ASTStencilBody(const iir::StencilMetaInformation& metadata, const Padding& padding,
+                 bool neighborMajorTables = false, bool unrollInteriorReductions = false);
 
   virtual ~ASTStencilBody();
 
   void setFirstPass() { firstPass_ = true; };
   void setSecondPass() { firstPass_ = false; };
 
+  /// @brief Load the neighbor indices and the k-invariant weights of `reductions` of `stage` ahead
+  /// of the k-loop, the reductions (and loops over the same chains) generated afterwards reuse them
+  /// on every level
+  void generateKInvariantLoads(
+      const iir::Stage& stage,
+      const std::vector<std::shared_ptr<ast::ReductionOverNeighborExpr>>& reductions);
+
+  /// @brief Compute `reductions` (over the same iteration space) in a single loop over the
+  /// neighbors, with an accumulator `lhs_<ID>` per reduction (first pass only)
+  void generateFusedReductions(
+      const std::vector<std::shared_ptr<ast::ReductionOverNeighborExpr>>& reductions);
+
   /// @name Statement implementation
   /// @{
   void visit(const std::shared_ptr<ast::BlockStmt>& stmt) override;
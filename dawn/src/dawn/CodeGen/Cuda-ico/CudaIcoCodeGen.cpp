@@ -139,6 +139,45 @@ std::string explodeUsedFields(const dawn::iir::Stencil& stencil,
   return explodeToStr(getUsedFieldsNames(stencil, intend));
 }
 
+std::string bufferName(const std::string& fieldName) { return fieldName + "_buffer_"; }
+
+// arguments (dense size, sparse size, k size) to allocate a persistent buffer for an API field
+std::string bufferAllocArgs(const dawn::iir::Stencil& stencil, int fieldID,
+                            const dawn::codegen::Padding& padding) {
+  using namespace dawn::codegen::cudaico;
+  auto dims = stencil.getMetadata().getFieldDimensions(fieldID);
+  if(dims.isVertical()) {
+    return "1, 1, kSize_";
+  }
+  std::string kSizeStr = dims.K() ? "kSize_" : "1";
+  auto hdims = dawn::ast::dimension_cast<dawn::ast::UnstructuredFieldDimension const&>(
+      dims.getHorizontalFieldDimension());
+  std::string denseSizeStr =
+      "mesh_." + locToDenseSizeStringGpuMesh(hdims.getDenseLocationType(), padding);
+  std::string sparseSizeStr = hdims.isDense() ? "1" : chainToSparseSizeString(hdims.getIterSpace());
+  return denseSizeStr + ", " + sparseSizeStr + ", " + kSizeStr;
+}
+
+// padded strides (int CellStride, int EdgeStride, int VertexStride) of the horizontal fields, which
+// need to be passed to a kernel accessing `fields`
+std::set<std::string> strideArgs(const std::map<int, dawn::iir::Field>& fields,
+                                 const dawn::codegen::Padding& padding) {
+  using namespace dawn::codegen::cudaico;
+  std::set<std::string> strides;
+  if(!padding.hasStride()) {
+    return strides;
+  }
+  for(const auto& field : fields) {
+    if(field.second.getFieldDimensions().isVertical()) {
+      continue;
+    }
+    auto dims = dawn::ast::dimension_cast<dawn::ast::UnstructuredFieldDimension const&>(
+        field.second.getFieldDimensions().getHorizontalFieldDimension());
+    strides.insert(locToStrideString(dims.getDenseLocationType()));
+  }
+  return strides;
+}
+
 } // namespace
 
 namespace dawn {
@@ -153,15 +192,25 @@ run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
       options.OutputCHeader == "" ? std::nullopt : std::make_optional(options.OutputCHeader),
       options.OutputFortranInterface == "" ? std::nullopt
                                            : std::make_optional(options.OutputFortranInterface),
-      Padding{options.paddingCells, options.paddingEdges, options.paddingVertices});
+      Padding{options.paddingCells, options.paddingEdges, options.paddingVertices,
+              options.paddingMultiple},
+      options.PersistentBuffers, options.NeighborMajorTables, options.LevelsPerThread,
+      options.UnrollInteriorReductions);
 
   return CG.generateCode();
 }
 
 CudaIcoCodeGen::CudaIcoCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoints,
                                std::optional<std::string> outputCHeader,
-                               std::optional<std::string> outputFortranInterface, Padding padding)
-    : CodeGen(ctx, maxHaloPoints, padding), codeGenOptions_{outputCHeader, outputFortranInterface} {
+                               std::optional<std::string> outputFortranInterface, Padding padding,
+                               bool persistentBuffers, bool neighborMajorTables,
+                               int levelsPerThread, bool unrollInteriorReductions)
+    : CodeGen(ctx, maxHaloPoints, padding),
+      codeGenOptions_{outputCHeader,       outputFortranInterface, persistentBuffers,
+                      neighborMajorTables, levelsPerThread,        unrollInteriorReductions} {
+  if(levelsPerThread < 1)
+    throw std::runtime_error("Invalid number of levels per thread: " +
+                             std::to_string(levelsPerThread));
 }
 
 CudaIcoCodeGen::~CudaIcoCodeGen() {}
@@ -200,6 +249,19 @@ private:
   std::unordered_set<ast::UnstructuredIterationSpace, IterSpaceHash> spaces_;
 };
 
+// whether `stage` reduces or loops over a chain whose neighborhoods are complete in the interior
+// subdomain, the kernel then needs the bounds of the interior
+static bool hasFullInteriorChains(const iir::Stage& stage) {
+  CollectIterationSpaces spaceCollector;
+  for(const auto& doMethod : stage.getChildren()) {
+    doMethod->getAST().accept(spaceCollector);
+  }
+  const auto& spaces = spaceCollector.getSpaces();
+  return std::any_of(spaces.begin(), spaces.end(), [](const ast::UnstructuredIterationSpace& space) {
+    return ICOChainIsFullInInterior(space.Chain);
+  });
+}
+
 void CudaIcoCodeGen::generateGpuMesh(
     const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
     Class& stencilWrapperClass, CodeGenProperties& codeGenProperties) {
@@ -209,6 +271,13 @@ void CudaIcoCodeGen::generateGpuMesh(
   gpuMeshClass.addMember("int", "NumEdges");
   gpuMeshClass.addMember("int", "NumCells");
   gpuMeshClass.addMember("dawn::unstructured_domain", "Domain");
+  const Padding& padding = codeGenOptions.UnstrPadding;
+  if(padding.hasStride()) {
+    for(auto loc : {ast::LocationType::Vertices, ast::LocationType::Edges,
+                    ast::LocationType::Cells}) {
+      gpuMeshClass.addMember("int", locToStrideString(loc));
+    }
+  }
 
   CollectIterationSpaces spaceCollector;
   std::unordered_set<ast::UnstructuredIterationSpace, CollectIterationSpaces::IterSpaceHash> spaces;
@@ -231,6 +300,16 @@ void CudaIcoCodeGen::generateGpuMesh(
     gpuMeshFromGlobalCtor.addStatement("NumCells = mesh->NumCells");
     gpuMeshFromGlobalCtor.addStatement("NumEdges = mesh->NumEdges");
     gpuMeshFromGlobalCtor.addStatement("Domain = mesh->Domain");
+    if(padding.hasStride()) {
+      // the padded sizes, without rounding them up to the multiple
+      const Padding sizes{padding.Cells(), padding.Edges(), padding.Vertices()};
+      for(auto loc : {ast::LocationType::Vertices, ast::LocationType::Edges,
+                      ast::LocationType::Cells}) {
+        gpuMeshFromGlobalCtor.addStatement(locToStrideString(loc) + " = ::dawn::padded_size(" +
+                                           locToDenseSizeStringGpuMesh(loc, sizes) + ", " +
+                                           std::to_string(padding.Multiple()) + ")");
+      }
+    }
     for(auto space : spaces) {
       gpuMeshFromGlobalCtor.addStatement(chainToTableString(space) + " = mesh->NeighborTables.at(" +
                                          "std::tuple<std::vector<dawn::LocationType>, bool>{" +
@@ -405,7 +484,7 @@ void CudaIcoCodeGen::generateRunFun(
 
       kernelCall << "<<<"
                  << "dG" + std::to_string(stage->getStageID()) + ",dB"
-                 << ">>>(";
+                 << (codeGenOptions_.PersistentBuffers ? ",0,stream_" : "") << ">>>(";
       if(!globalsMap.empty()) {
         kernelCall << "m_globals, ";
       }
@@ -429,6 +508,9 @@ void CudaIcoCodeGen::generateRunFun(
       for(auto arg : locArgs) {
         kernelCall << "mesh_." + arg + ", ";
       }
+      for(auto arg : strideArgs(fields, codeGenOptions.UnstrPadding)) {
+        kernelCall << "mesh_." + arg + ", ";
+      }
 
       // we always need the k size
       kernelCall << "kSize_, ";
@@ -438,6 +520,19 @@ void CudaIcoCodeGen::generateRunFun(
         kernelCall << hOffsetString << ", ";
       }
 
+      // neighbor-major tables are strided by the number of elements they were built for, which
+      // differs from the kernel size if the stage iterates over a subdomain
+      if(codeGenOptions_.NeighborMajorTables && !chains.empty()) {
+        kernelCall << numElementsString(*stage->getLocationType(), std::nullopt) << ", ";
+      }
+
+      // the interior elements reduce over complete neighborhoods
+      if(codeGenOptions_.UnrollInteriorReductions && hasFullInteriorChains(*stage)) {
+        const std::string loc = locToLocationTypeString(*stage->getLocationType());
+        kernelCall << "mesh_.Domain({" << loc << ", dawn::UnstructuredSubdomain::Interior, 0}), "
+                   << "mesh_.Domain({" << loc << ", dawn::UnstructuredSubdomain::Halo, 0}), ";
+      }
+
       for(auto chain : chains) {
         kernelCall << "mesh_." + chainToTableString(chain) + ", ";
       }
@@ -456,7 +551,10 @@ void CudaIcoCodeGen::generateRunFun(
       kernelCall << ")";
       runFun.addStatement(kernelCall.str());
       runFun.addStatement("gpuErrchk(cudaPeekAtLastError())");
-      runFun.addStatement("gpuErrchk(cudaDeviceSynchronize())");
+      // kernels on the same stream are ordered, the host only waits when copying back
+      if(!codeGenOptions_.PersistentBuffers) {
+        runFun.addStatement("gpuErrchk(cudaDeviceSynchronize())");
+      }
     }
   }
 
@@ -501,20 +599,48 @@ static void allocTempFields(MemberFunction& ctor, const iir::Stencil& stencil, P
 
 void CudaIcoCodeGen::generateStencilFree(MemberFunction& stencilFree, const iir::Stencil& stencil) {
   stencilFree.startBody();
+  if(codeGenOptions_.PersistentBuffers) {
+    // the stream only exists once the stencil is set up
+    stencilFree.addStatement("if(!is_setup_) return");
+  }
   for(auto accessID : stencil.getMetadata()
                           .getAccessesOfType<iir::FieldAccessType::InterStencilTemporary,
                                              iir::FieldAccessType::StencilTemporary>()) {
     auto fname = stencil.getMetadata().getFieldNameFromAccessID(accessID);
     stencilFree.addStatement("gpuErrchk(cudaFree(" + fname + "_))");
   }
+  if(codeGenOptions_.PersistentBuffers) {
+    for(auto fieldID : getUsedFields(stencil)) {
+      auto fname = stencil.getMetadata().getFieldNameFromAccessID(fieldID);
+      stencilFree.addStatement(bufferName(fname) + ".free()");
+    }
+    stencilFree.addStatement("gpuErrchk(cudaStreamDestroy(stream_))");
+    stencilFree.addStatement("is_setup_ = false");
+  }
 }
 
 void CudaIcoCodeGen::generateStencilSetup(MemberFunction& stencilSetup,
                                           const iir::Stencil& stencil) {
+  if(codeGenOptions_.PersistentBuffers) {
+    // the run API sets the stencil up on every call, the mesh and the buffers are only rebuilt if
+    // the mesh or the number of levels changes
+    stencilSetup.addStatement("if(is_setup_ && setup_mesh_ == mesh && kSize_ == kSize) return");
+    stencilSetup.addStatement("if(is_setup_) free()");
+    stencilSetup.addStatement("setup_mesh_ = mesh");
+  }
   stencilSetup.addStatement("mesh_ = GpuTriMesh(mesh)");
   stencilSetup.addStatement("kSize_ = kSize");
   stencilSetup.addStatement("is_setup_ = true");
   allocTempFields(stencilSetup, stencil, codeGenOptions.UnstrPadding);
+  if(codeGenOptions_.PersistentBuffers) {
+    for(auto fieldID : getUsedFields(stencil)) {
+      auto fname = stencil.getMetadata().getFieldNameFromAccessID(fieldID);
+      stencilSetup.addStatement(bufferName(fname) + ".allocate(" +
+                                bufferAllocArgs(stencil, fieldID, codeGenOptions.UnstrPadding) +
+                                ")");
+    }
+    stencilSetup.addStatement("gpuErrchk(cudaStreamCreate(&stream_))");
+  }
 }
 
 void CudaIcoCodeGen::generateCopyMemoryFun(MemberFunction& copyFun,
@@ -527,6 +653,17 @@ void CudaIcoCodeGen::generateCopyMemoryFun(MemberFunction& copyFun,
   }
   copyFun.addArg("bool do_reshape");
 
+  if(codeGenOptions_.PersistentBuffers) {
+    // stage into the buffers allocated in setup(), copies run asynchronously on stream_
+    for(auto fieldID : usedAPIFields) {
+      auto fname = stencil.getMetadata().getFieldNameFromAccessID(fieldID);
+      copyFun.addStatement(bufferName(fname) + ".copy_to_device_async(" + fname +
+                           ", do_reshape, stream_)");
+      copyFun.addStatement(fname + "_ = " + bufferName(fname) + ".device_ptr()");
+    }
+    return;
+  }
+
   // call initField on each field
   for(auto fieldID : usedAPIFields) {
     auto fname = stencil.getMetadata().getFieldNameFromAccessID(fieldID);
@@ -633,6 +770,20 @@ void CudaIcoCodeGen::generateCopyBackFun(MemberFunction& copyBackFun, const iir:
     }
   };
 
+  if(rawPtrs && codeGenOptions_.PersistentBuffers) {
+    // enqueue all device to host copies first such that they overlap, then wait and unpack
+    for(auto fieldID : usedAPIFields) {
+      copyBackFun.addStatement(bufferName(fieldInfos.at(fieldID).Name) +
+                               ".copy_to_host_async(stream_)");
+    }
+    for(auto fieldID : usedAPIFields) {
+      const auto& field = fieldInfos.at(fieldID);
+      copyBackFun.addStatement(bufferName(field.Name) + ".finish_copy_to_host(" + field.Name +
+                               ", do_reshape, stream_)");
+    }
+    return;
+  }
+
   // function body
   for(auto fieldID : usedAPIFields) {
     const auto& field = fieldInfos.at(fieldID);
@@ -708,6 +859,14 @@ void CudaIcoCodeGen::generateStencilClasses(
     stencilClass.addMember("static int", "kSize_");
     stencilClass.addMember("static GpuTriMesh", "mesh_");
     stencilClass.addMember("static bool", "is_setup_");
+    if(codeGenOptions_.PersistentBuffers) {
+      for(auto fieldID : getUsedFields(stencil)) {
+        stencilClass.addMember("static ::dawn::cuda_field_buffer",
+                               bufferName(stencil.getMetadata().getFieldNameFromAccessID(fieldID)));
+      }
+      stencilClass.addMember("static cudaStream_t", "stream_");
+      stencilClass.addMember("static const dawn::GlobalGpuTriMesh*", "setup_mesh_");
+    }
 
     stencilClass.changeAccessibility("public");
     auto meshGetter = stencilClass.addMemberFunction("static const GpuTriMesh &", "getMesh");
@@ -862,6 +1021,9 @@ void CudaIcoCodeGen::generateAllAPIRunFunctions(
         for(auto& apiRunFun : apiRunFuns) {
           apiRunFun->addStatement(fullStencilName + " s");
         }
+        // with persistent buffers the buffers outlive the call, they are allocated by the first
+        // call (or setup_<stencil>) and released by free_<stencil>
+        const bool freePerRun = !codeGenOptions_.PersistentBuffers;
         if(fromHost) {
           for(auto& apiRunFun : apiRunFuns) {
             apiRunFun->addStatement(fullStencilName + "::setup(mesh, k_size)");
@@ -879,14 +1041,21 @@ void CudaIcoCodeGen::generateAllAPIRunFunctions(
         }
         for(auto& apiRunFun : apiRunFuns) {
           apiRunFun->addStatement("s.run()");
+          // the results are on the device when the call returns (the kernels of persistent
+          // stencils run asynchronously on their stream)
+          if(!fromHost && codeGenOptions_.PersistentBuffers) {
+            apiRunFun->addStatement("gpuErrchk(cudaDeviceSynchronize())");
+          }
           apiRunFun->addStatement("double time = s.get_time()");
           apiRunFun->addStatement("s.reset()");
         }
         if(fromHost) {
           apiRunFuns[0]->addStatement("s.CopyResultToHost(" + ioFieldStr + ", true)");
           apiRunFuns[1]->addStatement("s.CopyResultToHost(" + ioFieldStr + ", false)");
-          for(auto& apiRunFun : apiRunFuns) {
-            apiRunFun->addStatement(fullStencilName + "::free()");
+          if(freePerRun) {
+            for(auto& apiRunFun : apiRunFuns) {
+              apiRunFun->addStatement(fullStencilName + "::free()");
+            }
           }
         }
         for(auto& apiRunFun : apiRunFuns) {
@@ -1165,13 +1334,26 @@ void CudaIcoCodeGen::generateStaticMembersTrailer(
        << "is_setup_ = false;\n";
   ssSW << "dawn_generated::cuda_ico::" + wrapperName << "::GpuTriMesh " << fullStencilName << "::"
        << "mesh_;\n";
+  if(codeGenOptions_.PersistentBuffers) {
+    for(auto fieldID : getUsedFields(*stencil)) {
+      auto fname = stencil->getMetadata().getFieldNameFromAccessID(fieldID);
+      ssSW << "::dawn::cuda_field_buffer " << fullStencilName << "::" << bufferName(fname)
+           << ";\n";
+    }
+    ssSW << "cudaStream_t " << fullStencilName << "::"
+         << "stream_;\n";
+    ssSW << "const dawn::GlobalGpuTriMesh* " << fullStencilName << "::"
+         << "setup_mesh_ = nullptr;\n";
+  }
 }
 
 void CudaIcoCodeGen::generateAllCudaKernels(
     std::stringstream& ssSW,
     const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation) {
   ASTStencilBody stencilBodyCXXVisitor(stencilInstantiation->getMetaData(),
-                                       codeGenOptions.UnstrPadding);
+                                       codeGenOptions.UnstrPadding,
+                                       codeGenOptions_.NeighborMajorTables,
+                                       codeGenOptions_.UnrollInteriorReductions);
   const auto& globalsMap = stencilInstantiation->getIIR()->getGlobalVariableMap();
 
   for(const auto& ms : iterateIIROver<iir::MultiStage>(*(stencilInstantiation->getIIR()))) {
@@ -1233,6 +1415,9 @@ void CudaIcoCodeGen::generateAllCudaKernels(
       for(auto arg : locArgs) {
         cudaKernel.addArg("int " + arg);
       }
+      for(auto arg : strideArgs(fields, codeGenOptions.UnstrPadding)) {
+        cudaKernel.addArg("int " + arg);
+      }
 
       // we always need the k size
       cudaKernel.addArg("int kSize");
@@ -1242,6 +1427,17 @@ void CudaIcoCodeGen::generateAllCudaKernels(
         cudaKernel.addArg("int hOffset");
       }
 
+      if(codeGenOptions_.NeighborMajorTables && !chains.empty()) {
+        cudaKernel.addArg("int tableStride");
+      }
+
+      const bool splitInterior =
+          codeGenOptions_.UnrollInteriorReductions && hasFullInteriorChains(*stage);
+      if(splitInterior) {
+        cudaKernel.addArg("int interiorLo");
+        cudaKernel.addArg("int interiorHi");
+      }
+
       for(auto chain : chains) {
         cudaKernel.addArg("const int *" + chainToTableString(chain));
       }
@@ -1299,6 +1495,10 @@ void CudaIcoCodeGen::generateAllCudaKernels(
         cudaKernel.addStatement("pidx += hOffset");
       }
 
+      if(splitInterior) {
+        cudaKernel.addStatement("const bool interior = pidx >= interiorLo && pidx < interiorHi");
+      }
+
       std::stringstream k_size;
       if(interval.levelIsEnd(iir::Interval::Bound::upper)) {
         k_size << "kSize + " << interval.upperOffset();
@@ -1306,6 +1506,18 @@ void CudaIcoCodeGen::generateAllCudaKernels(
         k_size << interval.upperLevel() << " + " << interval.upperOffset();
       }
 
+      // neighbor indices and weights do not depend on k, load them once for all levels of the
+      // thread
+      if(codeGenOptions_.LevelsPerThread > 1) {
+        FindReduceOverNeighborExpr findReduceOverNeighborExpr;
+        for(const auto& doMethod : stage->getChildren()) {
+          doMethod->getAST().accept(findReduceOverNeighborExpr);
+        }
+        stencilBodyCXXVisitor.generateKInvariantLoads(
+            *stage, findReduceOverNeighborExpr.reduceOverNeighborExprs());
+        cudaKernel << stencilBodyCXXVisitor.getCodeAndResetStream();
+      }
+
       // k loop (we ensured that all k intervals for all do methods in a stage are equal for
       // now)
       cudaKernel.addBlockStatement("for(int kIter = klo; kIter < khi; kIter++)", [&]() {
@@ -1315,15 +1527,26 @@ void CudaIcoCodeGen::generateAllCudaKernels(
           // Generate Do-Method
           const iir::DoMethod& doMethod = *doMethodPtr;
 
-          for(const auto& stmt : doMethod.getAST().getStatements()) {
-            FindReduceOverNeighborExpr findReduceOverNeighborExpr;
-            stmt->accept(findReduceOverNeighborExpr);
+          // reductions over the same neighbors declared in a row share one loop
+          for(const auto& block : groupFusedReductions(doMethod.getAST().getStatements())) {
             stencilBodyCXXVisitor.setFirstPass();
-            for(auto redExpr : findReduceOverNeighborExpr.reduceOverNeighborExprs()) {
-              redExpr->accept(stencilBodyCXXVisitor);
+            if(block.size() > 1) {
+              std::vector<std::shared_ptr<ast::ReductionOverNeighborExpr>> reductions;
+              for(const auto& stmt : block) {
+                reductions.push_back(getDeclaredReduction(stmt));
+              }
+              stencilBodyCXXVisitor.generateFusedReductions(reductions);
+            } else {
+              FindReduceOverNeighborExpr findReduceOverNeighborExpr;
+              block.front()->accept(findReduceOverNeighborExpr);
+              for(auto redExpr : findReduceOverNeighborExpr.reduceOverNeighborExprs()) {
+                redExpr->accept(stencilBodyCXXVisitor);
+              }
             }
             stencilBodyCXXVisitor.setSecondPass();
-            stmt->accept(stencilBodyCXXVisitor);
+            for(const auto& stmt : block) {
+              stmt->accept(stencilBodyCXXVisitor);
+            }
             cudaKernel << stencilBodyCXXVisitor.getCodeAndResetStream();
           }
         }
@@ -1597,6 +1820,12 @@ std::unique_ptr<TranslationUnit> CudaIcoCodeGen::generateCode() {
 
   for(const auto& nameStencilCtxPair : context_) {
     std::shared_ptr<iir::StencilInstantiation> stencilInstantiation = nameStencilCtxPair.second;
+    // the generated API runs a single stencil, e.g. the versions of --specialize-globals can't be
+    // selected
+    if(stencilInstantiation->getStencils().size() > 1)
+      throw std::runtime_error("cuda-ico generates code for at most one stencil, " +
+                               stencilInstantiation->getName() + " has " +
+                               std::to_string(stencilInstantiation->getStencils().size()));
     std::string code = generateStencilInstantiation(stencilInstantiation);
     if(code.empty())
       return nullptr;
@@ -1639,7 +1868,7 @@ std::unique_ptr<TranslationUnit> CudaIcoCodeGen::generateCode() {
       "#include \"driver-includes/timer_cuda.hpp\"",
       "#include <chrono>",
       "#define BLOCK_SIZE 16",
-      "#define LEVELS_PER_THREAD 1",
+      "#define LEVELS_PER_THREAD " + std::to_string(codeGenOptions_.LevelsPerThread),
       "#ifndef RELATIVE_ERROR_THRESHOLD",
       "#define RELATIVE_ERROR_THRESHOLD 1.0e-12",
       "#endif",
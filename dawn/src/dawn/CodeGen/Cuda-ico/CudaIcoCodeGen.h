@@ -46,7 +46,9 @@ public:
   ///@brief constructor
   CudaIcoCodeGen(const StencilInstantiationContext& ctx, int maxHaloPoints,
                  std::optional<std::string> outputCHeader,
-                 std::optional<std::string> outputFortranInterface, Padding = {});
+                 std::optional<std::string> outputFortranInterface, Padding = {},
+                 bool persistentBuffers = false, bool neighborMajorTables = false,
+                 int levelsPerThread = 1, bool unrollInteriorReductions = false);
   virtual ~CudaIcoCodeGen();
   virtual std::unique_ptr<TranslationUnit> generateCode() override;
 
@@ -54,6 +56,18 @@ public:
     // TODO: consider adding options for hard-coded values (e.g. BLOCK_SIZE)
     std::optional<std::string> OutputCHeader;
     std::optional<std::string> OutputFortranInterface;
+    // keep device and pinned host buffers of the API fields alive between runs and issue all
+    // transfers asynchronously on a per-stencil stream
+    bool PersistentBuffers = false;
+    // neighbor tables are stored neighbor-major, i.e. the neighbors `nbhIter` of consecutive
+    // elements are contiguous and the loads of a warp coalesce
+    bool NeighborMajorTables = false;
+    // number of vertical levels computed by each thread, the neighbor indices and k-invariant
+    // weights of the reductions are loaded once per thread if greater than 1
+    int LevelsPerThread = 1;
+    // reductions over chains with complete neighborhoods in the interior subdomain are unrolled
+    // and don't check for missing neighbors on the interior elements
+    bool UnrollInteriorReductions = false;
   };
 
 private:
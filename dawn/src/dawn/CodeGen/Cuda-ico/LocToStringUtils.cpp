@@ -111,6 +111,10 @@ std::string chainToVectorString(std::vector<dawn::ast::LocationType> locs) {
 std::string locToDenseSizeStringGpuMesh(dawn::ast::LocationType loc, std::optional<Padding> padding,
                                         bool addParens) {
   std::string ret;
+  if(padding.has_value() && padding->hasStride()) {
+    // padded size of the GpuTriMesh and kernel parameter
+    return locToStrideString(loc);
+  }
   switch(loc) {
   case dawn::ast::LocationType::Cells:
     ret = padding.has_value() ? "NumCells + " + std::to_string(padding->Cells()) : "NumCells";
@@ -131,6 +135,30 @@ std::string locToDenseSizeStringGpuMesh(dawn::ast::LocationType loc, std::option
     return ret;
   }
 }
+std::string locToStrideString(dawn::ast::LocationType loc) {
+  switch(loc) {
+  case dawn::ast::LocationType::Cells:
+    return "CellStride";
+  case dawn::ast::LocationType::Edges:
+    return "EdgeStride";
+  case dawn::ast::LocationType::Vertices:
+    return "VertexStride";
+  default:
+    dawn_unreachable("");
+  }
+}
+std::string locToLocationTypeString(dawn::ast::LocationType loc) {
+  switch(loc) {
+  case dawn::ast::LocationType::Cells:
+    return "::dawn::LocationType::Cells";
+  case dawn::ast::LocationType::Edges:
+    return "::dawn::LocationType::Edges";
+  case dawn::ast::LocationType::Vertices:
+    return "::dawn::LocationType::Vertices";
+  default:
+    dawn_unreachable("");
+  }
+}
 std::string locToDenseTypeString(dawn::ast::LocationType loc) {
   switch(loc) {
   case dawn::ast::LocationType::Cells:
@@ -37,6 +37,10 @@ std::string chainToVectorString(std::vector<dawn::ast::LocationType> locs);
 std::string locToDenseSizeStringGpuMesh(dawn::ast::LocationType loc, std::optional<Padding>,
                                         bool addParens = false);
 
+std::string locToStrideString(dawn::ast::LocationType loc);
+
+std::string locToLocationTypeString(dawn::ast::LocationType loc);
+
 std::string locToDenseTypeString(dawn::ast::LocationType loc);
 
 std::string locToSparseTypeString(dawn::ast::LocationType loc);
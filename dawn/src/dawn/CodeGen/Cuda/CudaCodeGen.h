@@ -62,6 +62,11 @@ private:
 
   void addTempStorageTypedef(Structure& stencilClass, iir::Stencil const& stencil) const override;
 
+  /// @brief The temporaries are stored in the default precision
+  std::string getTmpStorageType(const iir::Stencil::FieldInfo& field) const override {
+    return tmpStorageTypename_;
+  }
+
   void addTmpStorageInit(
       MemberFunction& ctr, iir::Stencil const& stencil,
       IndexRange<const std::map<int, iir::Stencil::FieldInfo>>& tempFields) const override;
@@ -785,8 +785,10 @@ void MSCodeGen::generateCudaKernelCode() {
 
   // first we construct non temporary field arguments
   for(const auto& fieldPair : nonTempFields) {
-    cudaKernel.addArg("::dawn::float_type * const " +
-                      metadata_.getFieldNameFromAccessID(fieldPair.second.getAccessID()));
+    const int accessID = fieldPair.second.getAccessID();
+    cudaKernel.addArg(
+        std::string(ASTCodeGenCXX::fieldPrecisionToCXXType(metadata_.getFieldPrecision(accessID))) +
+        " * const " + metadata_.getFieldNameFromAccessID(accessID));
   }
 
   // then the temporary field arguments
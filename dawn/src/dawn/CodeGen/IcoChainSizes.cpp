@@ -17,6 +17,7 @@
 #include "dawn/AST/LocationType.h"
 #include "dawn/Support/HashCombine.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <assert.h>
 #include <unordered_set>
@@ -262,4 +263,13 @@ int ICOChainSize(const ast::NeighborChain& chain) {
     return previous_locations.size();
   }
 }
+
+bool ICOChainIsFullInInterior(const ast::NeighborChain& chain) {
+  assert(1 < chain.size());
+  // only the vertices are irregular (the pentagon points of the icosahedron have 5 instead of 6
+  // neighbors), hence the neighborhood is complete as long as the chain doesn't step away from a
+  // vertex
+  return chain.size() <= std::size_t(ICOMaxFullChainLength) &&
+         std::find(chain.begin(), chain.end() - 1, ast::LocationType::Vertices) == chain.end() - 1;
+}
 } // namespace dawn
@@ -21,4 +21,14 @@ namespace dawn {
 
 int ICOChainSize(const ast::NeighborChain& chain);
 
+// Longest chain for which `ICOChainIsFullInInterior` holds. Longer chains are reduced with the
+// checked loops, which keeps the neighbor fronts the interfaces collect complete neighborhoods
+// with on the stack bounded.
+constexpr int ICOMaxFullChainLength = 6;
+
+// Whether all elements of the interior subdomain of an icosahedral mesh have exactly
+// `ICOChainSize(chain)` neighbors, i.e. their neighbor tables contain no missing values, and the
+// chain is at most `ICOMaxFullChainLength` long
+bool ICOChainIsFullInInterior(const ast::NeighborChain& chain);
+
 } // namespace dawn
\ No newline at end of file
@@ -25,13 +25,19 @@ class Padding {
   int cells_ = 0;
   int edges_ = 0;
   int vertices_ = 0;
+  int multiple_ = 1;
 
 public:
-  Padding(int cells, int edges, int vertices) : cells_(cells), edges_(edges), vertices_(vertices) {}
+  Padding(int cells, int edges, int vertices, int multiple = 1)
+      : cells_(cells), edges_(edges), vertices_(vertices), multiple_(multiple) {}
   Padding(){};
   int Cells() const { return cells_; }
   int Edges() const { return edges_; }
   int Vertices() const { return vertices_; }
+  /// The padded horizontal size is rounded up to a multiple of this number of elements, it is a
+  /// runtime value (the stride) if greater than 1
+  int Multiple() const { return multiple_; }
+  bool hasStride() const { return multiple_ > 1; }
 };
 
 /// @brief Options for all codegen backends combined.
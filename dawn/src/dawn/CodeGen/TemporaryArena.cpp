@@ -0,0 +1,86 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/CodeGen/TemporaryArena.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/StencilInstantiation.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace dawn {
+namespace codegen {
+
+TemporaryArena::TemporaryArena(const iir::StencilInstantiation& instantiation,
+                               const std::set<int>& ignoredAccessIDs) {
+  const auto& metadata = instantiation.getMetaData();
+
+  // stencils in the order of their calls, the ones which are never called last
+  std::vector<int> stencilIDs;
+  std::function<void(const std::shared_ptr<ast::Stmt>&)> collectCalls =
+      [&](const std::shared_ptr<ast::Stmt>& stmt) {
+        if(auto call = std::dynamic_pointer_cast<ast::StencilCallDeclStmt>(stmt))
+          stencilIDs.push_back(metadata.getStencilIDFromStencilCallStmt(call));
+        for(const auto& child : stmt->getChildren())
+          collectCalls(child);
+      };
+  for(const auto& stmt : instantiation.getIIR()->getControlFlowDescriptor().getStatements())
+    collectCalls(stmt);
+  for(const auto& stencil : instantiation.getStencils())
+    if(std::find(stencilIDs.begin(), stencilIDs.end(), stencil->getStencilID()) == stencilIDs.end())
+      stencilIDs.push_back(stencil->getStencilID());
+
+  // first and last multi-stage accessing each temporary, numbered in the order of execution
+  std::map<int, std::pair<int, int>> lifetimes;
+  int position = 0;
+  for(int stencilID : stencilIDs) {
+    const auto& stencil = *std::find_if(
+        instantiation.getStencils().begin(), instantiation.getStencils().end(),
+        [&](const std::unique_ptr<iir::Stencil>& s) { return s->getStencilID() == stencilID; });
+    for(const auto& multiStage : stencil->getChildren()) {
+      for(const auto& fieldPair : multiStage->getFields()) {
+        const int accessID = fieldPair.first;
+        if((!metadata.isAccessType(iir::FieldAccessType::StencilTemporary, accessID) &&
+            !metadata.isAccessType(iir::FieldAccessType::InterStencilTemporary, accessID)) ||
+           ignoredAccessIDs.count(accessID))
+          continue;
+        lifetimes.emplace(accessID, std::make_pair(position, position)).first->second.second =
+            position;
+      }
+      ++position;
+    }
+  }
+
+  std::vector<std::pair<int, std::pair<int, int>>> temporaries(lifetimes.begin(), lifetimes.end());
+  std::stable_sort(temporaries.begin(), temporaries.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.second.first < rhs.second.first;
+  });
+
+  // last position of the temporary held by each slot
+  std::vector<int> slotEnds;
+  for(const auto& [accessID, lifetime] : temporaries) {
+    auto slot = std::find_if(slotEnds.begin(), slotEnds.end(),
+                             [&](int end) { return end < lifetime.first; });
+    if(slot == slotEnds.end())
+      slot = slotEnds.insert(slotEnds.end(), lifetime.second);
+    else
+      *slot = lifetime.second;
+    slots_[accessID] = std::distance(slotEnds.begin(), slot);
+  }
+  numSlots_ = slotEnds.size();
+}
+
+} // namespace codegen
+} // namespace dawn
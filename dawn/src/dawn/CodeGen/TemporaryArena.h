@@ -0,0 +1,62 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include <map>
+#include <set>
+
+namespace dawn {
+namespace iir {
+class StencilInstantiation;
+}
+
+namespace codegen {
+
+/// @brief Assignment of the temporaries of a stencil instantiation to the slots of one arena
+///
+/// The lifetime of a temporary (stencil or inter-stencil) spans the multi-stages from its first to
+/// its last access, in the order in which the stencil calls of the control flow execute them.
+/// Temporaries with disjoint lifetimes share a slot. The slots are assigned greedily in the order
+/// of the first accesses, which needs as many slots as temporaries are alive at the same time.
+/// Each slot holds one temporary storage (of the largest size).
+///
+/// @ingroup codegen
+class TemporaryArena {
+public:
+  /// @brief Plan the arena of the temporaries of `instantiation` except `ignoredAccessIDs`
+  explicit TemporaryArena(const iir::StencilInstantiation& instantiation,
+                          const std::set<int>& ignoredAccessIDs = {});
+
+  /// @brief Whether the temporary `accessID` is allocated in the arena
+  bool contains(int accessID) const { return slots_.count(accessID); }
+
+  /// @brief Slot of the temporary `accessID`
+  int getSlot(int accessID) const { return slots_.at(accessID); }
+
+  /// @brief Number of slots, i.e. the peak number of temporaries allocated at the same time
+  int getNumSlots() const { return numSlots_; }
+
+  /// @brief Number of temporaries, i.e. the peak without sharing
+  int getNumTemporaries() const { return slots_.size(); }
+
+  bool empty() const { return slots_.empty(); }
+
+private:
+  std::map<int, int> slots_;
+  int numSlots_ = 0;
+};
+
+} // namespace codegen
+} // namespace dawn
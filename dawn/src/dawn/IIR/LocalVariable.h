@@ -34,6 +34,8 @@ class LocalVariableData {
 
   // Type of the variable. std::nullopt means not computed yet.
   std::optional<LocalVariableType> type_;
+  // Whether the variable holds a loop invariant value hoisted by PassLoopInvariantCodeMotion
+  bool isHoisted_ = false;
 
 public:
   /// @brief returns whether the type is set or not
@@ -50,6 +52,11 @@ public:
   ast::LocationType getLocationType() const;
 
   void setType(LocalVariableType type) { type_ = type; }
+
+  /// @brief returns whether the variable was introduced by PassLoopInvariantCodeMotion, i.e. its
+  /// declaration does not depend on the horizontal position and can be evaluated once per k-level
+  bool isHoisted() const { return isHoisted_; }
+  void setHoisted(bool isHoisted) { isHoisted_ = isHoisted; }
 };
 
 } // namespace iir
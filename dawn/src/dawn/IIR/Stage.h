@@ -116,6 +116,7 @@ public:
 
   /// @brief Get the unique `StageID`
   int getStageID() const { return StageID_; }
+  void setStageID(int stageID) { StageID_ = stageID; }
 
   /// @brief Get the vertical Interval of this stage
   std::vector<Interval> getIntervals() const;
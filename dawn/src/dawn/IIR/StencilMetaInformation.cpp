@@ -22,6 +22,7 @@
 #include "dawn/Support/Casting.h"
 #include "dawn/Support/Json.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <functional>
 #include <stack>
@@ -228,6 +229,13 @@ void StencilMetaInformation::moveRegisteredFieldTo(FieldAccessType type, int acc
   DAWN_ASSERT(type != FieldAccessType::APIField);
   DAWN_ASSERT_MSG(isFieldType(type), "non field access type can not be moved");
 
+  // demoting an API field (e.g. a dead field after stencil fusion) removes it from the signature
+  if(isAccessType(FieldAccessType::APIField, accessID)) {
+    auto& apiFieldIDs = fieldAccessMetadata_.apiFieldIDs_;
+    apiFieldIDs.erase(std::remove(apiFieldIDs.begin(), apiFieldIDs.end(), accessID),
+                      apiFieldIDs.end());
+  }
+
   fieldAccessMetadata_.accessIDType_[accessID] = type;
 
   if(fieldAccessMetadata_.TemporaryFieldAccessIDSet_.count(accessID)) {
@@ -345,6 +353,10 @@ void StencilMetaInformation::setFieldDimensions(int fieldID,
   fieldIDToInitializedDimensionsMap_.emplace(fieldID, std::move(fieldDimensions));
 }
 
+ast::FieldPrecision StencilMetaInformation::getFieldPrecision(int fieldID) const {
+  return getFieldDimensions(fieldID).getPrecision();
+}
+
 std::string StencilMetaInformation::getNameFromAccessID(int accessID) const {
   if(isAccessType(iir::FieldAccessType::Literal, accessID)) {
     return getNameFromLiteralAccessID(accessID);
@@ -591,5 +603,16 @@ void StencilMetaInformation::resetLocalVarTypes() {
   }
 }
 
+int StencilMetaInformation::getTemporaryNumLevels(int accessID) const {
+  auto it = temporaryToNumLevelsMap_.find(accessID);
+  return it != temporaryToNumLevelsMap_.end() ? it->second : 0;
+}
+
+void StencilMetaInformation::setTemporaryNumLevels(int accessID, int numLevels) {
+  DAWN_ASSERT(isAccessType(FieldAccessType::StencilTemporary, accessID));
+  DAWN_ASSERT(numLevels > 0);
+  temporaryToNumLevelsMap_[accessID] = numLevels;
+}
+
 } // namespace iir
 } // namespace dawn
@@ -159,6 +159,9 @@ public:
   ast::FieldDimensions getFieldDimensions(int fieldID) const;
   void setFieldDimensions(int fieldID, ast::FieldDimensions&& fieldDimensions);
 
+  /// @brief returns the precision in which the values of the field with id fieldID are stored
+  ast::FieldPrecision getFieldPrecision(int fieldID) const;
+
   template <FieldAccessType... TFieldAccessType>
   bool hasAccessesOfType() const {
     return !getAccessesOfType<TFieldAccessType...>().empty();
@@ -404,6 +407,12 @@ public:
   /// @brief Resets types of all variables to "not computed" (type_ = std::nullopt)
   void resetLocalVarTypes();
 
+  /// @brief Number of vertical levels stored of the temporary `accessID`, i.e. the size of the
+  /// rolling window of ij-planes set by `PassTemporaryDimensionReduction`. Returns 0 if the full
+  /// column is stored.
+  int getTemporaryNumLevels(int accessID) const;
+  void setTemporaryNumLevels(int accessID, int numLevels);
+
   dawn::ast::LocationType getDenseLocationTypeFromAccessID(int ID) const;
 
   const std::vector<int> getAPIFields() const { return fieldAccessMetadata_.apiFieldIDs_; }
@@ -449,6 +458,9 @@ private:
   /// Map from AccessID (of a local variable) to the data of such variable.
   std::unordered_map<int, iir::LocalVariableData> accessIDToLocalVariableDataMap_;
 
+  /// Map from AccessID (of a temporary) to the number of vertical levels stored, if reduced
+  std::unordered_map<int, int> temporaryToNumLevelsMap_;
+
   SourceLocation stencilLocation_;
   std::string stencilName_;
   std::string fileName_;
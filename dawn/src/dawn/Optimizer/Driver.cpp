@@ -22,14 +22,18 @@
 #include "dawn/Support/Logger.h"
 #include "dawn/Support/StringSwitch.h"
 
+#include "dawn/Optimizer/PassCommonSubexpressionElimination.h"
+#include "dawn/Optimizer/PassConstantFolding.h"
 #include "dawn/Optimizer/PassDataLocalityMetric.h"
 #include "dawn/Optimizer/PassFieldVersioning.h"
 #include "dawn/Optimizer/PassFixVersionedInputFields.h"
 #include "dawn/Optimizer/PassInlining.h"
 #include "dawn/Optimizer/PassIntervalPartitioning.h"
 #include "dawn/Optimizer/PassLocalVarType.h"
+#include "dawn/Optimizer/PassLoopInvariantCodeMotion.h"
 #include "dawn/Optimizer/PassMultiStageMerger.h"
 #include "dawn/Optimizer/PassPrintStencilGraph.h"
+#include "dawn/Optimizer/PassReductionFusion.h"
 #include "dawn/Optimizer/PassRemoveScalars.h"
 #include "dawn/Optimizer/PassSSA.h"
 #include "dawn/Optimizer/PassSetBlockSize.h"
@@ -41,10 +45,13 @@
 #include "dawn/Optimizer/PassSetStageLocationType.h"
 #include "dawn/Optimizer/PassSetStageName.h"
 #include "dawn/Optimizer/PassSetSyncStage.h"
+#include "dawn/Optimizer/PassStageFusion.h"
 #include "dawn/Optimizer/PassStageMerger.h"
 #include "dawn/Optimizer/PassStageReordering.h"
 #include "dawn/Optimizer/PassStageSplitAllStatements.h"
 #include "dawn/Optimizer/PassStageSplitter.h"
+#include "dawn/Optimizer/PassStencilFusion.h"
+#include "dawn/Optimizer/PassTemporaryDimensionReduction.h"
 #include "dawn/Optimizer/PassTemporaryMerger.h"
 #include "dawn/Optimizer/PassTemporaryToStencilFunction.h"
 #include "dawn/Optimizer/PassTemporaryType.h"
@@ -149,6 +156,53 @@ run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
       // validation check
       passManager.pushBackPass<PassValidation>();
       break;
+    case PassGroup::ConstantFolding:
+      // run the pass (this recomputes the stage graphs of the modified stencils)
+      passManager.pushBackPass<PassConstantFolding>();
+      // removed branches and stages can change the scope of temporaries ...
+      passManager.pushBackPass<PassTemporaryType>();
+      passManager.pushBackPass<PassLocalVarType>();
+      passManager.pushBackPass<PassRemoveScalars>();
+      // modify stage dependencies
+      passManager.pushBackPass<PassSetSyncStage>();
+      // validation check
+      passManager.pushBackPass<PassValidation>();
+      break;
+    case PassGroup::StageFusion:
+      // run the pass (this recomputes the stage graphs of the fused stencils)
+      passManager.pushBackPass<PassStageFusion>();
+      // temporaries which are now produced and consumed within one stage become local variables
+      passManager.pushBackPass<PassTemporaryType>();
+      passManager.pushBackPass<PassLocalVarType>();
+      passManager.pushBackPass<PassRemoveScalars>();
+      // modify stage dependencies
+      passManager.pushBackPass<PassSetSyncStage>();
+      // validation check
+      passManager.pushBackPass<PassValidation>();
+      break;
+    case PassGroup::CommonSubexpressionElimination:
+      // run the pass
+      passManager.pushBackPass<PassCommonSubexpressionElimination>();
+      // the new variables are typed, the ones of scalar type are inlined again (and left to the
+      // loop invariant code motion)
+      passManager.pushBackPass<PassLocalVarType>();
+      passManager.pushBackPass<PassRemoveScalars>();
+      // validation check
+      passManager.pushBackPass<PassValidation>();
+      break;
+    case PassGroup::ReductionFusion:
+      // run the pass (the reductions are grouped into location typed variables)
+      passManager.pushBackPass<PassReductionFusion>();
+      passManager.pushBackPass<PassLocalVarType>();
+      // validation check
+      passManager.pushBackPass<PassValidation>();
+      break;
+    case PassGroup::LoopInvariantCodeMotion:
+      // run the pass (the hoisted variables are typed and kept by the scalar removal)
+      passManager.pushBackPass<PassLoopInvariantCodeMotion>();
+      // validation check
+      passManager.pushBackPass<PassValidation>();
+      break;
     case PassGroup::SetStageName:
       // This is never used but if we want to reenable it, it is independent
       passManager.pushBackPass<PassSetStageName>();
@@ -156,20 +210,15 @@ run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
       passManager.pushBackPass<PassValidation>();
       break;
     case PassGroup::StageReordering:
-      if(stencilInstantiationMap.begin()->second->getIIR()->getGridType() !=
-         ast::GridType::Unstructured) {
-        passManager.pushBackPass<PassSetStageGraph>();
-        passManager.pushBackPass<PassSetDependencyGraph>();
-        passManager.pushBackPass<PassStageReordering>(reorderStrategy);
-        // moved stages around ...
-        passManager.pushBackPass<PassSetSyncStage>();
-        // if we want this info around, we should probably run this also
-        // passManager.pushBackPass<PassSetStageName>();
-        // validation check
-        passManager.pushBackPass<PassValidation>();
-      } else {
-        DAWN_LOG(WARNING) << "PassStageReordering currently disabled for unstructured meshes!";
-      }
+      passManager.pushBackPass<PassSetStageGraph>();
+      passManager.pushBackPass<PassSetDependencyGraph>();
+      passManager.pushBackPass<PassStageReordering>(reorderStrategy);
+      // moved stages around ...
+      passManager.pushBackPass<PassSetSyncStage>();
+      // if we want this info around, we should probably run this also
+      // passManager.pushBackPass<PassSetStageName>();
+      // validation check
+      passManager.pushBackPass<PassValidation>();
       break;
     case PassGroup::StageMerger:
       // merging requires the stage graph
@@ -247,6 +296,12 @@ run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
       // validation check
       passManager.pushBackPass<PassValidation>();
       break;
+    case PassGroup::TemporaryDimensionReduction:
+      // depends on the multi-stages and their loop order, hence should be the last group
+      passManager.pushBackPass<PassTemporaryDimensionReduction>();
+      // validation check
+      passManager.pushBackPass<PassValidation>();
+      break;
     case PassGroup::MultiStageMerger:
       // set up the graphs for the analysis
       passManager.pushBackPass<PassSetStageGraph>();
@@ -260,6 +315,21 @@ run(const std::map<std::string, std::shared_ptr<iir::StencilInstantiation>>&
       // validation check
       passManager.pushBackPass<PassValidation>();
       break;
+    case PassGroup::StencilFusion:
+      // run the pass (this recomputes the stage graphs of the fused stencils)
+      passManager.pushBackPass<PassStencilFusion>();
+      // merge multistages across the former stencil boundaries
+      passManager.pushBackPass<PassSetDependencyGraph>();
+      passManager.pushBackPass<PassMultiStageMerger>();
+      // since this can change the scope of temporaries ...
+      passManager.pushBackPass<PassTemporaryType>();
+      passManager.pushBackPass<PassLocalVarType>();
+      passManager.pushBackPass<PassRemoveScalars>();
+      // modify stage dependencies
+      passManager.pushBackPass<PassSetSyncStage>();
+      // validation check
+      passManager.pushBackPass<PassValidation>();
+      break;
     case PassGroup::Parallel:
       DAWN_ASSERT_MSG(false, "The parallel group is only valid for lowering to IIR.");
     }
@@ -27,6 +27,12 @@ enum class PassGroup {
   StageReordering,
   StageMerger,
   MultiStageMerger,
+  ConstantFolding,
+  StencilFusion,
+  StageFusion,
+  CommonSubexpressionElimination,
+  ReductionFusion,
+  LoopInvariantCodeMotion,
   TemporaryMerger,
   Inlining,
   IntervalPartitioning,
@@ -36,6 +42,7 @@ enum class PassGroup {
   SetBlockSize,
   DataLocalityMetric,
   SetLoopOrder,
+  TemporaryDimensionReduction,
 };
 
 struct Options {
@@ -0,0 +1,312 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/Optimizer/PassCommonSubexpressionElimination.h"
+#include "dawn/AST/ASTStringifier.h"
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/AccessComputation.h"
+#include "dawn/IIR/IIRNodeIterator.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Support/Logger.h"
+
+#include <optional>
+#include <set>
+
+namespace dawn {
+
+namespace {
+
+/// @brief Floating point operations of an expression. The ones in the body of a reduction are
+/// executed for every neighbor.
+struct Flops {
+  int perPoint = 0;
+  int perNeighbor = 0;
+};
+
+/// @brief Count the operators and function calls of `expr` (one flop each)
+void countFlops(const std::shared_ptr<ast::Expr>& expr, Flops& flops, bool isReductionBody) {
+  int& count = isReductionBody ? flops.perNeighbor : flops.perPoint;
+  if(auto reduction = std::dynamic_pointer_cast<ast::ReductionOverNeighborExpr>(expr)) {
+    countFlops(reduction->getInit(), flops, isReductionBody);
+    countFlops(reduction->getRhs(), flops, true);
+    // accumulation and weighting
+    flops.perNeighbor += reduction->getWeights() ? 2 : 1;
+    return;
+  }
+  if(expr->getKind() == ast::Expr::Kind::UnaryOperator ||
+     expr->getKind() == ast::Expr::Kind::BinaryOperator ||
+     expr->getKind() == ast::Expr::Kind::FunCallExpr)
+    ++count;
+  for(const auto& child : expr->getChildren())
+    countFlops(child, flops, isReductionBody);
+}
+
+/// @brief Number of nodes of `expr`
+int getSize(const std::shared_ptr<ast::Expr>& expr) {
+  int size = 1;
+  for(const auto& child : expr->getChildren())
+    size += getSize(child);
+  if(auto reduction = std::dynamic_pointer_cast<ast::ReductionOverNeighborExpr>(expr))
+    if(reduction->getWeights())
+      for(const auto& weight : *reduction->getWeights())
+        size += getSize(weight);
+  return size;
+}
+
+/// @brief Whether the evaluation of `expr` writes a variable or a field
+bool hasSideEffects(const std::shared_ptr<ast::Expr>& expr) {
+  if(expr->getKind() == ast::Expr::Kind::AssignmentExpr)
+    return true;
+  if(expr->getKind() == ast::Expr::Kind::UnaryOperator) {
+    const auto& op = std::static_pointer_cast<ast::UnaryOperator>(expr)->getOp();
+    if(op == "++" || op == "--")
+      return true;
+  }
+  for(const auto& child : expr->getChildren())
+    if(hasSideEffects(child))
+      return true;
+  return false;
+}
+
+/// @brief Whether `expr` contains a call to a stencil function
+bool callsStencilFunction(const std::shared_ptr<ast::Expr>& expr) {
+  if(expr->getKind() == ast::Expr::Kind::StencilFunCallExpr)
+    return true;
+  for(const auto& child : expr->getChildren())
+    if(callsStencilFunction(child))
+      return true;
+  return false;
+}
+
+/// @brief Access ids of the variables and fields read by `expr`, in pre-order
+void getReadAccessIDs(const std::shared_ptr<ast::Expr>& expr, std::vector<int>& accessIDs) {
+  if(expr->getKind() == ast::Expr::Kind::VarAccessExpr ||
+     expr->getKind() == ast::Expr::Kind::FieldAccessExpr)
+    accessIDs.push_back(iir::getAccessID(expr));
+  for(const auto& child : expr->getChildren())
+    getReadAccessIDs(child, accessIDs);
+  if(auto reduction = std::dynamic_pointer_cast<ast::ReductionOverNeighborExpr>(expr))
+    if(reduction->getWeights())
+      for(const auto& weight : *reduction->getWeights())
+        getReadAccessIDs(weight, accessIDs);
+}
+
+std::vector<int> getReadAccessIDs(const std::shared_ptr<ast::Expr>& expr) {
+  std::vector<int> accessIDs;
+  getReadAccessIDs(expr, accessIDs);
+  return accessIDs;
+}
+
+/// @brief Whether `left` and `right` compute the same value from the same variables and fields.
+/// The data of the expressions is not compared as every literal has its own access id.
+bool isSameValue(const std::shared_ptr<ast::Expr>& left, const std::shared_ptr<ast::Expr>& right) {
+  if(left->getKind() != right->getKind())
+    return false;
+  if(left->getKind() == ast::Expr::Kind::ReductionOverNeighborExpr &&
+     bool(std::static_pointer_cast<ast::ReductionOverNeighborExpr>(left)->getWeights()) !=
+         bool(std::static_pointer_cast<ast::ReductionOverNeighborExpr>(right)->getWeights()))
+    return false;
+  return left->equals(right.get(), false) && getReadAccessIDs(left) == getReadAccessIDs(right);
+}
+
+/// @brief Whether `expr` can be replaced by a variable holding its value. Expressions of literals
+/// are left to the compiler.
+bool isCandidate(const std::shared_ptr<ast::Expr>& expr) {
+  switch(expr->getKind()) {
+  case ast::Expr::Kind::UnaryOperator:
+  case ast::Expr::Kind::BinaryOperator:
+  case ast::Expr::Kind::TernaryOperator:
+  case ast::Expr::Kind::FunCallExpr:
+  case ast::Expr::Kind::ReductionOverNeighborExpr: {
+    return !getReadAccessIDs(expr).empty() && !callsStencilFunction(expr);
+  }
+  default:
+    return false;
+  }
+}
+
+/// @brief Occurrence of a candidate expression in the statement `stmtIdx` of a Do-Method
+struct Occurrence {
+  std::size_t stmtIdx;
+  std::shared_ptr<ast::Expr> expr;
+  // expression containing `expr`, nullptr if `expr` initializes a variable declaration
+  std::shared_ptr<ast::Expr> parent;
+};
+
+/// @brief Collect the candidates of `expr` and its subexpressions. The bodies of reductions (which
+/// depend on the neighbor) and the arguments of stencil functions are not split up. The arms of
+/// ternary operators and the right operands of `&&` and `||` are only evaluated conditionally
+/// (e.g. `b != 0 ? a / b : 0`) and are not searched, as the variable is computed unconditionally.
+void collectOccurrences(std::size_t stmtIdx, const std::shared_ptr<ast::Expr>& expr,
+                        const std::shared_ptr<ast::Expr>& parent,
+                        std::vector<Occurrence>& occurrences) {
+  if(isCandidate(expr))
+    occurrences.push_back({stmtIdx, expr, parent});
+  if(expr->getKind() == ast::Expr::Kind::ReductionOverNeighborExpr ||
+     expr->getKind() == ast::Expr::Kind::StencilFunCallExpr)
+    return;
+  if(const auto ternary = std::dynamic_pointer_cast<ast::TernaryOperator>(expr)) {
+    collectOccurrences(stmtIdx, ternary->getCondition(), expr, occurrences);
+    return;
+  }
+  if(const auto binary = std::dynamic_pointer_cast<ast::BinaryOperator>(expr)) {
+    if(binary->getOp() == "&&" || binary->getOp() == "||") {
+      collectOccurrences(stmtIdx, binary->getLeft(), expr, occurrences);
+      return;
+    }
+  }
+  for(const auto& child : expr->getChildren())
+    collectOccurrences(stmtIdx, child, expr, occurrences);
+}
+
+/// @brief Candidates in the right hand sides of the assignments and variable declarations of
+/// `statements`. Other statements (e.g. branches and loops) are not searched.
+std::vector<Occurrence>
+collectOccurrences(const std::vector<std::shared_ptr<ast::Stmt>>& statements,
+                   const iir::StencilMetaInformation& metadata) {
+  std::vector<Occurrence> occurrences;
+  for(std::size_t stmtIdx = 0; stmtIdx < statements.size(); ++stmtIdx) {
+    if(const auto exprStmt = std::dynamic_pointer_cast<ast::ExprStmt>(statements[stmtIdx])) {
+      const auto assignment = std::dynamic_pointer_cast<ast::AssignmentExpr>(exprStmt->getExpr());
+      if(assignment && !hasSideEffects(assignment->getRight()))
+        collectOccurrences(stmtIdx, assignment->getRight(), assignment, occurrences);
+    } else if(const auto varDeclStmt =
+                  std::dynamic_pointer_cast<ast::VarDeclStmt>(statements[stmtIdx])) {
+      // loop invariants are declared outside of the horizontal loops
+      if(metadata.getLocalVariableDataFromAccessID(iir::getAccessID(varDeclStmt)).isHoisted())
+        continue;
+      for(const auto& expr : varDeclStmt->getInitList())
+        if(!hasSideEffects(expr))
+          collectOccurrences(stmtIdx, expr, nullptr, occurrences);
+    }
+  }
+  return occurrences;
+}
+
+/// @brief Whether the value of `expr` at its occurrence in statement `first` is still valid in
+/// statement `last`
+bool isAvailable(const std::shared_ptr<ast::Expr>& expr,
+                 const std::vector<std::shared_ptr<ast::Stmt>>& statements, std::size_t first,
+                 std::size_t last) {
+  const std::vector<int> accessIDs = getReadAccessIDs(expr);
+  const std::set<int> readAccessIDs(accessIDs.begin(), accessIDs.end());
+  for(std::size_t stmtIdx = first; stmtIdx < last; ++stmtIdx)
+    for(const auto& write :
+        statements[stmtIdx]->getData<iir::IIRStmtData>().CallerAccesses->getWriteAccesses())
+      if(readAccessIDs.count(write.first))
+        return false;
+  return true;
+}
+
+/// @brief Eliminated expression and the number of its eliminated occurrences
+struct Elimination {
+  std::string varName;
+  std::shared_ptr<ast::Expr> expr;
+  int numEliminated;
+};
+
+/// @brief Replace the largest available common subexpression of the Do-Method by a local variable,
+/// returns std::nullopt if there is none
+std::optional<Elimination> eliminateCommonSubexpression(iir::DoMethod& doMethod,
+                                                        iir::StencilMetaInformation& metadata) {
+  const auto& statements = doMethod.getAST().getStatements();
+  const std::vector<Occurrence> occurrences = collectOccurrences(statements, metadata);
+
+  std::vector<Occurrence> best;
+  int bestSize = 0;
+  std::vector<bool> isNumbered(occurrences.size(), false);
+  for(std::size_t idx = 0; idx < occurrences.size(); ++idx) {
+    if(isNumbered[idx])
+      continue;
+    // occurrences of the same value, i.e. of an equal expression without a write to its operands
+    // since the first occurrence
+    const Occurrence& first = occurrences[idx];
+    std::vector<Occurrence> sameValue = {first};
+    for(std::size_t otherIdx = idx + 1; otherIdx < occurrences.size(); ++otherIdx) {
+      const Occurrence& other = occurrences[otherIdx];
+      if(isNumbered[otherIdx] || !isSameValue(first.expr, other.expr))
+        continue;
+      if(!isAvailable(first.expr, statements, first.stmtIdx, other.stmtIdx))
+        break;
+      isNumbered[otherIdx] = true;
+      sameValue.push_back(other);
+    }
+    const int size = getSize(first.expr);
+    if(sameValue.size() > 1 && size > bestSize) {
+      best = std::move(sameValue);
+      bestSize = size;
+    }
+  }
+  if(best.empty())
+    return std::nullopt;
+
+  const auto expr = best.front().expr;
+  auto varDeclStmt = metadata.declareVar(
+      false, "cse", Type(BuiltinTypeID::Auto, CVQualifier::Const), expr->clone());
+  const int accessID = iir::getAccessID(varDeclStmt);
+  for(const auto& occurrence : best) {
+    auto varAccessExpr = std::make_shared<ast::VarAccessExpr>(varDeclStmt->getName());
+    varAccessExpr->getData<iir::IIRAccessExprData>().AccessID = std::make_optional(accessID);
+    if(occurrence.parent) {
+      occurrence.parent->replaceChildren(occurrence.expr, varAccessExpr);
+    } else {
+      for(auto& init :
+          std::static_pointer_cast<ast::VarDeclStmt>(statements[occurrence.stmtIdx])->getInitList())
+        if(init == occurrence.expr)
+          init = varAccessExpr;
+    }
+  }
+
+  const std::vector<std::shared_ptr<ast::Stmt>> declaration = {varDeclStmt};
+  doMethod.getAST().insert(std::next(statements.begin(), best.front().stmtIdx), declaration.begin(),
+                           declaration.end());
+  computeAccesses(metadata, doMethod.getAST().getStatements());
+  return Elimination{varDeclStmt->getName(), expr, int(best.size()) - 1};
+}
+
+} // namespace
+
+bool PassCommonSubexpressionElimination::run(
+    const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+    const Options& options) {
+  auto& metadata = stencilInstantiation->getMetaData();
+
+  Flops eliminatedFlops;
+  for(const auto& doMethod : iterateIIROver<iir::DoMethod>(*stencilInstantiation->getIIR())) {
+    bool modified = false;
+    while(auto elimination = eliminateCommonSubexpression(*doMethod, metadata)) {
+      modified = true;
+      Flops flops;
+      countFlops(elimination->expr, flops, false);
+      eliminatedFlops.perPoint += elimination->numEliminated * flops.perPoint;
+      eliminatedFlops.perNeighbor += elimination->numEliminated * flops.perNeighbor;
+      DAWN_LOG(INFO) << stencilInstantiation->getName() << ": DoMethod: " << doMethod->getID()
+                     << " replaced " << elimination->numEliminated + 1 << " occurrences of `"
+                     << ast::ASTStringifier::toString(elimination->expr) << "` by `"
+                     << elimination->varName << "`";
+    }
+    if(modified)
+      doMethod->update(iir::NodeUpdateType::levelAndTreeAbove);
+  }
+
+  if(eliminatedFlops.perPoint > 0 || eliminatedFlops.perNeighbor > 0)
+    DAWN_LOG(INFO) << stencilInstantiation->getName() << ": eliminated " << eliminatedFlops.perPoint
+                   << " flops per grid point, plus " << eliminatedFlops.perNeighbor
+                   << " flops per neighbor of the reductions";
+
+  return true;
+}
+
+} // namespace dawn
@@ -0,0 +1,47 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "dawn/Optimizer/Pass.h"
+
+namespace dawn {
+
+/// @brief Eliminate common subexpressions within and across the statements of a Do-Method
+///
+/// Subexpressions of the assignments and variable declarations of a Do-Method are numbered by
+/// structural equality (`ast::Expr::equals`). An expression which occurs more than once is computed
+/// once into a constant local variable declared before its first occurrence, as long as none of
+/// the variables and fields it reads is written in between (according to the `CallerAccesses` of
+/// the statements). Whole reductions over neighbors are candidates, their bodies are not split up.
+/// Subexpressions which are only evaluated conditionally (in the arms of ternary operators and the
+/// right operands of `&&` and `||`) are not eliminated. The largest expressions are eliminated
+/// first.
+///
+/// The new variables are declared `const auto` and classified by `PassLocalVarType`. The number of
+/// eliminated floating point operations is reported to the info log.
+///
+/// @ingroup optimizer
+///
+/// This pass is not necessary to create legal code and is hence not in the debug-group
+class PassCommonSubexpressionElimination : public Pass {
+public:
+  PassCommonSubexpressionElimination() : Pass("PassCommonSubexpressionElimination") {}
+
+  /// @brief Pass implementation
+  bool run(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+           const Options& options = {}) override;
+};
+
+} // namespace dawn
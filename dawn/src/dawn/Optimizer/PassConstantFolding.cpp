@@ -0,0 +1,517 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/Optimizer/PassConstantFolding.h"
+#include "dawn/AST/ASTUtil.h"
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/AccessComputation.h"
+#include "dawn/IIR/IIRNodeIterator.h"
+#include "dawn/IIR/InstantiationHelper.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassSetStageGraph.h"
+#include "dawn/Optimizer/Replacing.h"
+#include "dawn/Support/Logger.h"
+#include "dawn/Support/StringUtil.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace dawn {
+
+namespace {
+
+bool isLiteral(const std::shared_ptr<ast::Expr>& expr) {
+  return expr->getKind() == ast::Expr::Kind::LiteralAccessExpr;
+}
+
+BuiltinTypeID getLiteralType(const std::shared_ptr<ast::Expr>& expr) {
+  return std::static_pointer_cast<ast::LiteralAccessExpr>(expr)->getBuiltinType();
+}
+
+bool isBooleanOperator(const std::string& op) {
+  return op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=" ||
+         op == "&&" || op == "||" || op == "!";
+}
+
+/// @brief Type of the result of an arithmetic operation on operands of type `left` and `right`
+BuiltinTypeID getArithmeticType(BuiltinTypeID left, BuiltinTypeID right) {
+  if(left == BuiltinTypeID::Double || right == BuiltinTypeID::Double)
+    return BuiltinTypeID::Double;
+  if(left == BuiltinTypeID::Float || right == BuiltinTypeID::Float)
+    return BuiltinTypeID::Float;
+  return BuiltinTypeID::Integer;
+}
+
+/// @brief Replace operators whose operands are literals by the literal of their value
+class ConstantFolder : public ast::ASTVisitorPostOrder {
+  iir::StencilMetaInformation& metadata_;
+  bool folded_ = false;
+
+  std::shared_ptr<ast::Expr> makeLiteral(double value, BuiltinTypeID type) {
+    std::string valueString;
+    switch(type) {
+    case BuiltinTypeID::Boolean:
+      valueString = ast::Value(value != 0.).toString();
+      break;
+    case BuiltinTypeID::Integer:
+      valueString = ast::Value(static_cast<int>(value)).toString();
+      break;
+    default:
+      // floating point literals are emitted as `::dawn::float_type`, which may be double, hence
+      // `Float` results are kept in double precision as well
+      valueString = ast::Value(value).toString();
+      break;
+    }
+    auto literal = std::make_shared<ast::LiteralAccessExpr>(valueString, type);
+    literal->getData<iir::IIRAccessExprData>().AccessID = std::make_optional(
+        metadata_.insertAccessOfType(iir::FieldAccessType::Literal, valueString));
+    folded_ = true;
+    return literal;
+  }
+
+  /// @brief Evaluate `expr` (whose operands are literals) into a literal of type `type`
+  std::shared_ptr<ast::Expr> evaluate(const std::shared_ptr<ast::Expr>& expr, BuiltinTypeID type) {
+    double value;
+    if(!ast::evalExprAsDouble(expr, value) || !std::isfinite(value))
+      return expr;
+    // the result of an integer operation which overflows is left to the generated code
+    if(type == BuiltinTypeID::Integer && (value < double(std::numeric_limits<int>::min()) ||
+                                          value > double(std::numeric_limits<int>::max())))
+      return expr;
+    return makeLiteral(value, type);
+  }
+
+public:
+  ConstantFolder(iir::StencilMetaInformation& metadata) : metadata_(metadata) {}
+
+  bool hasFolded() const { return folded_; }
+
+  std::shared_ptr<ast::Expr>
+  postVisitNode(std::shared_ptr<ast::UnaryOperator> const& expr) override {
+    if(!isLiteral(expr->getOperand()))
+      return expr;
+    BuiltinTypeID type = getLiteralType(expr->getOperand());
+    if(isBooleanOperator(expr->getOp()))
+      type = BuiltinTypeID::Boolean;
+    else if(type == BuiltinTypeID::Boolean)
+      type = BuiltinTypeID::Integer;
+    return evaluate(expr, type);
+  }
+
+  std::shared_ptr<ast::Expr>
+  postVisitNode(std::shared_ptr<ast::BinaryOperator> const& expr) override {
+    if(!isLiteral(expr->getLeft()))
+      return expr;
+
+    // short-circuit evaluation, the right operand has no side effects
+    bool left;
+    if((expr->getOp() == "&&" || expr->getOp() == "||") &&
+       ast::evalExprAsBoolean(expr->getLeft(), left) && left == (expr->getOp() == "||"))
+      return makeLiteral(left, BuiltinTypeID::Boolean);
+
+    if(!isLiteral(expr->getRight()))
+      return expr;
+    if(isBooleanOperator(expr->getOp()))
+      return evaluate(expr, BuiltinTypeID::Boolean);
+    return evaluate(
+        expr, getArithmeticType(getLiteralType(expr->getLeft()), getLiteralType(expr->getRight())));
+  }
+
+  std::shared_ptr<ast::Expr>
+  postVisitNode(std::shared_ptr<ast::TernaryOperator> const& expr) override {
+    bool condition;
+    if(!isLiteral(expr->getCondition()) || !ast::evalExprAsBoolean(expr->getCondition(), condition))
+      return expr;
+    folded_ = true;
+    return condition ? expr->getLeft() : expr->getRight();
+  }
+};
+
+/// @brief Replace the accesses to the global variable `name` by the literal `value`
+class GlobalReplacer : public ast::ASTVisitorPostOrder {
+  iir::StencilMetaInformation& metadata_;
+  const std::string& name_;
+  const bool value_;
+
+public:
+  GlobalReplacer(iir::StencilMetaInformation& metadata, const std::string& name, bool value)
+      : metadata_(metadata), name_(name), value_(value) {}
+
+  std::shared_ptr<ast::Expr>
+  postVisitNode(std::shared_ptr<ast::VarAccessExpr> const& expr) override {
+    if(!expr->isExternal() || expr->getName() != name_)
+      return expr;
+    const std::string valueString = ast::Value(value_).toString();
+    auto literal = std::make_shared<ast::LiteralAccessExpr>(valueString, BuiltinTypeID::Boolean);
+    literal->getData<iir::IIRAccessExprData>().AccessID = std::make_optional(
+        metadata_.insertAccessOfType(iir::FieldAccessType::Literal, valueString));
+    return literal;
+  }
+};
+
+/// @brief Collect the global variables read in the conditions of if-statements and ternary
+/// operators
+class ConditionGlobalsCollector : public ast::ASTVisitorForwardingNonConst {
+  std::set<std::string> globals_;
+  int conditionDepth_ = 0;
+
+public:
+  const std::set<std::string>& getGlobals() const { return globals_; }
+
+  void visit(const std::shared_ptr<ast::IfStmt>& stmt) override {
+    ++conditionDepth_;
+    stmt->getCondExpr()->accept(*this);
+    --conditionDepth_;
+    stmt->getThenStmt()->accept(*this);
+    if(stmt->hasElse())
+      stmt->getElseStmt()->accept(*this);
+  }
+
+  void visit(const std::shared_ptr<ast::TernaryOperator>& expr) override {
+    ++conditionDepth_;
+    expr->getCondition()->accept(*this);
+    --conditionDepth_;
+    expr->getLeft()->accept(*this);
+    expr->getRight()->accept(*this);
+  }
+
+  void visit(const std::shared_ptr<ast::VarAccessExpr>& expr) override {
+    if(conditionDepth_ > 0 && expr->isExternal())
+      globals_.insert(expr->getName());
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+};
+
+/// @brief Replace if-statements with a literal condition by the block of the taken branch
+bool removeDeadBranches(ast::BlockStmt& blockStmt) {
+  bool removed = false;
+  for(auto stmtIt = blockStmt.getStatements().begin(); stmtIt != blockStmt.getStatements().end();) {
+    if(const auto ifStmt = std::dynamic_pointer_cast<ast::IfStmt>(*stmtIt)) {
+      bool condition;
+      if(isLiteral(ifStmt->getCondExpr()) &&
+         ast::evalExprAsBoolean(ifStmt->getCondExpr(), condition)) {
+        removed = true;
+        const auto& taken = condition ? ifStmt->getThenStmt() : ifStmt->getElseStmt();
+        if(!taken) {
+          stmtIt = blockStmt.erase(stmtIt);
+          continue;
+        }
+        // the block keeps the scope of the local variables declared in the branch, continue with
+        // its statements
+        DAWN_ASSERT_MSG(taken->getKind() == ast::Stmt::Kind::BlockStmt,
+                        "branches of if-statements must be block statements");
+        blockStmt.substitute(stmtIt, std::shared_ptr<ast::Stmt>(taken));
+        continue;
+      }
+      for(const auto& branch : {ifStmt->getThenStmt(), ifStmt->getElseStmt()})
+        if(branch && branch->getKind() == ast::Stmt::Kind::BlockStmt)
+          removed |= removeDeadBranches(*std::static_pointer_cast<ast::BlockStmt>(branch));
+    } else if(const auto loopStmt = std::dynamic_pointer_cast<ast::LoopStmt>(*stmtIt)) {
+      removed |= removeDeadBranches(*loopStmt->getBlockStmt());
+    } else if(const auto nestedBlockStmt = std::dynamic_pointer_cast<ast::BlockStmt>(*stmtIt)) {
+      removed |= removeDeadBranches(*nestedBlockStmt);
+    }
+    ++stmtIt;
+  }
+  return removed;
+}
+
+/// @brief Fold the constants of and remove the dead branches from the statements of `doMethod`
+bool foldDoMethod(iir::DoMethod& doMethod, iir::StencilMetaInformation& metadata) {
+  ConstantFolder folder(metadata);
+  for(const auto& stmt : doMethod.getAST().getStatements())
+    stmt->acceptAndReplace(folder);
+  const bool removed = removeDeadBranches(doMethod.getAST());
+  if(!folder.hasFolded() && !removed)
+    return false;
+
+  computeAccesses(metadata, doMethod.getAST().getStatements());
+  doMethod.update(iir::NodeUpdateType::levelAndTreeAbove);
+  return true;
+}
+
+/// @brief Check if `stage` only writes local variables and stencil temporaries which no other
+/// stage of `stencil` accesses
+bool isDeadStage(const iir::Stage& stage, const iir::Stencil& stencil,
+                 const iir::StencilMetaInformation& metadata) {
+  for(const auto& stmt : iterateIIROverStmt(stage)) {
+    for(const auto& [accessID, extents] :
+        stmt->getData<iir::IIRStmtData>().CallerAccesses->getWriteAccesses()) {
+      if(metadata.isAccessType(iir::FieldAccessType::LocalVariable, accessID))
+        continue;
+      if(!metadata.isAccessType(iir::FieldAccessType::StencilTemporary, accessID))
+        return false;
+      for(const auto& otherStage : iterateIIROver<iir::Stage>(stencil))
+        if(otherStage.get() != &stage && otherStage->getFields().count(accessID))
+          return false;
+    }
+  }
+  return true;
+}
+
+/// @brief Remove empty Do-Methods, empty multi-stages and empty or dead stages from `stencil`
+bool removeDeadCode(iir::Stencil& stencil, const std::string& name,
+                    const iir::StencilMetaInformation& metadata) {
+  bool removedAny = false;
+  for(bool removed = true; removed;) {
+    removed = false;
+    for(const auto& multiStage : stencil.getChildren()) {
+      for(auto stageIt = multiStage->childrenBegin(); stageIt != multiStage->childrenEnd();) {
+        iir::Stage& stage = **stageIt;
+        const bool erasedDoMethod =
+            stage.childrenEraseIf([](const std::unique_ptr<iir::DoMethod>& doMethod) {
+              return doMethod->isEmptyOrNullStmt();
+            });
+        if(erasedDoMethod && !stage.childrenEmpty())
+          stage.update(iir::NodeUpdateType::levelAndTreeAbove);
+
+        if(stage.childrenEmpty() || isDeadStage(stage, stencil, metadata)) {
+          DAWN_LOG(INFO) << name << ": removing dead stage " << stage.getStageID();
+          stageIt = multiStage->childrenErase(stageIt);
+          removed = removedAny = true;
+        } else {
+          ++stageIt;
+        }
+      }
+    }
+    if(removed)
+      for(const auto& multiStage : stencil.getChildren())
+        multiStage->update(iir::NodeUpdateType::levelAndTreeAbove);
+  }
+
+  if(stencil.childrenEraseIf([](const std::unique_ptr<iir::MultiStage>& multiStage) {
+       return multiStage->childrenEmpty();
+     })) {
+    stencil.updateFromChildren();
+    removedAny = true;
+  }
+  return removedAny;
+}
+
+/// @brief Boolean global variables which are not constant, read in the conditions of `stencil`
+/// and not written by it
+std::vector<std::string>
+getSpecializableGlobals(const iir::Stencil& stencil,
+                        const iir::StencilInstantiation& stencilInstantiation) {
+  const auto& metadata = stencilInstantiation.getMetaData();
+  const auto& globalsMap = stencilInstantiation.getIIR()->getGlobalVariableMap();
+
+  ConditionGlobalsCollector collector;
+  for(const auto& stmt : iterateIIROverStmt(stencil))
+    stmt->accept(collector);
+
+  std::vector<std::string> globals;
+  for(const auto& name : collector.getGlobals()) {
+    auto global = globalsMap.find(name);
+    if(global == globalsMap.end() || global->second.isConstexpr() ||
+       global->second.getType() != ast::Value::Kind::Boolean)
+      continue;
+    const int accessID = metadata.getAccessIDFromName(name);
+    const auto stmts = iterateIIROverStmt(stencil);
+    if(std::none_of(stmts.begin(), stmts.end(), [&](const std::shared_ptr<ast::Stmt>& stmt) {
+         return stmt->getData<iir::IIRStmtData>().CallerAccesses->hasWriteAccess(accessID);
+       }))
+      globals.push_back(name);
+  }
+  return globals;
+}
+
+/// @brief Collect the stencil function calls in pre-order
+class StencilFunCallCollector : public ast::ASTVisitorForwardingNonConst {
+  std::vector<std::shared_ptr<ast::StencilFunCallExpr>> calls_;
+
+public:
+  const std::vector<std::shared_ptr<ast::StencilFunCallExpr>>& getCalls() const { return calls_; }
+
+  void visit(const std::shared_ptr<ast::StencilFunCallExpr>& expr) override {
+    calls_.push_back(expr);
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+};
+
+std::vector<std::shared_ptr<ast::StencilFunCallExpr>>
+getStencilFunCalls(const iir::Stencil& stencil) {
+  StencilFunCallCollector collector;
+  for(const auto& stmt : iterateIIROverStmt(stencil))
+    stmt->accept(collector);
+  return collector.getCalls();
+}
+
+/// @brief Copy of `stencil` with new IDs for the stencil, its multi-stages, stages and Do-Methods
+///
+/// The copied stencil function calls share the stencil function instantiations of the calls they
+/// were copied from.
+std::unique_ptr<iir::Stencil> cloneStencil(iir::Stencil& stencil,
+                                           iir::StencilInstantiation& stencilInstantiation) {
+  auto& metadata = stencilInstantiation.getMetaData();
+  auto newStencil = std::make_unique<iir::Stencil>(metadata, stencil.getStencilAttributes(),
+                                                   stencilInstantiation.nextUID());
+  for(const auto& multiStage : stencil.getChildren()) {
+    auto newMultiStage = multiStage->clone();
+    newMultiStage->setID(stencilInstantiation.nextUID());
+    for(const auto& stage : newMultiStage->getChildren()) {
+      stage->setStageID(stencilInstantiation.nextUID());
+      for(const auto& doMethod : stage->getChildren())
+        doMethod->setID(stencilInstantiation.nextUID());
+    }
+    newStencil->insertChild(std::move(newMultiStage));
+  }
+
+  const auto calls = getStencilFunCalls(stencil);
+  const auto newCalls = getStencilFunCalls(*newStencil);
+  DAWN_ASSERT(calls.size() == newCalls.size());
+  for(std::size_t idx = 0; idx < calls.size(); ++idx)
+    if(metadata.getExprToStencilFunctionInstantiation().count(calls[idx]))
+      metadata.insertExprToStencilFunctionInstantiation(
+          newCalls[idx], metadata.getStencilFunctionInstantiation(calls[idx]));
+  return newStencil;
+}
+
+void replaceGlobal(iir::Stencil& stencil, const std::string& name, bool value,
+                   iir::StencilMetaInformation& metadata) {
+  GlobalReplacer replacer(metadata, name, value);
+  for(const auto& doMethod : iterateIIROver<iir::DoMethod>(stencil)) {
+    for(const auto& stmt : doMethod->getAST().getStatements())
+      stmt->acceptAndReplace(replacer);
+    computeAccesses(metadata, doMethod->getAST().getStatements());
+  }
+}
+
+/// @brief Version `stencil` for each combination of values of `globals`
+///
+/// The versions are appended to `versions`, the version with index `i` assumes that `globals[j]`
+/// is the `j`th bit of `i`.
+void specializeStencil(iir::Stencil& stencil, const std::vector<std::string>& globals,
+                       iir::StencilInstantiation& stencilInstantiation,
+                       std::vector<std::unique_ptr<iir::Stencil>>& versions) {
+  const int numVersions = 1 << globals.size();
+  for(int version = 0; version < numVersions; ++version) {
+    versions.push_back(cloneStencil(stencil, stencilInstantiation));
+    for(std::size_t idx = 0; idx < globals.size(); ++idx)
+      replaceGlobal(*versions.back(), globals[idx], (version >> idx) & 1,
+                    stencilInstantiation.getMetaData());
+  }
+}
+
+/// @brief Statement selecting the stencil version for the values of `globals[idx:]` (the values of
+/// `globals[:idx]` are given by the bits of `version`)
+std::shared_ptr<ast::Stmt> makeVersionSelection(const std::vector<int>& versionIDs,
+                                                const std::vector<std::string>& globals,
+                                                std::size_t idx, int version,
+                                                iir::StencilMetaInformation& metadata) {
+  if(idx == globals.size()) {
+    auto stencilCall = iir::makeStencilCallDeclStmt(std::make_shared<ast::StencilCall>(
+        iir::InstantiationHelper::makeStencilCallCodeGenName(versionIDs[version])));
+    metadata.addStencilCallStmt(stencilCall, versionIDs[version]);
+    return iir::makeBlockStmt(std::vector<std::shared_ptr<ast::Stmt>>{stencilCall});
+  }
+
+  auto condition = std::make_shared<ast::VarAccessExpr>(globals[idx]);
+  condition->setIsExternal(true);
+  condition->getData<iir::IIRAccessExprData>().AccessID =
+      std::make_optional(metadata.getAccessIDFromName(globals[idx]));
+  return iir::makeIfStmt(
+      iir::makeExprStmt(condition),
+      makeVersionSelection(versionIDs, globals, idx + 1, version | (1 << idx), metadata),
+      makeVersionSelection(versionIDs, globals, idx + 1, version, metadata));
+}
+
+/// @brief Version the stencils of `stencilInstantiation` for up to `maxGlobals` boolean globals
+bool specializeGlobals(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+                       int maxGlobals) {
+  const auto& IIR = stencilInstantiation->getIIR();
+  bool specialized = false;
+  for(auto stencilIt = IIR->childrenBegin(); stencilIt != IIR->childrenEnd();) {
+    iir::Stencil& stencil = **stencilIt;
+    std::vector<std::string> globals = getSpecializableGlobals(stencil, *stencilInstantiation);
+    if(globals.empty()) {
+      ++stencilIt;
+      continue;
+    }
+    if(globals.size() > std::size_t(maxGlobals))
+      globals.resize(maxGlobals);
+
+    std::vector<std::unique_ptr<iir::Stencil>> versions;
+    specializeStencil(stencil, globals, *stencilInstantiation, versions);
+    std::vector<int> versionIDs;
+    for(const auto& version : versions)
+      versionIDs.push_back(version->getStencilID());
+
+    DAWN_LOG(INFO) << stencilInstantiation->getName() << ": versioning stencil "
+                   << stencil.getStencilID() << " for " << RangeToString()(globals) << " into "
+                   << RangeToString()(versionIDs);
+
+    replaceStencilCalls(stencilInstantiation, stencil.getStencilID(), [&]() {
+      return makeVersionSelection(versionIDs, globals, 0, 0, stencilInstantiation->getMetaData());
+    });
+
+    stencilIt = IIR->childrenErase(stencilIt);
+    stencilIt = IIR->insertChildren(stencilIt, std::make_move_iterator(versions.begin()),
+                                    std::make_move_iterator(versions.end()), IIR);
+    std::advance(stencilIt, versionIDs.size());
+    specialized = true;
+  }
+  return specialized;
+}
+
+} // namespace
+
+bool PassConstantFolding::run(
+    const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+    const Options& options) {
+  auto& metadata = stencilInstantiation->getMetaData();
+  const auto& IIR = stencilInstantiation->getIIR();
+
+  bool modifiedStencils = options.SpecializeGlobals > 0 &&
+                          specializeGlobals(stencilInstantiation, options.SpecializeGlobals);
+
+  for(const auto& doMethod : iterateIIROver<iir::DoMethod>(*IIR))
+    if(foldDoMethod(*doMethod, metadata))
+      DAWN_LOG(INFO) << stencilInstantiation->getName() << ": folded constants in Do-Method "
+                     << doMethod->getID();
+
+  for(const auto& stencil : IIR->getChildren())
+    modifiedStencils |= removeDeadCode(*stencil, stencilInstantiation->getName(), metadata);
+
+  for(auto stencilIt = IIR->childrenBegin(); stencilIt != IIR->childrenEnd();) {
+    if((*stencilIt)->childrenEmpty() && IIR->getChildren().size() > 1) {
+      DAWN_LOG(INFO) << stencilInstantiation->getName() << ": removing empty stencil "
+                     << (*stencilIt)->getStencilID();
+      replaceStencilCalls(stencilInstantiation, (*stencilIt)->getStencilID(), std::vector<int>{});
+      stencilIt = IIR->childrenErase(stencilIt);
+    } else {
+      ++stencilIt;
+    }
+  }
+
+  // the temporaries of the removed stages may not be accessed anymore
+  for(int accessID : metadata.getAccessesOfType<iir::FieldAccessType::StencilTemporary>()) {
+    if(std::none_of(IIR->childrenBegin(), IIR->childrenEnd(),
+                    [&](const std::unique_ptr<iir::Stencil>& stencil) {
+                      return stencil->getFields().count(accessID);
+                    }))
+      metadata.removeAccessID(accessID);
+  }
+
+  if(modifiedStencils) {
+    PassSetStageGraph pass;
+    pass.run(stencilInstantiation);
+  }
+  return true;
+}
+
+} // namespace dawn
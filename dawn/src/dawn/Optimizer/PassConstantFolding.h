@@ -0,0 +1,49 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "dawn/Optimizer/Pass.h"
+
+namespace dawn {
+
+/// @brief Fold constant expressions and remove the code which becomes dead
+///
+/// Constant global variables are replaced by literals when lowering the SIR. This pass evaluates
+/// unary, binary and ternary operators whose operands are literals, replaces if-statements with a
+/// literal condition by the block of the taken branch and removes
+///   - Do-Methods, stages and multi-stages which become empty,
+///   - stages which only write stencil temporaries that no other stage of the stencil reads,
+///   - stencils which become empty (unless it is the only stencil).
+///
+/// With `--specialize-globals=N` each stencil is first versioned for up to N boolean global
+/// variables which are not constant, read in the conditions of the stencil and not written by it.
+/// Each version is folded with the global replaced by `true` or `false` and the stencil
+/// description selects the version once per stencil call, instead of evaluating the global for
+/// every grid point. This requires a backend which generates the stencil description (i.e. not
+/// cuda-ico, which runs a single stencil).
+///
+/// @ingroup optimizer
+///
+/// This pass is not necessary to create legal code and is hence not in the debug-group
+class PassConstantFolding : public Pass {
+public:
+  PassConstantFolding() : Pass("PassConstantFolding") {}
+
+  /// @brief Pass implementation
+  bool run(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+           const Options& options = {}) override;
+};
+
+} // namespace dawn
@@ -0,0 +1,331 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/Optimizer/PassLoopInvariantCodeMotion.h"
+#include "dawn/AST/ASTVisitor.h"
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/AccessComputation.h"
+#include "dawn/IIR/IIRNodeIterator.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Support/Logger.h"
+
+#include <algorithm>
+#include <optional>
+#include <set>
+
+namespace dawn {
+
+namespace {
+
+bool isBooleanOperator(const std::string& op) {
+  return op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=" ||
+         op == "&&" || op == "||" || op == "!";
+}
+
+/// @brief Type of the result of an arithmetic operation on operands of type `left` and `right`
+/// (floating point values are stored as `::dawn::float_type`, i.e. `BuiltinTypeID::Float`)
+std::optional<BuiltinTypeID> getArithmeticType(std::optional<BuiltinTypeID> left,
+                                               std::optional<BuiltinTypeID> right) {
+  if(!left || !right)
+    return std::nullopt;
+  if(*left == BuiltinTypeID::Double || *left == BuiltinTypeID::Float ||
+     *right == BuiltinTypeID::Double || *right == BuiltinTypeID::Float)
+    return BuiltinTypeID::Float;
+  return BuiltinTypeID::Integer;
+}
+
+/// @brief Whether `expr` reads a variable or a field (expressions of literals are left to the
+/// compiler)
+bool readsVariable(const std::shared_ptr<ast::Expr>& expr) {
+  if(expr->getKind() == ast::Expr::Kind::VarAccessExpr ||
+     expr->getKind() == ast::Expr::Kind::FieldAccessExpr)
+    return true;
+  for(const auto& child : expr->getChildren())
+    if(readsVariable(child))
+      return true;
+  return false;
+}
+
+/// @brief Replaces the maximal loop invariant subexpressions of the statements of a Do-Method by
+/// hoisted local variables
+class InvariantHoister : public ast::ASTVisitorForwardingNonConst {
+  iir::StencilMetaInformation& metadata_;
+  const ast::GlobalVariableMap& globals_;
+  const bool isUnstructured_;
+  // variables and fields written in the Do-Method
+  std::set<int> writtenAccessIDs_;
+
+  // hoisted expressions, the access ids and the types of the variables holding them
+  struct Hoisted {
+    std::shared_ptr<ast::Expr> expr;
+    int accessID;
+    BuiltinTypeID type;
+  };
+  std::vector<Hoisted> hoisted_;
+  std::vector<std::shared_ptr<ast::Stmt>> declarations_;
+  // number of enclosing arms of ternary operators, nothing is hoisted out of conditionally
+  // evaluated expressions (e.g. a division guarded by a check of the divisor)
+  int conditionalDepth_ = 0;
+
+  bool isInvariantLeaf(const std::shared_ptr<ast::Expr>& expr) const {
+    switch(expr->getKind()) {
+    case ast::Expr::Kind::LiteralAccessExpr:
+      return true;
+    case ast::Expr::Kind::VarAccessExpr: {
+      const auto varAccess = std::static_pointer_cast<ast::VarAccessExpr>(expr);
+      const int accessID = iir::getAccessID(varAccess);
+      if(varAccess->isArrayAccess() || writtenAccessIDs_.count(accessID))
+        return false;
+      if(metadata_.isAccessType(iir::FieldAccessType::GlobalVariable, accessID))
+        return true;
+      return metadata_.getAccessIDToLocalVariableDataMap().count(accessID) &&
+             metadata_.getLocalVariableDataFromAccessID(accessID).isHoisted();
+    }
+    case ast::Expr::Kind::FieldAccessExpr: {
+      // only vertical fields have no horizontal dimension, the cartesian backends index all fields
+      // with (i, j, k)
+      const auto fieldAccess = std::static_pointer_cast<ast::FieldAccessExpr>(expr);
+      const int accessID = iir::getAccessID(fieldAccess);
+      return isUnstructured_ && !writtenAccessIDs_.count(accessID) &&
+             metadata_.getFieldDimensions(accessID).isVertical() &&
+             !fieldAccess->getOffset().hasVerticalIndirection();
+    }
+    default:
+      return false;
+    }
+  }
+
+  /// @brief Whether `expr` has no side effects and is invariant if its operands are
+  static bool isInvariantOperation(const std::shared_ptr<ast::Expr>& expr) {
+    switch(expr->getKind()) {
+    case ast::Expr::Kind::UnaryOperator: {
+      const auto& op = std::static_pointer_cast<ast::UnaryOperator>(expr)->getOp();
+      return op != "++" && op != "--";
+    }
+    case ast::Expr::Kind::BinaryOperator:
+    case ast::Expr::Kind::TernaryOperator:
+    case ast::Expr::Kind::FunCallExpr:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /// @brief Type of the value of the invariant expression `expr`, std::nullopt if unknown
+  std::optional<BuiltinTypeID> getType(const std::shared_ptr<ast::Expr>& expr) const {
+    switch(expr->getKind()) {
+    case ast::Expr::Kind::LiteralAccessExpr:
+      return std::static_pointer_cast<ast::LiteralAccessExpr>(expr)->getBuiltinType();
+    case ast::Expr::Kind::VarAccessExpr: {
+      const auto varAccess = std::static_pointer_cast<ast::VarAccessExpr>(expr);
+      if(varAccess->isExternal()) {
+        if(!globals_.count(varAccess->getName()))
+          return std::nullopt;
+        const BuiltinTypeID type =
+            ast::Value::typeToBuiltinTypeID(globals_.at(varAccess->getName()).getType());
+        return type == BuiltinTypeID::Invalid ? std::nullopt : std::make_optional(type);
+      }
+      for(const auto& hoisted : hoisted_)
+        if(hoisted.accessID == iir::getAccessID(varAccess))
+          return hoisted.type;
+      return std::nullopt;
+    }
+    case ast::Expr::Kind::FieldAccessExpr:
+    case ast::Expr::Kind::FunCallExpr:
+      return BuiltinTypeID::Float;
+    case ast::Expr::Kind::UnaryOperator: {
+      const auto unaryOp = std::static_pointer_cast<ast::UnaryOperator>(expr);
+      if(isBooleanOperator(unaryOp->getOp()))
+        return BuiltinTypeID::Boolean;
+      return getArithmeticType(getType(unaryOp->getOperand()), BuiltinTypeID::Integer);
+    }
+    case ast::Expr::Kind::BinaryOperator: {
+      const auto binaryOp = std::static_pointer_cast<ast::BinaryOperator>(expr);
+      if(isBooleanOperator(binaryOp->getOp()))
+        return BuiltinTypeID::Boolean;
+      return getArithmeticType(getType(binaryOp->getLeft()), getType(binaryOp->getRight()));
+    }
+    case ast::Expr::Kind::TernaryOperator: {
+      const auto ternaryOp = std::static_pointer_cast<ast::TernaryOperator>(expr);
+      const auto left = getType(ternaryOp->getLeft()), right = getType(ternaryOp->getRight());
+      if(left == BuiltinTypeID::Boolean && right == BuiltinTypeID::Boolean)
+        return BuiltinTypeID::Boolean;
+      return getArithmeticType(left, right);
+    }
+    default:
+      return std::nullopt;
+    }
+  }
+
+  /// @brief Whether the invariant expression `expr` is worth a hoisted variable. Boolean
+  /// expressions are kept as they are mostly used in conditions.
+  bool isWorthHoisting(const std::shared_ptr<ast::Expr>& expr) const {
+    if(expr->getKind() == ast::Expr::Kind::LiteralAccessExpr ||
+       expr->getKind() == ast::Expr::Kind::VarAccessExpr ||
+       expr->getKind() == ast::Expr::Kind::FieldAccessExpr || !readsVariable(expr))
+      return false;
+    const auto type = getType(expr);
+    return type == BuiltinTypeID::Integer || type == BuiltinTypeID::Float ||
+           type == BuiltinTypeID::Double;
+  }
+
+  /// @brief Replace the invariant expression `expr` by an access to a hoisted variable
+  std::shared_ptr<ast::Expr> hoist(const std::shared_ptr<ast::Expr>& expr) {
+    auto hoisted = std::find_if(hoisted_.begin(), hoisted_.end(),
+                                [&](const Hoisted& h) { return h.expr->equals(expr); });
+    if(hoisted == hoisted_.end()) {
+      const BuiltinTypeID type = *getType(expr);
+      auto varDeclStmt =
+          metadata_.declareVar(false, "licm", Type(type, CVQualifier::Const), expr->clone());
+      iir::LocalVariableData& data =
+          metadata_.getLocalVariableDataFromAccessID(iir::getAccessID(varDeclStmt));
+      data.setType(iir::LocalVariableType::Scalar);
+      data.setHoisted(true);
+      declarations_.push_back(varDeclStmt);
+      hoisted = hoisted_.insert(hoisted_.end(), Hoisted{expr, iir::getAccessID(varDeclStmt), type});
+    }
+
+    auto varAccessExpr =
+        std::make_shared<ast::VarAccessExpr>(metadata_.getNameFromAccessID(hoisted->accessID));
+    varAccessExpr->getData<iir::IIRAccessExprData>().AccessID =
+        std::make_optional(hoisted->accessID);
+    return varAccessExpr;
+  }
+
+  /// @brief Hoist the maximal invariant subexpressions of `expr` (but not `expr` itself) and
+  /// return whether `expr` is invariant
+  bool process(const std::shared_ptr<ast::Expr>& expr) {
+    if(auto reduction = std::dynamic_pointer_cast<ast::ReductionOverNeighborExpr>(expr)) {
+      // invariant parts of the right hand side are hoisted out of the neighbor loop, too
+      reduction->setRhs(processRoot(reduction->getRhs()));
+      reduction->setInit(processRoot(reduction->getInit()));
+      return false;
+    }
+    // field accesses (vertical indirections), array accesses and stencil function arguments are
+    // not split up
+    if(expr->getKind() == ast::Expr::Kind::FieldAccessExpr ||
+       expr->getKind() == ast::Expr::Kind::VarAccessExpr ||
+       expr->getKind() == ast::Expr::Kind::StencilFunCallExpr || expr->getChildren().empty())
+      return isInvariantLeaf(expr);
+
+    const std::vector<std::shared_ptr<ast::Expr>> children(expr->getChildren().begin(),
+                                                           expr->getChildren().end());
+    // the operands following the condition of a ternary operator are evaluated conditionally
+    auto isConditional = [&](std::size_t idx) {
+      return expr->getKind() == ast::Expr::Kind::TernaryOperator && idx > 0;
+    };
+    std::vector<bool> isInvariant;
+    for(std::size_t idx = 0; idx < children.size(); ++idx) {
+      conditionalDepth_ += isConditional(idx);
+      isInvariant.push_back(process(children[idx]));
+      conditionalDepth_ -= isConditional(idx);
+    }
+    if(isInvariantOperation(expr) &&
+       std::all_of(isInvariant.begin(), isInvariant.end(), [](bool b) { return b; }))
+      return true;
+
+    for(std::size_t idx = 0; idx < children.size(); ++idx)
+      if(isInvariant[idx] && conditionalDepth_ == 0 && !isConditional(idx) &&
+         isWorthHoisting(children[idx]))
+        expr->replaceChildren(children[idx], hoist(children[idx]));
+    return false;
+  }
+
+  /// @brief Hoist the maximal invariant subexpressions of `expr` (including `expr`)
+  std::shared_ptr<ast::Expr> processRoot(const std::shared_ptr<ast::Expr>& expr) {
+    if(process(expr) && conditionalDepth_ == 0 && isWorthHoisting(expr))
+      return hoist(expr);
+    return expr;
+  }
+
+public:
+  InvariantHoister(iir::StencilMetaInformation& metadata, const ast::GlobalVariableMap& globals,
+                   bool isUnstructured, const iir::DoMethod& doMethod)
+      : metadata_(metadata), globals_(globals), isUnstructured_(isUnstructured) {
+    for(const auto& stmt : doMethod.getAST().getStatements()) {
+      for(const auto& write :
+          stmt->getData<iir::IIRStmtData>().CallerAccesses->getWriteAccesses()) {
+        writtenAccessIDs_.insert(write.first);
+      }
+      // variables hoisted by a previous run can be reused
+      if(const auto& varDeclStmt = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmt)) {
+        const int accessID = iir::getAccessID(varDeclStmt);
+        if(metadata_.getLocalVariableDataFromAccessID(accessID).isHoisted()) {
+          writtenAccessIDs_.erase(accessID);
+          hoisted_.push_back({varDeclStmt->getInitList().front(), accessID,
+                              varDeclStmt->getType().getBuiltinTypeID()});
+        }
+      }
+    }
+  }
+
+  const std::vector<std::shared_ptr<ast::Stmt>>& getDeclarations() const { return declarations_; }
+
+  void visit(const std::shared_ptr<ast::ExprStmt>& stmt) override {
+    stmt->setExpr(processRoot(stmt->getExpr()));
+  }
+
+  void visit(const std::shared_ptr<ast::IfStmt>& stmt) override {
+    // the branches are executed conditionally, nothing is hoisted out of them
+    stmt->getCondStmt()->accept(*this);
+  }
+
+  void visit(const std::shared_ptr<ast::VarDeclStmt>& stmt) override {
+    if(metadata_.getLocalVariableDataFromAccessID(iir::getAccessID(stmt)).isHoisted())
+      return;
+    for(auto& expr : stmt->getInitList())
+      expr = processRoot(expr);
+  }
+};
+
+} // namespace
+
+bool PassLoopInvariantCodeMotion::run(
+    const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+    const Options& options) {
+  auto& metadata = stencilInstantiation->getMetaData();
+  const bool isUnstructured =
+      stencilInstantiation->getIIR()->getGridType() == ast::GridType::Unstructured;
+
+  for(const auto& doMethod : iterateIIROver<iir::DoMethod>(*stencilInstantiation->getIIR())) {
+    InvariantHoister hoister(metadata, stencilInstantiation->getIIR()->getGlobalVariableMap(),
+                             isUnstructured, *doMethod);
+    doMethod->getAST().accept(hoister);
+    const auto& declarations = hoister.getDeclarations();
+    if(declarations.empty())
+      continue;
+
+    // declare the new variables after the ones hoisted by a previous run
+    auto& statements = doMethod->getAST().getStatements();
+    auto position = std::find_if(statements.begin(), statements.end(), [&](const auto& stmt) {
+      const auto varDeclStmt = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmt);
+      return !varDeclStmt ||
+             !metadata.getLocalVariableDataFromAccessID(iir::getAccessID(varDeclStmt)).isHoisted();
+    });
+    doMethod->getAST().insert(position, declarations.begin(), declarations.end());
+
+    computeAccesses(metadata, doMethod->getAST().getStatements());
+    doMethod->update(iir::NodeUpdateType::levelAndTreeAbove);
+
+    for(const auto& stmt : declarations)
+      DAWN_LOG(INFO) << stencilInstantiation->getName() << ": DoMethod: " << doMethod->getID()
+                     << " hoisted loop invariant `"
+                     << std::static_pointer_cast<ast::VarDeclStmt>(stmt)->getName() << "`";
+  }
+
+  return true;
+}
+
+} // namespace dawn
@@ -0,0 +1,49 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "dawn/Optimizer/Pass.h"
+
+namespace dawn {
+
+/// @brief Hoist loop invariant subexpressions out of the horizontal loops
+///
+/// A subexpression of a Do-Method is invariant if it only reads literals, global variables and
+/// (unstructured) vertical fields which are not written in the Do-Method, e.g. `coeff * vgrid[k]`.
+/// Its value only depends on the k-level, but the backends evaluate it for every horizontal point
+/// (and every neighbor, inside a reduction). The maximal invariant subexpressions which read at
+/// least one variable are replaced by constant local variables declared at the top of the
+/// Do-Method and flagged as hoisted (`iir::LocalVariableData::isHoisted`). Equal subexpressions
+/// share the same variable. Subexpressions which are evaluated conditionally (in the branches of
+/// if-statements and the operands of ternary operators) are not hoisted, as they may trap if
+/// evaluated unconditionally (e.g. a division guarded by a check of the divisor).
+///
+/// The CPU backends (CXXNaive, CXXOpt, CXXNaive-ico) evaluate the hoisted declarations once per
+/// k-level before the horizontal loops. The GPU backends map the horizontal loops to the threads
+/// and evaluate them per thread.
+///
+/// @ingroup optimizer
+///
+/// This pass is not necessary to create legal code and is hence not in the debug-group
+class PassLoopInvariantCodeMotion : public Pass {
+public:
+  PassLoopInvariantCodeMotion() : Pass("PassLoopInvariantCodeMotion") {}
+
+  /// @brief Pass implementation
+  bool run(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+           const Options& options = {}) override;
+};
+
+} // namespace dawn
@@ -0,0 +1,223 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/Optimizer/PassReductionFusion.h"
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/AccessComputation.h"
+#include "dawn/IIR/IIRNodeIterator.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Support/Logger.h"
+
+#include <algorithm>
+#include <set>
+
+namespace dawn {
+
+namespace {
+
+/// @brief Access ids of the variables and fields read by `expr` (including the weights of
+/// reductions)
+void getReadAccessIDs(const std::shared_ptr<ast::Expr>& expr, std::set<int>& accessIDs) {
+  if(expr->getKind() == ast::Expr::Kind::VarAccessExpr ||
+     expr->getKind() == ast::Expr::Kind::FieldAccessExpr)
+    accessIDs.insert(iir::getAccessID(expr));
+  for(const auto& child : expr->getChildren())
+    getReadAccessIDs(child, accessIDs);
+  if(auto reduction = std::dynamic_pointer_cast<ast::ReductionOverNeighborExpr>(expr))
+    if(reduction->getWeights())
+      for(const auto& weight : *reduction->getWeights())
+        getReadAccessIDs(weight, accessIDs);
+}
+
+bool containsReduction(const std::shared_ptr<ast::Expr>& expr) {
+  if(expr->getKind() == ast::Expr::Kind::ReductionOverNeighborExpr)
+    return true;
+  for(const auto& child : expr->getChildren())
+    if(containsReduction(child))
+      return true;
+  return false;
+}
+
+/// @brief Whether the evaluation of `expr` writes a variable or a field
+bool hasSideEffects(const std::shared_ptr<ast::Expr>& expr) {
+  if(expr->getKind() == ast::Expr::Kind::AssignmentExpr)
+    return true;
+  if(expr->getKind() == ast::Expr::Kind::UnaryOperator) {
+    const auto& op = std::static_pointer_cast<ast::UnaryOperator>(expr)->getOp();
+    if(op == "++" || op == "--")
+      return true;
+  }
+  for(const auto& child : expr->getChildren())
+    if(hasSideEffects(child))
+      return true;
+  return false;
+}
+
+/// @brief Reduction in the statement `stmtIdx` of a Do-Method
+struct Reduction {
+  std::size_t stmtIdx;
+  std::shared_ptr<ast::ReductionOverNeighborExpr> expr;
+  // expression containing `expr`, nullptr if `expr` initializes a variable declaration
+  std::shared_ptr<ast::Expr> parent;
+};
+
+/// @brief Collect the reductions of `expr`, except for the ones which are only evaluated
+/// conditionally (in the arms of ternary operators and the right operands of `&&` and `||`), as
+/// the grouped reductions are evaluated unconditionally
+void collectReductions(std::size_t stmtIdx, const std::shared_ptr<ast::Expr>& expr,
+                       const std::shared_ptr<ast::Expr>& parent,
+                       std::vector<Reduction>& reductions) {
+  if(auto reduction = std::dynamic_pointer_cast<ast::ReductionOverNeighborExpr>(expr)) {
+    if(!containsReduction(reduction->getRhs()) && !containsReduction(reduction->getInit()))
+      reductions.push_back({stmtIdx, reduction, parent});
+    return;
+  }
+  if(expr->getKind() == ast::Expr::Kind::StencilFunCallExpr)
+    return;
+  if(const auto ternary = std::dynamic_pointer_cast<ast::TernaryOperator>(expr)) {
+    collectReductions(stmtIdx, ternary->getCondition(), expr, reductions);
+    return;
+  }
+  if(const auto binary = std::dynamic_pointer_cast<ast::BinaryOperator>(expr)) {
+    if(binary->getOp() == "&&" || binary->getOp() == "||") {
+      collectReductions(stmtIdx, binary->getLeft(), expr, reductions);
+      return;
+    }
+  }
+  for(const auto& child : expr->getChildren())
+    collectReductions(stmtIdx, child, expr, reductions);
+}
+
+/// @brief Reductions in the right hand sides of the assignments and variable declarations of
+/// `statements`. Other statements (e.g. branches and loops) are not searched.
+std::vector<Reduction> collectReductions(const std::vector<std::shared_ptr<ast::Stmt>>& statements,
+                                         const iir::StencilMetaInformation& metadata) {
+  std::vector<Reduction> reductions;
+  for(std::size_t stmtIdx = 0; stmtIdx < statements.size(); ++stmtIdx) {
+    if(const auto exprStmt = std::dynamic_pointer_cast<ast::ExprStmt>(statements[stmtIdx])) {
+      const auto assignment = std::dynamic_pointer_cast<ast::AssignmentExpr>(exprStmt->getExpr());
+      if(assignment && !hasSideEffects(assignment->getRight()))
+        collectReductions(stmtIdx, assignment->getRight(), assignment, reductions);
+    } else if(const auto varDeclStmt =
+                  std::dynamic_pointer_cast<ast::VarDeclStmt>(statements[stmtIdx])) {
+      if(metadata.getLocalVariableDataFromAccessID(iir::getAccessID(varDeclStmt)).isHoisted())
+        continue;
+      for(const auto& expr : varDeclStmt->getInitList())
+        if(!hasSideEffects(expr))
+          collectReductions(stmtIdx, expr, nullptr, reductions);
+    }
+  }
+  return reductions;
+}
+
+/// @brief Whether `reduction` can be evaluated before the statement `first` instead of the
+/// statement `last`, i.e. none of the statements in between writes what it reads
+bool isMovable(const std::shared_ptr<ast::ReductionOverNeighborExpr>& reduction,
+               const std::vector<std::shared_ptr<ast::Stmt>>& statements, std::size_t first,
+               std::size_t last) {
+  std::set<int> readAccessIDs;
+  getReadAccessIDs(reduction, readAccessIDs);
+  for(std::size_t stmtIdx = first; stmtIdx < last; ++stmtIdx)
+    for(const auto& write :
+        statements[stmtIdx]->getData<iir::IIRStmtData>().CallerAccesses->getWriteAccesses())
+      if(readAccessIDs.count(write.first))
+        return false;
+  return true;
+}
+
+/// @brief Reductions over the same iteration space which are evaluated before the statement
+/// `anchor`
+struct Group {
+  std::size_t anchor;
+  std::vector<Reduction> members;
+};
+
+/// @brief Whether the members of `group` already initialize consecutive declarations starting at
+/// the anchor (e.g. grouped by a previous run)
+bool isGrouped(const Group& group) {
+  for(std::size_t idx = 0; idx < group.members.size(); ++idx)
+    if(group.members[idx].parent || group.members[idx].stmtIdx != group.anchor + idx)
+      return false;
+  return true;
+}
+
+} // namespace
+
+bool PassReductionFusion::run(
+    const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+    const Options& options) {
+  auto& metadata = stencilInstantiation->getMetaData();
+
+  for(const auto& doMethod : iterateIIROver<iir::DoMethod>(*stencilInstantiation->getIIR())) {
+    const auto& statements = doMethod->getAST().getStatements();
+
+    std::vector<Group> groups;
+    for(const auto& reduction : collectReductions(statements, metadata)) {
+      // join the last group over the same iteration space
+      auto group = std::find_if(groups.rbegin(), groups.rend(), [&](const Group& group) {
+        return group.members.front().expr->getIterSpace() == reduction.expr->getIterSpace();
+      });
+      if(group != groups.rend() &&
+         isMovable(reduction.expr, statements, group->anchor, reduction.stmtIdx)) {
+        group->members.push_back(reduction);
+      } else {
+        groups.push_back({reduction.stmtIdx, {reduction}});
+      }
+    }
+    groups.erase(std::remove_if(groups.begin(), groups.end(),
+                                [](const Group& group) {
+                                  return group.members.size() < 2 || isGrouped(group);
+                                }),
+                 groups.end());
+    if(groups.empty())
+      continue;
+
+    // replace the reductions by variables, then insert the declarations from the back such that
+    // the anchors of the preceding groups stay valid
+    std::vector<std::vector<std::shared_ptr<ast::Stmt>>> declarations;
+    for(const auto& group : groups) {
+      declarations.emplace_back();
+      for(const auto& member : group.members) {
+        auto varDeclStmt = metadata.declareVar(
+            false, "red", Type(BuiltinTypeID::Auto, CVQualifier::Const), member.expr);
+        const int accessID = iir::getAccessID(varDeclStmt);
+        auto varAccessExpr = std::make_shared<ast::VarAccessExpr>(varDeclStmt->getName());
+        varAccessExpr->getData<iir::IIRAccessExprData>().AccessID = std::make_optional(accessID);
+        if(member.parent) {
+          member.parent->replaceChildren(member.expr, varAccessExpr);
+        } else {
+          for(auto& init :
+              std::static_pointer_cast<ast::VarDeclStmt>(statements[member.stmtIdx])->getInitList())
+            if(init == member.expr)
+              init = varAccessExpr;
+        }
+        declarations.back().push_back(varDeclStmt);
+      }
+      DAWN_LOG(INFO) << stencilInstantiation->getName() << ": DoMethod: " << doMethod->getID()
+                     << " fused " << group.members.size()
+                     << " reductions over the same neighbors into one loop";
+    }
+    for(std::size_t idx = groups.size(); idx-- > 0;)
+      doMethod->getAST().insert(std::next(statements.begin(), groups[idx].anchor),
+                                declarations[idx].begin(), declarations[idx].end());
+
+    computeAccesses(metadata, doMethod->getAST().getStatements());
+    doMethod->update(iir::NodeUpdateType::levelAndTreeAbove);
+  }
+
+  return true;
+}
+
+} // namespace dawn
@@ -0,0 +1,48 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "dawn/Optimizer/Pass.h"
+
+namespace dawn {
+
+/// @brief Group the reductions of a Do-Method over the same iteration space such that they are
+/// computed in a single loop over the neighbors
+///
+/// The reductions over the same neighbor chain (and include-center flag) in the assignments and
+/// variable declarations of a Do-Method are moved into consecutive constant local variables,
+/// declared before the statement of the first reduction of the group. A reduction joins a group as
+/// long as none of the variables and fields it reads is written in between (according to the
+/// `CallerAccesses` of the statements). Reductions containing other reductions are not moved, nor
+/// are reductions which are only evaluated conditionally (e.g. in the arms of a ternary operator).
+///
+/// The unstructured backends (CXXNaive-ico, CUDA-ico) generate consecutive declarations initialized
+/// by reductions over the same iteration space as one loop over the neighbors with an accumulator
+/// per reduction (@see codegen::CodeGen::groupFusedReductions), which loads the neighbor indices
+/// once.
+///
+/// @ingroup optimizer
+///
+/// This pass is not necessary to create legal code and is hence not in the debug-group
+class PassReductionFusion : public Pass {
+public:
+  PassReductionFusion() : Pass("PassReductionFusion") {}
+
+  /// @brief Pass implementation
+  bool run(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+           const Options& options = {}) override;
+};
+
+} // namespace dawn
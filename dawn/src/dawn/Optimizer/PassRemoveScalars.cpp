@@ -91,7 +91,9 @@ std::optional<int> getScalarLhsOfStatement(const std::shared_ptr<ast::Stmt> stmt
 
   if(scalarAccessID.has_value()) {
     DAWN_ASSERT_MSG(idToLocalVariableData.count(*scalarAccessID), "Uncategorized local variable.");
-    if(idToLocalVariableData.at(*scalarAccessID).isScalar()) {
+    // hoisted loop invariants are kept, they are evaluated once per k-level
+    const auto& data = idToLocalVariableData.at(*scalarAccessID);
+    if(data.isScalar() && !data.isHoisted()) {
       return scalarAccessID;
     }
   }
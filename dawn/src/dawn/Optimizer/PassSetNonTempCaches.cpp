@@ -136,6 +136,8 @@ private:
             "Currently creating a new temporary field is not supported for unstructured grids.");
       ast::FieldDimensions fieldDims{ast::HorizontalFieldDimension(ast::cartesian, {true, true}),
                                      true};
+      // the cache holds copies of the values of the field
+      fieldDims.setPrecision(metadata_.getFieldPrecision(oldID));
       // Register the new temporary in the metadata
       int newID = metadata_.insertAccessOfType(iir::FieldAccessType::StencilTemporary,
                                                "__tmp_cache_" + std::to_string(i));
@@ -0,0 +1,125 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/Optimizer/PassStageFusion.h"
+#include "dawn/IIR/DependencyGraphAccesses.h"
+#include "dawn/IIR/Stage.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassSetStageGraph.h"
+#include "dawn/Support/Logger.h"
+
+#include <iterator>
+
+namespace dawn {
+
+namespace {
+
+/// @brief Check if the fields written by `writer` are accessed pointwise by `writer` and `other`
+bool hasPointwiseDependencies(const iir::Stage& writer, const iir::Stage& other) {
+  for(const auto& [accessID, field] : writer.getFields()) {
+    if(field.getIntend() == iir::Field::IntendKind::Input)
+      continue;
+    auto otherField = other.getFields().find(accessID);
+    if(otherField == other.getFields().end())
+      continue;
+    if(!field.getExtents().isPointwise() || !otherField->second.getExtents().isPointwise())
+      return false;
+  }
+  return true;
+}
+
+/// @brief Get the reason why `second` cannot be fused into `first` or NULL if it can
+const char* getFusionObstacle(const iir::Stage& first, const iir::Stage& second) {
+  if(first.getLocationType() != second.getLocationType())
+    return "different location types";
+  if(first.getIterationSpace() != second.getIterationSpace() ||
+     first.getUnstructuredIterationSpace() != second.getUnstructuredIterationSpace())
+    return "different iteration spaces";
+  if(first.getChildren().size() != 1 || second.getChildren().size() != 1 ||
+     first.getSingleDoMethod().getInterval() != second.getSingleDoMethod().getInterval())
+    return "different vertical intervals";
+  if(!hasPointwiseDependencies(first, second) || !hasPointwiseDependencies(second, first))
+    return "non-pointwise dependency";
+  return nullptr;
+}
+
+} // anonymous namespace
+
+bool PassStageFusion::run(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+                          const Options& options) {
+  if(stencilInstantiation->getIIR()->getGridType() != ast::GridType::Unstructured)
+    return true;
+
+  const auto& metadata = stencilInstantiation->getMetaData();
+  bool fusedAny = false;
+
+  for(const auto& stencil : stencilInstantiation->getStencils()) {
+    for(const auto& multiStage : stencil->getChildren()) {
+      auto curStageIt = multiStage->childrenBegin();
+      while(curStageIt != multiStage->childrenEnd() &&
+            std::next(curStageIt) != multiStage->childrenEnd()) {
+        auto nextStageIt = std::next(curStageIt);
+        iir::Stage& curStage = **curStageIt;
+        iir::Stage& nextStage = **nextStageIt;
+
+        if(const char* obstacle = getFusionObstacle(curStage, nextStage)) {
+          DAWN_LOG(INFO) << stencilInstantiation->getName() << ": not fusing stage "
+                         << nextStage.getStageID() << " into stage " << curStage.getStageID()
+                         << " (" << obstacle << ")";
+          ++curStageIt;
+          continue;
+        }
+
+        // The statements of both stages are executed one after another at every point, hence
+        // the dependency graph is simply built over all of them (bottom to top)
+        std::vector<std::shared_ptr<ast::Stmt>> stmts;
+        for(const iir::Stage* stage : {&curStage, &nextStage}) {
+          const auto& stageStmts = stage->getSingleDoMethod().getAST().getStatements();
+          stmts.insert(stmts.end(), stageStmts.begin(), stageStmts.end());
+        }
+        iir::DependencyGraphAccesses graph(metadata);
+        for(auto stmtIt = stmts.rbegin(); stmtIt != stmts.rend(); ++stmtIt)
+          graph.insertStatement(*stmtIt);
+        if(!graph.isDAG()) {
+          DAWN_LOG(INFO) << stencilInstantiation->getName() << ": not fusing stage "
+                         << nextStage.getStageID() << " into stage " << curStage.getStageID()
+                         << " (cyclic dependencies)";
+          ++curStageIt;
+          continue;
+        }
+
+        DAWN_LOG(INFO) << stencilInstantiation->getName() << ": fusing stage "
+                       << nextStage.getStageID() << " into stage " << curStage.getStageID();
+
+        curStage.appendDoMethod(*nextStage.childrenBegin(), *curStage.childrenBegin(),
+                                std::move(graph));
+        multiStage->childrenErase(nextStageIt);
+        for(auto& doMethod : curStage.getChildren())
+          doMethod->update(iir::NodeUpdateType::level);
+        curStage.update(iir::NodeUpdateType::levelAndTreeAbove);
+        fusedAny = true;
+      }
+    }
+  }
+
+  if(fusedAny) {
+    // The stage graphs of the fused stencils are outdated
+    PassSetStageGraph pass;
+    pass.run(stencilInstantiation);
+  }
+
+  return true;
+}
+
+} // namespace dawn
@@ -0,0 +1,48 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "dawn/Optimizer/Pass.h"
+
+namespace dawn {
+
+/// @brief Fuse consecutive stages of unstructured stencils into a single stage
+///
+/// The cuda-ico backend generates one kernel per stage. Two consecutive stages of a multi-stage
+/// are fused if they have the same location type and iteration space, consist of a single
+/// Do-Method over the same interval and every field written by one of them is accessed pointwise
+/// (horizontally and vertically) by both. The fused stage is then launched as a single kernel and
+/// temporaries produced and consumed within it can be demoted to local variables (registers) by
+/// `PassTemporaryType`.
+///
+/// In contrast to `PassStageMerger` this never creates stages with Do-Methods over different
+/// intervals, which the cuda-ico backend does not support. Fused and rejected stage pairs are
+/// reported in the log.
+///
+/// The stage graphs of the fused stencils are recomputed.
+///
+/// @ingroup optimizer
+///
+/// This pass is not necessary to create legal code and is hence not in the debug-group
+class PassStageFusion : public Pass {
+public:
+  PassStageFusion() : Pass("PassStageFusion") {}
+
+  /// @brief Pass implementation
+  bool run(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+           const Options& options = {}) override;
+};
+
+} // namespace dawn
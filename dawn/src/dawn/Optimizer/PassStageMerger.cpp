@@ -39,6 +39,9 @@ bool PassStageMerger::run(const std::shared_ptr<iir::StencilInstantiation>& sten
   if(options.WriteStencilInstantiation)
     stencilInstantiation->jsonDump(filenameWE + "_before_stage_merger.json");
 
+  const bool unstructured =
+      stencilInstantiation->getIIR()->getGridType() == ast::GridType::Unstructured;
+
   for(const auto& stencil : stencilInstantiation->getStencils()) {
     if(stencil->isEmpty()) {
       continue;
@@ -55,6 +58,10 @@ bool PassStageMerger::run(const std::shared_ptr<iir::StencilInstantiation>& sten
     // Do we need to run the analysis for this stencil?
     bool mergeDoMethodsOfStencil =
         attributes.has(ast::Attr::Kind::MergeDoMethods) || options.MergeDoMethods;
+    // Stages of unstructured stencils are only merged if their Do-Methods have the same interval,
+    // the unstructured backends expect all Do-Methods of a stage to have the same bounds
+    if(unstructured)
+      mergeDoMethodsOfStencil = false;
 
     // Note that the underlying assumption is that stages in the same multi-stage are guaranteed to
     // have no counter loop-oorder vertical dependencies. We can thus treat each multi-stage in
@@ -81,16 +88,15 @@ bool PassStageMerger::run(const std::shared_ptr<iir::StencilInstantiation>& sten
               candidateStageIt != multiStage->childrenREnd(); ++candidateStageIt) {
             iir::Stage& candidateStage = **candidateStageIt;
 
-            // do the iterationspaces match?
-            if(candidateStage.getIterationSpace() != curStage.getIterationSpace())
-              continue;
-
-            // can only merge stages with same location type (for Cartesian they are both
-            // std::nullopt)
+            // can only merge stages with same iteration space and location type (for Cartesian
+            // the location types are both std::nullopt)
             //
             // whether or not we need to break or we can continue and considers stages futher
             // abovedepends if the candidate stage can savely be moved below the current stage
-            if(candidateStage.getLocationType() != curStage.getLocationType()) {
+            if(candidateStage.getIterationSpace() != curStage.getIterationSpace() ||
+               (unstructured && candidateStage.getUnstructuredIterationSpace() !=
+                                    curStage.getUnstructuredIterationSpace()) ||
+               candidateStage.getLocationType() != curStage.getLocationType()) {
               if(stageDAG.depends(curStage.getStageID(), candidateStage.getStageID())) {
                 break;
               } else {
@@ -0,0 +1,196 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/Optimizer/PassStencilFusion.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/IIRNodeIterator.h"
+#include "dawn/IIR/IntervalAlgorithms.h"
+#include "dawn/IIR/MultiInterval.h"
+#include "dawn/IIR/Stage.h"
+#include "dawn/IIR/Stencil.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassSetStageGraph.h"
+#include "dawn/Support/Logger.h"
+
+#include <set>
+#include <sstream>
+
+namespace dawn {
+
+namespace {
+
+/// @brief Get the stencil called by `stmt` or NULL if `stmt` is not a stencil call
+iir::Stencil* getCalledStencil(const std::shared_ptr<iir::StencilInstantiation>& instantiation,
+                               const std::shared_ptr<ast::Stmt>& stmt) {
+  if(!isa<ast::StencilCallDeclStmt>(stmt.get()))
+    return nullptr;
+
+  int stencilID = instantiation->getMetaData().getStencilIDFromStencilCallStmt(
+      std::static_pointer_cast<ast::StencilCallDeclStmt>(stmt));
+  for(const auto& stencil : instantiation->getStencils())
+    if(stencil->getStencilID() == stencilID)
+      return stencil.get();
+  return nullptr;
+}
+
+/// @brief Fields written by `stencil`
+std::set<int> getOutputFields(const iir::Stencil& stencil) {
+  std::set<int> outputFields;
+  for(const auto& [accessID, fieldInfo] : stencil.getFields())
+    if(fieldInfo.field.getIntend() != iir::Field::IntendKind::Input)
+      outputFields.insert(accessID);
+  return outputFields;
+}
+
+/// @brief Check if `second` can be appended to `first`
+bool isFusable(iir::Stencil& first, iir::Stencil& second, int maxFieldsPerStencil) {
+  if(!(first.getStencilAttributes() == second.getStencilAttributes()))
+    return false;
+
+  // Everything the first stencil computes has to be read pointwise in the horizontal, otherwise
+  // the first stencil would need to compute its outputs in the halo as well
+  const auto outputFields = getOutputFields(first);
+  for(const auto& [accessID, fieldInfo] : second.getFields()) {
+    if(!outputFields.count(accessID))
+      continue;
+    const auto& readExtents = fieldInfo.field.getReadExtentsRB();
+    if(readExtents && !readExtents->isHorizontalPointwise())
+      return false;
+  }
+
+  std::set<int> fields;
+  for(const auto& stencil : {&first, &second})
+    for(const auto& fieldPair : stencil->getFields())
+      fields.insert(fieldPair.first);
+  return fields.size() <= maxFieldsPerStencil;
+}
+
+/// @brief Check if every read of `accessID` within `stencil` reads levels which were written
+/// unconditionally before
+///
+/// Only writes by top-level expression statements of a Do-Method count. Levels written by an
+/// earlier multi-stage are available to all reads, levels written earlier in the same multi-stage
+/// only to reads without vertical offset.
+bool isWrittenBeforeRead(const iir::Stencil& stencil, int accessID) {
+  iir::MultiInterval writtenBeforeMultiStage;
+  for(const auto& multiStage : stencil.getChildren()) {
+    iir::MultiInterval written = writtenBeforeMultiStage;
+    for(const auto& doMethod : iterateIIROver<iir::DoMethod>(*multiStage)) {
+      const iir::Interval& interval = doMethod->getInterval();
+      for(const auto& stmt : doMethod->getAST().getStatements()) {
+        const auto& accesses = *stmt->getData<iir::IIRStmtData>().CallerAccesses;
+        if(accesses.hasReadAccess(accessID)) {
+          const auto& verticalExtent = accesses.getReadAccess(accessID).verticalExtent();
+          if(!iir::substract(interval.extendInterval(verticalExtent),
+                             verticalExtent.isPointwise() ? written : writtenBeforeMultiStage)
+                  .empty())
+            return false;
+        }
+        if(accesses.hasWriteAccess(accessID) && isa<ast::ExprStmt>(stmt.get()))
+          written.insert(interval);
+      }
+    }
+    writtenBeforeMultiStage = written;
+  }
+  return true;
+}
+
+std::set<std::string> parseFieldList(const std::string& fieldList) {
+  std::set<std::string> fields;
+  std::istringstream ss(fieldList);
+  std::string field;
+  while(std::getline(ss, field, ','))
+    if(!field.empty())
+      fields.insert(field);
+  return fields;
+}
+
+} // anonymous namespace
+
+bool PassStencilFusion::run(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+                            const Options& options) {
+  auto& metadata = stencilInstantiation->getMetaData();
+  auto& controlFlow = stencilInstantiation->getIIR()->getControlFlowDescriptor();
+  const auto deadFields = parseFieldList(options.DeadFields);
+
+  bool fusedAny = false;
+  std::size_t stmtIdx = 0;
+  while(stmtIdx + 1 < controlFlow.getStatements().size()) {
+    const auto& stmts = controlFlow.getStatements();
+    iir::Stencil* first = getCalledStencil(stencilInstantiation, stmts[stmtIdx]);
+    iir::Stencil* second = getCalledStencil(stencilInstantiation, stmts[stmtIdx + 1]);
+    if(!first || !second || !isFusable(*first, *second, options.MaxFieldsPerStencil)) {
+      ++stmtIdx;
+      continue;
+    }
+
+    const int secondID = second->getStencilID();
+    DAWN_LOG(INFO) << stencilInstantiation->getName() << ": fusing stencil " << secondID
+                   << " into stencil " << first->getStencilID();
+
+    // Intermediate fields: computed by the first stencil and consumed by the second one
+    std::set<int> intermediateFields;
+    const auto outputFields = getOutputFields(*first);
+    for(const auto& fieldPair : second->getFields())
+      if(outputFields.count(fieldPair.first))
+        intermediateFields.insert(fieldPair.first);
+
+    // Append the multi-stages of the second stencil (the multi-stages keep their loop order and
+    // are separated by a synchronization, hence the order of execution is preserved) ...
+    for(auto& multiStage : second->getChildren())
+      first->insertChild(std::move(multiStage));
+
+    // ... and remove the second stencil together with its call
+    stencilInstantiation->getIIR()->childrenEraseIf(
+        [&](const std::unique_ptr<iir::Stencil>& stencil) {
+          return stencil->getStencilID() == secondID;
+        });
+    controlFlow.removeStencilCalls({secondID}, metadata);
+    first->updateFromChildren();
+
+    // Demote intermediate fields the user declared as dead to temporaries
+    for(int accessID : intermediateFields) {
+      const std::string& name = metadata.getFieldNameFromAccessID(accessID);
+      if(!deadFields.count(name) ||
+         !metadata.isAccessType(iir::FieldAccessType::APIField, accessID) ||
+         metadata.hasFieldBC(name) || !isWrittenBeforeRead(*first, accessID))
+        continue;
+
+      bool accessedElsewhere = false;
+      for(const auto& stencil : stencilInstantiation->getStencils())
+        if(stencil.get() != first && stencil->hasFieldAccessID(accessID))
+          accessedElsewhere = true;
+      if(accessedElsewhere)
+        continue;
+
+      metadata.moveRegisteredFieldTo(iir::FieldAccessType::StencilTemporary, accessID);
+      DAWN_LOG(INFO) << stencilInstantiation->getName() << ": demoting dead field " << name
+                     << " to a temporary";
+    }
+
+    fusedAny = true;
+  }
+
+  if(fusedAny) {
+    stencilInstantiation->computeDerivedInfo();
+
+    // The stage graphs of the fused stencils are outdated
+    PassSetStageGraph pass;
+    pass.run(stencilInstantiation);
+  }
+
+  return true;
+}
+
+} // namespace dawn
@@ -0,0 +1,48 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "dawn/Optimizer/Pass.h"
+
+namespace dawn {
+
+/// @brief Fuse consecutive stencil calls of the control flow into a single stencil
+///
+/// Two stencils called one after another (without any statement in between) are fused if they
+/// have the same attributes, the second stencil reads everything the first one writes at zero
+/// horizontal offset (no redundant computations are needed in the halo) and the fused stencil
+/// does not exceed `MaxFieldsPerStencil`. The multi-stages of the second stencil are appended to
+/// the first stencil, such that `PassMultiStageMerger` can merge them across the former stencil
+/// boundary.
+///
+/// Intermediate API fields (written by the first and read by the second stencil) which are listed
+/// in `DeadFields` and are not accessed anywhere else are demoted to stencil temporaries, provided
+/// the fused stencil writes every level it reads unconditionally before reading it.
+///
+/// The stage graphs of fused stencils are recomputed.
+///
+/// @ingroup optimizer
+///
+/// This pass is not necessary to create legal code and is hence not in the debug-group
+class PassStencilFusion : public Pass {
+public:
+  PassStencilFusion() : Pass("PassStencilFusion") {}
+
+  /// @brief Pass implementation
+  bool run(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+           const Options& options = {}) override;
+};
+
+} // namespace dawn
@@ -0,0 +1,118 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/Optimizer/PassTemporaryDimensionReduction.h"
+#include "dawn/AST/ASTVisitor.h"
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Support/Logger.h"
+
+#include <set>
+
+namespace dawn {
+
+namespace {
+
+/// @brief Collects the fields passed as arguments to stencil functions
+class StencilFunArgumentCollector : public ast::ASTVisitorForwardingNonConst {
+  int argListNesting_ = 0;
+  std::set<int> accessIDs_;
+
+public:
+  void visit(const std::shared_ptr<ast::StencilFunCallExpr>& expr) override {
+    ++argListNesting_;
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+    --argListNesting_;
+  }
+
+  void visit(const std::shared_ptr<ast::FieldAccessExpr>& expr) override {
+    if(argListNesting_ > 0)
+      accessIDs_.insert(iir::getAccessID(expr));
+  }
+
+  const std::set<int>& getAccessIDs() const { return accessIDs_; }
+};
+
+/// @brief Number of levels of `field` which have to be stored in a multi-stage with the loop order
+/// `loopOrder`, std::nullopt if the full column is needed
+std::optional<int> computeNumLevels(const iir::Field& field, iir::LoopOrderKind loopOrder) {
+  // written at the current level only
+  const auto& writeExtents = field.getWriteExtents();
+  if(!writeExtents || writeExtents->verticalExtent().isUndefined() ||
+     !writeExtents->isVerticalPointwise())
+    return std::nullopt;
+
+  const auto& readExtents = field.getReadExtents();
+  if(!readExtents)
+    return 1;
+  const iir::Extent& vExtent = readExtents->verticalExtent();
+  if(vExtent.isUndefined())
+    return std::nullopt;
+
+  // read at levels which are already computed in the loop order
+  switch(loopOrder) {
+  case iir::LoopOrderKind::Forward:
+    if(vExtent.plus() > 0)
+      return std::nullopt;
+    return 1 - vExtent.minus();
+  case iir::LoopOrderKind::Backward:
+    if(vExtent.minus() < 0)
+      return std::nullopt;
+    return 1 + vExtent.plus();
+  case iir::LoopOrderKind::Parallel:
+    if(!readExtents->isVerticalPointwise())
+      return std::nullopt;
+    return 1;
+  }
+  return std::nullopt;
+}
+
+} // namespace
+
+bool PassTemporaryDimensionReduction::run(
+    const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+    const Options& options) {
+  // the unstructured backends do not support reduced temporaries
+  if(stencilInstantiation->getIIR()->getGridType() == ast::GridType::Unstructured)
+    return true;
+
+  auto& metadata = stencilInstantiation->getMetaData();
+
+  for(const auto& stencil : stencilInstantiation->getStencils()) {
+    StencilFunArgumentCollector stencilFunArguments;
+    stencil->accept(stencilFunArguments);
+
+    for(const auto& multiStage : stencil->getChildren()) {
+      for(const auto& [accessID, field] : multiStage->getFields()) {
+        if(!metadata.isAccessType(iir::FieldAccessType::StencilTemporary, accessID) ||
+           stencilFunArguments.getAccessIDs().count(accessID) ||
+           stencilInstantiation->isIDAccessedMultipleMSs(accessID))
+          continue;
+
+        const auto numLevels = computeNumLevels(field, multiStage->getLoopOrder());
+        if(!numLevels)
+          continue;
+
+        metadata.setTemporaryNumLevels(accessID, *numLevels);
+        DAWN_LOG(INFO) << stencilInstantiation->getName() << ": reduce "
+                       << metadata.getFieldNameFromAccessID(accessID) << " to " << *numLevels
+                       << (*numLevels == 1 ? " ij-plane" : " ij-planes");
+      }
+    }
+  }
+
+  return true;
+}
+
+} // namespace dawn
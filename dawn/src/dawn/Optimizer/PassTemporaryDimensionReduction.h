@@ -0,0 +1,47 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "dawn/Optimizer/Pass.h"
+
+namespace dawn {
+
+/// @brief Reduce the vertical dimension of the storages of temporaries to the levels which are
+/// alive at the same time
+///
+/// A temporary which is accessed in a single multi-stage, written at the current level only and
+/// read at the current level or at levels already computed in the loop order of the multi-stage
+/// (e.g. `k-1` in a forward loop) only needs to store a rolling window of ij-planes: a single plane
+/// if it is read at the current level only, `n + 1` planes if it is read up to `n` levels back. The
+/// number of levels is recorded in the `StencilMetaInformation` (@see
+/// iir::StencilMetaInformation::getTemporaryNumLevels) and used by the cartesian CPU backends
+/// (CXXNaive, CXXOpt) to allocate the reduced storage. Temporaries passed to stencil functions are
+/// not reduced.
+///
+/// The pass has to run after all passes modifying multi-stages or their loop order.
+///
+/// @ingroup optimizer
+///
+/// This pass is not necessary to create legal code and is hence not in the debug-group
+class PassTemporaryDimensionReduction : public Pass {
+public:
+  PassTemporaryDimensionReduction() : Pass("PassTemporaryDimensionReduction") {}
+
+  /// @brief Pass implementation
+  bool run(const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+           const Options& options = {}) override;
+};
+
+} // namespace dawn
@@ -99,8 +99,9 @@ bool PassTemporaryMerger::run(
     if(TemporaryDAG.empty())
       continue;
 
-    // Add dependencies due to overlapping lifetime of the temporaries. The dependencies will assure
-    // that these temporaries can not be merged into one i.e have different colors.
+    // Add dependencies due to overlapping lifetime (or different precisions) of the temporaries.
+    // The dependencies will assure that these temporaries can not be merged into one i.e have
+    // different colors.
     std::unordered_set<int> temporaries;
     std::for_each(TemporaryDAG.getVertices().begin(), TemporaryDAG.getVertices().end(),
                   [&](const std::pair<int, Vertex>& vertexPair) {
@@ -119,7 +120,8 @@ bool PassTemporaryMerger::run(
         if(FromAccessID == ToAccessID)
           continue;
 
-        if(FromLifetime.overlaps(ToLifetime)) {
+        if(FromLifetime.overlaps(ToLifetime) ||
+           metadata.getFieldPrecision(FromAccessID) != metadata.getFieldPrecision(ToAccessID)) {
           TemporaryDAG.insertEdge(FromAccessID, ToAccessID, iir::Extents{});
         }
       }
@@ -22,6 +22,7 @@
 #include "dawn/IIR/Stencil.h"
 #include "dawn/IIR/StencilInstantiation.h"
 #include "dawn/Optimizer/StatementMapper.h"
+#include "dawn/Optimizer/TemporaryCostModel.h"
 #include "dawn/Optimizer/TemporaryHandling.h"
 #include "dawn/SIR/AST.h"
 #include "dawn/SIR/SIR.h"
@@ -513,7 +514,8 @@ public:
 
 SkipIDs PassTemporaryToStencilFunction::computeSkipAccessIDs(
     const std::unique_ptr<iir::Stencil>& stencilPtr,
-    const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation) const {
+    const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+    const Options& options, bool report) const {
 
   const auto& metadata = stencilInstantiation->getMetaData();
   SkipIDs skipIDs;
@@ -557,6 +559,17 @@ SkipIDs PassTemporaryToStencilFunction::computeSkipAccessIDs(
         skipIDs.appendAccessIDsToMS(multiStage->getID(), field.getAccessID());
         continue;
       }
+      // weigh recomputing the temporary at each use against keeping it in memory
+      TemporaryCost cost = computeTemporaryCost(metadata, *multiStage, field.getAccessID(), options);
+      if(report) {
+        DAWN_LOG(INFO) << stencilInstantiation->getName() << ": tmp "
+                       << metadata.getFieldNameFromAccessID(field.getAccessID()) << " "
+                       << cost.toString();
+      }
+      if(!cost.recompute()) {
+        skipIDs.appendAccessIDsToMS(multiStage->getID(), field.getAccessID());
+        continue;
+      }
     }
   }
 
@@ -572,7 +585,7 @@ bool PassTemporaryToStencilFunction::run(
   for(const auto& stencilPtr : stencilInstantiation->getStencils()) {
     const auto& fields = stencilPtr->getFields();
 
-    SkipIDs skipIDs = computeSkipAccessIDs(stencilPtr, stencilInstantiation);
+    SkipIDs skipIDs = computeSkipAccessIDs(stencilPtr, stencilInstantiation, options, false);
 
     std::unordered_set<int> localVarAccessIDs;
     LocalVariablePromotion localVariablePromotion(metadata, *stencilPtr, fields, skipIDs,
@@ -605,7 +618,7 @@ bool PassTemporaryToStencilFunction::run(
                                            iir::TemporaryScope::StencilTemporary);
     }
 
-    skipIDs = computeSkipAccessIDs(stencilPtr, stencilInstantiation);
+    skipIDs = computeSkipAccessIDs(stencilPtr, stencilInstantiation, options, true);
 
     // Iterate multi-stages for the replacement of temporaries by stencil functions
     for(const auto& multiStage : stencilPtr->getChildren()) {
@@ -57,9 +57,13 @@ public:
            const Options& options = {}) override;
 
 private:
+  /// @brief Compute the fields which are not replaced by stencil functions. Temporaries whose
+  /// recomputation is estimated to be more expensive than keeping them in memory are skipped as
+  /// well, the decisions are logged if `report` is set.
   SkipIDs computeSkipAccessIDs(
       const std::unique_ptr<iir::Stencil>& stencilPtr,
-      const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation) const;
+      const std::shared_ptr<iir::StencilInstantiation>& stencilInstantiation,
+      const Options& options, bool report) const;
 };
 
 } // namespace dawn
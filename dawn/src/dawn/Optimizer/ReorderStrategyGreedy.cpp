@@ -20,6 +20,8 @@
 #include "dawn/IIR/StencilInstantiation.h"
 #include "dawn/Support/Iterator.h"
 
+#include <algorithm>
+
 namespace dawn {
 
 std::unique_ptr<iir::Stencil>
@@ -49,6 +51,26 @@ ReorderStrategyGreedy::reorder(iir::StencilInstantiation* stencilInstantiation,
           break;
       }
 
+      // On unstructured meshes only stages with the same location type can be merged. Move the
+      // stage right behind the first such stage it can be moved to or, if there is none, at least
+      // do not separate two stages of the same location type.
+      if(const auto locationType = stage->getLocationType()) {
+        auto locationTypeOf = [&](int idx) {
+          return newStencil->getStage(totalNewStages + idx)->getLocationType();
+        };
+        int sameLocationIdx = std::max(stageIdx, 0);
+        while(sameLocationIdx < newNumStages && locationTypeOf(sameLocationIdx) != locationType)
+          ++sameLocationIdx;
+
+        if(sameLocationIdx < newNumStages) {
+          stageIdx = sameLocationIdx;
+        } else {
+          while(stageIdx >= 0 && stageIdx < newNumStages - 1 &&
+                locationTypeOf(stageIdx) == locationTypeOf(stageIdx + 1))
+            ++stageIdx;
+        }
+      }
+
       iir::Stencil::StagePosition stagePos(msIdx, stageIdx);
       newStencil->insertStage(stagePos, std::move(stage));
       newNumStages += 1;
@@ -60,4 +82,3 @@ ReorderStrategyGreedy::reorder(iir::StencilInstantiation* stencilInstantiation,
 }
 
 } // namespace dawn
-
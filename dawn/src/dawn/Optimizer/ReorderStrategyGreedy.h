@@ -23,6 +23,9 @@ class StencilInstantiation;
 }
 /// @brief Reordering strategy which tries to move each stage upwards as far as possible under the
 /// sole constraint that the extent of any field does not exeed the maximum halo points
+///
+/// Stages of unstructured stencils are grouped by location type instead, i.e. they are moved right
+/// behind the first stage with the same location type they can legally be moved to.
 /// @ingroup optimizer
 class ReorderStrategyGreedy : public ReorderStrategy {
 public:
@@ -33,4 +36,3 @@ public:
 };
 
 } // namespace dawn
-
@@ -129,6 +129,26 @@ public:
 
 void replaceStencilCalls(const std::shared_ptr<iir::StencilInstantiation>& instantiation,
                          int oldStencilID, const std::vector<int>& newStencilIDs) {
+  replaceStencilCalls(instantiation, oldStencilID, [&]() -> std::shared_ptr<ast::Stmt> {
+    // Create the new stencils
+    std::vector<std::shared_ptr<ast::StencilCallDeclStmt>> newStencilCalls;
+    for(int StencilID : newStencilIDs) {
+      auto placeholderStencil = std::make_shared<ast::StencilCall>(
+          iir::InstantiationHelper::makeStencilCallCodeGenName(StencilID));
+      newStencilCalls.push_back(iir::makeStencilCallDeclStmt(placeholderStencil));
+      instantiation->getMetaData().addStencilCallStmt(newStencilCalls.back(), StencilID);
+    }
+
+    // Bundle all the statements in a block statements
+    auto newBlockStmt = iir::makeBlockStmt();
+    newBlockStmt->insert_back(newStencilCalls);
+    return newBlockStmt;
+  });
+}
+
+void replaceStencilCalls(const std::shared_ptr<iir::StencilInstantiation>& instantiation,
+                         int oldStencilID,
+                         const std::function<std::shared_ptr<ast::Stmt>()>& makeReplacement) {
   GetStencilCalls visitor(instantiation, oldStencilID);
 
   for(auto& stmt : instantiation->getIIR()->getControlFlowDescriptor().getStatements()) {
@@ -136,32 +156,16 @@ void replaceStencilCalls(const std::shared_ptr<iir::StencilInstantiation>& insta
 
     stmt->accept(visitor);
     for(auto& oldStencilCall : visitor.getStencilCallsToReplace()) {
-
-      // Create the new stencils
-      std::vector<std::shared_ptr<ast::StencilCallDeclStmt>> newStencilCalls;
-      for(int StencilID : newStencilIDs) {
-        auto placeholderStencil = std::make_shared<ast::StencilCall>(
-            iir::InstantiationHelper::makeStencilCallCodeGenName(StencilID));
-        newStencilCalls.push_back(iir::makeStencilCallDeclStmt(placeholderStencil));
-      }
-
-      // Bundle all the statements in a block statements
-      auto newBlockStmt = iir::makeBlockStmt();
-      newBlockStmt->insert_back(newStencilCalls);
+      instantiation->getMetaData().eraseStencilCallStmt(oldStencilCall);
+      auto newStmt = makeReplacement();
 
       if(oldStencilCall == stmt) {
         // Replace the the statement directly
         DAWN_ASSERT(visitor.getStencilCallsToReplace().size() == 1);
-        stmt = newBlockStmt;
+        stmt = newStmt;
       } else {
         // Recursively replace the statement
-        ast::replaceOldStmtWithNewStmtInStmt(stmt, oldStencilCall, newBlockStmt);
-      }
-
-      auto& metadata = instantiation->getMetaData();
-      metadata.eraseStencilCallStmt(oldStencilCall);
-      for(std::size_t i = 0; i < newStencilIDs.size(); ++i) {
-        metadata.addStencilCallStmt(newStencilCalls[i], newStencilIDs[i]);
+        ast::replaceOldStmtWithNewStmtInStmt(stmt, oldStencilCall, newStmt);
       }
     }
   }
@@ -16,6 +16,7 @@
 
 #include "dawn/AST/ASTVisitor.h"
 #include "dawn/Support/ArrayRef.h"
+#include <functional>
 #include <memory>
 
 namespace dawn {
@@ -51,6 +52,15 @@ void replaceVarWithFieldAccessInStmts(iir::Stencil* stencil, int AccessID,
 void replaceStencilCalls(const std::shared_ptr<iir::StencilInstantiation>& instantiation,
                          int oldStencilID, const std::vector<int>& newStencilIDs);
 
+/// @brief Replace all stencil calls to `oldStencilID` in the stencil description AST of
+/// `instantiation` with the statement returned by `makeReplacement` (called once per stencil call)
+///
+/// The stencil calls in the replacement have to be registered in the meta information by the
+/// caller.
+void replaceStencilCalls(const std::shared_ptr<iir::StencilInstantiation>& instantiation,
+                         int oldStencilID,
+                         const std::function<std::shared_ptr<ast::Stmt>()>& makeReplacement);
+
 /// @}
 
 } // namespace dawn
@@ -0,0 +1,153 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/Optimizer/TemporaryCostModel.h"
+#include "dawn/AST/ASTVisitor.h"
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/IIRNodeIterator.h"
+#include "dawn/IIR/StencilFunctionInstantiation.h"
+#include "dawn/IIR/StencilMetaInformation.h"
+#include "dawn/Support/Format.h"
+
+#include <algorithm>
+#include <stack>
+
+namespace dawn {
+
+namespace {
+
+/// Calls to math functions (sqrt, exp, pow, ...) are about an order of magnitude more expensive
+/// than arithmetic operations
+static constexpr int FLOPS_PER_MATH_FUNCTION = 10;
+
+/// Tile used to estimate the redundant computations in the halo of a materialized temporary if no
+/// block size is given (same as the default block size of PassSetBlockSize)
+static constexpr int DEFAULT_TILE_I = 32;
+static constexpr int DEFAULT_TILE_J = 4;
+
+class FlopCounter : public ast::ASTVisitorForwardingNonConst {
+  const iir::StencilMetaInformation& metadata_;
+  std::stack<std::shared_ptr<iir::StencilFunctionInstantiation>> stencilFunCalls_;
+  int flops_ = 0;
+
+public:
+  FlopCounter(const iir::StencilMetaInformation& metadata) : metadata_(metadata) {}
+
+  int getFlops() const { return flops_; }
+
+  void visit(const std::shared_ptr<ast::UnaryOperator>& expr) override {
+    ++flops_;
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+  void visit(const std::shared_ptr<ast::BinaryOperator>& expr) override {
+    ++flops_;
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+  void visit(const std::shared_ptr<ast::AssignmentExpr>& expr) override {
+    // compound assignments, e.g. `a += b`
+    if(expr->getOp() != "=")
+      ++flops_;
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+  void visit(const std::shared_ptr<ast::TernaryOperator>& expr) override {
+    ++flops_;
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+  void visit(const std::shared_ptr<ast::FunCallExpr>& expr) override {
+    flops_ += FLOPS_PER_MATH_FUNCTION;
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+  }
+  void visit(const std::shared_ptr<ast::StencilFunCallExpr>& expr) override {
+    auto stencilFun = stencilFunCalls_.empty()
+                          ? metadata_.getStencilFunctionInstantiation(expr)
+                          : stencilFunCalls_.top()->getStencilFunctionInstantiation(expr);
+    ast::ASTVisitorForwardingNonConst::visit(expr);
+
+    stencilFunCalls_.push(stencilFun);
+    stencilFun->getAST()->accept(*this);
+    stencilFunCalls_.pop();
+  }
+};
+
+/// Collects the definitions and uses of a temporary
+class TemporaryAccessCounter : public ast::ASTVisitorForwardingNonConst {
+  const iir::StencilMetaInformation& metadata_;
+  const int accessID_;
+  int flops_ = 0;
+  int numUses_ = 0;
+
+public:
+  TemporaryAccessCounter(const iir::StencilMetaInformation& metadata, int accessID)
+      : metadata_(metadata), accessID_(accessID) {}
+
+  int getFlops() const { return flops_; }
+  int getNumUses() const { return numUses_; }
+
+  void visit(const std::shared_ptr<ast::AssignmentExpr>& expr) override {
+    if(expr->getLeft()->getKind() == ast::Expr::Kind::FieldAccessExpr &&
+       iir::getAccessID(expr->getLeft()) == accessID_) {
+      FlopCounter flopCounter(metadata_);
+      expr->getRight()->accept(flopCounter);
+      flops_ = std::max(flops_, flopCounter.getFlops());
+      if(expr->getOp() != "=")
+        ++numUses_;
+      expr->getRight()->accept(*this);
+    } else {
+      ast::ASTVisitorForwardingNonConst::visit(expr);
+    }
+  }
+  void visit(const std::shared_ptr<ast::FieldAccessExpr>& expr) override {
+    if(iir::getAccessID(expr) == accessID_)
+      ++numUses_;
+  }
+};
+
+} // anonymous namespace
+
+std::string TemporaryCost::toString() const {
+  return format("%s (flops: %i, uses: %i, halo factor: %.2f, machine balance: %i => "
+                "recompute: %.1f, materialize: %.1f flops per point)",
+                recompute() ? "computed on the fly" : "kept materialized", flops, numUses,
+                haloFactor, machineBalance, recomputeCost(), materializeCost());
+}
+
+TemporaryCost computeTemporaryCost(const iir::StencilMetaInformation& metadata,
+                                   const iir::MultiStage& multiStage, int accessID,
+                                   const Options& options) {
+  TemporaryAccessCounter counter(metadata, accessID);
+  for(const auto& stmt : iterateIIROverStmt(multiStage)) {
+    stmt->accept(counter);
+  }
+
+  TemporaryCost cost;
+  cost.flops = counter.getFlops();
+  cost.numUses = counter.getNumUses();
+  cost.machineBalance = options.MachineBalance;
+
+  const auto& fields = multiStage.getFields();
+  if(fields.count(accessID)) {
+    const int tileI = options.BlockSizeI > 0 ? options.BlockSizeI : DEFAULT_TILE_I;
+    const int tileJ = options.BlockSizeJ > 0 ? options.BlockSizeJ : DEFAULT_TILE_J;
+    cost.haloFactor = iir::extent_dispatch(
+        fields.at(accessID).getExtents().horizontalExtent(),
+        [&](iir::CartesianExtent const& hExtent) {
+          return double(tileI + hExtent.iPlus() - hExtent.iMinus()) *
+                 (tileJ + hExtent.jPlus() - hExtent.jMinus()) / (tileI * tileJ);
+        },
+        [](iir::UnstructuredExtent const&) { return 1.0; }, []() { return 1.0; });
+  }
+  return cost;
+}
+
+} // namespace dawn
@@ -0,0 +1,57 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "dawn/IIR/MultiStage.h"
+#include "dawn/Optimizer/Options.h"
+
+#include <string>
+
+namespace dawn {
+
+/// @brief Estimated cost of a stencil temporary within a multi-stage, in flops per point of the
+/// compute domain
+///
+/// A materialized temporary is computed once per point, on the compute domain grown by its read
+/// extents, and costs a store and a load per point. A temporary computed on the fly costs no memory
+/// traffic, but its definition is evaluated at each of its uses.
+///
+/// @ingroup optimizer
+struct TemporaryCost {
+  int flops = 0;           ///< Flops to compute one point of the temporary
+  int numUses = 0;         ///< Number of read accesses to the temporary
+  double haloFactor = 1.0; ///< Computed points per point of the compute domain if materialized
+  int machineBalance = 0;  ///< Flops per value loaded from or stored to memory
+
+  double materializeCost() const { return flops * haloFactor + 2.0 * machineBalance; }
+  double recomputeCost() const { return static_cast<double>(flops) * numUses; }
+
+  /// @brief Whether the temporary should be computed on the fly
+  bool recompute() const { return recomputeCost() <= materializeCost(); }
+
+  /// @brief Human readable explanation of the decision
+  std::string toString() const;
+};
+
+/// @brief Estimate the cost of the temporary `accessID` within `multiStage`
+///
+/// The flops of the temporary are the ones of its most expensive definition within the
+/// multi-stage. Calls to math functions are weighted as several flops and calls to stencil
+/// functions are weighted by the flops of their body.
+TemporaryCost computeTemporaryCost(const iir::StencilMetaInformation& metadata,
+                                   const iir::MultiStage& multiStage, int accessID,
+                                   const Options& options);
+
+} // namespace dawn
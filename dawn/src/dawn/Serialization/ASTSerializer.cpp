@@ -275,6 +275,17 @@ void setOffset(dawn::proto::ast::Offset* offsetProto, const sir::Offset* offset)
 void setFieldDimensions(dawn::proto::ast::FieldDimensions* protoFieldDimensions,
                         const ast::FieldDimensions& fieldDimensions) {
   protoFieldDimensions->set_mask_k(fieldDimensions.K());
+  switch(fieldDimensions.getPrecision()) {
+  case ast::FieldPrecision::Default:
+    protoFieldDimensions->set_precision(proto::ast::FieldDimensions_Precision_DefaultPrecision);
+    break;
+  case ast::FieldPrecision::Single:
+    protoFieldDimensions->set_precision(proto::ast::FieldDimensions_Precision_SinglePrecision);
+    break;
+  case ast::FieldPrecision::Double:
+    protoFieldDimensions->set_precision(proto::ast::FieldDimensions_Precision_DoublePrecision);
+    break;
+  }
   if(!fieldDimensions.isVertical()) {
     if(dawn::ast::dimension_isa<ast::CartesianFieldDimension const&>(
            fieldDimensions.getHorizontalFieldDimension())) {
@@ -754,9 +765,9 @@ void setAST(proto::ast::AST* astProto, const AST* ast) {
 // Deserialization
 //===------------------------------------------------------------------------------------------===//
 
+namespace {
 ast::FieldDimensions
-makeFieldDimensions(const proto::ast::FieldDimensions& protoFieldDimensions) {
-
+makeHorizontalFieldDimensions(const proto::ast::FieldDimensions& protoFieldDimensions) {
   if(protoFieldDimensions.has_cartesian_horizontal_dimension()) {
     const auto& protoCartesianDimension = protoFieldDimensions.cartesian_horizontal_dimension();
     return ast::FieldDimensions(
@@ -785,6 +796,23 @@ makeFieldDimensions(const proto::ast::FieldDimensions& protoFieldDimensions) {
     return ast::FieldDimensions(protoFieldDimensions.mask_k());
   }
 }
+} // namespace
+
+ast::FieldDimensions
+makeFieldDimensions(const proto::ast::FieldDimensions& protoFieldDimensions) {
+  ast::FieldDimensions fieldDimensions = makeHorizontalFieldDimensions(protoFieldDimensions);
+  switch(protoFieldDimensions.precision()) {
+  case proto::ast::FieldDimensions_Precision_SinglePrecision:
+    fieldDimensions.setPrecision(ast::FieldPrecision::Single);
+    break;
+  case proto::ast::FieldDimensions_Precision_DoublePrecision:
+    fieldDimensions.setPrecision(ast::FieldPrecision::Double);
+    break;
+  default:
+    break;
+  }
+  return fieldDimensions;
+}
 
 BuiltinTypeID makeBuiltinTypeID(const proto::ast::BuiltinType& builtinTypeProto) {
   switch(builtinTypeProto.type_id()) {
@@ -15,5 +15,6 @@
 #include "dawn/Support/IndexGenerator.h"
 namespace dawn {
 std::unique_ptr<IndexGenerator> IndexGenerator::instance;
+thread_local IndexGenerator* IndexGenerator::scoped = nullptr;
 
 } // namespace dawn
@@ -20,20 +20,25 @@
 
 namespace dawn {
 
+/// The indices are drawn from a process-wide generator, unless the compiling thread installed a
+/// generator owned by the translation unit with `IndexGenerator::Scope` (see UIDGenerator)
 class IndexGenerator {
 private:
   IndexGenerator(const IndexGenerator&) = delete;
   IndexGenerator& operator=(const IndexGenerator&) = delete;
 
   static std::unique_ptr<IndexGenerator> instance;
+  static thread_local IndexGenerator* scoped;
 
   long unsigned int idx_ = 0;
 
-private:
+public:
   IndexGenerator() = default;
 
-public:
   static IndexGenerator& Instance() {
+    if(scoped)
+      return *scoped;
+
     if(!instance)
       instance.reset(new IndexGenerator);
 
@@ -44,6 +49,18 @@ public:
     DAWN_ASSERT(idx_ < std::numeric_limits<long unsigned int>::max());
     return idx_++;
   }
+
+  /// @brief Makes `generator` the instance of the calling thread for the lifetime of the scope
+  class Scope {
+    IndexGenerator* previous_;
+
+  public:
+    explicit Scope(IndexGenerator& generator) : previous_(scoped) { scoped = &generator; }
+    ~Scope() { scoped = previous_; }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
 };
 
 } // namespace dawn
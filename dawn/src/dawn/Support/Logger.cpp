@@ -81,6 +81,7 @@ DiagnosticProxy Logger::operator()(const std::string& file, int line, const std:
 }
 
 void Logger::doEnqueue(const std::string& message) {
+  std::lock_guard<std::mutex> lock(mutex_);
   data_.push_back(message);
   if(show_) {
     *os_ << data_.back();
@@ -107,7 +108,10 @@ void Logger::messageFormatter(const MessageFormatter& msgFmt) { msgFmt_ = msgFmt
 Logger::DiagnosticFormatter Logger::diagnosticFormatter() const { return diagFmt_; }
 void Logger::diagnosticFormatter(const DiagnosticFormatter& diagFmt) { diagFmt_ = diagFmt; }
 
-void Logger::clear() { data_.clear(); }
+void Logger::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  data_.clear();
+}
 
 void Logger::show() { show_ = true; }
 void Logger::hide() { show_ = false; }
@@ -18,6 +18,7 @@
 #include <functional>
 #include <iostream>
 #include <list>
+#include <mutex>
 #include <sstream>
 #include <stack>
 #include <string>
@@ -142,6 +143,8 @@ private:
   std::ostream* os_;
   Container data_;
   bool show_;
+  // messages may be reported concurrently, e.g. by gtclang compiling several files in parallel
+  std::mutex mutex_;
 };
 
 /// @brief create a basic (default) message formatter
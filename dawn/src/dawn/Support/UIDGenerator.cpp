@@ -18,8 +18,12 @@ namespace dawn {
 
 /* Null, because instance will be initialized on demand. */
 UIDGenerator* UIDGenerator::instance_ = 0;
+thread_local UIDGenerator* UIDGenerator::scoped_ = nullptr;
 
 UIDGenerator* UIDGenerator::getInstance() {
+  if(scoped_)
+    return scoped_;
+
   if(instance_ == 0) {
     instance_ = new UIDGenerator();
   }
@@ -27,4 +31,8 @@ UIDGenerator* UIDGenerator::getInstance() {
   return instance_;
 }
 
+UIDGenerator::Scope::Scope(UIDGenerator& generator) : previous_(scoped_) { scoped_ = &generator; }
+
+UIDGenerator::Scope::~Scope() { scoped_ = previous_; }
+
 } // namespace dawn
@@ -19,14 +19,19 @@
 namespace dawn {
 
 /// @brief Unique identifier generator (starting from @b 1)
+///
+/// The identifiers are drawn from a process-wide generator, unless the compiling thread installed
+/// a generator owned by the translation unit with `UIDGenerator::Scope`. Stencils compiled
+/// concurrently are thus numbered as if they were compiled on their own.
 /// @ingroup support
 class UIDGenerator : NonCopyable {
   int counter_;
   static UIDGenerator* instance_;
+  static thread_local UIDGenerator* scoped_;
 
+public:
   UIDGenerator() : counter_(1) {}
 
-public:
   static UIDGenerator* getInstance();
 
   /// @brief Get a unique *strictly* positive identifer
@@ -36,6 +41,15 @@ public:
 
   /// @brief We need a way to modify the generator after deserialization
   void set(int id) { counter_ = id; }
+
+  /// @brief Makes `generator` the instance of the calling thread for the lifetime of the scope
+  class Scope : NonCopyable {
+    UIDGenerator* previous_;
+
+  public:
+    explicit Scope(UIDGenerator& generator);
+    ~Scope();
+  };
 };
 
 } // namespace dawn
@@ -60,19 +60,28 @@ Array3i asArray(FieldType ft) {
 
 std::shared_ptr<iir::StencilInstantiation>
 IIRBuilder::build(std::string const& name, std::unique_ptr<iir::Stencil> stencilIIR) {
+  std::vector<std::unique_ptr<iir::Stencil>> stencils;
+  stencils.push_back(std::move(stencilIIR));
+  return build(name, std::move(stencils));
+}
+
+std::shared_ptr<iir::StencilInstantiation>
+IIRBuilder::build(std::string const& name, std::vector<std::unique_ptr<iir::Stencil>> stencils) {
   DAWN_ASSERT(si_);
   // setup the whole stencil instantiation
-  auto stencil_id = stencilIIR->getStencilID();
   si_->getMetaData().setStencilName(name);
-  si_->getIIR()->insertChild(std::move(stencilIIR), si_->getIIR());
+  for(auto& stencilIIR : stencils) {
+    auto stencil_id = stencilIIR->getStencilID();
+    si_->getIIR()->insertChild(std::move(stencilIIR), si_->getIIR());
 
-  auto placeholderStencil = std::make_shared<ast::StencilCall>(
-      iir::InstantiationHelper::makeStencilCallCodeGenName(stencil_id));
-  auto stencilCallDeclStmt = iir::makeStencilCallDeclStmt(placeholderStencil);
-  // Register the call and set it as a replacement for the next vertical region
-  si_->getMetaData().addStencilCallStmt(stencilCallDeclStmt, stencil_id);
+    auto placeholderStencil = std::make_shared<ast::StencilCall>(
+        iir::InstantiationHelper::makeStencilCallCodeGenName(stencil_id));
+    auto stencilCallDeclStmt = iir::makeStencilCallDeclStmt(placeholderStencil);
+    // Register the call and set it as a replacement for the next vertical region
+    si_->getMetaData().addStencilCallStmt(stencilCallDeclStmt, stencil_id);
 
-  si_->getIIR()->getControlFlowDescriptor().insertStmt(stencilCallDeclStmt);
+    si_->getIIR()->getControlFlowDescriptor().insertStmt(stencilCallDeclStmt);
+  }
 
   // update everything
   for(const auto& MS : iterateIIROver<iir::MultiStage>(*(si_->getIIR()))) {
@@ -242,24 +251,28 @@ std::shared_ptr<ast::Stmt> IIRBuilder::declareVar(IIRBuilder::LocalVar& var) {
   return var.decl;
 }
 
-IIRBuilder::Field CartesianIIRBuilder::field(const std::string& name, FieldType ft) {
+IIRBuilder::Field CartesianIIRBuilder::field(const std::string& name, FieldType ft,
+                                             ast::FieldPrecision precision) {
   DAWN_ASSERT(si_);
   auto fieldMaskArray = asArray(ft);
   ast::FieldDimensions dimensions(
       ast::HorizontalFieldDimension{ast::cartesian,
                                     {fieldMaskArray[0] == 1, fieldMaskArray[1] == 1}},
       fieldMaskArray[2] == 1);
+  dimensions.setPrecision(precision);
   int id = si_->getMetaData().addField(iir::FieldAccessType::APIField, name, std::move(dimensions));
   return {id, name};
 }
 
-IIRBuilder::Field CartesianIIRBuilder::tmpField(const std::string& name, FieldType ft) {
+IIRBuilder::Field CartesianIIRBuilder::tmpField(const std::string& name, FieldType ft,
+                                                ast::FieldPrecision precision) {
   DAWN_ASSERT(si_);
   auto fieldMaskArray = asArray(ft);
   ast::FieldDimensions dimensions(
       ast::HorizontalFieldDimension{ast::cartesian,
                                     {fieldMaskArray[0] == 1, fieldMaskArray[1] == 1}},
       fieldMaskArray[2] == 1);
+  dimensions.setPrecision(precision);
   int id = si_->getMetaData().addTmpField(iir::FieldAccessType::StencilTemporary, name,
                                           std::move(dimensions));
   std::string newName = si_->getMetaData().getFieldNameFromAccessID(id);
@@ -336,6 +336,10 @@ public:
   std::shared_ptr<iir::StencilInstantiation> build(std::string const& name,
                                                    std::unique_ptr<iir::Stencil> stencil);
 
+  // generates the final instantiation context, the stencils are called in the given order
+  std::shared_ptr<iir::StencilInstantiation>
+  build(std::string const& name, std::vector<std::unique_ptr<iir::Stencil>> stencils);
+
 protected:
   std::shared_ptr<iir::StencilInstantiation> si_;
 };
@@ -370,8 +374,10 @@ public:
   std::shared_ptr<ast::Expr> at(Field const& field, Array3i const& offset);
   std::shared_ptr<ast::Expr> at(Field const& field, AccessType access = AccessType::r);
 
-  Field field(std::string const& name, FieldType ft = FieldType::ijk);
-  Field tmpField(std::string const& name, FieldType ft = FieldType::ijk);
+  Field field(std::string const& name, FieldType ft = FieldType::ijk,
+              ast::FieldPrecision precision = ast::FieldPrecision::Default);
+  Field tmpField(std::string const& name, FieldType ft = FieldType::ijk,
+                 ast::FieldPrecision precision = ast::FieldPrecision::Default);
 };
 } // namespace iir
 } // namespace dawn
@@ -69,8 +69,24 @@ dawn::PassGroup parsePassGroup(const std::string& passGroup) {
     return dawn::PassGroup::DataLocalityMetric;
   else if(passGroup == "MultiStageMerger" || passGroup == "multistage-merger")
     return dawn::PassGroup::MultiStageMerger;
+  else if(passGroup == "ConstantFolding" || passGroup == "constant-folding")
+    return dawn::PassGroup::ConstantFolding;
+  else if(passGroup == "StencilFusion" || passGroup == "stencil-fusion")
+    return dawn::PassGroup::StencilFusion;
+  else if(passGroup == "StageFusion" || passGroup == "stage-fusion")
+    return dawn::PassGroup::StageFusion;
+  else if(passGroup == "CommonSubexpressionElimination" ||
+          passGroup == "common-subexpression-elimination")
+    return dawn::PassGroup::CommonSubexpressionElimination;
+  else if(passGroup == "ReductionFusion" || passGroup == "reduction-fusion")
+    return dawn::PassGroup::ReductionFusion;
+  else if(passGroup == "LoopInvariantCodeMotion" || passGroup == "loop-invariant-code-motion")
+    return dawn::PassGroup::LoopInvariantCodeMotion;
   else if(passGroup == "SetLoopOrder" || passGroup == "set-loop-order")
     return dawn::PassGroup::SetLoopOrder;
+  else if(passGroup == "TemporaryDimensionReduction" ||
+          passGroup == "temporary-dimension-reduction")
+    return dawn::PassGroup::TemporaryDimensionReduction;
   else
     throw std::runtime_error(std::string("Unknown pass group: ") + passGroup);
 }
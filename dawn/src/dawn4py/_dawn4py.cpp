@@ -47,6 +47,12 @@ PYBIND11_MODULE(_dawn4py, m) {
       .value("StageReordering", dawn::PassGroup::StageReordering)
       .value("StageMerger", dawn::PassGroup::StageMerger)
       .value("MultiStageMerger", dawn::PassGroup::MultiStageMerger)
+      .value("ConstantFolding", dawn::PassGroup::ConstantFolding)
+      .value("StencilFusion", dawn::PassGroup::StencilFusion)
+      .value("StageFusion", dawn::PassGroup::StageFusion)
+      .value("CommonSubexpressionElimination", dawn::PassGroup::CommonSubexpressionElimination)
+      .value("ReductionFusion", dawn::PassGroup::ReductionFusion)
+      .value("LoopInvariantCodeMotion", dawn::PassGroup::LoopInvariantCodeMotion)
       .value("TemporaryMerger", dawn::PassGroup::TemporaryMerger)
       .value("Inlining", dawn::PassGroup::Inlining)
       .value("IntervalPartitioning", dawn::PassGroup::IntervalPartitioning)
@@ -56,6 +62,7 @@ PYBIND11_MODULE(_dawn4py, m) {
       .value("SetBlockSize", dawn::PassGroup::SetBlockSize)
       .value("DataLocalityMetric", dawn::PassGroup::DataLocalityMetric)
       .value("SetLoopOrder", dawn::PassGroup::SetLoopOrder)
+      .value("TemporaryDimensionReduction", dawn::PassGroup::TemporaryDimensionReduction)
       .export_values();
 
   py::enum_<dawn::codegen::Backend>(m, "CodeGenBackend")
@@ -79,8 +86,9 @@ PYBIND11_MODULE(_dawn4py, m) {
       .def(
           py::init([](int MaxHaloPoints, const std::string& ReorderStrategy,
                       int MaxFieldsPerStencil, bool MaxCutMSS, int BlockSizeI, int BlockSizeJ,
-                      int BlockSizeK, int SMemMaxFields, int TexCacheMaxFields, bool SplitStencils,
-                      bool MergeStages, bool MergeDoMethods, bool DisableKCaches, bool KeepVarnames,
+                      int BlockSizeK, int SMemMaxFields, int TexCacheMaxFields, int MachineBalance,
+                      bool SplitStencils, const std::string& DeadFields, bool MergeStages,
+                      bool MergeDoMethods, int SpecializeGlobals, bool DisableKCaches, bool KeepVarnames,
                       bool ReportAccesses, bool SerializeIIR, const std::string& IIRFormat,
                       bool DumpSplitGraphs, bool DumpStageGraph, bool DumpTemporaryGraphs,
                       bool DumpRaceConditionGraph, bool DumpStencilInstantiation,
@@ -94,9 +102,12 @@ PYBIND11_MODULE(_dawn4py, m) {
                                  BlockSizeK,
                                  SMemMaxFields,
                                  TexCacheMaxFields,
+                                 MachineBalance,
                                  SplitStencils,
+                                 DeadFields,
                                  MergeStages,
                                  MergeDoMethods,
+                                 SpecializeGlobals,
                                  DisableKCaches,
                                  KeepVarnames,
                                  ReportAccesses,
@@ -114,10 +125,13 @@ PYBIND11_MODULE(_dawn4py, m) {
           py::arg("max_fields_per_stencil") = 40, py::arg("max_cut_mss") = false,
           py::arg("block_size_i") = 0, py::arg("block_size_j") = 0, py::arg("block_size_k") = 0,
           py::arg("s_mem_max_fields") = 8, py::arg("tex_cache_max_fields") = 3,
-          py::arg("split_stencils") = false, py::arg("merge_stages") = false,
-          py::arg("merge_do_methods") = true, py::arg("disable_k_caches") = false,
-          py::arg("keep_varnames") = false, py::arg("report_accesses") = false,
-          py::arg("serialize_iir") = false, py::arg("iir_format") = "json",
+          py::arg("machine_balance") = 10, py::arg("split_stencils") = false,
+          py::arg("dead_fields") = "",
+          py::arg("merge_stages") = false, py::arg("merge_do_methods") = true,
+          py::arg("specialize_globals") = 0,
+          py::arg("disable_k_caches") = false, py::arg("keep_varnames") = false,
+          py::arg("report_accesses") = false, py::arg("serialize_iir") = false,
+          py::arg("iir_format") = "json",
           py::arg("dump_split_graphs") = false, py::arg("dump_stage_graph") = false,
           py::arg("dump_temporary_graphs") = false, py::arg("dump_race_condition_graph") = false,
           py::arg("dump_stencil_instantiation") = false,
@@ -131,9 +145,12 @@ PYBIND11_MODULE(_dawn4py, m) {
       .def_readwrite("block_size_k", &dawn::Options::BlockSizeK)
       .def_readwrite("s_mem_max_fields", &dawn::Options::SMemMaxFields)
       .def_readwrite("tex_cache_max_fields", &dawn::Options::TexCacheMaxFields)
+      .def_readwrite("machine_balance", &dawn::Options::MachineBalance)
       .def_readwrite("split_stencils", &dawn::Options::SplitStencils)
+      .def_readwrite("dead_fields", &dawn::Options::DeadFields)
       .def_readwrite("merge_stages", &dawn::Options::MergeStages)
       .def_readwrite("merge_do_methods", &dawn::Options::MergeDoMethods)
+      .def_readwrite("specialize_globals", &dawn::Options::SpecializeGlobals)
       .def_readwrite("disable_k_caches", &dawn::Options::DisableKCaches)
       .def_readwrite("keep_varnames", &dawn::Options::KeepVarnames)
       .def_readwrite("report_accesses", &dawn::Options::ReportAccesses)
@@ -159,9 +176,14 @@ PYBIND11_MODULE(_dawn4py, m) {
            << "block_size_k=" << self.BlockSizeK << ",\n    "
            << "s_mem_max_fields=" << self.SMemMaxFields << ",\n    "
            << "tex_cache_max_fields=" << self.TexCacheMaxFields << ",\n    "
+           << "machine_balance=" << self.MachineBalance << ",\n    "
            << "split_stencils=" << self.SplitStencils << ",\n    "
+           << "dead_fields="
+           << "\"" << self.DeadFields << "\""
+           << ",\n    "
            << "merge_stages=" << self.MergeStages << ",\n    "
            << "merge_do_methods=" << self.MergeDoMethods << ",\n    "
+           << "specialize_globals=" << self.SpecializeGlobals << ",\n    "
            << "disable_k_caches=" << self.DisableKCaches << ",\n    "
            << "keep_varnames=" << self.KeepVarnames << ",\n    "
            << "report_accesses=" << self.ReportAccesses << ",\n    "
@@ -184,18 +206,28 @@ PYBIND11_MODULE(_dawn4py, m) {
           py::init([](int MaxHaloSize, bool UseParallelEP, bool RunWithSync, int MaxBlocksPerSM,
                       int nsms, int DomainSizeI, int DomainSizeJ, int DomainSizeK, int paddingCells,
                       int paddingEdges, int paddingVertices, const std::string& OutputCHeader,
-                      const std::string& OutputFortranInterface) {
+                      const std::string& OutputFortranInterface, bool PersistentBuffers,
+                      bool NeighborMajorTables, int LevelsPerThread, int paddingMultiple,
+                      bool UnrollInteriorReductions, int SimdWidth, bool TemporaryArena,
+                      bool FuseBoundaryConditions) {
             return dawn::codegen::Options{
-                MaxHaloSize,     UseParallelEP, RunWithSync,           MaxBlocksPerSM, nsms,
-                DomainSizeI,     DomainSizeJ,   DomainSizeK,           paddingCells,   paddingEdges,
-                paddingVertices, OutputCHeader, OutputFortranInterface};
+                MaxHaloSize,   UseParallelEP, RunWithSync,     MaxBlocksPerSM,
+                nsms,          DomainSizeI,   DomainSizeJ,     DomainSizeK,
+                paddingCells,  paddingEdges,  paddingVertices, OutputCHeader,
+                OutputFortranInterface,       PersistentBuffers, NeighborMajorTables,
+                LevelsPerThread,               paddingMultiple, UnrollInteriorReductions,
+                SimdWidth,                     TemporaryArena,  FuseBoundaryConditions};
           }),
           py::arg("max_halo_size") = 3, py::arg("use_parallel_ep") = false,
           py::arg("run_with_sync") = true, py::arg("max_blocks_per_sm") = 0, py::arg("nsms") = 0,
           py::arg("domain_size_i") = 0, py::arg("domain_size_j") = 0, py::arg("domain_size_k") = 0,
           py::arg("padding_cells") = 0, py::arg("padding_edges") = 0,
           py::arg("padding_vertices") = 0, py::arg("output_c_header") = "",
-          py::arg("output_fortran_interface") = "")
+          py::arg("output_fortran_interface") = "", py::arg("persistent_buffers") = false,
+          py::arg("neighbor_major_tables") = false, py::arg("levels_per_thread") = 1,
+          py::arg("padding_multiple") = 1, py::arg("unroll_interior_reductions") = false,
+          py::arg("simd_width") = 0, py::arg("temporary_arena") = false,
+          py::arg("fuse_boundary_conditions") = false)
       .def_readwrite("max_halo_size", &dawn::codegen::Options::MaxHaloSize)
       .def_readwrite("use_parallel_ep", &dawn::codegen::Options::UseParallelEP)
       .def_readwrite("run_with_sync", &dawn::codegen::Options::RunWithSync)
@@ -209,6 +241,15 @@ PYBIND11_MODULE(_dawn4py, m) {
       .def_readwrite("padding_vertices", &dawn::codegen::Options::paddingVertices)
       .def_readwrite("output_c_header", &dawn::codegen::Options::OutputCHeader)
       .def_readwrite("output_fortran_interface", &dawn::codegen::Options::OutputFortranInterface)
+      .def_readwrite("persistent_buffers", &dawn::codegen::Options::PersistentBuffers)
+      .def_readwrite("neighbor_major_tables", &dawn::codegen::Options::NeighborMajorTables)
+      .def_readwrite("levels_per_thread", &dawn::codegen::Options::LevelsPerThread)
+      .def_readwrite("padding_multiple", &dawn::codegen::Options::paddingMultiple)
+      .def_readwrite("unroll_interior_reductions",
+                     &dawn::codegen::Options::UnrollInteriorReductions)
+      .def_readwrite("simd_width", &dawn::codegen::Options::SimdWidth)
+      .def_readwrite("temporary_arena", &dawn::codegen::Options::TemporaryArena)
+      .def_readwrite("fuse_boundary_conditions", &dawn::codegen::Options::FuseBoundaryConditions)
       .def("__repr__", [](const dawn::codegen::Options& self) {
         std::ostringstream ss;
         ss << "max_halo_size=" << self.MaxHaloSize << ",\n    "
@@ -226,7 +267,16 @@ PYBIND11_MODULE(_dawn4py, m) {
            << "\"" << self.OutputCHeader << "\""
            << ",\n    "
            << "output_fortran_interface="
-           << "\"" << self.OutputFortranInterface << "\"";
+           << "\"" << self.OutputFortranInterface << "\""
+           << ",\n    "
+           << "persistent_buffers=" << self.PersistentBuffers << ",\n    "
+           << "neighbor_major_tables=" << self.NeighborMajorTables << ",\n    "
+           << "levels_per_thread=" << self.LevelsPerThread << ",\n    "
+           << "padding_multiple=" << self.paddingMultiple << ",\n    "
+           << "unroll_interior_reductions=" << self.UnrollInteriorReductions << ",\n    "
+           << "simd_width=" << self.SimdWidth << ",\n    "
+           << "temporary_arena=" << self.TemporaryArena << ",\n    "
+           << "fuse_boundary_conditions=" << self.FuseBoundaryConditions;
         return "CodeGenOptions(\n    " + ss.str() + "\n)";
       });
 
@@ -125,6 +125,14 @@ class TestMakeField(unittest.TestCase):
         self.assertEqual(field.field_dimensions.cartesian_horizontal_dimension.mask_cart_j, 0)
         self.assertEqual(field.field_dimensions.mask_k, 1)
 
+    def test_make_field_cartesian_precision(self):
+        field = make_field(
+            "foo", make_field_dimensions_cartesian(precision=FieldDimensions.SinglePrecision)
+        )
+        self.assertEqual(field.field_dimensions.precision, FieldDimensions.SinglePrecision)
+        field = make_field("foo", make_field_dimensions_cartesian())
+        self.assertEqual(field.field_dimensions.precision, FieldDimensions.DefaultPrecision)
+
     def test_make_field_unstructured(self):
         field = make_field("foo", make_field_dimensions_unstructured([LocationType.Value('Edge')], 1))
         self.assertEqual(field.name, "foo")
@@ -179,10 +179,15 @@ def make_type(builtin_type_or_name, is_const: bool = False, is_volatile: bool =
     return t
 
 
-def make_field_dimensions_cartesian(mask: List[int] = None) -> FieldDimensions:
+def make_field_dimensions_cartesian(
+    mask: List[int] = None, precision: int = FieldDimensions.DefaultPrecision
+) -> FieldDimensions:
     """ Create FieldDimensions of cartesian type
 
-    :param mask: mask to identify which cartesian dimensions are legal (default is [1, 1, 1])
+    :param mask:      mask to identify which cartesian dimensions are legal (default is [1, 1, 1])
+    :param precision: precision in which the values of the field are stored, e.g.
+                      FieldDimensions.SinglePrecision (default is the precision of the generated
+                      code)
     """
 
     if mask is None:
@@ -196,6 +201,7 @@ def make_field_dimensions_cartesian(mask: List[int] = None) -> FieldDimensions:
     dims = FieldDimensions()
     dims.cartesian_horizontal_dimension.CopyFrom(horizontal_dim)
     dims.mask_k = mask[2]
+    dims.precision = precision
     return dims
 
 
@@ -19,6 +19,9 @@
 #include <cuda.h>
 #include <cuda_runtime.h>
 
+#include "field_transfer.hpp"
+#include "nbh_table.hpp"
+#include "padded_field.hpp"
 #include "unstructured_domain.hpp"
 #include "unstructured_interface.hpp"
 
@@ -26,8 +29,6 @@
 #include <map>
 #include <vector>
 
-#define DEVICE_MISSING_VALUE -1
-
 #define gpuErrchk(ans)                                                                             \
   { gpuAssert((ans), __FILE__, __LINE__); }
 inline void gpuAssert(cudaError_t code, const char* file, int line, bool abort = true) {
@@ -74,52 +75,6 @@ template <typename T>
 ::dawn::float_type verticalFieldType(NoLibTag);
 // ENDTODO
 
-inline void reshape(const dawn::float_type* input, dawn::float_type* output, int kSize,
-                    int numElements, int sparseSize) {
-  // In: edges, klevels, sparse
-  // Out: klevels, sparse, edges
-
-  for(int elIdx = 0; elIdx < numElements; elIdx++)
-    for(int kLevel = 0; kLevel < kSize; kLevel++)
-      for(int sparseIdx = 0; sparseIdx < sparseSize; sparseIdx++) {
-        output[kLevel * numElements * sparseSize + sparseIdx * numElements + elIdx] =
-            input[elIdx * kSize * sparseSize + kLevel * sparseSize + sparseIdx];
-      }
-}
-
-inline void reshape(const dawn::float_type* input, dawn::float_type* output, int kSize,
-                    int numElements) {
-  // In: edges, klevels
-  // Out: klevels, edges
-
-  for(int elIdx = 0; elIdx < numElements; elIdx++)
-    for(int kLevel = 0; kLevel < kSize; kLevel++) {
-      output[kLevel * numElements + elIdx] = input[elIdx * kSize + kLevel];
-    }
-}
-
-inline void reshape_back(const dawn::float_type* input, dawn::float_type* output, int kSize,
-                         int numElements) {
-  // In: klevels, edges
-  // Out: edges, klevels
-
-  for(int elIdx = 0; elIdx < numElements; elIdx++)
-    for(int kLevel = 0; kLevel < kSize; kLevel++) {
-      output[elIdx * kSize + kLevel] = input[kLevel * numElements + elIdx];
-    }
-}
-inline void reshape_back(const dawn::float_type* input, dawn::float_type* output, int kSize,
-                         int numElements, int sparseSize) {
-  // In: klevels, sparse, edges
-  // Out: edges, klevels, sparse
-  for(int elIdx = 0; elIdx < numElements; elIdx++)
-    for(int kLevel = 0; kLevel < kSize; kLevel++)
-      for(int sparseIdx = 0; sparseIdx < sparseSize; sparseIdx++) {
-        output[elIdx * kSize * sparseSize + kLevel * sparseSize + sparseIdx] =
-            input[kLevel * numElements * sparseSize + sparseIdx * numElements + elIdx];
-      }
-}
-
 inline void allocField(dawn::float_type** cudaStorage, int kSize) {
   gpuErrchk(cudaMalloc((void**)cudaStorage, sizeof(dawn::float_type) * kSize));
 }
@@ -132,6 +87,36 @@ inline void allocField(dawn::float_type** cudaStorage, int denseSize, int sparse
       cudaMalloc((void**)cudaStorage, sizeof(dawn::float_type) * denseSize * sparseSize * kSize));
 }
 
+// Device side of `persistent_field_buffer`: device memory, page-locked staging memory and
+// asynchronous copies on a CUDA stream
+struct cuda_device_allocator {
+  using stream_type = cudaStream_t;
+
+  static void* allocate_device(std::size_t bytes) {
+    void* ptr;
+    gpuErrchk(cudaMalloc(&ptr, bytes));
+    return ptr;
+  }
+  static void deallocate_device(void* ptr) { gpuErrchk(cudaFree(ptr)); }
+  static void* allocate_host_pinned(std::size_t bytes) {
+    void* ptr;
+    gpuErrchk(cudaMallocHost(&ptr, bytes));
+    return ptr;
+  }
+  static void deallocate_host_pinned(void* ptr) { gpuErrchk(cudaFreeHost(ptr)); }
+  static void copy_to_device_async(void* dst, const void* src, std::size_t bytes,
+                                   stream_type stream) {
+    gpuErrchk(cudaMemcpyAsync(dst, src, bytes, cudaMemcpyHostToDevice, stream));
+  }
+  static void copy_to_host_async(void* dst, const void* src, std::size_t bytes,
+                                 stream_type stream) {
+    gpuErrchk(cudaMemcpyAsync(dst, src, bytes, cudaMemcpyDeviceToHost, stream));
+  }
+  static void synchronize(stream_type stream) { gpuErrchk(cudaStreamSynchronize(stream)); }
+};
+
+using cuda_field_buffer = persistent_field_buffer<cuda_device_allocator>;
+
 template <class FieldT>
 void initField(const FieldT& field, dawn::float_type** cudaStorage, int kSize) {
   gpuErrchk(cudaMalloc((void**)cudaStorage, sizeof(dawn::float_type) * field.numElements()));
@@ -205,48 +190,31 @@ inline void initSparseField(::dawn::float_type*& field, dawn::float_type** cudaS
   }
 }
 
+// Generate the neighbor table of `chain` on the host and copy it to `target` on the device. If a
+// `cache` is given, the table is read from it if present and stored to it otherwise.
+//
+// Stencils generated with neighbor-major tables (`-neighbor-major-tables`) expect the
+// `nbh_table_layout::neighbor_major` layout.
 template <typename LibTag>
 void generateNbhTable(dawn::mesh_t<LibTag> const& mesh, std::vector<dawn::LocationType> chain,
                       int numElements, int numNbhPerElement, int* target,
-                      bool includeCenter = false) {
-  std::vector<dawn::nbh_table_index_t<LibTag>> elems;
-  switch(chain.front()) {
-  case dawn::LocationType::Cells: {
-    for(auto cell : getCells(LibTag{}, mesh)) {
-      elems.push_back(cell);
-    }
-    break;
-  }
-  case dawn::LocationType::Edges: {
-    for(auto edge : getEdges(LibTag{}, mesh)) {
-      elems.push_back(edge);
-    }
-    break;
-  }
-  case dawn::LocationType::Vertices: {
-    for(auto vertex : getVertices(LibTag{}, mesh)) {
-      elems.push_back(vertex);
+                      bool includeCenter = false, const nbh_table_cache* cache = nullptr,
+                      nbh_table_layout layout = nbh_table_layout::element_major) {
+  const std::size_t bytes = sizeof(int) * numElements * numNbhPerElement;
+  const dawn::UnstructuredIterationSpace space{chain, includeCenter};
+  if(cache) {
+    if(auto cachedTable = cache->load(space, numElements, numNbhPerElement, layout)) {
+      gpuErrchk(cudaMemcpy(target, cachedTable.data(), bytes, cudaMemcpyHostToDevice));
+      return;
     }
-    break;
-  }
   }
 
-  assert(elems.size() == numElements);
-
-  std::vector<int> hostTable;
-  for(int elem : elems) {
-    auto neighbors = getNeighbors(LibTag{}, mesh, chain, elem, includeCenter);
-    for(int nbhIdx = 0; nbhIdx < numNbhPerElement; nbhIdx++) {
-      if(nbhIdx < neighbors.size()) {
-        hostTable.push_back(neighbors[nbhIdx]);
-      } else {
-        hostTable.push_back(DEVICE_MISSING_VALUE);
-      }
-    }
+  std::vector<int> hostTable(numElements * numNbhPerElement);
+  fillNbhTable<LibTag>(mesh, chain, numElements, numNbhPerElement, hostTable.data(), includeCenter,
+                       layout);
+  if(cache) {
+    cache->store(space, hostTable.data(), numElements, numNbhPerElement, layout);
   }
-
-  assert(hostTable.size() == numElements * numNbhPerElement);
-  gpuErrchk(cudaMemcpy(target, hostTable.data(), sizeof(int) * numElements * numNbhPerElement,
-                       cudaMemcpyHostToDevice));
+  gpuErrchk(cudaMemcpy(target, hostTable.data(), bytes, cudaMemcpyHostToDevice));
 }
 } // namespace dawn
\ No newline at end of file
@@ -0,0 +1,204 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "defs.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace dawn {
+
+inline void reshape(const dawn::float_type* input, dawn::float_type* output, int kSize,
+                    int numElements, int sparseSize) {
+  // In: edges, klevels, sparse
+  // Out: klevels, sparse, edges
+
+  for(int elIdx = 0; elIdx < numElements; elIdx++)
+    for(int kLevel = 0; kLevel < kSize; kLevel++)
+      for(int sparseIdx = 0; sparseIdx < sparseSize; sparseIdx++) {
+        output[kLevel * numElements * sparseSize + sparseIdx * numElements + elIdx] =
+            input[elIdx * kSize * sparseSize + kLevel * sparseSize + sparseIdx];
+      }
+}
+
+inline void reshape(const dawn::float_type* input, dawn::float_type* output, int kSize,
+                    int numElements) {
+  // In: edges, klevels
+  // Out: klevels, edges
+
+  for(int elIdx = 0; elIdx < numElements; elIdx++)
+    for(int kLevel = 0; kLevel < kSize; kLevel++) {
+      output[kLevel * numElements + elIdx] = input[elIdx * kSize + kLevel];
+    }
+}
+
+inline void reshape_back(const dawn::float_type* input, dawn::float_type* output, int kSize,
+                         int numElements) {
+  // In: klevels, edges
+  // Out: edges, klevels
+
+  for(int elIdx = 0; elIdx < numElements; elIdx++)
+    for(int kLevel = 0; kLevel < kSize; kLevel++) {
+      output[elIdx * kSize + kLevel] = input[kLevel * numElements + elIdx];
+    }
+}
+inline void reshape_back(const dawn::float_type* input, dawn::float_type* output, int kSize,
+                         int numElements, int sparseSize) {
+  // In: klevels, sparse, edges
+  // Out: edges, klevels, sparse
+  for(int elIdx = 0; elIdx < numElements; elIdx++)
+    for(int kLevel = 0; kLevel < kSize; kLevel++)
+      for(int sparseIdx = 0; sparseIdx < sparseSize; sparseIdx++) {
+        output[elIdx * kSize * sparseSize + kLevel * sparseSize + sparseIdx] =
+            input[kLevel * numElements * sparseSize + sparseIdx * numElements + elIdx];
+      }
+}
+
+/**
+ * @class persistent_field_buffer
+ * A device buffer together with a (pinned) host staging buffer of the same size. Both are
+ * allocated once and reused for every transfer, so repeated timesteps neither allocate device
+ * memory nor copy from pageable host memory.
+ *
+ * The device side is abstracted by `Allocator`, which needs to provide the following static
+ * members:
+ *
+ *   using stream_type = ...;
+ *   void* allocate_device(std::size_t bytes);
+ *   void deallocate_device(void* ptr);
+ *   void* allocate_host_pinned(std::size_t bytes);
+ *   void deallocate_host_pinned(void* ptr);
+ *   void copy_to_device_async(void* dst, const void* src, std::size_t bytes, stream_type stream);
+ *   void copy_to_host_async(void* dst, const void* src, std::size_t bytes, stream_type stream);
+ *   void synchronize(stream_type stream);
+ *
+ * The CUDA allocator lives in `cuda_utils.hpp`, any host-only allocator can be used for testing.
+ */
+template <class Allocator>
+class persistent_field_buffer {
+public:
+  using stream_type = typename Allocator::stream_type;
+
+  persistent_field_buffer() = default;
+  persistent_field_buffer(const persistent_field_buffer&) = delete;
+  persistent_field_buffer& operator=(const persistent_field_buffer&) = delete;
+
+  /**
+   * Allocate the device and the staging buffer. A dense field has `sparseSize == 1`, a
+   * horizontal field `kSize == 1` and a vertical field `denseSize == 1`.
+   */
+  void allocate(int denseSize, int sparseSize, int kSize) {
+    free();
+    denseSize_ = denseSize;
+    sparseSize_ = sparseSize;
+    kSize_ = kSize;
+    device_ = static_cast<dawn::float_type*>(Allocator::allocate_device(bytes()));
+    staging_ = static_cast<dawn::float_type*>(Allocator::allocate_host_pinned(bytes()));
+  }
+
+  /**
+   * Release both buffers. Buffers are released explicitly (by the `free()` of the generated
+   * stencil) since they are usually held in static members which outlive the device context.
+   */
+  void free() {
+    if(device_) {
+      Allocator::deallocate_device(device_);
+    }
+    if(staging_) {
+      Allocator::deallocate_host_pinned(staging_);
+    }
+    device_ = nullptr;
+    staging_ = nullptr;
+    inFlight_ = false;
+  }
+
+  bool is_allocated() const { return device_ != nullptr; }
+  dawn::float_type* device_ptr() const { return device_; }
+  std::size_t num_elements() const {
+    return static_cast<std::size_t>(denseSize_) * sparseSize_ * kSize_;
+  }
+  std::size_t bytes() const { return sizeof(dawn::float_type) * num_elements(); }
+
+  /**
+   * Stage `host` (optionally reshaping it from the host to the device layout) and enqueue the
+   * copy to the device on `stream`. `host` may be reused as soon as this function returns.
+   */
+  void copy_to_device_async(const dawn::float_type* host, bool doReshape, stream_type stream) {
+    wait_for_staging(stream);
+    if(doReshape) {
+      if(sparseSize_ == 1) {
+        reshape(host, staging_, kSize_, denseSize_);
+      } else {
+        reshape(host, staging_, kSize_, denseSize_, sparseSize_);
+      }
+    } else {
+      std::copy(host, host + num_elements(), staging_);
+    }
+    Allocator::copy_to_device_async(device_, staging_, bytes(), stream);
+    inFlight_ = true;
+  }
+
+  /**
+   * Enqueue the copy of the device buffer into the staging buffer on `stream`. The result is
+   * available on the host after `finish_copy_to_host`.
+   */
+  void copy_to_host_async(stream_type stream) {
+    wait_for_staging(stream);
+    Allocator::copy_to_host_async(staging_, device_, bytes(), stream);
+    inFlight_ = true;
+  }
+
+  /**
+   * Wait for a copy issued by `copy_to_host_async` and write the staged data to `host`
+   * (optionally reshaping it back from the device to the host layout).
+   */
+  void finish_copy_to_host(dawn::float_type* host, bool doReshape, stream_type stream) {
+    wait_for_staging(stream);
+    if(doReshape) {
+      if(sparseSize_ == 1) {
+        reshape_back(staging_, host, kSize_, denseSize_);
+      } else {
+        reshape_back(staging_, host, kSize_, denseSize_, sparseSize_);
+      }
+    } else {
+      std::copy(staging_, staging_ + num_elements(), host);
+    }
+  }
+
+  void copy_to_host(dawn::float_type* host, bool doReshape, stream_type stream) {
+    copy_to_host_async(stream);
+    finish_copy_to_host(host, doReshape, stream);
+  }
+
+private:
+  // the staging buffer must not be touched by the host while an asynchronous copy is reading
+  // from or writing to it
+  void wait_for_staging(stream_type stream) {
+    if(inFlight_) {
+      Allocator::synchronize(stream);
+      inFlight_ = false;
+    }
+  }
+
+  dawn::float_type* device_ = nullptr;
+  dawn::float_type* staging_ = nullptr;
+  int denseSize_ = 0;
+  int sparseSize_ = 1;
+  int kSize_ = 0;
+  bool inFlight_ = false;
+};
+
+} // namespace dawn
@@ -22,6 +22,7 @@
 #include "domain.hpp"
 #include "extent.hpp"
 #include "halo.hpp"
+#include "halo_exchange.hpp"
 #include "math.hpp"
 #include "param_wrapper.hpp"
 #include "storage.hpp"
@@ -0,0 +1,68 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "extent.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dawn {
+namespace driver {
+
+// Region around the compute domain of a field which has to hold valid data before a multi-stage
+// is executed. The extent is given relative to the compute domain, e.g. {{-1, 1}, {0, 0}, {0, 0}}
+// requires one halo line on either side in i.
+struct halo_region {
+  std::string field;
+  cartesian_extent extent;
+};
+
+// Hooks used by generated stencils to update the halos of a decomposed domain. The exchange of a
+// field is started (`start`) right after the multi-stage producing it and completed (`wait`, with
+// the same region) right before the first multi-stage reading its halo. Implementations may thus
+// post the exchange (e.g. non-blocking MPI sends/receives) in `start` and overlap it with the
+// multi-stages in between. The halos of the inputs of a stencil are not exchanged, they have to be
+// valid when the stencil is run.
+struct halo_exchange_hooks {
+  std::function<void(const halo_region&)> start;
+  std::function<void(const halo_region&)> wait;
+
+  explicit operator bool() const { return static_cast<bool>(start); }
+
+  void start_exchange(const halo_region& region) const {
+    if(start)
+      start(region);
+  }
+
+  void wait_exchange(const halo_region& region) const {
+    if(start && wait)
+      wait(region);
+  }
+
+  // start and complete the exchanges of all `regions`
+  void exchange(const std::vector<halo_region>& regions) const {
+    for(const auto& region : regions) {
+      start_exchange(region);
+    }
+    for(const auto& region : regions) {
+      wait_exchange(region);
+    }
+  }
+};
+
+} // namespace driver
+} // namespace dawn
@@ -0,0 +1,153 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "halo_exchange.hpp"
+
+#include <array>
+#include <cassert>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dawn {
+namespace driver {
+
+// In-process stand-in for a distributed run on a `xcols` x `ycols` grid of ranks, meant for
+// testing halo exchanges without MPI. Rank `r` owns the subdomain in column `r % xcols` and row
+// `r / xcols`. Every rank holds `isize` x `jsize` points, including `halo` points on each side.
+//
+// Each rank is expected to run in its own thread and to use the hooks returned by `hooks(rank)`.
+// `wait` acts as a barrier: once all ranks arrived, the halo points of the started exchanges of the
+// field are copied from the interior of the neighboring ranks. The vertical dimension is not
+// decomposed.
+template <typename T>
+class local_halo_exchange {
+  struct field_view {
+    T* data;
+    std::array<int, 3> strides;
+    int ksize;
+
+    T& operator()(int i, int j, int k) const {
+      return data[i * strides[0] + j * strides[1] + k * strides[2]];
+    }
+  };
+
+  const int xcols_, ycols_;
+  const int isize_, jsize_, halo_;
+  const bool periodic_;
+
+  std::vector<std::map<std::string, field_view>> fields_;
+  std::vector<std::vector<halo_region>> pending_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int numArrived_ = 0;
+  unsigned generation_ = 0;
+
+public:
+  local_halo_exchange(int xcols, int ycols, int isize, int jsize, int halo, bool periodic = false)
+      : xcols_(xcols), ycols_(ycols), isize_(isize), jsize_(jsize), halo_(halo),
+        periodic_(periodic), fields_(xcols * ycols), pending_(xcols * ycols) {
+    assert(isize > 2 * halo && jsize > 2 * halo);
+  }
+
+  local_halo_exchange(const local_halo_exchange&) = delete;
+  local_halo_exchange& operator=(const local_halo_exchange&) = delete;
+
+  int num_ranks() const { return xcols_ * ycols_; }
+
+  // Register the storage of `field` on `rank`. Needs to happen before any exchange is started.
+  void register_field(int rank, const std::string& field, T* data,
+                      const std::array<int, 3>& strides, int ksize) {
+    fields_[rank][field] = field_view{data, strides, ksize};
+  }
+
+  halo_exchange_hooks hooks(int rank) {
+    halo_exchange_hooks hooks;
+    hooks.start = [this, rank](const halo_region& region) { pending_[rank].push_back(region); };
+    hooks.wait = [this, rank](const halo_region& waited) {
+      // all ranks finished writing their interior ...
+      barrier();
+      auto& pending = pending_[rank];
+      for(auto it = pending.begin(); it != pending.end();) {
+        if(it->field == waited.field) {
+          update(rank, *it);
+          it = pending.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      // ... and no rank modifies its interior before all halos are read
+      barrier();
+    };
+    return hooks;
+  }
+
+private:
+  void barrier() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const unsigned generation = generation_;
+    if(++numArrived_ == num_ranks()) {
+      numArrived_ = 0;
+      ++generation_;
+      cv_.notify_all();
+    } else {
+      cv_.wait(lock, [this, generation] { return generation != generation_; });
+    }
+  }
+
+  // Index of the neighbor of `rank` in direction (`di`, `dj`) or -1 if there is none
+  int neighbor(int rank, int di, int dj) const {
+    int col = rank % xcols_ + di;
+    int row = rank / xcols_ + dj;
+    if(periodic_) {
+      col = (col + xcols_) % xcols_;
+      row = (row + ycols_) % ycols_;
+    } else if(col < 0 || col >= xcols_ || row < 0 || row >= ycols_) {
+      return -1;
+    }
+    return row * xcols_ + col;
+  }
+
+  void update(int rank, const halo_region& region) {
+    const int ni = isize_ - 2 * halo_;
+    const int nj = jsize_ - 2 * halo_;
+    assert(-region.extent[0][0] <= halo_ && region.extent[0][1] <= halo_);
+    assert(-region.extent[1][0] <= halo_ && region.extent[1][1] <= halo_);
+
+    const field_view& dst = fields_[rank].at(region.field);
+    for(int j = halo_ + region.extent[1][0]; j < halo_ + nj + region.extent[1][1]; ++j) {
+      const int dj = j < halo_ ? -1 : (j >= halo_ + nj ? 1 : 0);
+      for(int i = halo_ + region.extent[0][0]; i < halo_ + ni + region.extent[0][1]; ++i) {
+        const int di = i < halo_ ? -1 : (i >= halo_ + ni ? 1 : 0);
+        if(di == 0 && dj == 0)
+          continue;
+        const int srcRank = neighbor(rank, di, dj);
+        if(srcRank < 0)
+          continue;
+        const field_view& src = fields_[srcRank].at(region.field);
+        for(int k = 0; k < dst.ksize; ++k) {
+          dst(i, j, k) = src(i - di * ni, j - dj * nj, k);
+        }
+      }
+    }
+  }
+};
+
+} // namespace driver
+} // namespace dawn
@@ -0,0 +1,258 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "nbh_table.hpp"
+#include "unstructured_domain.hpp"
+#include "unstructured_interface.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <numeric>
+#include <vector>
+
+// Renumbering of the elements of unstructured meshes to improve the locality of the neighbor
+// gathers `field[nbhIdx]` of the generated stencils. A permutation is computed per location type
+// and applied to the fields when entering and leaving the stencils and to the neighbor tables once.
+//
+// The permutations never move an element across a splitter index of the `unstructured_domain`,
+// hence the subdomains (LateralBoundary, Nudging, Interior, Halo) keep their index ranges and the
+// domain of the mesh stays valid after renumbering.
+
+namespace dawn {
+
+// Permutation of the elements of one location type, `toOld(newIdx)` is the original index of the
+// element stored at `newIdx` after renumbering
+class element_permutation {
+  std::vector<int> newToOld_;
+  std::vector<int> oldToNew_;
+
+public:
+  element_permutation() = default;
+  explicit element_permutation(std::vector<int> newToOld)
+      : newToOld_(std::move(newToOld)), oldToNew_(newToOld_.size()) {
+    for(std::size_t newIdx = 0; newIdx < newToOld_.size(); ++newIdx) {
+      assert(newToOld_[newIdx] >= 0 && std::size_t(newToOld_[newIdx]) < newToOld_.size());
+      oldToNew_[newToOld_[newIdx]] = newIdx;
+    }
+  }
+
+  static element_permutation identity(int numElements) {
+    std::vector<int> newToOld(numElements);
+    std::iota(newToOld.begin(), newToOld.end(), 0);
+    return element_permutation(std::move(newToOld));
+  }
+
+  int size() const { return newToOld_.size(); }
+  int toNew(int oldIdx) const { return oldToNew_[oldIdx]; }
+  int toOld(int newIdx) const { return newToOld_[newIdx]; }
+
+  // Copy the field `src` in original numbering to `dst` in the new numbering. Every element owns
+  // `valuesPerElement` contiguous values, e.g. the levels (and sparse entries) of the fields passed
+  // from the host, see `reshape`.
+  template <typename T>
+  void toNew(const T* src, T* dst, int valuesPerElement = 1) const {
+    for(std::size_t newIdx = 0; newIdx < newToOld_.size(); ++newIdx) {
+      std::copy_n(src + std::size_t(newToOld_[newIdx]) * valuesPerElement, valuesPerElement,
+                  dst + newIdx * valuesPerElement);
+    }
+  }
+  // Inverse of `toNew`, to hand the fields back in their original numbering
+  template <typename T>
+  void toOld(const T* src, T* dst, int valuesPerElement = 1) const {
+    for(std::size_t newIdx = 0; newIdx < newToOld_.size(); ++newIdx) {
+      std::copy_n(src + newIdx * valuesPerElement, valuesPerElement,
+                  dst + std::size_t(newToOld_[newIdx]) * valuesPerElement);
+    }
+  }
+
+  // Renumber the neighbor table `src` of the elements of this permutation, whose entries are
+  // elements of `target`. Padding entries (DEVICE_MISSING_VALUE) are kept.
+  void renumberTable(const int* src, int* dst, int numNbhPerElement,
+                     const element_permutation& target,
+                     nbh_table_layout layout = nbh_table_layout::element_major) const {
+    const std::size_t numElements = newToOld_.size();
+    for(std::size_t newIdx = 0; newIdx < numElements; ++newIdx) {
+      const std::size_t oldIdx = newToOld_[newIdx];
+      for(int nbh = 0; nbh < numNbhPerElement; ++nbh) {
+        const std::size_t from = layout == nbh_table_layout::element_major
+                                     ? oldIdx * numNbhPerElement + nbh
+                                     : nbh * numElements + oldIdx;
+        const std::size_t to = layout == nbh_table_layout::element_major
+                                   ? newIdx * numNbhPerElement + nbh
+                                   : nbh * numElements + newIdx;
+        dst[to] =
+            src[from] == DEVICE_MISSING_VALUE ? DEVICE_MISSING_VALUE : target.toNew(src[from]);
+      }
+    }
+  }
+};
+
+namespace detail {
+// Contiguous ranges [begin, end) of [0, numElements) delimited by `splitters`
+inline std::vector<std::pair<int, int>> renumberingBlocks(int numElements,
+                                                          std::vector<int> splitters) {
+  splitters.push_back(0);
+  splitters.push_back(numElements);
+  std::sort(splitters.begin(), splitters.end());
+  splitters.erase(std::unique(splitters.begin(), splitters.end()), splitters.end());
+
+  std::vector<std::pair<int, int>> blocks;
+  for(std::size_t idx = 0; idx + 1 < splitters.size(); ++idx) {
+    if(splitters[idx] >= 0 && splitters[idx + 1] <= numElements) {
+      blocks.emplace_back(splitters[idx], splitters[idx + 1]);
+    }
+  }
+  return blocks;
+}
+
+// Index of (x, y) along the Hilbert curve filling [0, 2^16)^2
+inline std::uint64_t hilbertIndex(std::uint32_t x, std::uint32_t y) {
+  std::uint64_t index = 0;
+  for(std::uint32_t side = 1u << 15; side > 0; side /= 2) {
+    const std::uint32_t rx = (x & side) > 0;
+    const std::uint32_t ry = (y & side) > 0;
+    index += std::uint64_t(side) * side * ((3 * rx) ^ ry);
+    // rotate the quadrant
+    if(ry == 0) {
+      if(rx == 1) {
+        x = side - 1 - (x & (side - 1));
+        y = side - 1 - (y & (side - 1));
+      }
+      std::swap(x, y);
+    }
+  }
+  return index;
+}
+} // namespace detail
+
+// Reverse Cuthill-McKee ordering of the graph `adjacency` (neighbors of each element), computed
+// separately within the blocks delimited by `splitters`. Within a block, every connected component
+// is traversed breadth-first starting from an element of minimal degree, visiting neighbors by
+// increasing degree.
+inline element_permutation reverseCuthillMcKee(const std::vector<std::vector<int>>& adjacency,
+                                               const std::vector<int>& splitters = {}) {
+  const int numElements = adjacency.size();
+  std::vector<int> newToOld;
+  newToOld.reserve(numElements);
+  std::vector<bool> visited(numElements, false);
+  std::vector<int> degree(numElements);
+
+  for(auto block : detail::renumberingBlocks(numElements, splitters)) {
+    auto inBlock = [&](int elem) { return elem >= block.first && elem < block.second; };
+    for(int elem = block.first; elem < block.second; ++elem) {
+      degree[elem] = std::count_if(adjacency[elem].begin(), adjacency[elem].end(), inBlock);
+    }
+    std::vector<int> byDegree(block.second - block.first);
+    std::iota(byDegree.begin(), byDegree.end(), block.first);
+    std::stable_sort(byDegree.begin(), byDegree.end(),
+                     [&](int a, int b) { return degree[a] < degree[b]; });
+
+    const std::size_t blockBegin = newToOld.size();
+    std::deque<int> queue;
+    std::vector<int> neighbors;
+    for(int start : byDegree) {
+      if(visited[start]) {
+        continue;
+      }
+      visited[start] = true;
+      queue.push_back(start);
+      while(!queue.empty()) {
+        const int elem = queue.front();
+        queue.pop_front();
+        newToOld.push_back(elem);
+        neighbors.clear();
+        for(int nbh : adjacency[elem]) {
+          if(nbh != DEVICE_MISSING_VALUE && inBlock(nbh) && !visited[nbh]) {
+            visited[nbh] = true;
+            neighbors.push_back(nbh);
+          }
+        }
+        std::stable_sort(neighbors.begin(), neighbors.end(),
+                         [&](int a, int b) { return degree[a] < degree[b]; });
+        queue.insert(queue.end(), neighbors.begin(), neighbors.end());
+      }
+    }
+    std::reverse(newToOld.begin() + blockBegin, newToOld.end());
+  }
+  return element_permutation(std::move(newToOld));
+}
+
+// Ordering of the elements with coordinates (x, y), e.g. cell centroids in lon/lat, along a
+// Hilbert curve over the bounding box of each block delimited by `splitters`
+inline element_permutation hilbertOrder(const std::vector<double>& x, const std::vector<double>& y,
+                                        const std::vector<int>& splitters = {}) {
+  assert(x.size() == y.size());
+  const int numElements = x.size();
+  std::vector<int> newToOld(numElements);
+  std::iota(newToOld.begin(), newToOld.end(), 0);
+  std::vector<std::uint64_t> index(numElements);
+
+  for(auto block : detail::renumberingBlocks(numElements, splitters)) {
+    if(block.first == block.second) {
+      continue;
+    }
+    const auto xRange = std::minmax_element(x.begin() + block.first, x.begin() + block.second);
+    const auto yRange = std::minmax_element(y.begin() + block.first, y.begin() + block.second);
+    auto quantize = [](double value, double min, double max) {
+      return max > min ? std::uint32_t((value - min) / (max - min) * 65535.) : 0u;
+    };
+    for(int elem = block.first; elem < block.second; ++elem) {
+      index[elem] = detail::hilbertIndex(quantize(x[elem], *xRange.first, *xRange.second),
+                                         quantize(y[elem], *yRange.first, *yRange.second));
+    }
+    std::stable_sort(newToOld.begin() + block.first, newToOld.begin() + block.second,
+                     [&](int a, int b) { return index[a] < index[b]; });
+  }
+  return element_permutation(std::move(newToOld));
+}
+
+// Elements of `loc` adjacent in `mesh` (sharing an edge for cells and vertices, a cell for edges),
+// to be ordered by `reverseCuthillMcKee`
+template <typename LibTag>
+std::vector<std::vector<int>> meshAdjacency(dawn::mesh_t<LibTag> const& mesh,
+                                            dawn::LocationType loc) {
+  std::vector<std::vector<int>> adjacency;
+  auto addNeighbors = [&](std::vector<dawn::LocationType> chain, int elem) {
+    auto neighbors = getNeighbors(LibTag{}, mesh, chain, elem);
+    adjacency.emplace_back(neighbors.begin(), neighbors.end());
+  };
+  switch(loc) {
+  case dawn::LocationType::Cells:
+    for(auto cell : getCells(LibTag{}, mesh)) {
+      addNeighbors(
+          {dawn::LocationType::Cells, dawn::LocationType::Edges, dawn::LocationType::Cells}, cell);
+    }
+    break;
+  case dawn::LocationType::Edges:
+    for(auto edge : getEdges(LibTag{}, mesh)) {
+      addNeighbors(
+          {dawn::LocationType::Edges, dawn::LocationType::Cells, dawn::LocationType::Edges}, edge);
+    }
+    break;
+  case dawn::LocationType::Vertices:
+    for(auto vertex : getVertices(LibTag{}, mesh)) {
+      addNeighbors(
+          {dawn::LocationType::Vertices, dawn::LocationType::Edges, dawn::LocationType::Vertices},
+          vertex);
+    }
+    break;
+  }
+  return adjacency;
+}
+
+} // namespace dawn
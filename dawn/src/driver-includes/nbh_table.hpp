@@ -0,0 +1,293 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "unstructured_interface.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEVICE_MISSING_VALUE -1
+
+namespace dawn {
+
+// Call `fn(begin, end)` concurrently on contiguous chunks of [0, size). Small ranges are not split,
+// as starting a thread costs more than processing a few elements.
+template <typename Fn>
+void parallel_chunks(std::size_t size, Fn&& fn,
+                     unsigned numThreads = std::thread::hardware_concurrency()) {
+  const std::size_t minChunkSize = 1024;
+  numThreads = std::max(1u, std::min<unsigned>(numThreads, size / minChunkSize));
+  if(numThreads == 1) {
+    fn(std::size_t(0), size);
+    return;
+  }
+  const std::size_t chunkSize = (size + numThreads - 1) / numThreads;
+  std::vector<std::thread> threads;
+  for(unsigned thread = 1; thread < numThreads; ++thread) {
+    threads.emplace_back(fn, std::min(size, thread * chunkSize),
+                         std::min(size, (thread + 1) * chunkSize));
+  }
+  fn(std::size_t(0), std::min(size, chunkSize));
+  for(auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Memory layout of a neighbor table of `numElements` x `numNbhPerElement` entries
+enum class nbh_table_layout {
+  // table[elem * numNbhPerElement + nbh], the neighbors of an element are contiguous
+  element_major,
+  // table[nbh * numElements + elem], the n-th neighbors of consecutive elements are contiguous. On
+  // GPUs, where consecutive threads process consecutive elements, the loads of a warp coalesce.
+  neighbor_major
+};
+
+// Fill the host neighbor table `table` of size `numElements` x `numNbhPerElement` with the
+// neighbors of each element along `chain`. Elements with fewer neighbors are padded with
+// DEVICE_MISSING_VALUE.
+//
+// The elements are collected in a first pass, after which the size of the table is known and every
+// element owns a row (or column) of it. These are then filled concurrently by the non-allocating
+// `getNeighbors` overload of the mesh library, which writes the neighbors into the row (or column)
+// and returns their number, and the remaining entries are padded.
+template <typename LibTag>
+void fillNbhTable(dawn::mesh_t<LibTag> const& mesh, const std::vector<dawn::LocationType>& chain,
+                  int numElements, int numNbhPerElement, int* table, bool includeCenter = false,
+                  nbh_table_layout layout = nbh_table_layout::element_major) {
+  std::vector<dawn::nbh_table_index_t<LibTag>> elems;
+  elems.reserve(numElements);
+  switch(chain.front()) {
+  case dawn::LocationType::Cells: {
+    for(auto cell : getCells(LibTag{}, mesh)) {
+      elems.push_back(cell);
+    }
+    break;
+  }
+  case dawn::LocationType::Edges: {
+    for(auto edge : getEdges(LibTag{}, mesh)) {
+      elems.push_back(edge);
+    }
+    break;
+  }
+  case dawn::LocationType::Vertices: {
+    for(auto vertex : getVertices(LibTag{}, mesh)) {
+      elems.push_back(vertex);
+    }
+    break;
+  }
+  }
+
+  assert(elems.size() == std::size_t(numElements));
+
+  parallel_chunks(elems.size(), [&](std::size_t begin, std::size_t end) {
+    for(std::size_t elemIdx = begin; elemIdx != end; ++elemIdx) {
+      const bool elementMajor = layout == nbh_table_layout::element_major;
+      int* row = elementMajor ? table + elemIdx * numNbhPerElement : table + elemIdx;
+      const int stride = elementMajor ? 1 : numElements;
+      const int numNbh = getNeighbors(LibTag{}, mesh, chain, elems[elemIdx], includeCenter, row,
+                                      numNbhPerElement, stride);
+      for(int nbh = numNbh; nbh < numNbhPerElement; ++nbh) {
+        row[std::size_t(nbh) * stride] = DEVICE_MISSING_VALUE;
+      }
+    }
+  });
+}
+
+// FNV-1a hash of the number of elements of `mesh` and of the vertices of its cells and edges, to
+// be used as key of a `nbh_table_cache`. Meshes with the same fingerprint are assumed to have the
+// same neighbor tables.
+template <typename LibTag>
+std::uint64_t meshFingerprint(dawn::mesh_t<LibTag> const& mesh) {
+  std::uint64_t hash = 14695981039346656037ull;
+  auto combine = [&](std::int64_t value) {
+    for(int byte = 0; byte < 8; ++byte) {
+      hash ^= (value >> (8 * byte)) & 0xff;
+      hash *= 1099511628211ull;
+    }
+  };
+  combine(-1);
+  // cells and edges have a few vertices only, which are collected into a buffer on the stack
+  const std::vector<dawn::LocationType> cellVertices{dawn::LocationType::Cells,
+                                                     dawn::LocationType::Vertices};
+  const std::vector<dawn::LocationType> edgeVertices{dawn::LocationType::Edges,
+                                                     dawn::LocationType::Vertices};
+  constexpr int maxVertices = 16;
+  int vertices[maxVertices];
+  for(auto cell : getCells(LibTag{}, mesh)) {
+    const int numNbh =
+        getNeighbors(LibTag{}, mesh, cellVertices, cell, false, vertices, maxVertices);
+    for(int vertex = 0; vertex < numNbh; ++vertex)
+      combine(vertices[vertex]);
+    combine(-1);
+  }
+  for(auto edge : getEdges(LibTag{}, mesh)) {
+    const int numNbh =
+        getNeighbors(LibTag{}, mesh, edgeVertices, edge, false, vertices, maxVertices);
+    for(int vertex = 0; vertex < numNbh; ++vertex)
+      combine(vertices[vertex]);
+    combine(-1);
+  }
+  int numVertices = 0;
+  for(auto vertex : getVertices(LibTag{}, mesh)) {
+    (void)vertex;
+    ++numVertices;
+  }
+  combine(numVertices);
+  return hash;
+}
+
+// On-disk cache of neighbor tables, keyed by a mesh fingerprint (see `meshFingerprint`) and the
+// iteration space and layout of the table. Restarts and ensemble members sharing a mesh memory-map
+// the cached tables instead of recomputing them.
+//
+// Tables are written to a temporary file which is renamed once complete, hence concurrent runs
+// sharing the cache directory never observe partially written tables.
+class nbh_table_cache {
+  struct file_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t numElements;
+    std::uint64_t fingerprint;
+    std::uint32_t numNbhPerElement;
+    std::uint32_t layout;
+  };
+  static constexpr std::uint32_t version_ = 2;
+
+  std::string directory_;
+  std::uint64_t fingerprint_;
+
+  file_header makeHeader(int numElements, int numNbhPerElement, nbh_table_layout layout) const {
+    file_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "dawnnbh", 8);
+    header.version = version_;
+    header.numElements = numElements;
+    header.fingerprint = fingerprint_;
+    header.numNbhPerElement = numNbhPerElement;
+    header.layout = static_cast<std::uint32_t>(layout);
+    return header;
+  }
+
+public:
+  // Read-only memory mapping of a cached table, evaluates to false if the table was not cached
+  class mapped_table {
+    void* base_ = nullptr;
+    std::size_t bytes_ = 0;
+
+  public:
+    mapped_table() = default;
+    mapped_table(void* base, std::size_t bytes) : base_(base), bytes_(bytes) {}
+    mapped_table(const mapped_table&) = delete;
+    mapped_table& operator=(const mapped_table&) = delete;
+    mapped_table(mapped_table&& other) : base_(other.base_), bytes_(other.bytes_) {
+      other.base_ = nullptr;
+    }
+    ~mapped_table() {
+      if(base_)
+        munmap(base_, bytes_);
+    }
+
+    explicit operator bool() const { return base_ != nullptr; }
+    const int* data() const {
+      return reinterpret_cast<const int*>(static_cast<const char*>(base_) + sizeof(file_header));
+    }
+  };
+
+  nbh_table_cache(std::string directory, std::uint64_t meshFingerprint)
+      : directory_(std::move(directory)), fingerprint_(meshFingerprint) {}
+
+  // Path of the file caching the table of `space`
+  std::string path(const dawn::UnstructuredIterationSpace& space,
+                   nbh_table_layout layout = nbh_table_layout::element_major) const {
+    static const char locationNames[] = {'c', 'e', 'v'};
+    char fingerprint[17];
+    std::snprintf(fingerprint, sizeof(fingerprint), "%016llx",
+                  static_cast<unsigned long long>(fingerprint_));
+    std::string name = "nbh_" + std::string(fingerprint) + "_";
+    for(auto loc : std::get<0>(space)) {
+      name += locationNames[static_cast<int>(loc)];
+    }
+    if(std::get<1>(space)) {
+      name += "_center";
+    }
+    if(layout == nbh_table_layout::neighbor_major) {
+      name += "_nbhmajor";
+    }
+    return directory_ + "/" + name + ".bin";
+  }
+
+  // Map the cached table of `space`. Tables of a different size, layout or mesh are ignored.
+  mapped_table load(const dawn::UnstructuredIterationSpace& space, int numElements,
+                    int numNbhPerElement,
+                    nbh_table_layout layout = nbh_table_layout::element_major) const {
+    const int fd = open(path(space, layout).c_str(), O_RDONLY);
+    if(fd < 0)
+      return mapped_table();
+
+    const std::size_t bytes =
+        sizeof(file_header) + sizeof(int) * std::size_t(numElements) * numNbhPerElement;
+    struct stat status;
+    void* base = MAP_FAILED;
+    if(fstat(fd, &status) == 0 && std::size_t(status.st_size) == bytes) {
+      base = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if(base == MAP_FAILED)
+      return mapped_table();
+
+    mapped_table table(base, bytes);
+    const file_header header = makeHeader(numElements, numNbhPerElement, layout);
+    if(std::memcmp(base, &header, sizeof(header)) != 0)
+      return mapped_table();
+    return table;
+  }
+
+  // Write the table of `space` to the cache, returns false if the cache directory is not writable
+  bool store(const dawn::UnstructuredIterationSpace& space, const int* table, int numElements,
+             int numNbhPerElement,
+             nbh_table_layout layout = nbh_table_layout::element_major) const {
+    const std::string target = path(space, layout);
+    const std::string tmp = target + "." + std::to_string(getpid()) + ".tmp";
+    std::FILE* file = std::fopen(tmp.c_str(), "wb");
+    if(!file)
+      return false;
+
+    const file_header header = makeHeader(numElements, numNbhPerElement, layout);
+    const std::size_t size = std::size_t(numElements) * numNbhPerElement;
+    bool success = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(table, sizeof(int), size, file) == size;
+    success = std::fclose(file) == 0 && success;
+    if(!success || std::rename(tmp.c_str(), target.c_str()) != 0) {
+      std::remove(tmp.c_str());
+      return false;
+    }
+    return true;
+  }
+};
+
+} // namespace dawn
@@ -0,0 +1,87 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace dawn {
+
+/**
+ * Smallest multiple of `multiple` which is not less than `size`. The cuda-ico backend pads the
+ * horizontal dimension of the fields to this size if `--padding-multiple` is set, such that every
+ * level (and sparse entry) starts at a multiple of `multiple` elements.
+ */
+constexpr int padded_size(int size, int multiple) {
+  return multiple > 1 ? (size + multiple - 1) / multiple * multiple : size;
+}
+
+/**
+ * @class padded_field
+ * Owning storage of an unstructured field in the layout of the generated cuda-ico stencils, i.e.
+ * levels, sparse entries, elements from slowest to fastest varying. The elements of each level are
+ * padded to `stride() = padded_size(numElements, multiple)` and the storage is aligned to
+ * `alignment` bytes, hence every level starts at an aligned address if `multiple * sizeof(T)` is a
+ * multiple of `alignment` (e.g. 32 doubles per warp and 128 bytes).
+ *
+ * The storage is released with the field, `data()` and `stride()` can be passed to the generated
+ * stencils without reshaping.
+ */
+template <typename T>
+class padded_field {
+public:
+  padded_field() = default;
+  padded_field(int numElements, int kSize, int sparseSize = 1, int multiple = 32,
+               std::size_t alignment = 128)
+      : numElements_(numElements), stride_(padded_size(numElements, multiple)),
+        sparseSize_(sparseSize), kSize_(kSize) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment is a power of two");
+    storage_.reset(new unsigned char[size() * sizeof(T) + alignment - 1]());
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage_.get());
+    data_ = reinterpret_cast<T*>((address + alignment - 1) & ~std::uintptr_t(alignment - 1));
+  }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+
+  int numElements() const { return numElements_; }
+  int stride() const { return stride_; }
+  int sparseSize() const { return sparseSize_; }
+  int kSize() const { return kSize_; }
+  // number of values including the padding
+  std::size_t size() const { return std::size_t(stride_) * sparseSize_ * kSize_; }
+
+  T& operator()(int elem, int k) { return data_[index(elem, 0, k)]; }
+  const T& operator()(int elem, int k) const { return data_[index(elem, 0, k)]; }
+  T& operator()(int elem, int sparse, int k) { return data_[index(elem, sparse, k)]; }
+  const T& operator()(int elem, int sparse, int k) const { return data_[index(elem, sparse, k)]; }
+
+private:
+  std::size_t index(int elem, int sparse, int k) const {
+    assert(elem < numElements_ && sparse < sparseSize_ && k < kSize_);
+    return (std::size_t(k) * sparseSize_ + sparse) * stride_ + elem;
+  }
+
+  std::unique_ptr<unsigned char[]> storage_;
+  T* data_ = nullptr;
+  int numElements_ = 0;
+  int stride_ = 0;
+  int sparseSize_ = 1;
+  int kSize_ = 0;
+};
+
+} // namespace dawn
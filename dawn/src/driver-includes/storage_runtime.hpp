@@ -97,6 +97,25 @@ using storage_scalar_t = storage_traits_t::data_store_t<::dawn::float_type, meta
 using storage_t = storage_ijk_t;
 /** @} */
 
+/**
+ * @brief Storage types of the fields with a precision of their own, independent of
+ * `::dawn::float_type`
+ * @{
+ */
+using storage_ijk_float_t = storage_traits_t::data_store_t<float, meta_data_ijk_t>;
+using storage_ij_float_t = storage_traits_t::data_store_t<float, meta_data_ij_t>;
+using storage_i_float_t = storage_traits_t::data_store_t<float, meta_data_i_t>;
+using storage_j_float_t = storage_traits_t::data_store_t<float, meta_data_j_t>;
+using storage_k_float_t = storage_traits_t::data_store_t<float, meta_data_k_t>;
+using storage_scalar_float_t = storage_traits_t::data_store_t<float, meta_data_scalar_t>;
+using storage_ijk_double_t = storage_traits_t::data_store_t<double, meta_data_ijk_t>;
+using storage_ij_double_t = storage_traits_t::data_store_t<double, meta_data_ij_t>;
+using storage_i_double_t = storage_traits_t::data_store_t<double, meta_data_i_t>;
+using storage_j_double_t = storage_traits_t::data_store_t<double, meta_data_j_t>;
+using storage_k_double_t = storage_traits_t::data_store_t<double, meta_data_k_t>;
+using storage_scalar_double_t = storage_traits_t::data_store_t<double, meta_data_scalar_t>;
+/** @} */
+
 /** @} */
 
 #if DAWN_STORAGE_TYPE == DAWN_STORAGE_HOST
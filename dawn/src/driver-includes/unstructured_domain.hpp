@@ -14,7 +14,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
+#include <tuple>
+#include <vector>
 
 #include "unstructured_interface.hpp"
 
@@ -29,6 +32,19 @@ class unstructured_domain {
 public:
   int operator()(KeyType&& key) const { return subdomainToIndex_.at(key); }
   void set_splitter_index(KeyType&& key, int index) { subdomainToIndex_[key] = index; }
+
+  // All splitter indices set for the elements of `loc`, in ascending order
+  std::vector<int> splitter_indices(::dawn::LocationType loc) const {
+    std::vector<int> indices;
+    for(const auto& splitter : subdomainToIndex_) {
+      if(std::get<0>(splitter.first) == loc) {
+        indices.push_back(splitter.second);
+      }
+    }
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    return indices;
+  }
 };
 
 } // namespace dawn
\ No newline at end of file
@@ -17,6 +17,7 @@
 #include "defs.hpp"
 #include "extent.hpp"
 
+#include <array>
 #include <vector>
 
 namespace dawn {
@@ -70,6 +71,16 @@ using mesh_t = decltype(meshType(Tag{}));
 enum class LocationType { Cells = 0, Edges, Vertices };
 using UnstructuredIterationSpace = std::tuple<std::vector<LocationType>, bool>;
 
+// Passed to `reduce` by the generated code for elements with exactly N neighbors along the chain,
+// e.g. the interior elements of icosahedral meshes, the reduction needs no missing value checks.
+// The reduction collects the indices of the neighbors into `neighbors`, on the stack of the caller.
+// Dawn only generates complete neighborhoods for chains of at most 6 locations, which don't step
+// away from vertices.
+template <int N>
+struct complete_neighborhood {
+  std::array<int, N> neighbors;
+};
+
 // generic deref, specialize if needed
 template <typename Tag, typename LocationType>
 auto deref(Tag, LocationType const& l) -> LocationType const& {
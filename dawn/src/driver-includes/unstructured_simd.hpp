@@ -0,0 +1,81 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include "defs.hpp"
+
+#include <utility>
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#else
+#error "SIMD code generation (--simd-width) requires <experimental/simd>"
+#endif
+
+namespace dawn {
+
+// Values of `Width` consecutive vertical levels, computed by the SIMD code of the naive-ico backend
+template <int Width>
+using float_simd = std::experimental::fixed_size_simd<float_type, Width>;
+
+// Load the values of the `Width` levels accessed by `access(lane)`. Fields whose levels are
+// contiguous in memory (e.g. atlas fields) are loaded with a vector load, other layouts with one
+// load per lane.
+template <int Width, typename Access>
+float_simd<Width> simd_load(Access&& access) {
+  const float_type* first = &access(0);
+  if(&access(Width - 1) == first + (Width - 1))
+    return float_simd<Width>(first, std::experimental::element_aligned);
+  return float_simd<Width>([&](auto lane) { return access(int(lane)); });
+}
+
+// Reference to the `Width` levels accessed by `access(lane)`, assigned by the SIMD code
+template <int Width, typename Access>
+class simd_reference {
+  Access access_;
+
+public:
+  explicit simd_reference(Access access) : access_(access) {}
+
+  simd_reference& operator=(const float_simd<Width>& value) {
+    float_type* first = &access_(0);
+    if(&access_(Width - 1) == first + (Width - 1)) {
+      value.copy_to(first, std::experimental::element_aligned);
+    } else {
+      for(int lane = 0; lane < Width; ++lane)
+        access_(lane) = value[lane];
+    }
+    return *this;
+  }
+  simd_reference& operator+=(const float_simd<Width>& value) {
+    return *this = simd_load<Width>(access_) + value;
+  }
+  simd_reference& operator-=(const float_simd<Width>& value) {
+    return *this = simd_load<Width>(access_) - value;
+  }
+  simd_reference& operator*=(const float_simd<Width>& value) {
+    return *this = simd_load<Width>(access_) * value;
+  }
+  simd_reference& operator/=(const float_simd<Width>& value) {
+    return *this = simd_load<Width>(access_) / value;
+  }
+};
+
+template <int Width, typename Access>
+simd_reference<Width, Access> simd_ref(Access&& access) {
+  return simd_reference<Width, Access>(std::forward<Access>(access));
+}
+
+} // namespace dawn
@@ -16,6 +16,7 @@
 
 #include "atlas/mesh.h"
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <functional>
 #include <iterator>
@@ -82,16 +83,18 @@ public:
   int numElements() const { return atlas_field_.shape(0); }
 
   VerticalField(atlas::array::ArrayView<T, 1> const& atlas_field) : atlas_field_(atlas_field) {}
+  // view of the field `owner`, which is kept alive as long as the view
+  VerticalField(atlas::Field const& owner)
+      : atlas_field_(atlas::array::make_view<T, 1>(owner)), owner_(owner) {}
 
 private:
   atlas::array::ArrayView<T, 1> atlas_field_;
+  atlas::Field owner_;
 };
 
 inline VerticalField<::dawn::float_type> allocateField(atlasTag, size_t k_size) {
-  // leaky!
-  auto field = new atlas::Field("allocated", atlas::array::DataType::real64(),
-                                atlas::array::make_shape(k_size));
-  return VerticalField<::dawn::float_type>(atlas::array::make_view<::dawn::float_type, 1>(*field));
+  return VerticalField<::dawn::float_type>(atlas::Field(
+      "allocated", atlas::array::DataType::real64(), atlas::array::make_shape(k_size)));
 }
 
 template <typename T>
@@ -116,15 +119,18 @@ public:
   }
 
   Field(atlas::array::ArrayView<T, 2> const& atlas_field) : atlas_field_(atlas_field) {}
+  // view of the field `owner`, which is kept alive as long as the view
+  Field(atlas::Field const& owner)
+      : atlas_field_(atlas::array::make_view<T, 2>(owner)), owner_(owner) {}
 
 private:
   atlas::array::ArrayView<T, 2> atlas_field_;
+  atlas::Field owner_;
 };
 
 inline Field<::dawn::float_type> allocateField(atlasTag, size_t num_el, size_t k_size) {
-  auto field = new atlas::Field("allocate", atlas::array::DataType::real64(),
-                                atlas::array::make_shape(num_el, k_size));
-  return Field<::dawn::float_type>(atlas::array::make_view<::dawn::float_type, 2>(*field));
+  return Field<::dawn::float_type>(atlas::Field("allocate", atlas::array::DataType::real64(),
+                                                atlas::array::make_shape(num_el, k_size)));
 }
 
 template <typename T>
@@ -162,18 +168,20 @@ public:
 
   SparseDimension(atlas::array::ArrayView<T, 3> const& sparse_dimension)
       : sparse_dimension_(sparse_dimension) {}
+  // view of the field `owner`, which is kept alive as long as the view
+  SparseDimension(atlas::Field const& owner)
+      : sparse_dimension_(atlas::array::make_view<T, 3>(owner)), owner_(owner) {}
 
 private:
   atlas::array::ArrayView<T, 3> sparse_dimension_;
+  atlas::Field owner_;
 };
 
 inline SparseDimension<::dawn::float_type> allocateField(atlasTag, size_t num_el, size_t k_size,
                                                          size_t sparse_size) {
-  // leaky!
-  auto field = new atlas::Field("allocate", atlas::array::DataType::real64(),
-                                atlas::array::make_shape(num_el, k_size, sparse_size));
   return SparseDimension<::dawn::float_type>(
-      atlas::array::make_view<::dawn::float_type, 3>(*field));
+      atlas::Field("allocate", atlas::array::DataType::real64(),
+                   atlas::array::make_shape(num_el, k_size, sparse_size)));
 }
 
 template <typename T>
@@ -397,4 +405,192 @@ auto reduce(atlasTag, atlas::Mesh const& m, int idx, Init init,
   return init;
 }
 
+//===------------------------------------------------------------------------------------------===//
+// versions for complete neighborhoods (fixed number of neighbors N)
+//===------------------------------------------------------------------------------------------===//
+
+// neighbor table from cells or edges (the complete neighborhoods don't step away from vertices)
+inline const atlas::Mesh::HybridElements::Connectivity&
+getConnectivity(atlas::Mesh const& mesh, dawn::LocationType from, dawn::LocationType to) {
+  assert(from != dawn::LocationType::Vertices && from != to);
+  const atlas::Mesh::HybridElements& elements =
+      from == dawn::LocationType::Cells
+          ? static_cast<const atlas::Mesh::HybridElements&>(mesh.cells())
+          : mesh.edges();
+  switch(to) {
+  case dawn::LocationType::Cells:
+    return elements.cell_connectivity();
+  case dawn::LocationType::Edges:
+    return elements.edge_connectivity();
+  default:
+    return elements.node_connectivity();
+  }
+}
+
+// calls `fn` with each neighbor of type `to` of the element `idx` of type `from`
+template <typename Fn>
+void forEachNeighbor(atlas::Mesh const& mesh, dawn::LocationType from, dawn::LocationType to,
+                     int idx, Fn&& fn) {
+  auto visit = [&](const auto& conn) {
+    for(int n = 0; n < conn.cols(idx); ++n) {
+      if(conn(idx, n) != conn.missing_value()) {
+        fn(conn(idx, n));
+      }
+    }
+  };
+  if(from == dawn::LocationType::Vertices) {
+    visit(to == dawn::LocationType::Cells ? mesh.nodes().cell_connectivity()
+                                          : mesh.nodes().edge_connectivity());
+  } else {
+    visit(getConnectivity(mesh, from, to));
+  }
+}
+
+// calls `fn` with each element of the front `depth` steps along `chain` from `idx`, in the order
+// of the fronts built by `getNeighbors` (duplicates included)
+template <typename Fn>
+void forEachFrontElement(atlas::Mesh const& mesh, std::vector<dawn::LocationType> const& chain,
+                         std::size_t step, std::size_t depth, int idx, Fn& fn) {
+  if(step == depth) {
+    fn(idx);
+    return;
+  }
+  forEachNeighbor(mesh, chain[step], chain[step + 1], idx, [&](int nextIdx) {
+    forEachFrontElement(mesh, chain, step + 1, depth, nextIdx, fn);
+  });
+}
+
+// collects the same neighbors in the same order as `getNeighbors` into neighbors[0],
+// neighbors[stride], ... without allocating and returns their number. Only the first
+// `maxNeighbors` neighbors are collected. The fronts are not stored but enumerated again for each
+// step of the chain.
+inline int getNeighbors(atlasTag, atlas::Mesh const& mesh,
+                        std::vector<dawn::LocationType> const& chain, int idx, bool includeCenter,
+                        int* neighbors, int maxNeighbors, int stride = 1) {
+  // see `getNeighbors` for the exclusion of the original element and the center element
+  const dawn::LocationType targetType = chain.back();
+  const bool excludeOrigin = chain.front() == targetType;
+  int size = 0;
+  if(includeCenter && maxNeighbors > 0) {
+    neighbors[0] = idx;
+    size = 1;
+  }
+  const int first = size;
+  auto addNeighbor = [&](int nbhIdx) {
+    if(size == maxNeighbors || (excludeOrigin && nbhIdx == idx)) {
+      return;
+    }
+    for(int i = first; i < size; ++i) {
+      if(neighbors[std::size_t(i) * stride] == nbhIdx) {
+        return;
+      }
+    }
+    neighbors[std::size_t(size++) * stride] = nbhIdx;
+  };
+
+  for(std::size_t depth = 0; depth + 1 < chain.size(); ++depth) {
+    // add to the result set the neighbors (of target type) of the elements of the front
+    if(chain[depth] == targetType) {
+      continue;
+    }
+    auto addTargetNeighbors = [&](int elemIdx) {
+      forEachNeighbor(mesh, chain[depth], targetType, elemIdx, addNeighbor);
+    };
+    forEachFrontElement(mesh, chain, 0, depth, idx, addTargetNeighbors);
+  }
+  return size;
+}
+
+// collects the same neighbors in the same order as `getNeighbors` into `neighbors`, without
+// allocating. The fronts are deduplicated (an element visited again adds no new neighbors and
+// leads to no new elements) and kept on the stack. Their size is bounded for the chains dawn
+// generates complete neighborhoods for (see `complete_neighborhood`), other meshes or chains with
+// larger fronts fall back to enumerating the fronts without storing them.
+template <std::size_t N>
+void getNeighbors(atlasTag, atlas::Mesh const& mesh, std::vector<dawn::LocationType> const& chain,
+                  int idx, bool includeCenter, std::array<int, N>& neighbors) {
+  constexpr int maxFrontSize = 32;
+  std::array<int, maxFrontSize> fronts[2];
+  int frontSize = 1;
+  fronts[0][0] = idx;
+
+  // see `getNeighbors` for the exclusion of the original element and the center element
+  const dawn::LocationType targetType = chain.back();
+  const bool excludeOrigin = chain.front() == targetType;
+  const int first = includeCenter ? 1 : 0;
+  int size = first;
+  if(includeCenter) {
+    neighbors[0] = idx;
+  }
+  auto addNeighbors = [&](const atlas::Mesh::HybridElements::Connectivity& conn, int elemIdx) {
+    for(int n = 0; n < conn.cols(elemIdx); ++n) {
+      const int nbhIdx = conn(elemIdx, n);
+      if(nbhIdx == conn.missing_value() || (excludeOrigin && nbhIdx == idx) ||
+         std::find(neighbors.begin() + first, neighbors.begin() + size, nbhIdx) !=
+             neighbors.begin() + size) {
+        continue;
+      }
+      assert(size < int(N) && "incomplete neighborhood");
+      if(size < int(N)) {
+        neighbors[size++] = nbhIdx;
+      }
+    }
+  };
+
+  for(std::size_t step = 0; step + 1 < chain.size(); ++step) {
+    const auto& front = fronts[step % 2];
+    auto& newFront = fronts[(step + 1) % 2];
+    // the front of the last step contains elements of the target type, it is not needed
+    const bool isLastStep = step + 2 == chain.size();
+    const auto& conn = getConnectivity(mesh, chain[step], chain[step + 1]);
+
+    int newFrontSize = 0;
+    for(int i = 0; i < frontSize; ++i) {
+      // add to result set the neighbors (of target type) of the current element
+      if(chain[step] != targetType) {
+        addNeighbors(getConnectivity(mesh, chain[step], targetType), front[i]);
+      }
+      if(isLastStep) {
+        continue;
+      }
+      // build up the new front for the next step
+      for(int n = 0; n < conn.cols(front[i]); ++n) {
+        const int nextIdx = conn(front[i], n);
+        if(nextIdx == conn.missing_value() ||
+           std::find(newFront.begin(), newFront.begin() + newFrontSize, nextIdx) !=
+               newFront.begin() + newFrontSize) {
+          continue;
+        }
+        if(newFrontSize == maxFrontSize) {
+          getNeighbors(atlasTag{}, mesh, chain, idx, includeCenter, neighbors.data(), int(N));
+          return;
+        }
+        newFront[newFrontSize++] = nextIdx;
+      }
+    }
+    frontSize = newFrontSize;
+  }
+  assert(size == int(N) && "incomplete neighborhood");
+}
+
+template <int N, typename Init, typename Op, typename WeightT>
+auto reduce(atlasTag, dawn::complete_neighborhood<N>&& nbh, atlas::Mesh const& m, int idx,
+            Init init, std::vector<dawn::LocationType> chain, Op&& op,
+            std::vector<WeightT>&& weights, bool includeCenter = false) {
+  static_assert(std::is_arithmetic<WeightT>::value, "weights need to be of arithmetic type!\n");
+  getNeighbors(atlasTag{}, m, chain, idx, includeCenter, nbh.neighbors);
+  for(int i = 0; i < N; ++i)
+    op(init, nbh.neighbors[i], weights[i]);
+  return init;
+}
+
+template <int N, typename Init, typename Op>
+auto reduce(atlasTag, dawn::complete_neighborhood<N>&& nbh, atlas::Mesh const& m, int idx,
+            Init init, std::vector<dawn::LocationType> chain, Op&& op, bool includeCenter = false) {
+  getNeighbors(atlasTag{}, m, chain, idx, includeCenter, nbh.neighbors);
+  for(int i = 0; i < N; ++i)
+    op(init, nbh.neighbors[i]);
+  return init;
+}
+
 } // namespace atlasInterface
@@ -14,6 +14,7 @@
 
 #include "UnstructuredStencils.h"
 #include "dawn/CodeGen/Cuda-ico/LocToStringUtils.h"
+#include "dawn/CodeGen/Driver.h"
 #include "dawn/CodeGen/IcoChainSizes.h"
 #include "dawn/CodeGen/Options.h"
 #include "dawn/Serialization/IIRSerializer.h"
@@ -94,4 +95,271 @@ TEST(CudaIco, ChainSizes) {
   }
 }
 
+TEST(CudaIco, ChainsFullInInterior) {
+  using dawn::ast::LocationType;
+  EXPECT_TRUE(dawn::ICOChainIsFullInInterior({LocationType::Cells, LocationType::Vertices}));
+  EXPECT_FALSE(dawn::ICOChainIsFullInInterior({LocationType::Vertices, LocationType::Cells}));
+  EXPECT_TRUE(dawn::ICOChainIsFullInInterior(
+      {LocationType::Cells, LocationType::Edges, LocationType::Cells, LocationType::Edges,
+       LocationType::Cells, LocationType::Edges}));
+  // longer chains are not unrolled, their fronts are not bounded by the interfaces
+  EXPECT_FALSE(dawn::ICOChainIsFullInInterior(
+      {LocationType::Cells, LocationType::Edges, LocationType::Cells, LocationType::Edges,
+       LocationType::Cells, LocationType::Edges, LocationType::Cells}));
+}
+
+TEST(CudaIco, MultipleStencils) {
+  // e.g. the versions of a stencil specialized for global variables, which the generated API can't
+  // select from
+  using LocType = dawn::ast::LocationType;
+  dawn::UIDGenerator::getInstance()->reset();
+  dawn::iir::UnstructuredIIRBuilder b;
+  auto in_f = b.field("in_field", LocType::Edges);
+  auto out_f = b.field("out_field", LocType::Edges);
+  std::vector<std::unique_ptr<dawn::iir::Stencil>> stencils;
+  for(int version = 0; version < 2; ++version)
+    stencils.push_back(b.stencil(b.multistage(
+        dawn::iir::LoopOrderKind::Parallel,
+        b.stage(LocType::Edges, b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                                           b.stmt(b.assignExpr(b.at(out_f), b.at(in_f))))))));
+  auto stencil = b.build("versions", std::move(stencils));
+
+  EXPECT_THROW(dawn::codegen::run(stencil, backend), std::runtime_error);
+}
+
+TEST(CudaIco, PersistentBuffers) {
+  dawn::codegen::Options options;
+  options.PersistentBuffers = true;
+  auto tu = dawn::codegen::run(dawn::getReductionsStencil(), backend, options);
+  const std::string code = dawn::codegen::generate(tu);
+
+  // buffers and stream are created once in setup() ...
+  EXPECT_NE(code.find("lhs_field_buffer_.allocate(mesh_.NumEdges + 0, 1, kSize_)"),
+            std::string::npos);
+  EXPECT_NE(code.find("cudaStreamCreate(&stream_)"), std::string::npos);
+  // ... reused for the transfers ...
+  EXPECT_NE(code.find("rhs_field_buffer_.copy_to_device_async(rhs_field, do_reshape, stream_)"),
+            std::string::npos);
+  EXPECT_NE(code.find("lhs_field_buffer_.finish_copy_to_host(lhs_field, do_reshape, stream_)"),
+            std::string::npos);
+  EXPECT_EQ(code.find("initField("), std::string::npos);
+  // ... and kernels are launched on the stream without synchronizing the device
+  EXPECT_NE(code.find("stream_>>>"), std::string::npos);
+  const auto run = code.find("void run() {");
+  ASSERT_NE(run, std::string::npos);
+  EXPECT_EQ(code.substr(run, code.find("\n    }\n", run) - run).find("cudaDeviceSynchronize"),
+            std::string::npos);
+
+  // the run functions keep working without explicit setup: setup() returns early once the buffers
+  // are allocated for the same mesh, the buffers are not freed after the run
+  EXPECT_NE(code.find("if(is_setup_ && setup_mesh_ == mesh && kSize_ == kSize) return"),
+            std::string::npos);
+  EXPECT_NE(code.find("setup_mesh_ = mesh"), std::string::npos);
+  // free() without setup does not destroy the stream
+  const auto free = code.find("static void free() {");
+  ASSERT_NE(free, std::string::npos);
+  EXPECT_LT(code.find("if(!is_setup_) return", free), code.find("cudaStreamDestroy", free));
+  const auto runFromHost = code.find("double run_reductions_from_c_host(");
+  ASSERT_NE(runFromHost, std::string::npos);
+  const auto runFromHostBody =
+      code.substr(runFromHost, code.find("return time;", runFromHost) - runFromHost);
+  EXPECT_NE(runFromHostBody.find("::setup(mesh, k_size)"), std::string::npos);
+  EXPECT_EQ(runFromHostBody.find("::free()"), std::string::npos);
+  // the run function on device pointers waits for the kernels
+  const auto runFromDevice = code.find("double run_reductions(");
+  ASSERT_NE(runFromDevice, std::string::npos);
+  EXPECT_NE(code.substr(runFromDevice, code.find("return time;", runFromDevice) - runFromDevice)
+                .find("cudaDeviceSynchronize()"),
+            std::string::npos);
+}
+
+TEST(CudaIco, NeighborMajorTables) {
+  dawn::codegen::Options options;
+  auto code =
+      dawn::codegen::generate(dawn::codegen::run(dawn::getReductionsStencil(), backend, options));
+  EXPECT_NE(code.find("[pidx * E_C_SIZE + nbhIter]"), std::string::npos);
+  EXPECT_EQ(code.find("tableStride"), std::string::npos);
+
+  options.NeighborMajorTables = true;
+  code =
+      dawn::codegen::generate(dawn::codegen::run(dawn::getReductionsStencil(), backend, options));
+  // tables are indexed neighbor-major and strided by the number of elements of the mesh
+  EXPECT_NE(code.find("[nbhIter * tableStride + pidx]"), std::string::npos);
+  EXPECT_EQ(code.find("[pidx * E_C_SIZE + nbhIter]"), std::string::npos);
+  EXPECT_NE(code.find("int tableStride"), std::string::npos);
+  EXPECT_NE(code.find("kSize_, mesh_.NumCells, mesh_.evTable"), std::string::npos);
+}
+
+TEST(CudaIco, LevelsPerThread) {
+  using LocType = dawn::ast::LocationType;
+  dawn::iir::UnstructuredIIRBuilder b;
+  auto edge_f = b.field("edge_field", LocType::Edges);
+  auto cell_f = b.field("cell_field", LocType::Cells);
+  auto stencil = b.build(
+      "weighted",
+      b.stencil(b.multistage(
+          dawn::iir::LoopOrderKind::Parallel,
+          b.stage(
+              LocType::Edges,
+              b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                         b.stmt(b.assignExpr(
+                             b.at(edge_f), b.reduceOverNeighborExpr(
+                                               dawn::iir::Op::plus,
+                                               b.at(cell_f, dawn::iir::HOffsetType::withOffset, 0),
+                                               b.lit(0.), {LocType::Edges, LocType::Cells},
+                                               std::vector<double>({1., -1.})))))))));
+
+  dawn::codegen::Options options;
+  auto code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  EXPECT_NE(code.find("#define LEVELS_PER_THREAD 1"), std::string::npos);
+  EXPECT_EQ(code.find("nbhIdx_ecTable"), std::string::npos);
+
+  options.LevelsPerThread = 4;
+  code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  EXPECT_NE(code.find("#define LEVELS_PER_THREAD 4"), std::string::npos);
+  // neighbor indices and weights are loaded ahead of the k-loop ...
+  const auto kLoop = code.find("for(int kIter = klo; kIter < khi; kIter++)");
+  ASSERT_NE(kLoop, std::string::npos);
+  EXPECT_LT(code.find("int nbhIdx_ecTable[E_C_SIZE];"), kLoop);
+  EXPECT_LT(code.find("::dawn::float_type weights_"), kLoop);
+  // ... and reused on every level
+  EXPECT_NE(code.find("int nbhIdx = nbhIdx_ecTable[nbhIter];", kLoop), std::string::npos);
+  EXPECT_EQ(code.find("::dawn::float_type weights_", kLoop), std::string::npos);
+
+  options.LevelsPerThread = 0;
+  EXPECT_THROW(dawn::codegen::run(stencil, backend, options), std::runtime_error);
+}
+
+TEST(CudaIco, LevelsPerThreadWrittenWeights) {
+  using LocType = dawn::ast::LocationType;
+  dawn::iir::UnstructuredIIRBuilder b;
+  auto edge_f = b.field("edge_field", LocType::Edges);
+  auto cell_f = b.field("cell_field", LocType::Cells);
+  auto weight_f = b.field("weight_field", LocType::Edges, false);
+  auto stencil = b.build(
+      "weighted",
+      b.stencil(b.multistage(
+          dawn::iir::LoopOrderKind::Parallel,
+          b.stage(
+              LocType::Edges,
+              b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                         b.stmt(b.assignExpr(b.at(weight_f), b.lit(2.))),
+                         b.stmt(b.assignExpr(
+                             b.at(edge_f), b.reduceOverNeighborExpr(
+                                               dawn::iir::Op::plus,
+                                               b.at(cell_f, dawn::iir::HOffsetType::withOffset, 0),
+                                               b.lit(0.), {LocType::Edges, LocType::Cells},
+                                               std::vector<std::shared_ptr<dawn::ast::Expr>>(
+                                                   {b.at(weight_f), b.lit(-1.)})))))))));
+
+  dawn::codegen::Options options;
+  options.LevelsPerThread = 4;
+  auto code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  const auto kLoop = code.find("for(int kIter = klo; kIter < khi; kIter++)");
+  ASSERT_NE(kLoop, std::string::npos);
+  // the neighbor indices are still loaded ahead of the k-loop ...
+  EXPECT_LT(code.find("int nbhIdx_ecTable[E_C_SIZE];"), kLoop);
+  // ... but the weights read a field written by the stage, on every level
+  const auto weights = code.find("::dawn::float_type weights_");
+  ASSERT_NE(weights, std::string::npos);
+  EXPECT_GT(weights, kLoop);
+}
+
+TEST(CudaIco, PaddingMultiple) {
+  using LocType = dawn::ast::LocationType;
+  dawn::iir::UnstructuredIIRBuilder b;
+  auto edge_f = b.field("edge_field", LocType::Edges);
+  auto cell_f = b.field("cell_field", LocType::Cells);
+  auto stencil = b.build(
+      "padded", b.stencil(b.multistage(
+                    dawn::iir::LoopOrderKind::Parallel,
+                    b.stage(LocType::Edges,
+                            b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                                       b.stmt(b.assignExpr(
+                                           b.at(edge_f),
+                                           b.reduceOverNeighborExpr(
+                                               dawn::iir::Op::plus,
+                                               b.at(cell_f, dawn::iir::HOffsetType::withOffset, 0),
+                                               b.lit(0.), {LocType::Edges, LocType::Cells}))))))));
+
+  dawn::codegen::Options options;
+  auto code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  EXPECT_EQ(code.find("EdgeStride"), std::string::npos);
+
+  options.paddingEdges = 3;
+  options.paddingMultiple = 32;
+  code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  // the strides are computed once by the mesh ...
+  EXPECT_NE(code.find("EdgeStride = ::dawn::padded_size(NumEdges + 3, 32);"), std::string::npos);
+  // ... and passed to the kernels, which index all fields with them
+  EXPECT_NE(code.find("int CellStride, int EdgeStride"), std::string::npos);
+  EXPECT_NE(code.find("mesh_.CellStride, mesh_.EdgeStride"), std::string::npos);
+  EXPECT_NE(code.find("* EdgeStride + pidx]"), std::string::npos);
+  EXPECT_EQ(code.find("(NumEdges + 3)"), std::string::npos);
+}
+
+TEST(CudaIco, UnrollInteriorReductions) {
+  using LocType = dawn::ast::LocationType;
+  dawn::iir::UnstructuredIIRBuilder b;
+  auto edge_f = b.field("edge_field", LocType::Edges);
+  auto cell_f = b.field("cell_field", LocType::Cells);
+  auto vertex_f = b.field("vertex_field", LocType::Vertices);
+  auto stencil = b.build(
+      "interior",
+      b.stencil(b.multistage(
+          dawn::iir::LoopOrderKind::Parallel,
+          b.stage(
+              LocType::Edges,
+              b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                         b.stmt(b.assignExpr(
+                             b.at(edge_f), b.reduceOverNeighborExpr(
+                                               dawn::iir::Op::plus,
+                                               b.at(cell_f, dawn::iir::HOffsetType::withOffset, 0),
+                                               b.lit(0.), {LocType::Edges, LocType::Cells}))))),
+          b.stage(LocType::Vertices,
+                  b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                             b.stmt(b.assignExpr(
+                                 b.at(vertex_f),
+                                 b.reduceOverNeighborExpr(
+                                     dawn::iir::Op::plus,
+                                     b.at(edge_f, dawn::iir::HOffsetType::withOffset, 0), b.lit(0.),
+                                     {LocType::Vertices, LocType::Edges}))))))));
+
+  dawn::codegen::Options options;
+  auto code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  EXPECT_EQ(code.find("interiorLo"), std::string::npos);
+  EXPECT_EQ(code.find("#pragma unroll"), std::string::npos);
+
+  options.UnrollInteriorReductions = true;
+  code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  // the edges have two cells in the interior ...
+  EXPECT_NE(code.find("int kSize, int interiorLo,"), std::string::npos);
+  EXPECT_NE(code.find("const bool interior = pidx >= interiorLo && pidx < interiorHi;"),
+            std::string::npos);
+  EXPECT_NE(code.find("mesh_.Domain({::dawn::LocationType::Edges, "
+                      "dawn::UnstructuredSubdomain::Interior, 0}),"),
+            std::string::npos);
+  EXPECT_NE(code.find("mesh_.Domain({::dawn::LocationType::Edges, "
+                      "dawn::UnstructuredSubdomain::Halo, 0}),"),
+            std::string::npos);
+  const auto unrolled = code.find("#pragma unroll");
+  ASSERT_NE(unrolled, std::string::npos);
+  EXPECT_LT(code.find("if(interior)"), unrolled);
+  // ... while the pentagon points have five edges only
+  EXPECT_EQ(code.find("#pragma unroll", unrolled + 1), std::string::npos);
+  EXPECT_EQ(code.find("Domain({::dawn::LocationType::Vertices"), std::string::npos);
+}
+
+TEST(CudaIco, FusedReductions) {
+  auto code = dawn::codegen::generate(
+      dawn::codegen::run(dawn::getFusedReductionsStencil(), backend, dawn::codegen::Options()));
+  // both reductions accumulate in a single loop over the neighbors
+  const auto loop = code.find("for(int nbhIter = 0; nbhIter < E_C_SIZE; nbhIter++)");
+  ASSERT_NE(loop, std::string::npos);
+  EXPECT_EQ(code.find("for(int nbhIter = 0;", loop + 1), std::string::npos);
+  const auto accumulations = code.substr(loop, code.find("__local_red", loop) - loop);
+  EXPECT_NE(accumulations.find("+= cell_field["), std::string::npos);
+  EXPECT_NE(accumulations.find("[nbhIter] * cell2_field["), std::string::npos);
+}
+
 } // namespace
\ No newline at end of file
@@ -13,7 +13,9 @@
 //===------------------------------------------------------------------------------------------===//
 
 #include "UnstructuredStencils.h"
+#include "dawn/CodeGen/Driver.h"
 #include "dawn/CodeGen/Options.h"
+#include "dawn/Optimizer/PassLoopInvariantCodeMotion.h"
 #include "dawn/Serialization/IIRSerializer.h"
 
 #include <gtest/gtest.h>
@@ -25,4 +27,136 @@ constexpr auto backend = dawn::codegen::Backend::CXXNaiveIco;
 // NOTE: Often-changing backend. For the moment we prefer to test code generation through end-to-end
 // tests checking the output. To be reconsidered once this is stable.
 
+TEST(NaiveIco, UnrollInteriorReductions) {
+  using LocType = dawn::ast::LocationType;
+  dawn::iir::UnstructuredIIRBuilder b;
+  auto edge_f = b.field("edge_field", LocType::Edges);
+  auto cell_f = b.field("cell_field", LocType::Cells);
+  auto stencil = b.build(
+      "interior",
+      b.stencil(b.multistage(
+          dawn::iir::LoopOrderKind::Parallel,
+          b.stage(
+              LocType::Edges,
+              b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                         b.stmt(b.assignExpr(
+                             b.at(edge_f), b.reduceOverNeighborExpr(
+                                               dawn::iir::Op::plus,
+                                               b.at(cell_f, dawn::iir::HOffsetType::withOffset, 0),
+                                               b.lit(0.), {LocType::Edges, LocType::Cells}))))))));
+
+  dawn::codegen::Options options;
+  auto code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  EXPECT_EQ(code.find("complete_neighborhood"), std::string::npos);
+
+  options.UnrollInteriorReductions = true;
+  code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  // the loop over the edges is split at the interior, only the interior edges reduce over exactly
+  // two cells
+  const auto interiorLoop =
+      code.find("for(auto const& loc : getEdges(LibTag{}, m_mesh, interiorLo, interiorHi))");
+  ASSERT_NE(interiorLoop, std::string::npos);
+  EXPECT_LT(code.find("getEdges(LibTag{}, m_mesh, lo, interiorLo)"), interiorLoop);
+  EXPECT_GT(code.find("getEdges(LibTag{}, m_mesh, interiorHi, hi)"), interiorLoop);
+  const auto complete = code.find("reduce(LibTag{}, ::dawn::complete_neighborhood<2>{}");
+  EXPECT_GT(complete, interiorLoop);
+  EXPECT_EQ(code.rfind("complete_neighborhood"), code.find("complete_neighborhood"));
+}
+
+TEST(NaiveIco, SimdLevels) {
+  using LocType = dawn::ast::LocationType;
+  auto makeStencil = [](dawn::iir::LoopOrderKind loopOrder) {
+    dawn::iir::UnstructuredIIRBuilder b;
+    auto edge_f = b.field("edge_field", LocType::Edges);
+    auto cell_f = b.field("cell_field", LocType::Cells);
+    return b.build(
+        "simd", b.stencil(b.multistage(
+                    loopOrder,
+                    b.stage(LocType::Edges,
+                            b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                                       b.stmt(b.assignExpr(
+                                           b.at(edge_f),
+                                           b.reduceOverNeighborExpr(
+                                               dawn::iir::Op::plus,
+                                               b.at(cell_f, dawn::iir::HOffsetType::withOffset, 0),
+                                               b.lit(0.), {LocType::Edges, LocType::Cells}))))))));
+  };
+
+  dawn::codegen::Options options;
+  options.SimdWidth = 4;
+  auto code = dawn::codegen::generate(
+      dawn::codegen::run(makeStencil(dawn::iir::LoopOrderKind::Parallel), backend, options));
+  EXPECT_NE(code.find("#include <driver-includes/unstructured_simd.hpp>"), std::string::npos);
+  // four levels at once, followed by the remaining levels in scalar code
+  const auto simdLoop = code.find("for(int k = 0; k + 3 <= ");
+  ASSERT_NE(simdLoop, std::string::npos);
+  const auto scalarLoop = code.find("for(int k = 0 + (");
+  ASSERT_NE(scalarLoop, std::string::npos);
+  EXPECT_LT(simdLoop, scalarLoop);
+  const std::string simdBody = code.substr(simdLoop, scalarLoop - simdLoop);
+  EXPECT_NE(simdBody.find("::dawn::simd_ref<4>("), std::string::npos);
+  EXPECT_NE(simdBody.find("return m_edge_field(deref(LibTag{}, loc), (k + 0 + lane));"),
+            std::string::npos);
+  EXPECT_NE(simdBody.find("::dawn::float_simd<4>((::dawn::float_type)0"), std::string::npos);
+  EXPECT_NE(simdBody.find("::dawn::simd_load<4>("), std::string::npos);
+  EXPECT_NE(simdBody.find("return m_cell_field(deref(LibTag{}, red_loc1), (k + 0 + lane));"),
+            std::string::npos);
+  EXPECT_EQ(code.find("::dawn::simd_", scalarLoop), std::string::npos);
+
+  // the levels of forward and backward multi-stages depend on each other
+  code = dawn::codegen::generate(
+      dawn::codegen::run(makeStencil(dawn::iir::LoopOrderKind::Forward), backend, options));
+  EXPECT_EQ(code.find("float_simd"), std::string::npos);
+  EXPECT_EQ(code.find("k + 3"), std::string::npos);
+}
+
+TEST(NaiveIco, HoistLoopInvariants) {
+  using LocType = dawn::ast::LocationType;
+  dawn::iir::UnstructuredIIRBuilder b;
+  auto in_f = b.field("in_field", LocType::Edges);
+  auto out_f = b.field("out_field", LocType::Edges);
+  auto v_f = b.vertical_field("v_field");
+  auto coeff = b.globalvar("coeff", 2.);
+  auto stencil = b.build(
+      "hoisting",
+      b.stencil(b.multistage(
+          dawn::iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                             b.stmt(b.assignExpr(b.at(out_f),
+                                                 b.binaryExpr(b.at(in_f),
+                                                              b.binaryExpr(b.at(coeff), b.at(v_f),
+                                                                           dawn::iir::Op::multiply),
+                                                              dawn::iir::Op::multiply))))))));
+
+  dawn::PassLoopInvariantCodeMotion pass;
+  ASSERT_TRUE(pass.run(stencil));
+
+  auto code = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+  // `coeff * v_field` is computed once per k-level, before the loop over the edges
+  const auto declaration = code.find("const ::dawn::float_type __local_licm");
+  const auto loop = code.find("for(auto const& loc : getEdges(LibTag{}, m_mesh))");
+  ASSERT_NE(declaration, std::string::npos);
+  ASSERT_NE(loop, std::string::npos);
+  EXPECT_LT(code.find("for(int k = "), declaration);
+  EXPECT_LT(declaration, loop);
+  const std::string loopBody = code.substr(loop, code.find("}\n", loop) - loop);
+  EXPECT_NE(loopBody.find("__local_licm"), std::string::npos);
+  EXPECT_EQ(loopBody.find("m_globals.coeff"), std::string::npos);
+}
+
+TEST(NaiveIco, FusedReductions) {
+  auto code = dawn::codegen::generate(
+      dawn::codegen::run(dawn::getFusedReductionsStencil(), backend, dawn::codegen::Options()));
+  // both reductions accumulate in a single call to reduce
+  const auto reduce = code.find("reduce(LibTag{}");
+  ASSERT_NE(reduce, std::string::npos);
+  EXPECT_EQ(code.find("reduce(LibTag{}", reduce + 1), std::string::npos);
+  EXPECT_NE(code.find("weights_"), std::string::npos);
+  const auto accumulations = code.substr(reduce, code.find("return lhs;", reduce) - reduce);
+  EXPECT_NE(accumulations.find("+= m_cell_field("), std::string::npos);
+  EXPECT_NE(accumulations.find("[sparse_dimension_idx0] *"), std::string::npos);
+  EXPECT_NE(accumulations.find("m_cell2_field("), std::string::npos);
+}
+
 } // namespace
\ No newline at end of file
@@ -13,11 +13,21 @@
 //===------------------------------------------------------------------------------------------===//
 
 #include "Stencils.h"
+#include "dawn/CodeGen/Driver.h"
 #include "dawn/CodeGen/Options.h"
+#include "dawn/Optimizer/PassLoopInvariantCodeMotion.h"
+#include "dawn/Optimizer/PassTemporaryDimensionReduction.h"
+#include "dawn/SIR/AST.h"
+#include "dawn/SIR/ASTStmt.h"
+#include "dawn/SIR/SIR.h"
 #include "dawn/Serialization/IIRSerializer.h"
+#include "dawn/Support/Logger.h"
+#include "dawn/Unittest/IIRBuilder.h"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 namespace {
 
 constexpr auto backend = dawn::codegen::Backend::CXXNaive;
@@ -44,4 +54,397 @@ TEST(Naive, DzCStencil) {
           "reference/update_dz_c.cpp");
 }
 
+TEST(Naive, VerticalSweepStencil) {
+  // forward sweeps are computed column by column, i.e. with the k-loop innermost
+  auto tu = dawn::codegen::run(dawn::getVerticalSweepStencil(), backend);
+  const std::string code = dawn::codegen::generate(tu);
+
+  const auto iLoop = code.find("for(int i = iMin + 0;");
+  const auto jLoop = code.find("for(int j = jMin + 0;", iLoop);
+  const auto kLoop = code.find("for(int k = kMin + 1 + 0; k <= kMax + 0 + 0; ++k)", jLoop);
+  ASSERT_NE(iLoop, std::string::npos);
+  ASSERT_NE(jLoop, std::string::npos);
+  ASSERT_NE(kLoop, std::string::npos);
+}
+
+TEST(Naive, VerticalSweepWithHorizontalDependency) {
+  // the second stage reads `tmp`, which is computed within the multi-stage, at a horizontal
+  // offset, hence all columns have to be computed level by level
+  dawn::UIDGenerator::getInstance()->reset();
+  dawn::iir::CartesianIIRBuilder b;
+  auto in = b.field("in", dawn::iir::FieldType::ijk);
+  auto tmp = b.field("tmp", dawn::iir::FieldType::ijk);
+  auto out = b.field("out", dawn::iir::FieldType::ijk);
+  auto stencil = b.build(
+      "generated",
+      b.stencil(b.multistage(
+          dawn::iir::LoopOrderKind::Forward,
+          b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                             b.stmt(b.assignExpr(b.at(tmp, dawn::iir::AccessType::rw),
+                                                 b.at(in))))),
+          b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                             b.stmt(b.assignExpr(b.at(out, dawn::iir::AccessType::rw),
+                                                 b.at(tmp, {1, 0, 0}))))))));
+
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+  const auto kLoop = code.find("for(int k = ");
+  ASSERT_NE(kLoop, std::string::npos);
+  EXPECT_LT(kLoop, code.find("for(int i = "));
+}
+
+TEST(Naive, HoistLoopInvariants) {
+  dawn::UIDGenerator::getInstance()->reset();
+  dawn::iir::CartesianIIRBuilder b;
+  auto in = b.field("in", dawn::iir::FieldType::ijk);
+  auto out = b.field("out", dawn::iir::FieldType::ijk);
+  auto coeff = b.globalvar("coeff", 2.);
+  auto stencil = b.build(
+      "generated",
+      b.stencil(b.multistage(
+          dawn::iir::LoopOrderKind::Parallel,
+          b.stage(b.doMethod(
+              dawn::ast::Interval::Start, dawn::ast::Interval::End,
+              b.stmt(b.assignExpr(b.at(out), b.binaryExpr(b.at(in),
+                                                          b.binaryExpr(b.at(coeff), b.lit(0.5),
+                                                                       dawn::iir::Op::multiply),
+                                                          dawn::iir::Op::multiply))))))));
+
+  dawn::PassLoopInvariantCodeMotion pass;
+  ASSERT_TRUE(pass.run(stencil));
+
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+  // `coeff * 0.5` is computed once per k-level, before the horizontal loops
+  const auto kLoop = code.find("for(int k = ");
+  const auto declaration = code.find("const ::dawn::float_type __local_licm", kLoop);
+  const auto iLoop = code.find("for(int i = ", kLoop);
+  ASSERT_NE(kLoop, std::string::npos);
+  ASSERT_NE(declaration, std::string::npos);
+  EXPECT_LT(declaration, iLoop);
+  const std::string loopBody = code.substr(iLoop, code.find("}\n", iLoop) - iLoop);
+  EXPECT_NE(loopBody.find("__local_licm"), std::string::npos);
+  EXPECT_EQ(loopBody.find("m_globals.coeff"), std::string::npos);
+}
+
+TEST(Naive, TemporaryArena) {
+  using namespace dawn::iir;
+  dawn::UIDGenerator::getInstance()->reset();
+  CartesianIIRBuilder b;
+  auto in = b.field("in", FieldType::ijk);
+  auto out = b.field("out", FieldType::ijk);
+  auto tmpA = b.tmpField("tmp_a", FieldType::ijk);
+  auto tmpB = b.tmpField("tmp_b", FieldType::ijk);
+  auto doMethod = [&](std::shared_ptr<dawn::ast::Stmt> stmt) {
+    return b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End, stmt);
+  };
+  // the lifetimes of `tmp_a` (first two multi-stages) and `tmp_b` (last two) are disjoint
+  auto stencil = b.build(
+      "generated",
+      b.stencil(b.multistage(LoopOrderKind::Forward,
+                             b.stage(doMethod(b.stmt(b.assignExpr(b.at(tmpA), b.at(in)))))),
+                b.multistage(LoopOrderKind::Backward,
+                             b.stage(doMethod(b.stmt(b.assignExpr(b.at(out), b.at(tmpA)))))),
+                b.multistage(LoopOrderKind::Forward,
+                             b.stage(doMethod(b.stmt(b.assignExpr(b.at(tmpB), b.at(out)))))),
+                b.multistage(LoopOrderKind::Backward,
+                             b.stage(doMethod(b.stmt(b.assignExpr(b.at(out), b.at(tmpB))))))));
+
+  dawn::codegen::Options options;
+  options.TemporaryArena = true;
+  dawn::log::info.clear();
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+
+  // one slot of the arena is shared by both temporaries
+  EXPECT_TRUE(
+      std::any_of(dawn::log::info.begin(), dawn::log::info.end(), [](const std::string& msg) {
+        return msg.find("reduced from 16 to 8 bytes per grid point") != std::string::npos;
+      }));
+  EXPECT_NE(code.find("m_tmp_arena(1 * tmp_slot_size(dom))"), std::string::npos);
+  EXPECT_NE(code.find("m___tmp_tmp_a_3(m_tmp_meta_data, tmp_arena + 0 * tmp_slot_size"),
+            std::string::npos);
+  EXPECT_NE(code.find("m___tmp_tmp_b_4(m_tmp_meta_data, tmp_arena + 0 * tmp_slot_size"),
+            std::string::npos);
+  EXPECT_NE(code.find("static std::size_t tmp_storage_size("), std::string::npos);
+  EXPECT_NE(code.find("static std::size_t tmp_slot_size("), std::string::npos);
+  EXPECT_NE(code.find("std::size_t tmp_slot_size)"), std::string::npos);
+
+  // without the option, each temporary owns its storage
+  const std::string reference = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+  EXPECT_EQ(reference.find("m_tmp_arena"), std::string::npos);
+}
+
+TEST(Naive, TemporaryDimensionReduction) {
+  using namespace dawn::iir;
+  dawn::UIDGenerator::getInstance()->reset();
+  CartesianIIRBuilder b;
+  auto in = b.field("in", FieldType::ijk);
+  auto out = b.field("out", FieldType::ijk);
+  auto lap = b.tmpField("lap", FieldType::ijk);
+  auto prev = b.tmpField("prev", FieldType::ijk);
+  // forward: lap = in; prev = in; out = lap[i+1] + prev[k-1]
+  auto stencil =
+      b.build("generated",
+              b.stencil(b.multistage(
+                  LoopOrderKind::Forward,
+                  b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                                     b.stmt(b.assignExpr(b.at(lap), b.at(in))),
+                                     b.stmt(b.assignExpr(b.at(prev), b.at(in))))),
+                  b.stage(b.doMethod(
+                      dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                      b.stmt(b.assignExpr(b.at(out), b.binaryExpr(b.at(lap, {1, 0, 0}),
+                                                                  b.at(prev, {0, 0, -1})))))))));
+
+  dawn::PassTemporaryDimensionReduction pass;
+  ASSERT_TRUE(pass.run(stencil));
+
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+  // `lap` is stored in a single ij-plane, `prev` in two planes used alternately
+  EXPECT_NE(code.find("m_tmp_window_meta_data_1(dom_.isize() + 1, dom_.jsize(), 1)"),
+            std::string::npos);
+  EXPECT_NE(code.find("m_tmp_window_meta_data_2(dom_.isize() + 1, dom_.jsize(), 2)"),
+            std::string::npos);
+  EXPECT_NE(code.find("__tmp_lap_3(i + 1, j + 0, 0)"), std::string::npos);
+  EXPECT_NE(code.find("__tmp_prev_4(i + 0, j + 0, ((k + -1) % 2 + 2) % 2)"), std::string::npos);
+}
+
+TEST(Naive, FixedDomainSize) {
+  using namespace dawn::iir;
+  CartesianIIRBuilder b;
+  auto in = b.field("in", FieldType::ijk);
+  auto out = b.field("out", FieldType::ijk);
+  auto stencil = b.build(
+      "generated", b.stencil(b.multistage(
+                       LoopOrderKind::Parallel,
+                       b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                                          b.stmt(b.assignExpr(b.at(out), b.at(in, {1, 0, 0}))))))));
+
+  dawn::codegen::Options options;
+  options.DomainSizeI = 64;
+  options.DomainSizeJ = 32;
+  options.DomainSizeK = 80;
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+
+  EXPECT_NE(code.find("constexpr int iMax = 63 - GRIDTOOLS_DAWN_HALO_EXTENT;"), std::string::npos);
+  EXPECT_NE(code.find("constexpr int jMax = 31 - GRIDTOOLS_DAWN_HALO_EXTENT;"), std::string::npos);
+  EXPECT_NE(code.find("constexpr int kMax = 79;"), std::string::npos);
+  EXPECT_NE(code.find("assert(dom.isize() == 64 && dom.jsize() == 32 && dom.ksize() == 80);"),
+            std::string::npos);
+
+  // the bounds are computed at runtime unless all sizes are set
+  options.DomainSizeK = 0;
+  const std::string reference =
+      dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+  EXPECT_EQ(reference.find("constexpr int"), std::string::npos);
+  EXPECT_NE(reference.find("int kMax = m_dom.ksize() - m_dom.kplus() - 1;"), std::string::npos);
+}
+
+TEST(Naive, MixedPrecision) {
+  using namespace dawn::iir;
+  dawn::UIDGenerator::getInstance()->reset();
+  CartesianIIRBuilder b;
+  auto in = b.field("in", FieldType::ijk, dawn::ast::FieldPrecision::Single);
+  auto out = b.field("out", FieldType::ijk);
+  auto tmp = b.tmpField("tmp", FieldType::ijk, dawn::ast::FieldPrecision::Single);
+  auto stencil =
+      b.build("generated",
+              b.stencil(b.multistage(
+                  LoopOrderKind::Parallel,
+                  b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                                     b.stmt(b.assignExpr(b.at(tmp), b.at(in))))),
+                  b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                                     b.stmt(b.assignExpr(b.at(out), b.at(tmp, {1, 0, 0}))))))));
+
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+
+  // single precision storages
+  EXPECT_NE(code.find("storage_ijk_float_t& in_"), std::string::npos);
+  EXPECT_NE(code.find("storage_ijk_t& out_"), std::string::npos);
+  EXPECT_NE(code.find("using tmp_storage_float_t ="), std::string::npos);
+  EXPECT_NE(code.find("tmp_storage_float_t m___tmp_tmp_3;"), std::string::npos);
+  // explicit conversions from and to the precision of the computation
+  EXPECT_NE(
+      code.find("static_cast<float>(static_cast<::dawn::float_type>(in(i + 0, j + 0, k + 0)));"),
+      std::string::npos);
+  EXPECT_NE(code.find("static_cast<::dawn::float_type>(__tmp_tmp_3(i + 1, j + 0, k + 0));"),
+            std::string::npos);
+}
+
+TEST(Naive, MixedPrecisionCompoundAssignment) {
+  using namespace dawn::iir;
+  dawn::UIDGenerator::getInstance()->reset();
+  CartesianIIRBuilder b;
+  auto in = b.field("in", FieldType::ijk);
+  auto out = b.field("out", FieldType::ijk, dawn::ast::FieldPrecision::Single);
+  auto stencil =
+      b.build("generated",
+              b.stencil(b.multistage(
+                  LoopOrderKind::Parallel,
+                  b.stage(b.doMethod(
+                      dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                      b.stmt(b.assignExpr(b.at(out, AccessType::rw), b.at(in), Op::plus)))))));
+
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+
+  // the addition is carried out in the precision of the computation
+  EXPECT_NE(code.find("out(i + 0, j + 0, k + 0) = "
+                      "static_cast<float>(static_cast<::dawn::float_type>(out(i + 0, j + 0, k + "
+                      "0)) + (in(i + 0, j + 0, k + 0)));"),
+            std::string::npos);
+  EXPECT_EQ(code.find("out(i + 0, j + 0, k + 0) +="), std::string::npos);
+}
+
+TEST(Naive, FusedBoundaryCondition) {
+  using namespace dawn::iir;
+  dawn::UIDGenerator::getInstance()->reset();
+  CartesianIIRBuilder b;
+  auto in = b.field("in", FieldType::ijk);
+  auto out = b.field("out", FieldType::ijk);
+  auto stencil = b.build(
+      "generated", b.stencil(b.multistage(
+                       LoopOrderKind::Parallel,
+                       b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                                          b.stmt(b.assignExpr(b.at(out), b.at(in))))))));
+
+  // boundary_condition(zero(), out) with zero(f) { f = 0.0; }
+  auto zero = std::make_shared<dawn::sir::StencilFunction>();
+  zero->Name = "zero";
+  zero->Args.push_back(std::make_shared<dawn::sir::Field>(
+      "f", dawn::ast::FieldDimensions(
+               dawn::ast::HorizontalFieldDimension(dawn::ast::cartesian, {true, true}), true)));
+  zero->Asts.push_back(std::make_shared<dawn::ast::AST>(
+      dawn::sir::makeBlockStmt(std::vector<std::shared_ptr<dawn::ast::Stmt>>{
+          dawn::sir::makeExprStmt(std::make_shared<dawn::ast::AssignmentExpr>(
+              std::make_shared<dawn::ast::FieldAccessExpr>(
+                  "f", dawn::ast::Offsets(dawn::ast::cartesian, 0, 0, 0)),
+              std::make_shared<dawn::ast::LiteralAccessExpr>("0.0",
+                                                             dawn::BuiltinTypeID::Double)))})));
+  stencil->getIIR()->insertStencilFunction(zero);
+  auto bc = makeBoundaryConditionDeclStmt("zero");
+  bc->getFields().push_back("out");
+  stencil->getMetaData().addFieldBC("out", bc);
+
+  dawn::codegen::Options options;
+  options.FuseBoundaryConditions = true;
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend, options));
+
+  EXPECT_NE(code.find("struct zero"), std::string::npos);
+  // the boundary region of each k-level is updated after the level is computed
+  const auto kLoop = code.find("for(int k = kMin + 0 + 0; k <= kMax + 0 + 0; ++k)");
+  const auto stage = code.find("out(i + 0, j + 0, k + 0) = in(i + 0, j + 0, k + 0);", kLoop);
+  const auto boundary =
+      code.find("for(int i = iMin - m_dom.iminus(); i <= iMax + m_dom.iplus(); ++i)", stage);
+  const auto apply = code.find("zero()(0, out, i, j, k);", boundary);
+  ASSERT_NE(kLoop, std::string::npos);
+  ASSERT_NE(stage, std::string::npos);
+  ASSERT_NE(boundary, std::string::npos);
+  ASSERT_NE(apply, std::string::npos);
+  EXPECT_EQ(code.find("for(int k", stage), std::string::npos);
+
+  // the boundary conditions are not applied by the cxx backends otherwise
+  const std::string reference = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+  EXPECT_EQ(reference.find("zero()("), std::string::npos);
+}
+
+TEST(Naive, FusedBoundaryConditionReadingLaterField) {
+  using namespace dawn::iir;
+  auto makeStencil = [](bool otherWrittenLast) {
+    dawn::UIDGenerator::getInstance()->reset();
+    CartesianIIRBuilder b;
+    auto in = b.field("in", FieldType::ijk);
+    auto out = b.field("out", FieldType::ijk);
+    auto other = b.field("other", FieldType::ijk);
+    auto multiStage = [&](IIRBuilder::Field const& field) {
+      return b.multistage(
+          LoopOrderKind::Parallel,
+          b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                             b.stmt(b.assignExpr(b.at(field), b.at(in))))));
+    };
+    auto stencil = otherWrittenLast
+                       ? b.build("generated", b.stencil(multiStage(out), multiStage(other)))
+                       : b.build("generated", b.stencil(multiStage(other), multiStage(out)));
+
+    // boundary_condition(copy(), out, other) with copy(f, g) { f = g; }
+    auto fieldArg = [](const std::string& name) {
+      return std::make_shared<dawn::sir::Field>(
+          name, dawn::ast::FieldDimensions(
+                    dawn::ast::HorizontalFieldDimension(dawn::ast::cartesian, {true, true}), true));
+    };
+    auto copy = std::make_shared<dawn::sir::StencilFunction>();
+    copy->Name = "copy";
+    copy->Args.push_back(fieldArg("f"));
+    copy->Args.push_back(fieldArg("g"));
+    copy->Asts.push_back(std::make_shared<dawn::ast::AST>(
+        dawn::sir::makeBlockStmt(std::vector<std::shared_ptr<dawn::ast::Stmt>>{
+            dawn::sir::makeExprStmt(std::make_shared<dawn::ast::AssignmentExpr>(
+                std::make_shared<dawn::ast::FieldAccessExpr>(
+                    "f", dawn::ast::Offsets(dawn::ast::cartesian, 0, 0, 0)),
+                std::make_shared<dawn::ast::FieldAccessExpr>(
+                    "g", dawn::ast::Offsets(dawn::ast::cartesian, 0, 0, 0))))})));
+    stencil->getIIR()->insertStencilFunction(copy);
+    auto bc = makeBoundaryConditionDeclStmt("copy");
+    bc->getFields().push_back("out");
+    bc->getFields().push_back("other");
+    stencil->getMetaData().addFieldBC("out", bc);
+    return stencil;
+  };
+
+  dawn::codegen::Options options;
+  options.FuseBoundaryConditions = true;
+
+  // `other` is final when `out` is produced
+  const std::string fused =
+      dawn::codegen::generate(dawn::codegen::run(makeStencil(false), backend, options));
+  EXPECT_NE(fused.find("copy()(0, out, other, i, j, k);"), std::string::npos);
+
+  // the functor would read `other` before the last multi-stage writes it
+  const std::string stale =
+      dawn::codegen::generate(dawn::codegen::run(makeStencil(true), backend, options));
+  EXPECT_EQ(stale.find("copy()("), std::string::npos);
+}
+
+TEST(Naive, HaloExchange) {
+  using namespace dawn::iir;
+  dawn::UIDGenerator::getInstance()->reset();
+  CartesianIIRBuilder b;
+  auto in = b.field("in", FieldType::ijk);
+  auto mid = b.field("mid", FieldType::ijk);
+  auto other = b.field("other", FieldType::ijk);
+  auto out = b.field("out", FieldType::ijk);
+  auto doMethod = [&](std::shared_ptr<dawn::ast::Stmt> stmt) {
+    return b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End, stmt);
+  };
+  // `mid` is produced by the first multi-stage and its halo is read by the last one
+  auto stencil = b.build(
+      "generated",
+      b.stencil(
+          b.multistage(LoopOrderKind::Parallel,
+                       b.stage(doMethod(b.stmt(b.assignExpr(b.at(mid), b.at(in, {-1, 0, 0})))))),
+          b.multistage(LoopOrderKind::Parallel,
+                       b.stage(doMethod(b.stmt(b.assignExpr(b.at(other), b.at(in)))))),
+          b.multistage(LoopOrderKind::Parallel,
+                       b.stage(doMethod(b.stmt(b.assignExpr(b.at(out), b.at(mid, {0, 1, 0}))))))));
+
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+
+  // the exchange is started after the first multi-stage and only completed before the last one
+  const auto midLoop = code.find("mid(i + 0, j + 0, k + 0) =");
+  const auto start =
+      code.find("m_haloExchange.start_exchange({\"mid\", {{{0, 0}, {0, 1}, {0, 0}}}})");
+  const auto otherLoop = code.find("other(i + 0, j + 0, k + 0) =");
+  const auto wait =
+      code.find("m_haloExchange.wait_exchange({\"mid\", {{{0, 0}, {0, 1}, {0, 0}}}})");
+  const auto outLoop = code.find("out(i + 0, j + 0, k + 0) =");
+  ASSERT_NE(midLoop, std::string::npos);
+  ASSERT_NE(start, std::string::npos);
+  ASSERT_NE(otherLoop, std::string::npos);
+  ASSERT_NE(wait, std::string::npos);
+  ASSERT_NE(outLoop, std::string::npos);
+  EXPECT_LT(midLoop, start);
+  EXPECT_LT(start, otherLoop);
+  EXPECT_LT(otherLoop, wait);
+  EXPECT_LT(wait, outLoop);
+
+  // the halo of the input is not exchanged
+  EXPECT_EQ(code.find("_exchange({\"in\""), std::string::npos);
+}
+
 } // namespace
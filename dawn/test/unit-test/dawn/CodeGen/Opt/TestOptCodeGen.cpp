@@ -13,8 +13,10 @@
 //===------------------------------------------------------------------------------------------===//
 
 #include "Stencils.h"
+#include "dawn/CodeGen/Driver.h"
 #include "dawn/CodeGen/Options.h"
 #include "dawn/Serialization/IIRSerializer.h"
+#include "dawn/Unittest/IIRBuilder.h"
 
 #include <gtest/gtest.h>
 
@@ -26,4 +28,44 @@ TEST(Opt, LaplacianStencil) {
   runTest(dawn::getLaplacianStencil(), backend, "reference/laplacian_stencil_opt.cpp");
 }
 
+TEST(Opt, VerticalSweepStencil) {
+  // forward sweeps are computed column by column and the columns are distributed among threads
+  auto tu = dawn::codegen::run(dawn::getVerticalSweepStencil(), backend);
+  const std::string code = dawn::codegen::generate(tu);
+
+  const auto parallelLoop = code.find("#pragma omp parallel for");
+  ASSERT_NE(parallelLoop, std::string::npos);
+  const auto iLoop = code.find("for(int", parallelLoop);
+  ASSERT_EQ(iLoop, code.find("for(int i = iMin + 0;", parallelLoop));
+  const auto jLoop = code.find("for(int j = jMin + 0;", iLoop);
+  const auto kLoop = code.find("for(int k = kMin + 1 + 0; k <= kMax + 0 + 0; ++k)", jLoop);
+  ASSERT_NE(jLoop, std::string::npos);
+  ASSERT_NE(kLoop, std::string::npos);
+}
+
+TEST(Opt, VerticalSweepWithHorizontalDependency) {
+  // the second stage reads `tmp`, which is computed within the multi-stage, at a horizontal
+  // offset, hence all columns have to be computed level by level
+  dawn::UIDGenerator::getInstance()->reset();
+  dawn::iir::CartesianIIRBuilder b;
+  auto in = b.field("in", dawn::iir::FieldType::ijk);
+  auto tmp = b.field("tmp", dawn::iir::FieldType::ijk);
+  auto out = b.field("out", dawn::iir::FieldType::ijk);
+  auto stencil = b.build(
+      "generated",
+      b.stencil(b.multistage(
+          dawn::iir::LoopOrderKind::Forward,
+          b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                             b.stmt(b.assignExpr(b.at(tmp, dawn::iir::AccessType::rw),
+                                                 b.at(in))))),
+          b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                             b.stmt(b.assignExpr(b.at(out, dawn::iir::AccessType::rw),
+                                                 b.at(tmp, {1, 0, 0}))))))));
+
+  const std::string code = dawn::codegen::generate(dawn::codegen::run(stencil, backend));
+  const auto kLoop = code.find("for(int k = ");
+  ASSERT_NE(kLoop, std::string::npos);
+  EXPECT_LT(kLoop, code.find("for(int i = "));
+}
+
 } // namespace
@@ -109,6 +109,26 @@ std::shared_ptr<iir::StencilInstantiation> getNonOverlappingInterval() {
   return stencilInstantiation;
 }
 
+std::shared_ptr<iir::StencilInstantiation> getVerticalSweepStencil() {
+  UIDGenerator::getInstance()->reset();
+
+  iir::CartesianIIRBuilder b;
+  auto in = b.field("in", iir::FieldType::ijk);
+  auto out = b.field("out", iir::FieldType::ijk);
+
+  auto stencilInstantiation = b.build(
+      "generated",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Forward,
+          b.stage(b.doMethod(AInterval::Start, AInterval::End, 1, 0,
+                             b.block(b.stmt(b.assignExpr(
+                                 b.at(out, iir::AccessType::rw),
+                                 b.binaryExpr(b.at(out, {0, 0, -1}), b.at(in, {1, 0, 0}),
+                                              iir::Op::plus)))))))));
+
+  return stencilInstantiation;
+}
+
 void runTest(const std::shared_ptr<iir::StencilInstantiation> stencilInstantiation,
              codegen::Backend backend, const std::string& refFile, bool withSync) {
   dawn::codegen::Options options;
@@ -23,6 +23,7 @@ namespace dawn {
 std::shared_ptr<iir::StencilInstantiation> getGlobalIndexStencil();
 std::shared_ptr<iir::StencilInstantiation> getLaplacianStencil();
 std::shared_ptr<iir::StencilInstantiation> getNonOverlappingInterval();
+std::shared_ptr<iir::StencilInstantiation> getVerticalSweepStencil();
 
 void runTest(const std::shared_ptr<dawn::iir::StencilInstantiation> stencilInstantiation,
              codegen::Backend backend, const std::string& ref_file, bool withSync = true);
@@ -1,6 +1,8 @@
 #include "UnstructuredStencils.h"
 #include "dawn/AST/LocationType.h"
 #include "dawn/CodeGen/Driver.h"
+#include "dawn/Optimizer/PassLocalVarType.h"
+#include "dawn/Optimizer/PassReductionFusion.h"
 #include "dawn/Unittest/IIRBuilder.h"
 
 #include <gtest/gtest.h>
@@ -41,6 +43,45 @@ std::shared_ptr<iir::StencilInstantiation> getReductionsStencil() {
   return stencilInstantiation;
 }
 
+std::shared_ptr<iir::StencilInstantiation> getFusedReductionsStencil() {
+  UIDGenerator::getInstance()->reset();
+
+  using namespace dawn::iir;
+  using LocType = dawn::ast::LocationType;
+
+  iir::UnstructuredIIRBuilder b;
+  auto out1_f = b.field("out1_field", LocType::Edges);
+  auto out2_f = b.field("out2_field", LocType::Edges);
+  auto cell_f = b.field("cell_field", LocType::Cells);
+  auto cell2_f = b.field("cell2_field", LocType::Cells);
+
+  auto stencilInstantiation = b.build(
+      "fused_reductions",
+      b.stencil(b.multistage(
+          LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(
+                      dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                      b.stmt(b.assignExpr(
+                          b.at(out1_f), b.reduceOverNeighborExpr(
+                                            iir::Op::plus, b.at(cell_f, HOffsetType::withOffset, 0),
+                                            b.lit(0.), {LocType::Edges, LocType::Cells}))),
+                      b.stmt(b.assignExpr(
+                          b.at(out2_f),
+                          b.binaryExpr(b.lit(2.),
+                                       b.reduceOverNeighborExpr(
+                                           iir::Op::plus, b.at(cell2_f, HOffsetType::withOffset, 0),
+                                           b.lit(0.), {LocType::Edges, LocType::Cells},
+                                           std::vector<double>({1., -1.})),
+                                       iir::Op::multiply))))))));
+
+  PassReductionFusion passReductionFusion;
+  passReductionFusion.run(stencilInstantiation);
+  PassLocalVarType passLocalVarType;
+  passLocalVarType.run(stencilInstantiation);
+  return stencilInstantiation;
+}
+
 void runTest(const std::shared_ptr<iir::StencilInstantiation> stencilInstantiation,
              codegen::Backend backend, const std::string& refFile) {
   dawn::codegen::Options options;
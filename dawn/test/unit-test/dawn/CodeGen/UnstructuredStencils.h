@@ -23,6 +23,10 @@ namespace dawn {
 
 std::shared_ptr<iir::StencilInstantiation> getReductionsStencil();
 
+/// Two reductions over the edge-cell neighbors in separate statements, grouped by
+/// `PassReductionFusion`
+std::shared_ptr<iir::StencilInstantiation> getFusedReductionsStencil();
+
 void runTest(const std::shared_ptr<iir::StencilInstantiation> stencilInstantiation,
              codegen::Backend backend, const std::string& refFile);
 
@@ -73,6 +73,16 @@ private:
           globalOffsets({computeGlobalOffsets(rank, m_dom, xcols, ycols)}) {}
     static constexpr ::dawn::driver::cartesian_extent in_field_extent = {0, 0, 0, 0, 0, 0};
     static constexpr ::dawn::driver::cartesian_extent out_field_extent = {0, 0, 0, 0, 0, 0};
+    ::dawn::driver::halo_exchange_hooks m_haloExchange;
+
+    void set_halo_exchange(const ::dawn::driver::halo_exchange_hooks& haloExchange) {
+      m_haloExchange = haloExchange;
+    }
+
+    static std::vector<::dawn::driver::halo_region> halo_regions(int multiStageIdx) {
+      std::vector<::dawn::driver::halo_region> regions;
+      return regions;
+    }
 
     void run(storage_ijk_t& in_field_, storage_ijk_t& out_field_) {
       int iMin = m_dom.iminus();
@@ -126,6 +136,10 @@ public:
     assert(dom.ksize() >= 1);
   }
 
+  void set_halo_exchange(const ::dawn::driver::halo_exchange_hooks& haloExchange) {
+    m_stencil_28.set_halo_exchange(haloExchange);
+  }
+
   void run(storage_ijk_t in_field, storage_ijk_t out_field) {
     m_stencil_28.run(in_field, out_field);
   }
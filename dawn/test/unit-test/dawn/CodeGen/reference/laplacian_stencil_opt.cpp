@@ -58,6 +58,19 @@ private:
     stencil_47(const gridtools::dawn::domain& dom_, int rank, int xcols, int ycols) : m_dom(dom_) {}
     static constexpr ::dawn::driver::cartesian_extent in_extent = {-1, 1, -1, 1, 0, 0};
     static constexpr ::dawn::driver::cartesian_extent out_extent = {0, 0, 0, 0, 0, 0};
+    ::dawn::driver::halo_exchange_hooks m_haloExchange;
+
+    void set_halo_exchange(const ::dawn::driver::halo_exchange_hooks& haloExchange) {
+      m_haloExchange = haloExchange;
+    }
+
+    static std::vector<::dawn::driver::halo_region> halo_regions(int multiStageIdx) {
+      std::vector<::dawn::driver::halo_region> regions;
+      if(multiStageIdx == 0) {
+        regions.push_back({"in", {{{-1, 1}, {-1, 1}, {0, 0}}}});
+      }
+      return regions;
+    }
 
     void run(storage_ijk_t& in_, storage_ijk_t& out_) {
       int iMin = m_dom.iminus();
@@ -110,6 +123,10 @@ public:
     assert(dom.ksize() >= 1);
   }
 
+  void set_halo_exchange(const ::dawn::driver::halo_exchange_hooks& haloExchange) {
+    m_stencil_47.set_halo_exchange(haloExchange);
+  }
+
   void run(storage_ijk_t in, storage_ijk_t out) { m_stencil_47.run(in, out); }
 };
 } // namespace cxxopt
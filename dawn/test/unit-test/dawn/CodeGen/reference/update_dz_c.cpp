@@ -87,6 +87,35 @@ private:
     static constexpr ::dawn::driver::cartesian_extent gz_y_extent = {0, 1, -1, 1, 0, 0};
     static constexpr ::dawn::driver::cartesian_extent ws3_extent = {0, 0, 0, 0, 0, 0};
     static constexpr ::dawn::driver::cartesian_extent gz_0_extent = {0, 0, 0, 0, 0, 1};
+    ::dawn::driver::halo_exchange_hooks m_haloExchange;
+
+    void set_halo_exchange(const ::dawn::driver::halo_exchange_hooks& haloExchange) {
+      m_haloExchange = haloExchange;
+    }
+
+    static std::vector<::dawn::driver::halo_region> halo_regions(int multiStageIdx) {
+      std::vector<::dawn::driver::halo_region> regions;
+      if(multiStageIdx == 0) {
+        regions.push_back({"dp_ref", {{{0, 1}, {0, 1}, {0, 1}}}});
+        regions.push_back({"ut", {{{0, 1}, {0, 1}, {0, 1}}}});
+        regions.push_back({"vt", {{{0, 1}, {0, 1}, {0, 1}}}});
+      }
+      if(multiStageIdx == 1) {
+        regions.push_back({"dp_ref", {{{0, 1}, {0, 1}, {-2, 0}}}});
+        regions.push_back({"ut", {{{0, 1}, {0, 1}, {-2, 0}}}});
+        regions.push_back({"vt", {{{0, 1}, {0, 1}, {-2, 0}}}});
+      }
+      if(multiStageIdx == 2) {
+        regions.push_back({"dp_ref", {{{0, 1}, {0, 1}, {-1, 0}}}});
+        regions.push_back({"ut", {{{0, 1}, {0, 1}, {-1, 0}}}});
+        regions.push_back({"vt", {{{0, 1}, {0, 1}, {-1, 0}}}});
+      }
+      if(multiStageIdx == 3) {
+        regions.push_back({"gz_x", {{{-1, 1}, {0, 1}, {0, 0}}}});
+        regions.push_back({"gz_y", {{{0, 1}, {-1, 1}, {0, 0}}}});
+      }
+      return regions;
+    }
 
     void run(storage_ijk_t& dp_ref_, storage_ijk_t& zs_, storage_ijk_t& area_, storage_ijk_t& ut_,
              storage_ijk_t& vt_, storage_ijk_t& gz_, storage_ijk_t& gz_x_, storage_ijk_t& gz_y_,
@@ -468,6 +497,10 @@ public:
 
   void set_dt(double dt) { m_globals.dt = dt; }
 
+  void set_halo_exchange(const ::dawn::driver::halo_exchange_hooks& haloExchange) {
+    m_stencil_443.set_halo_exchange(haloExchange);
+  }
+
   void run(storage_ijk_t dp_ref, storage_ijk_t zs, storage_ijk_t area, storage_ijk_t ut,
            storage_ijk_t vt, storage_ijk_t gz, storage_ijk_t gz_x, storage_ijk_t gz_y,
            storage_ijk_t ws3) {
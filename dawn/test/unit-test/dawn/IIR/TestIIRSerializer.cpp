@@ -514,4 +514,36 @@ TEST_F(IIRSerializerTest, IterationSpace) {
   IIR_EXPECT_EQ(instantiation, deserialized);
 }
 
+TEST_F(IIRSerializerTest, FieldPrecision) {
+  using namespace dawn::iir;
+
+  CartesianIIRBuilder b;
+  auto in_f = b.field("in_f", FieldType::ijk, ast::FieldPrecision::Single);
+  auto out_f = b.field("out_f", FieldType::ijk, ast::FieldPrecision::Double);
+  auto tmp_f = b.tmpField("tmp_f", FieldType::ijk, ast::FieldPrecision::Single);
+
+  auto instantiation = b.build(
+      "precision",
+      b.stencil(b.multistage(
+          LoopOrderKind::Parallel,
+          b.stage(b.doMethod(dawn::ast::Interval::Start, dawn::ast::Interval::End,
+                             b.stmt(b.assignExpr(b.at(tmp_f), b.at(in_f))),
+                             b.stmt(b.assignExpr(b.at(out_f), b.at(tmp_f))))))));
+
+  auto deserialized =
+      IIRSerializer::deserializeFromString(IIRSerializer::serializeToString(instantiation));
+  IIR_EXPECT_EQ(instantiation, deserialized);
+
+  auto& metadata = deserialized->getMetaData();
+  EXPECT_EQ(metadata.getFieldPrecision(in_f.id), ast::FieldPrecision::Single);
+  EXPECT_EQ(metadata.getFieldPrecision(out_f.id), ast::FieldPrecision::Double);
+  EXPECT_EQ(metadata.getFieldPrecision(tmp_f.id), ast::FieldPrecision::Single);
+
+  // the precision takes part in the comparison
+  auto dimensions = metadata.getFieldDimensions(in_f.id);
+  dimensions.setPrecision(ast::FieldPrecision::Default);
+  metadata.setFieldDimensions(in_f.id, std::move(dimensions));
+  IIR_EXPECT_NE(instantiation, deserialized);
+}
+
 } // anonymous namespace
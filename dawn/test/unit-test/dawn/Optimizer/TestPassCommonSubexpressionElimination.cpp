@@ -0,0 +1,213 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/IIR.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassCommonSubexpressionElimination.h"
+#include "dawn/Optimizer/PassLocalVarType.h"
+#include "dawn/Support/Logger.h"
+#include "dawn/Unittest/IIRBuilder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+using namespace dawn;
+
+namespace {
+
+using AInterval = dawn::ast::Interval;
+using LocType = dawn::ast::LocationType;
+
+const iir::DoMethod& getDoMethod(const std::shared_ptr<iir::StencilInstantiation>& instantiation) {
+  return **iterateIIROver<iir::DoMethod>(*instantiation->getIIR()).begin();
+}
+
+std::shared_ptr<ast::Expr> getRhs(const std::shared_ptr<ast::Stmt>& stmt) {
+  return std::dynamic_pointer_cast<ast::AssignmentExpr>(
+             std::dynamic_pointer_cast<ast::ExprStmt>(stmt)->getExpr())
+      ->getRight();
+}
+
+TEST(TestPassCommonSubexpressionElimination, ReductionAcrossStatements) {
+  // out1 = reduce(in) * 2.; out2 = in2 + reduce(in);
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Cells);
+  auto in2 = b.field("in2", LocType::Edges);
+  auto out1 = b.field("out1", LocType::Edges);
+  auto out2 = b.field("out2", LocType::Edges);
+
+  auto reduction = [&]() {
+    return b.reduceOverNeighborExpr(iir::Op::plus, b.at(in, iir::HOffsetType::withOffset, 0),
+                                    b.lit(0.), {LocType::Edges, LocType::Cells});
+  };
+  auto instantiation = b.build(
+      "cse",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(AInterval::Start, AInterval::End,
+                             b.stmt(b.assignExpr(b.at(out1), b.binaryExpr(reduction(), b.lit(2.),
+                                                                          iir::Op::multiply))),
+                             b.stmt(b.assignExpr(b.at(out2), b.binaryExpr(b.at(in2), reduction(),
+                                                                          iir::Op::plus))))))));
+
+  log::info.clear();
+  PassCommonSubexpressionElimination pass;
+  EXPECT_TRUE(pass.run(instantiation));
+  PassLocalVarType passLocalVarType;
+  EXPECT_TRUE(passLocalVarType.run(instantiation));
+
+  const auto& stmts = getDoMethod(instantiation).getAST().getStatements();
+  ASSERT_EQ(stmts.size(), 3);
+  auto declaration = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmts[0]);
+  ASSERT_TRUE(declaration);
+  EXPECT_TRUE(declaration->getType().isConst());
+  EXPECT_EQ(declaration->getInitList().front()->getKind(),
+            ast::Expr::Kind::ReductionOverNeighborExpr);
+  EXPECT_EQ(instantiation->getMetaData()
+                .getLocalVariableDataFromAccessID(iir::getAccessID(declaration))
+                .getType(),
+            iir::LocalVariableType::OnEdges);
+
+  auto first = std::dynamic_pointer_cast<ast::BinaryOperator>(getRhs(stmts[1]));
+  auto second = std::dynamic_pointer_cast<ast::BinaryOperator>(getRhs(stmts[2]));
+  ASSERT_TRUE(first && second);
+  EXPECT_EQ(iir::getAccessID(first->getLeft()), iir::getAccessID(declaration));
+  EXPECT_EQ(iir::getAccessID(second->getRight()), iir::getAccessID(declaration));
+
+  // one reduction (a single accumulation per neighbor) is eliminated
+  EXPECT_TRUE(std::any_of(log::info.begin(), log::info.end(), [](const std::string& msg) {
+    return msg.find("eliminated 0 flops per grid point, plus 1 flops per neighbor") !=
+           std::string::npos;
+  }));
+}
+
+TEST(TestPassCommonSubexpressionElimination, LargestFirst) {
+  // out1 = (u[i+1] - u) * dx; out2 = (u[i+1] - u) * dx + 1.; out3 = u[i+1] - u;
+  UIDGenerator::getInstance()->reset();
+  iir::CartesianIIRBuilder b;
+  auto u = b.field("u", iir::FieldType::ijk);
+  auto dx = b.field("dx", iir::FieldType::ijk);
+  auto out1 = b.field("out1", iir::FieldType::ijk);
+  auto out2 = b.field("out2", iir::FieldType::ijk);
+  auto out3 = b.field("out3", iir::FieldType::ijk);
+
+  auto difference = [&]() { return b.binaryExpr(b.at(u, {1, 0, 0}), b.at(u), iir::Op::minus); };
+  auto instantiation = b.build(
+      "cse",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(b.doMethod(
+              AInterval::Start, AInterval::End,
+              b.stmt(b.assignExpr(b.at(out1),
+                                  b.binaryExpr(difference(), b.at(dx), iir::Op::multiply))),
+              b.stmt(b.assignExpr(
+                  b.at(out2), b.binaryExpr(b.binaryExpr(difference(), b.at(dx), iir::Op::multiply),
+                                           b.lit(1.), iir::Op::plus))),
+              b.stmt(b.assignExpr(b.at(out3), difference())))))));
+
+  PassCommonSubexpressionElimination pass;
+  EXPECT_TRUE(pass.run(instantiation));
+  PassLocalVarType passLocalVarType;
+  EXPECT_TRUE(passLocalVarType.run(instantiation));
+
+  // `u[i+1] - u` is declared before `(u[i+1] - u) * dx`, which reuses it
+  const auto& stmts = getDoMethod(instantiation).getAST().getStatements();
+  ASSERT_EQ(stmts.size(), 5);
+  auto differenceDecl = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmts[0]);
+  auto productDecl = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmts[1]);
+  ASSERT_TRUE(differenceDecl && productDecl);
+  EXPECT_TRUE(differenceDecl->getInitList().front()->equals(difference()));
+  auto product = std::dynamic_pointer_cast<ast::BinaryOperator>(productDecl->getInitList().front());
+  ASSERT_TRUE(product);
+  EXPECT_EQ(iir::getAccessID(product->getLeft()), iir::getAccessID(differenceDecl));
+  EXPECT_EQ(instantiation->getMetaData()
+                .getLocalVariableDataFromAccessID(iir::getAccessID(productDecl))
+                .getType(),
+            iir::LocalVariableType::OnIJ);
+
+  EXPECT_EQ(iir::getAccessID(getRhs(stmts[2])), iir::getAccessID(productDecl));
+  EXPECT_EQ(iir::getAccessID(getRhs(stmts[4])), iir::getAccessID(differenceDecl));
+}
+
+TEST(TestPassCommonSubexpressionElimination, RespectWrites) {
+  // out1 = u[i+1] - u; u = in; out2 = u[i+1] - u;
+  UIDGenerator::getInstance()->reset();
+  iir::CartesianIIRBuilder b;
+  auto u = b.field("u", iir::FieldType::ijk);
+  auto in = b.field("in", iir::FieldType::ijk);
+  auto out1 = b.field("out1", iir::FieldType::ijk);
+  auto out2 = b.field("out2", iir::FieldType::ijk);
+
+  auto instantiation = b.build(
+      "cse", b.stencil(b.multistage(
+                 iir::LoopOrderKind::Parallel,
+                 b.stage(b.doMethod(
+                     AInterval::Start, AInterval::End,
+                     b.stmt(b.assignExpr(
+                         b.at(out1), b.binaryExpr(b.at(u, {1, 0, 0}), b.at(u), iir::Op::minus))),
+                     b.stmt(b.assignExpr(b.at(u, iir::AccessType::rw), b.at(in))),
+                     b.stmt(b.assignExpr(b.at(out2), b.binaryExpr(b.at(u, {1, 0, 0}), b.at(u),
+                                                                  iir::Op::minus))))))));
+
+  // `u` changes between the two differences
+  PassCommonSubexpressionElimination pass;
+  EXPECT_TRUE(pass.run(instantiation));
+  EXPECT_EQ(getDoMethod(instantiation).getAST().getStatements().size(), 3);
+}
+
+TEST(TestPassCommonSubexpressionElimination, KeepGuardedDivision) {
+  // out1 = g != 0 ? in / g : 0.; out2 = g != 0 ? in / g : 1.;
+  UIDGenerator::getInstance()->reset();
+  iir::CartesianIIRBuilder b;
+  auto in = b.field("in", iir::FieldType::ijk);
+  auto g = b.field("g", iir::FieldType::ijk);
+  auto out1 = b.field("out1", iir::FieldType::ijk);
+  auto out2 = b.field("out2", iir::FieldType::ijk);
+
+  auto guardedDivision = [&](double otherwise) {
+    return b.conditionalExpr(b.binaryExpr(b.at(g), b.lit(0), iir::Op::notEqual),
+                             b.binaryExpr(b.at(in), b.at(g), iir::Op::divide), b.lit(otherwise));
+  };
+  auto instantiation = b.build(
+      "cse", b.stencil(b.multistage(
+                 iir::LoopOrderKind::Parallel,
+                 b.stage(b.doMethod(AInterval::Start, AInterval::End,
+                                    b.stmt(b.assignExpr(b.at(out1), guardedDivision(0.))),
+                                    b.stmt(b.assignExpr(b.at(out2), guardedDivision(1.))))))));
+
+  PassCommonSubexpressionElimination pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  // `in / g` is only evaluated if `g != 0`, the condition itself may be shared
+  const auto& stmts = getDoMethod(instantiation).getAST().getStatements();
+  for(const auto& stmt : stmts) {
+    if(auto declaration = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmt)) {
+      auto init =
+          std::dynamic_pointer_cast<ast::BinaryOperator>(declaration->getInitList().front());
+      ASSERT_TRUE(init);
+      EXPECT_NE(init->getOp(), "/");
+      continue;
+    }
+    auto ternary = std::dynamic_pointer_cast<ast::TernaryOperator>(getRhs(stmt));
+    ASSERT_TRUE(ternary);
+    EXPECT_EQ(ternary->getLeft()->getKind(), ast::Expr::Kind::BinaryOperator);
+  }
+}
+
+} // anonymous namespace
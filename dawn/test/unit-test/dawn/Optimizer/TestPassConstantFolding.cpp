@@ -0,0 +1,291 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/IIR.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/Lowering.h"
+#include "dawn/Optimizer/PassConstantFolding.h"
+#include "dawn/Serialization/SIRSerializer.h"
+#include "dawn/Unittest/IIRBuilder.h"
+
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+
+using namespace dawn;
+
+namespace {
+
+using AInterval = dawn::ast::Interval;
+using LocType = dawn::ast::LocationType;
+
+const iir::DoMethod& getSingleDoMethod(const iir::Stencil& stencil) {
+  const auto& multiStage = *stencil.getChildren().front();
+  EXPECT_EQ(multiStage.getChildren().size(), 1);
+  return multiStage.getChildren().front()->getSingleDoMethod();
+}
+
+TEST(TestPassConstantFolding, FoldLiteralsAndBranches) {
+  // if(1 < 2) { out = in * (2. * 3.); } else { out = in; }
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Edges);
+  auto out = b.field("out", LocType::Edges);
+
+  auto instantiation = b.build(
+      "folding",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(AInterval::Start, AInterval::End,
+                             b.ifStmt(b.binaryExpr(b.lit(1), b.lit(2), iir::Op::less),
+                                      b.block(b.stmt(b.assignExpr(
+                                          b.at(out), b.binaryExpr(b.at(in),
+                                                                  b.binaryExpr(b.lit(2.), b.lit(3.),
+                                                                               iir::Op::multiply),
+                                                                  iir::Op::multiply)))),
+                                      b.block(b.stmt(b.assignExpr(b.at(out), b.at(in))))))))));
+
+  PassConstantFolding pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  // the block of the taken branch replaces the if-statement
+  const auto& stmts = getSingleDoMethod(*instantiation->getStencils()[0]).getAST().getStatements();
+  ASSERT_EQ(stmts.size(), 1);
+  auto blockStmt = std::dynamic_pointer_cast<ast::BlockStmt>(stmts[0]);
+  ASSERT_TRUE(blockStmt);
+  ASSERT_EQ(blockStmt->getStatements().size(), 1);
+  auto exprStmt = std::dynamic_pointer_cast<ast::ExprStmt>(blockStmt->getStatements()[0]);
+  ASSERT_TRUE(exprStmt);
+  auto assignment = std::dynamic_pointer_cast<ast::AssignmentExpr>(exprStmt->getExpr());
+  ASSERT_TRUE(assignment);
+  auto product = std::dynamic_pointer_cast<ast::BinaryOperator>(assignment->getRight());
+  ASSERT_TRUE(product);
+  auto literal = std::dynamic_pointer_cast<ast::LiteralAccessExpr>(product->getRight());
+  ASSERT_TRUE(literal);
+  EXPECT_EQ(literal->getValue(), "6");
+  EXPECT_EQ(literal->getBuiltinType(), BuiltinTypeID::Double);
+  EXPECT_TRUE(literal->getData<iir::IIRAccessExprData>().AccessID.has_value());
+}
+
+TEST(TestPassConstantFolding, IntegerDivision) {
+  // out = 7 / 2
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto out = b.field("out", LocType::Edges);
+
+  auto instantiation = b.build(
+      "folding",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(AInterval::Start, AInterval::End,
+                             b.stmt(b.assignExpr(b.at(out), b.binaryExpr(b.lit(7), b.lit(2),
+                                                                         iir::Op::divide))))))));
+
+  PassConstantFolding pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  const auto& stmts = getSingleDoMethod(*instantiation->getStencils()[0]).getAST().getStatements();
+  auto assignment = std::dynamic_pointer_cast<ast::AssignmentExpr>(
+      std::dynamic_pointer_cast<ast::ExprStmt>(stmts[0])->getExpr());
+  auto literal = std::dynamic_pointer_cast<ast::LiteralAccessExpr>(assignment->getRight());
+  ASSERT_TRUE(literal);
+  EXPECT_EQ(literal->getValue(), "3");
+  EXPECT_EQ(literal->getBuiltinType(), BuiltinTypeID::Integer);
+}
+
+TEST(TestPassConstantFolding, FloatingPointPrecision) {
+  // out = 0.1f * 3.f; out = 0.1 * 3.
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto out = b.field("out", LocType::Edges);
+
+  auto instantiation = b.build(
+      "folding",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(AInterval::Start, AInterval::End,
+                             b.stmt(b.assignExpr(b.at(out), b.binaryExpr(b.lit(0.1f), b.lit(3.f),
+                                                                         iir::Op::multiply))),
+                             b.stmt(b.assignExpr(b.at(out), b.binaryExpr(b.lit(0.1), b.lit(3.),
+                                                                         iir::Op::multiply))))))));
+
+  PassConstantFolding pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  // both are folded in double precision, the literals round-trip
+  const auto& stmts = getSingleDoMethod(*instantiation->getStencils()[0]).getAST().getStatements();
+  ASSERT_EQ(stmts.size(), 2);
+  for(auto type : {BuiltinTypeID::Float, BuiltinTypeID::Double}) {
+    const auto& stmt = stmts[type == BuiltinTypeID::Float ? 0 : 1];
+    auto assignment = std::dynamic_pointer_cast<ast::AssignmentExpr>(
+        std::dynamic_pointer_cast<ast::ExprStmt>(stmt)->getExpr());
+    auto literal = std::dynamic_pointer_cast<ast::LiteralAccessExpr>(assignment->getRight());
+    ASSERT_TRUE(literal);
+    EXPECT_EQ(std::stod(literal->getValue()), 0.1 * 3.) << literal->getValue();
+    EXPECT_EQ(literal->getBuiltinType(), type);
+  }
+}
+
+TEST(TestPassConstantFolding, IntegerOverflow) {
+  // out = 2000000000 * 2 is not folded, as the result does not fit into an int
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto out = b.field("out", LocType::Edges);
+
+  auto instantiation = b.build(
+      "folding",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(AInterval::Start, AInterval::End,
+                             b.stmt(b.assignExpr(b.at(out), b.binaryExpr(b.lit(2000000000),
+                                                                         b.lit(2),
+                                                                         iir::Op::multiply))))))));
+
+  PassConstantFolding pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  const auto& stmts = getSingleDoMethod(*instantiation->getStencils()[0]).getAST().getStatements();
+  auto assignment = std::dynamic_pointer_cast<ast::AssignmentExpr>(
+      std::dynamic_pointer_cast<ast::ExprStmt>(stmts[0])->getExpr());
+  EXPECT_TRUE(std::dynamic_pointer_cast<ast::BinaryOperator>(assignment->getRight()));
+}
+
+TEST(TestPassConstantFolding, RemoveDeadStage) {
+  // tmp = in; if(false) { out = tmp; } else { out = in; }
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Edges);
+  auto tmp = b.tmpField("tmp", LocType::Edges);
+  auto out = b.field("out", LocType::Edges);
+
+  auto instantiation = b.build(
+      "folding",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges, b.doMethod(AInterval::Start, AInterval::End,
+                                             b.stmt(b.assignExpr(b.at(tmp), b.at(in))))),
+          b.stage(
+              LocType::Edges,
+              b.doMethod(AInterval::Start, AInterval::End,
+                         b.ifStmt(b.lit(false), b.block(b.stmt(b.assignExpr(b.at(out), b.at(tmp)))),
+                                  b.block(b.stmt(b.assignExpr(b.at(out), b.at(in))))))))));
+
+  PassConstantFolding pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  const auto& stencil = *instantiation->getStencils()[0];
+  EXPECT_EQ(getSingleDoMethod(stencil).getAST().getStatements().size(), 1);
+  EXPECT_FALSE(stencil.getFields().count(tmp.id));
+  EXPECT_FALSE(
+      instantiation->getMetaData().isAccessType(iir::FieldAccessType::StencilTemporary, tmp.id));
+}
+
+TEST(TestPassConstantFolding, SpecializeGlobals) {
+  // if(flag) { out = in; } else { out = 0.; }
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Edges);
+  auto out = b.field("out", LocType::Edges);
+  auto flag = b.globalvar("flag", false);
+
+  auto instantiation = b.build(
+      "folding",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(
+              LocType::Edges,
+              b.doMethod(AInterval::Start, AInterval::End,
+                         b.ifStmt(b.at(flag), b.block(b.stmt(b.assignExpr(b.at(out), b.at(in)))),
+                                  b.block(b.stmt(b.assignExpr(b.at(out), b.lit(0.))))))))));
+
+  // without specialization the branch is kept
+  PassConstantFolding pass;
+  EXPECT_TRUE(pass.run(instantiation));
+  ASSERT_EQ(instantiation->getStencils().size(), 1);
+
+  Options options;
+  options.SpecializeGlobals = 1;
+  EXPECT_TRUE(pass.run(instantiation, options));
+
+  // one branch free version of the stencil for each value of the global ...
+  ASSERT_EQ(instantiation->getStencils().size(), 2);
+  for(const auto& stencil : instantiation->getStencils()) {
+    const auto& stmts = getSingleDoMethod(*stencil).getAST().getStatements();
+    ASSERT_EQ(stmts.size(), 1);
+    EXPECT_EQ(stmts[0]->getKind(), ast::Stmt::Kind::BlockStmt);
+  }
+
+  // ... selected once per stencil call
+  const auto& controlFlow = instantiation->getIIR()->getControlFlowDescriptor().getStatements();
+  ASSERT_EQ(controlFlow.size(), 1);
+  auto selection = std::dynamic_pointer_cast<ast::IfStmt>(controlFlow[0]);
+  ASSERT_TRUE(selection);
+  auto condition = std::dynamic_pointer_cast<ast::VarAccessExpr>(selection->getCondExpr());
+  ASSERT_TRUE(condition);
+  EXPECT_EQ(iir::getAccessID(condition), flag.id);
+  EXPECT_EQ(instantiation->getMetaData().getStencilCallToStencilIDMap().size(), 2);
+}
+
+TEST(TestPassConstantFolding, SpecializeGlobalsFunctionCall) {
+  // if(flag) { out = f(in); } else { out = 0.0; }
+  UIDGenerator::getInstance()->reset();
+  auto stencilIR = SIRSerializer::deserialize("input/test_constant_folding_function_call.sir");
+  auto instantiation = toStencilInstantiationMap(*stencilIR).begin()->second;
+
+  Options options;
+  options.SpecializeGlobals = 1;
+  PassConstantFolding pass;
+  EXPECT_TRUE(pass.run(instantiation, options));
+  ASSERT_EQ(instantiation->getStencils().size(), 2);
+
+  // the versions have their own multi-stages, stages and Do-Methods ...
+  std::set<int> multiStageIDs, stageIDs, doMethodIDs;
+  for(const auto& stencil : instantiation->getStencils()) {
+    for(const auto& multiStage : stencil->getChildren()) {
+      EXPECT_TRUE(multiStageIDs.insert(multiStage->getID()).second);
+      for(const auto& stage : multiStage->getChildren()) {
+        EXPECT_TRUE(stageIDs.insert(stage->getStageID()).second);
+        for(const auto& doMethod : stage->getChildren())
+          EXPECT_TRUE(doMethodIDs.insert(doMethod->getID()).second);
+      }
+    }
+  }
+
+  // ... and the stencil function call of the version for `flag == true` is instantiated
+  const auto& metadata = instantiation->getMetaData();
+  int numCalls = 0;
+  for(const auto& stencil : instantiation->getStencils()) {
+    const auto& stmts = getSingleDoMethod(*stencil).getAST().getStatements();
+    ASSERT_EQ(stmts.size(), 1);
+    auto blockStmt = std::dynamic_pointer_cast<ast::BlockStmt>(stmts[0]);
+    ASSERT_TRUE(blockStmt);
+    auto exprStmt = std::dynamic_pointer_cast<ast::ExprStmt>(blockStmt->getStatements()[0]);
+    ASSERT_TRUE(exprStmt);
+    auto assignment = std::dynamic_pointer_cast<ast::AssignmentExpr>(exprStmt->getExpr());
+    ASSERT_TRUE(assignment);
+    if(auto call = std::dynamic_pointer_cast<ast::StencilFunCallExpr>(assignment->getRight())) {
+      EXPECT_TRUE(metadata.getExprToStencilFunctionInstantiation().count(call));
+      ++numCalls;
+    }
+  }
+  EXPECT_EQ(numCalls, 1);
+}
+
+} // anonymous namespace
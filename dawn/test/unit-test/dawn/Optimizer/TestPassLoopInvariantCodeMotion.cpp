@@ -0,0 +1,215 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/IIR.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassLoopInvariantCodeMotion.h"
+#include "dawn/Optimizer/PassRemoveScalars.h"
+#include "dawn/Unittest/IIRBuilder.h"
+
+#include <gtest/gtest.h>
+
+using namespace dawn;
+
+namespace {
+
+using AInterval = dawn::ast::Interval;
+using LocType = dawn::ast::LocationType;
+
+const iir::DoMethod& getDoMethod(const std::shared_ptr<iir::StencilInstantiation>& instantiation) {
+  return **iterateIIROver<iir::DoMethod>(*instantiation->getIIR()).begin();
+}
+
+// Returns the hoisted variable declared by `stmt`, nullptr if it is not a hoisted declaration
+std::shared_ptr<ast::VarDeclStmt>
+getHoistedVarDecl(const std::shared_ptr<iir::StencilInstantiation>& instantiation,
+                  const std::shared_ptr<ast::Stmt>& stmt) {
+  auto varDeclStmt = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmt);
+  if(!varDeclStmt || !instantiation->getMetaData()
+                          .getLocalVariableDataFromAccessID(iir::getAccessID(varDeclStmt))
+                          .isHoisted())
+    return nullptr;
+  return varDeclStmt;
+}
+
+TEST(TestPassLoopInvariantCodeMotion, HoistVerticalAndGlobal) {
+  // out = in * (coeff * v); out2 = in + coeff * v;
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Edges);
+  auto out = b.field("out", LocType::Edges);
+  auto out2 = b.field("out2", LocType::Edges);
+  auto v = b.vertical_field("v");
+  auto coeff = b.globalvar("coeff", 2.);
+
+  auto instantiation = b.build(
+      "licm",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(
+              LocType::Edges,
+              b.doMethod(
+                  AInterval::Start, AInterval::End,
+                  b.stmt(b.assignExpr(
+                      b.at(out),
+                      b.binaryExpr(b.at(in), b.binaryExpr(b.at(coeff), b.at(v), iir::Op::multiply),
+                                   iir::Op::multiply))),
+                  b.stmt(b.assignExpr(
+                      b.at(out2),
+                      b.binaryExpr(b.at(in), b.binaryExpr(b.at(coeff), b.at(v), iir::Op::multiply),
+                                   iir::Op::plus))))))));
+
+  PassLoopInvariantCodeMotion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  // a single declaration shared by both statements
+  const auto& stmts = getDoMethod(instantiation).getAST().getStatements();
+  ASSERT_EQ(stmts.size(), 3);
+  auto declaration = getHoistedVarDecl(instantiation, stmts[0]);
+  ASSERT_TRUE(declaration);
+  EXPECT_EQ(declaration->getType().getBuiltinTypeID(), BuiltinTypeID::Float);
+  EXPECT_TRUE(declaration->getType().isConst());
+  EXPECT_EQ(declaration->getInitList().front()->getKind(), ast::Expr::Kind::BinaryOperator);
+  EXPECT_TRUE(instantiation->getMetaData()
+                  .getLocalVariableDataFromAccessID(iir::getAccessID(declaration))
+                  .isScalar());
+
+  for(int idx : {1, 2}) {
+    auto assignment = std::dynamic_pointer_cast<ast::AssignmentExpr>(
+        std::dynamic_pointer_cast<ast::ExprStmt>(stmts[idx])->getExpr());
+    auto rhs = std::dynamic_pointer_cast<ast::BinaryOperator>(assignment->getRight());
+    ASSERT_TRUE(rhs);
+    auto var = std::dynamic_pointer_cast<ast::VarAccessExpr>(rhs->getRight());
+    ASSERT_TRUE(var);
+    EXPECT_EQ(iir::getAccessID(var), iir::getAccessID(declaration));
+  }
+
+  // running the pass again and removing scalars keeps the hoisted variable
+  EXPECT_TRUE(pass.run(instantiation));
+  PassRemoveScalars removeScalars;
+  EXPECT_TRUE(removeScalars.run(instantiation));
+  EXPECT_EQ(getDoMethod(instantiation).getAST().getStatements().size(), 3);
+}
+
+TEST(TestPassLoopInvariantCodeMotion, HoistOutOfReduction) {
+  // out = reduce(in * (coeff / 3))
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Cells);
+  auto out = b.field("out", LocType::Edges);
+  auto coeff = b.globalvar("coeff", 6);
+
+  auto instantiation = b.build(
+      "licm",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(
+              LocType::Edges,
+              b.doMethod(AInterval::Start, AInterval::End,
+                         b.stmt(b.assignExpr(
+                             b.at(out),
+                             b.reduceOverNeighborExpr(
+                                 iir::Op::plus,
+                                 b.binaryExpr(b.at(in, iir::HOffsetType::withOffset, 0),
+                                              b.binaryExpr(b.at(coeff), b.lit(3), iir::Op::divide),
+                                              iir::Op::multiply),
+                                 b.lit(0.), {LocType::Edges, LocType::Cells}))))))));
+
+  PassLoopInvariantCodeMotion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  const auto& stmts = getDoMethod(instantiation).getAST().getStatements();
+  ASSERT_EQ(stmts.size(), 2);
+  auto declaration = getHoistedVarDecl(instantiation, stmts[0]);
+  ASSERT_TRUE(declaration);
+  // integer division is preserved
+  EXPECT_EQ(declaration->getType().getBuiltinTypeID(), BuiltinTypeID::Integer);
+}
+
+TEST(TestPassLoopInvariantCodeMotion, KeepGuardedDivision) {
+  // if(g != 0) { out = in * (n / g); } out2 = g != 0 ? in * (n / g) : 0.;
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Edges);
+  auto out = b.field("out", LocType::Edges);
+  auto out2 = b.field("out2", LocType::Edges);
+  auto n = b.globalvar("n", 6);
+  auto g = b.globalvar("g", 0);
+
+  auto instantiation = b.build(
+      "licm",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(
+              LocType::Edges,
+              b.doMethod(
+                  AInterval::Start, AInterval::End,
+                  b.ifStmt(b.binaryExpr(b.at(g), b.lit(0), iir::Op::notEqual),
+                           b.block(b.stmt(b.assignExpr(
+                               b.at(out),
+                               b.binaryExpr(b.at(in),
+                                            b.binaryExpr(b.at(n), b.at(g), iir::Op::divide),
+                                            iir::Op::multiply))))),
+                  b.stmt(b.assignExpr(
+                      b.at(out2),
+                      b.conditionalExpr(
+                          b.binaryExpr(b.at(g), b.lit(0), iir::Op::notEqual),
+                          b.binaryExpr(b.at(in), b.binaryExpr(b.at(n), b.at(g), iir::Op::divide),
+                                       iir::Op::multiply),
+                          b.lit(0.)))))))));
+
+  PassLoopInvariantCodeMotion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  // `n / g` is only evaluated if `g != 0`, hoisting it would divide by zero
+  const auto& stmts = getDoMethod(instantiation).getAST().getStatements();
+  ASSERT_EQ(stmts.size(), 2);
+  for(const auto& stmt : stmts)
+    EXPECT_FALSE(getHoistedVarDecl(instantiation, stmt));
+}
+
+TEST(TestPassLoopInvariantCodeMotion, KeepVariant) {
+  // out = in * coeff; v = v + 1.; out = out + v * coeff;
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Edges);
+  auto out = b.field("out", LocType::Edges);
+  auto v = b.vertical_field("v");
+  auto coeff = b.globalvar("coeff", 2.);
+
+  auto instantiation = b.build(
+      "licm",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(AInterval::Start, AInterval::End,
+                             b.stmt(b.assignExpr(b.at(out), b.binaryExpr(b.at(in), b.at(coeff),
+                                                                         iir::Op::multiply))),
+                             b.stmt(b.assignExpr(b.at(v, iir::AccessType::rw),
+                                                 b.binaryExpr(b.at(v), b.lit(1.), iir::Op::plus))),
+                             b.stmt(b.assignExpr(
+                                 b.at(out, iir::AccessType::rw),
+                                 b.binaryExpr(b.at(out),
+                                              b.binaryExpr(b.at(v), b.at(coeff), iir::Op::multiply),
+                                              iir::Op::plus))))))));
+
+  // single variables are not hoisted and `v` is written in the Do-Method
+  PassLoopInvariantCodeMotion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+  EXPECT_EQ(getDoMethod(instantiation).getAST().getStatements().size(), 3);
+}
+
+} // anonymous namespace
@@ -0,0 +1,161 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/ASTStmt.h"
+#include "dawn/IIR/IIR.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassReductionFusion.h"
+#include "dawn/Unittest/IIRBuilder.h"
+
+#include <gtest/gtest.h>
+
+using namespace dawn;
+
+namespace {
+
+using AInterval = dawn::ast::Interval;
+using LocType = dawn::ast::LocationType;
+
+const iir::DoMethod& getDoMethod(const std::shared_ptr<iir::StencilInstantiation>& instantiation) {
+  return **iterateIIROver<iir::DoMethod>(*instantiation->getIIR()).begin();
+}
+
+std::shared_ptr<ast::ReductionOverNeighborExpr>
+getDeclaredReduction(const std::shared_ptr<ast::Stmt>& stmt) {
+  auto varDeclStmt = std::dynamic_pointer_cast<ast::VarDeclStmt>(stmt);
+  return varDeclStmt ? std::dynamic_pointer_cast<ast::ReductionOverNeighborExpr>(
+                           varDeclStmt->getInitList().front())
+                     : nullptr;
+}
+
+TEST(TestPassReductionFusion, GroupSameIterationSpace) {
+  // out1 = reduce(in1, E->C); out2 = reduce(in2, E->V); out3 = 2 * reduce(in3, E->C);
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in1 = b.field("in1", LocType::Cells);
+  auto in2 = b.field("in2", LocType::Vertices);
+  auto in3 = b.field("in3", LocType::Cells);
+  auto out1 = b.field("out1", LocType::Edges);
+  auto out2 = b.field("out2", LocType::Edges);
+  auto out3 = b.field("out3", LocType::Edges);
+
+  auto reduction = [&](const auto& field, LocType target) {
+    return b.reduceOverNeighborExpr(iir::Op::plus, b.at(field, iir::HOffsetType::withOffset, 0),
+                                    b.lit(0.), {LocType::Edges, target});
+  };
+  auto instantiation = b.build(
+      "fusion",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(AInterval::Start, AInterval::End,
+                             b.stmt(b.assignExpr(b.at(out1), reduction(in1, LocType::Cells))),
+                             b.stmt(b.assignExpr(b.at(out2), reduction(in2, LocType::Vertices))),
+                             b.stmt(b.assignExpr(
+                                 b.at(out3), b.binaryExpr(b.lit(2.), reduction(in3, LocType::Cells),
+                                                          iir::Op::multiply))))))));
+
+  PassReductionFusion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  // the two reductions over the edge-cell neighbors are declared in a row, the other one is left
+  const auto& stmts = getDoMethod(instantiation).getAST().getStatements();
+  ASSERT_EQ(stmts.size(), 5);
+  auto first = getDeclaredReduction(stmts[0]);
+  auto second = getDeclaredReduction(stmts[1]);
+  ASSERT_TRUE(first && second);
+  EXPECT_EQ(first->getIterSpace(), second->getIterSpace());
+  EXPECT_EQ(iir::getAccessID(first->getRhs()),
+            instantiation->getMetaData().getAccessIDFromName("in1"));
+  EXPECT_EQ(iir::getAccessID(second->getRhs()),
+            instantiation->getMetaData().getAccessIDFromName("in3"));
+  EXPECT_FALSE(getDeclaredReduction(stmts[3]));
+
+  // running again does not change anything
+  EXPECT_TRUE(pass.run(instantiation));
+  EXPECT_EQ(getDoMethod(instantiation).getAST().getStatements().size(), 5);
+}
+
+TEST(TestPassReductionFusion, RespectWrites) {
+  // out1 = reduce(in, E->C); in = out1; out2 = reduce(in, E->C);
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Cells);
+  auto tmp = b.field("tmp", LocType::Cells);
+  auto out1 = b.field("out1", LocType::Edges);
+  auto out2 = b.field("out2", LocType::Edges);
+
+  auto reduction = [&]() {
+    return b.reduceOverNeighborExpr(iir::Op::plus, b.at(in, iir::HOffsetType::withOffset, 0),
+                                    b.lit(0.), {LocType::Edges, LocType::Cells});
+  };
+  auto instantiation =
+      b.build("fusion",
+              b.stencil(b.multistage(
+                  iir::LoopOrderKind::Parallel,
+                  b.stage(LocType::Edges,
+                          b.doMethod(AInterval::Start, AInterval::End,
+                                     b.stmt(b.assignExpr(b.at(out1), reduction())),
+                                     b.stmt(b.assignExpr(b.at(in, iir::AccessType::rw), b.at(tmp))),
+                                     b.stmt(b.assignExpr(b.at(out2), reduction())))))));
+
+  // `in` changes between the two reductions
+  PassReductionFusion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+  EXPECT_EQ(getDoMethod(instantiation).getAST().getStatements().size(), 3);
+}
+
+TEST(TestPassReductionFusion, KeepConditionalReduction) {
+  // out1 = reduce(in1, E->C); out2 = flag > 0 ? reduce(in2, E->C) : 0.;
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in1 = b.field("in1", LocType::Cells);
+  auto in2 = b.field("in2", LocType::Cells);
+  auto flag = b.field("flag", LocType::Edges);
+  auto out1 = b.field("out1", LocType::Edges);
+  auto out2 = b.field("out2", LocType::Edges);
+
+  auto reduction = [&](const auto& field) {
+    return b.reduceOverNeighborExpr(iir::Op::plus, b.at(field, iir::HOffsetType::withOffset, 0),
+                                    b.lit(0.), {LocType::Edges, LocType::Cells});
+  };
+  auto instantiation = b.build(
+      "fusion",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges,
+                  b.doMethod(AInterval::Start, AInterval::End,
+                             b.stmt(b.assignExpr(b.at(out1), reduction(in1))),
+                             b.stmt(b.assignExpr(
+                                 b.at(out2),
+                                 b.conditionalExpr(
+                                     b.binaryExpr(b.at(flag), b.lit(0.), iir::Op::greater),
+                                     reduction(in2), b.lit(0.)))))))));
+
+  PassReductionFusion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  // the second reduction is only evaluated if `flag > 0`
+  const auto& stmts = getDoMethod(instantiation).getAST().getStatements();
+  ASSERT_EQ(stmts.size(), 2);
+  auto ternary = std::dynamic_pointer_cast<ast::TernaryOperator>(
+      std::dynamic_pointer_cast<ast::AssignmentExpr>(
+          std::dynamic_pointer_cast<ast::ExprStmt>(stmts[1])->getExpr())
+          ->getRight());
+  ASSERT_TRUE(ternary);
+  EXPECT_EQ(ternary->getLeft()->getKind(), ast::Expr::Kind::ReductionOverNeighborExpr);
+}
+
+} // anonymous namespace
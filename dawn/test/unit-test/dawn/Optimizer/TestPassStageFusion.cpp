@@ -0,0 +1,114 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/IIR/IIR.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassStageFusion.h"
+#include "dawn/Unittest/IIRBuilder.h"
+
+#include <gtest/gtest.h>
+
+using namespace dawn;
+
+namespace {
+
+using AInterval = dawn::ast::Interval;
+using LocType = dawn::ast::LocationType;
+
+const iir::MultiStage& getSingleMultiStage(const iir::StencilInstantiation& instantiation) {
+  return *instantiation.getStencils()[0]->getChildren().front();
+}
+
+TEST(TestPassStageFusion, FusePointwiseChain) {
+  // mid = in; out = 2 * mid (both on edges)
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Edges);
+  auto mid = b.tmpField("mid", LocType::Edges);
+  auto out = b.field("out", LocType::Edges);
+
+  auto instantiation = b.build(
+      "fusion",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges, b.doMethod(AInterval::Start, AInterval::End,
+                                             b.stmt(b.assignExpr(b.at(mid), b.at(in))))),
+          b.stage(LocType::Edges,
+                  b.doMethod(AInterval::Start, AInterval::End,
+                             b.stmt(b.assignExpr(b.at(out), b.binaryExpr(b.lit(2.), b.at(mid),
+                                                                         iir::Op::multiply))))))));
+  ASSERT_EQ(getSingleMultiStage(*instantiation).getChildren().size(), 2);
+
+  PassStageFusion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  const auto& multiStage = getSingleMultiStage(*instantiation);
+  ASSERT_EQ(multiStage.getChildren().size(), 1);
+  const auto& stage = *multiStage.getChildren().front();
+  EXPECT_EQ(stage.getLocationType(), LocType::Edges);
+  ASSERT_EQ(stage.getChildren().size(), 1);
+  EXPECT_EQ(stage.getSingleDoMethod().getAST().getStatements().size(), 2);
+  EXPECT_TRUE(stage.getSingleDoMethod().getDependencyGraph().has_value());
+  EXPECT_TRUE(instantiation->getStencils()[0]->getStageDependencyGraph().has_value());
+}
+
+TEST(TestPassStageFusion, KeepReductionOverProducedField) {
+  // mid = in; out = sum_over(Cell > Edge > Cell, mid) (both on cells)
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Cells);
+  auto mid = b.tmpField("mid", LocType::Cells);
+  auto out = b.field("out", LocType::Cells);
+
+  auto instantiation = b.build(
+      "fusion",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Cells, b.doMethod(AInterval::Start, AInterval::End,
+                                             b.stmt(b.assignExpr(b.at(mid), b.at(in))))),
+          b.stage(LocType::Cells,
+                  b.doMethod(
+                      AInterval::Start, AInterval::End,
+                      b.stmt(b.assignExpr(
+                          b.at(out),
+                          b.reduceOverNeighborExpr(
+                              iir::Op::plus, b.at(mid, iir::HOffsetType::withOffset, 0), b.lit(0.),
+                              {LocType::Cells, LocType::Edges, LocType::Cells}))))))));
+
+  PassStageFusion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+  EXPECT_EQ(getSingleMultiStage(*instantiation).getChildren().size(), 2);
+}
+
+TEST(TestPassStageFusion, KeepDifferentIntervals) {
+  UIDGenerator::getInstance()->reset();
+  iir::UnstructuredIIRBuilder b;
+  auto in = b.field("in", LocType::Edges);
+  auto out = b.field("out", LocType::Edges);
+
+  auto instantiation = b.build(
+      "fusion",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges, b.doMethod(AInterval::Start, AInterval::End,
+                                             b.stmt(b.assignExpr(b.at(out), b.at(in))))),
+          b.stage(LocType::Edges, b.doMethod(AInterval::Start, AInterval::Start,
+                                             b.stmt(b.assignExpr(b.at(out), b.lit(0.))))))));
+
+  PassStageFusion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+  EXPECT_EQ(getSingleMultiStage(*instantiation).getChildren().size(), 2);
+}
+
+} // anonymous namespace
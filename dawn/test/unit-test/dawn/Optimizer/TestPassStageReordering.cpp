@@ -17,8 +17,10 @@
 #include "dawn/Optimizer/PassMultiStageMerger.h"
 #include "dawn/Optimizer/PassSetDependencyGraph.h"
 #include "dawn/Optimizer/PassSetStageGraph.h"
+#include "dawn/Optimizer/PassStageMerger.h"
 #include "dawn/Optimizer/PassStageReordering.h"
 #include "dawn/Serialization/IIRSerializer.h"
+#include "dawn/Unittest/IIRBuilder.h"
 
 #include <fstream>
 #include <gtest/gtest.h>
@@ -163,4 +165,59 @@ TEST_F(TestPassStageReordering, ReorderTest8) {
   runTest("input/tridiagonal_solve.iir", {1, 0, 2, 4, 3, 5});
 }
 
+TEST_F(TestPassStageReordering, ReorderUnstructured) {
+  /*
+    eout0 = ein0;
+    cout0 = sum_over(Cell > Edge, eout0);
+    eout1 = ein1;
+   */
+  using LocType = ast::LocationType;
+  iir::UnstructuredIIRBuilder b;
+  auto ein0 = b.field("ein0", LocType::Edges);
+  auto ein1 = b.field("ein1", LocType::Edges);
+  auto eout0 = b.field("eout0", LocType::Edges);
+  auto eout1 = b.field("eout1", LocType::Edges);
+  auto cout0 = b.field("cout0", LocType::Cells);
+
+  auto instantiation = b.build(
+      "reorder",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Parallel,
+          b.stage(LocType::Edges, b.doMethod(ast::Interval::Start, ast::Interval::End,
+                                             b.stmt(b.assignExpr(b.at(eout0), b.at(ein0))))),
+          b.stage(LocType::Cells,
+                  b.doMethod(ast::Interval::Start, ast::Interval::End,
+                             b.stmt(b.assignExpr(
+                                 b.at(cout0),
+                                 b.reduceOverNeighborExpr(
+                                     iir::Op::plus, b.at(eout0, iir::HOffsetType::withOffset, 0),
+                                     b.lit(0.), {LocType::Cells, LocType::Edges}))))),
+          b.stage(LocType::Edges, b.doMethod(ast::Interval::Start, ast::Interval::End,
+                                             b.stmt(b.assignExpr(b.at(eout1), b.at(ein1))))))));
+
+  PassSetStageGraph stageGraphPass;
+  EXPECT_TRUE(stageGraphPass.run(instantiation));
+  PassSetDependencyGraph dependencyGraphPass;
+  EXPECT_TRUE(dependencyGraphPass.run(instantiation));
+  PassStageReordering stageReorderPass(dawn::ReorderStrategy::Kind::Greedy);
+  EXPECT_TRUE(stageReorderPass.run(instantiation));
+
+  // The independent stage on edges is moved next to the other one ...
+  auto getLocationTypes = [&]() {
+    std::vector<std::optional<LocType>> locationTypes;
+    for(const auto& stage : iterateIIROver<iir::Stage>(*instantiation->getIIR()))
+      locationTypes.push_back(stage->getLocationType());
+    return locationTypes;
+  };
+  EXPECT_EQ(getLocationTypes(),
+            (std::vector<std::optional<LocType>>{LocType::Edges, LocType::Edges, LocType::Cells}));
+
+  // ... such that the two can be merged
+  EXPECT_TRUE(stageGraphPass.run(instantiation));
+  PassStageMerger stageMergerPass;
+  EXPECT_TRUE(stageMergerPass.run(instantiation));
+  EXPECT_EQ(getLocationTypes(),
+            (std::vector<std::optional<LocType>>{LocType::Edges, LocType::Cells}));
+}
+
 } // anonymous namespace
@@ -0,0 +1,137 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/IIR/IIR.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassStencilFusion.h"
+#include "dawn/Unittest/IIRBuilder.h"
+
+#include <gtest/gtest.h>
+
+using namespace dawn;
+
+namespace {
+
+using AInterval = dawn::ast::Interval;
+
+/// in -> mid -> out, split over two stencils. The first stencil writes `mid` on `writeInterval`,
+/// under the condition `in > 0` if `conditional` is set, the second one reads it at `offset`.
+std::shared_ptr<iir::StencilInstantiation>
+makeCopyChain(const Array3i& offset,
+              const iir::Interval& writeInterval = iir::Interval(AInterval::Start, AInterval::End),
+              bool conditional = false) {
+  UIDGenerator::getInstance()->reset();
+
+  iir::CartesianIIRBuilder b;
+  auto in = b.field("in", iir::FieldType::ijk);
+  auto mid = b.field("mid", iir::FieldType::ijk);
+  auto out = b.field("out", iir::FieldType::ijk);
+
+  auto write = b.stmt(b.assignExpr(b.at(mid, iir::AccessType::rw), b.at(in)));
+  if(conditional)
+    write = b.ifStmt(b.binaryExpr(b.at(in), b.lit(0.), iir::Op::greater), b.block(write));
+
+  std::vector<std::unique_ptr<iir::Stencil>> stencils;
+  stencils.push_back(b.stencil(b.multistage(iir::LoopOrderKind::Parallel,
+                                            b.stage(b.doMethod(writeInterval, write)))));
+  stencils.push_back(b.stencil(b.multistage(
+      iir::LoopOrderKind::Parallel,
+      b.stage(b.doMethod(
+          AInterval::Start, AInterval::End,
+          b.stmt(b.assignExpr(b.at(out, iir::AccessType::rw), b.at(mid, offset))))))));
+  return b.build("fusion", std::move(stencils));
+}
+
+TEST(TestPassStencilFusion, FuseConsecutiveStencils) {
+  auto instantiation = makeCopyChain({0, 0, 0});
+  ASSERT_EQ(instantiation->getStencils().size(), 2);
+
+  PassStencilFusion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  ASSERT_EQ(instantiation->getStencils().size(), 1);
+  EXPECT_EQ(instantiation->getStencils()[0]->getChildren().size(), 2);
+  EXPECT_EQ(instantiation->getIIR()->getControlFlowDescriptor().getStatements().size(), 1);
+  EXPECT_TRUE(instantiation->getStencils()[0]->getStageDependencyGraph().has_value());
+
+  // `mid` is not marked dead, hence it remains part of the API
+  const auto& metadata = instantiation->getMetaData();
+  EXPECT_TRUE(metadata.isAccessType(iir::FieldAccessType::APIField, "mid"));
+}
+
+TEST(TestPassStencilFusion, DontFuseHorizontalOffset) {
+  auto instantiation = makeCopyChain({1, 0, 0});
+
+  PassStencilFusion pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  EXPECT_EQ(instantiation->getStencils().size(), 2);
+  EXPECT_EQ(instantiation->getIIR()->getControlFlowDescriptor().getStatements().size(), 2);
+}
+
+TEST(TestPassStencilFusion, DemoteDeadField) {
+  auto instantiation = makeCopyChain({0, 0, 0});
+
+  Options options;
+  options.DeadFields = "mid";
+  PassStencilFusion pass;
+  EXPECT_TRUE(pass.run(instantiation, options));
+
+  ASSERT_EQ(instantiation->getStencils().size(), 1);
+  const auto& metadata = instantiation->getMetaData();
+  EXPECT_TRUE(metadata.isAccessType(iir::FieldAccessType::StencilTemporary, "mid"));
+  EXPECT_EQ(metadata.getAPIFields().size(), 2);
+}
+
+TEST(TestPassStencilFusion, DontDemotePartiallyWrittenField) {
+  // `mid` is written on [0, 10] but read on all levels
+  auto instantiation =
+      makeCopyChain({0, 0, 0}, iir::Interval(AInterval::Start, AInterval::Start, 0, 10));
+
+  Options options;
+  options.DeadFields = "mid";
+  PassStencilFusion pass;
+  EXPECT_TRUE(pass.run(instantiation, options));
+
+  ASSERT_EQ(instantiation->getStencils().size(), 1);
+  EXPECT_TRUE(instantiation->getMetaData().isAccessType(iir::FieldAccessType::APIField, "mid"));
+}
+
+TEST(TestPassStencilFusion, DontDemoteConditionallyWrittenField) {
+  auto instantiation =
+      makeCopyChain({0, 0, 0}, iir::Interval(AInterval::Start, AInterval::End), true);
+
+  Options options;
+  options.DeadFields = "mid";
+  PassStencilFusion pass;
+  EXPECT_TRUE(pass.run(instantiation, options));
+
+  ASSERT_EQ(instantiation->getStencils().size(), 1);
+  EXPECT_TRUE(instantiation->getMetaData().isAccessType(iir::FieldAccessType::APIField, "mid"));
+}
+
+TEST(TestPassStencilFusion, DontDemoteFieldReadBelowWrittenLevels) {
+  // `mid` is read at k-1 on all levels, the level below the first one is never written
+  auto instantiation = makeCopyChain({0, 0, -1});
+
+  Options options;
+  options.DeadFields = "mid";
+  PassStencilFusion pass;
+  EXPECT_TRUE(pass.run(instantiation, options));
+
+  ASSERT_EQ(instantiation->getStencils().size(), 1);
+  EXPECT_TRUE(instantiation->getMetaData().isAccessType(iir::FieldAccessType::APIField, "mid"));
+}
+
+} // anonymous namespace
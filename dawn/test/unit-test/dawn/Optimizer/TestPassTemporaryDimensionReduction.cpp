@@ -0,0 +1,94 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassTemporaryDimensionReduction.h"
+#include "dawn/Unittest/IIRBuilder.h"
+
+#include <gtest/gtest.h>
+
+using namespace dawn;
+
+namespace {
+
+using AInterval = dawn::ast::Interval;
+
+TEST(TestPassTemporaryDimensionReduction, RollingWindow) {
+  // forward: a = in; b = in; c = in; out = a[i+1] + b[k-2] + c[k+1]
+  UIDGenerator::getInstance()->reset();
+  iir::CartesianIIRBuilder b;
+  auto in = b.field("in", iir::FieldType::ijk);
+  auto out = b.field("out", iir::FieldType::ijk);
+  auto tmpA = b.tmpField("a", iir::FieldType::ijk);
+  auto tmpB = b.tmpField("b", iir::FieldType::ijk);
+  auto tmpC = b.tmpField("c", iir::FieldType::ijk);
+
+  auto instantiation = b.build(
+      "reduction",
+      b.stencil(b.multistage(
+          iir::LoopOrderKind::Forward,
+          b.stage(b.doMethod(AInterval::Start, AInterval::End,
+                             b.stmt(b.assignExpr(b.at(tmpA), b.at(in))),
+                             b.stmt(b.assignExpr(b.at(tmpB), b.at(in))),
+                             b.stmt(b.assignExpr(b.at(tmpC), b.at(in))))),
+          b.stage(b.doMethod(
+              AInterval::Start, AInterval::End,
+              b.stmt(b.assignExpr(b.at(out), b.binaryExpr(b.binaryExpr(b.at(tmpA, {1, 0, 0}),
+                                                                       b.at(tmpB, {0, 0, -2})),
+                                                          b.at(tmpC, {0, 0, 1})))))))));
+
+  PassTemporaryDimensionReduction pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  const auto& metadata = instantiation->getMetaData();
+  // a single plane for the horizontal access, the planes k-2 to k for the vertical one
+  EXPECT_EQ(metadata.getTemporaryNumLevels(tmpA.id), 1);
+  EXPECT_EQ(metadata.getTemporaryNumLevels(tmpB.id), 3);
+  // k+1 is computed after k in a forward loop
+  EXPECT_EQ(metadata.getTemporaryNumLevels(tmpC.id), 0);
+}
+
+TEST(TestPassTemporaryDimensionReduction, KeepAcrossMultiStages) {
+  // parallel: a = in; b = in; out = a + b[k+1], parallel: out = a
+  UIDGenerator::getInstance()->reset();
+  iir::CartesianIIRBuilder b;
+  auto in = b.field("in", iir::FieldType::ijk);
+  auto out = b.field("out", iir::FieldType::ijk);
+  auto tmpA = b.tmpField("a", iir::FieldType::ijk);
+  auto tmpB = b.tmpField("b", iir::FieldType::ijk);
+
+  auto instantiation = b.build(
+      "reduction",
+      b.stencil(
+          b.multistage(iir::LoopOrderKind::Parallel,
+                       b.stage(b.doMethod(AInterval::Start, AInterval::End,
+                                          b.stmt(b.assignExpr(b.at(tmpA), b.at(in))),
+                                          b.stmt(b.assignExpr(b.at(tmpB), b.at(in))))),
+                       b.stage(b.doMethod(
+                           AInterval::Start, AInterval::End,
+                           b.stmt(b.assignExpr(b.at(out),
+                                               b.binaryExpr(b.at(tmpA), b.at(tmpB, {0, 0, 1}))))))),
+          b.multistage(iir::LoopOrderKind::Parallel,
+                       b.stage(b.doMethod(AInterval::Start, AInterval::End,
+                                          b.stmt(b.assignExpr(b.at(out), b.at(tmpA))))))));
+
+  PassTemporaryDimensionReduction pass;
+  EXPECT_TRUE(pass.run(instantiation));
+
+  const auto& metadata = instantiation->getMetaData();
+  EXPECT_EQ(metadata.getTemporaryNumLevels(tmpA.id), 0);
+  EXPECT_EQ(metadata.getTemporaryNumLevels(tmpB.id), 0);
+}
+
+} // namespace
@@ -0,0 +1,119 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/IIR/ASTExpr.h"
+#include "dawn/IIR/IIR.h"
+#include "dawn/IIR/StencilInstantiation.h"
+#include "dawn/Optimizer/PassTemporaryToStencilFunction.h"
+#include "dawn/Optimizer/TemporaryCostModel.h"
+#include "dawn/Unittest/IIRBuilder.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+
+using namespace dawn;
+
+namespace {
+
+using AInterval = dawn::ast::Interval;
+
+/// tmp = in + 1 (cheap) or tmp = sqrt(in * in + 1) (expensive),
+/// out = tmp[i-1] + tmp[i+1] + tmp[j-1] + tmp[j+1]
+std::shared_ptr<iir::StencilInstantiation> makeStencil(bool expensive) {
+  UIDGenerator::getInstance()->reset();
+
+  iir::CartesianIIRBuilder b;
+  auto in = b.field("in", iir::FieldType::ijk);
+  auto out = b.field("out", iir::FieldType::ijk);
+  auto tmp = b.tmpField("tmp", iir::FieldType::ijk);
+
+  std::shared_ptr<ast::Expr> definition;
+  if(expensive) {
+    auto sqrt = std::make_shared<ast::FunCallExpr>("sqrt");
+    sqrt->insertArgument(b.binaryExpr(b.binaryExpr(b.at(in), b.at(in), iir::Op::multiply),
+                                      b.lit(1.), iir::Op::plus));
+    definition = sqrt;
+  } else {
+    definition = b.binaryExpr(b.at(in), b.lit(1.), iir::Op::plus);
+  }
+
+  auto stencil = b.stencil(b.multistage(
+      iir::LoopOrderKind::Parallel,
+      b.stage(
+          b.doMethod(AInterval::Start, AInterval::End,
+                     b.stmt(b.assignExpr(b.at(tmp, iir::AccessType::rw), std::move(definition))))),
+      b.stage(b.doMethod(
+          AInterval::Start, AInterval::End,
+          b.stmt(b.assignExpr(
+              b.at(out, iir::AccessType::rw),
+              b.binaryExpr(b.binaryExpr(b.at(tmp, {-1, 0, 0}), b.at(tmp, {1, 0, 0})),
+                           b.binaryExpr(b.at(tmp, {0, -1, 0}), b.at(tmp, {0, 1, 0})))))))));
+  return b.build("cost_model", std::move(stencil));
+}
+
+TemporaryCost computeCost(const std::shared_ptr<iir::StencilInstantiation>& instantiation,
+                          const Options& options) {
+  const auto& stencil = *instantiation->getStencils()[0];
+  auto tmp = std::find_if(stencil.getFields().begin(), stencil.getFields().end(),
+                          [](const auto& field) { return field.second.IsTemporary; });
+  return computeTemporaryCost(instantiation->getMetaData(), *stencil.getChildren().front(),
+                              tmp->first, options);
+}
+
+/// Number of stencil functions created by PassTemporaryToStencilFunction, one per replaced access
+int runPass(const std::shared_ptr<iir::StencilInstantiation>& instantiation,
+            const Options& options) {
+  for(auto& stmt : iterateIIROverStmt(*instantiation->getIIR())) {
+    stmt->getData<iir::IIRStmtData>().StackTrace = std::vector<ast::StencilCall*>();
+  }
+  PassTemporaryToStencilFunction pass;
+  pass.run(instantiation, options);
+  return instantiation->getIIR()->getStencilFunctions().size();
+}
+
+TEST(TestTemporaryCostModel, CheapTemporary) {
+  TemporaryCost cost = computeCost(makeStencil(false), Options{});
+
+  EXPECT_EQ(cost.flops, 1);
+  EXPECT_EQ(cost.numUses, 4);
+  // default tile of 32 x 4 grown by one point on each side
+  EXPECT_DOUBLE_EQ(cost.haloFactor, 34. * 6. / (32. * 4.));
+  EXPECT_TRUE(cost.recompute());
+}
+
+TEST(TestTemporaryCostModel, ExpensiveTemporary) {
+  TemporaryCost cost = computeCost(makeStencil(true), Options{});
+
+  EXPECT_EQ(cost.flops, 12);
+  EXPECT_EQ(cost.numUses, 4);
+  EXPECT_FALSE(cost.recompute());
+}
+
+TEST(TestTemporaryCostModel, MachineBalance) {
+  // on a machine with little bandwidth even expensive temporaries are recomputed
+  Options options;
+  options.MachineBalance = 20;
+  EXPECT_TRUE(computeCost(makeStencil(true), options).recompute());
+}
+
+TEST(TestTemporaryCostModel, PassTemporaryToStencilFunction) {
+  EXPECT_EQ(runPass(makeStencil(false), Options{}), 4);
+  EXPECT_EQ(runPass(makeStencil(true), Options{}), 0);
+
+  Options options;
+  options.MachineBalance = 20;
+  EXPECT_EQ(runPass(makeStencil(true), options), 4);
+}
+
+} // anonymous namespace
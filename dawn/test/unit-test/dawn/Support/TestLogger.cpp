@@ -16,6 +16,8 @@
 #include <algorithm>
 #include <gtest/gtest.h>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace dawn;
 
@@ -115,6 +117,23 @@ TEST(Logger, size_and_clear) {
   EXPECT_EQ(log.size(), 0);
 }
 
+TEST(Logger, concurrent) {
+  std::ostringstream buffer;
+  Logger log(makeMessageFormatter(), makeDiagnosticFormatter(), buffer);
+  std::vector<std::thread> threads;
+  for(int thread = 0; thread < 4; ++thread) {
+    threads.emplace_back([&log]() {
+      for(int message = 0; message < 1000; ++message)
+        log("TestLogger.cpp", 42) << "A message\n";
+    });
+  }
+  for(auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(log.size(), 4000);
+  const std::string output = buffer.str();
+  EXPECT_EQ(std::count(output.begin(), output.end(), '\n'), 4000);
+}
+
 TEST(Logger, show_and_hide) {
   std::ostringstream buffer;
   Logger log(makeMessageFormatter(), makeDiagnosticFormatter(), buffer, false);
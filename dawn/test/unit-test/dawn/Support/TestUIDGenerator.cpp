@@ -0,0 +1,69 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dawn/Support/IndexGenerator.h"
+#include "dawn/Support/UIDGenerator.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace dawn;
+
+namespace {
+
+TEST(UIDGenerator, scope) {
+  UIDGenerator* global = UIDGenerator::getInstance();
+  {
+    UIDGenerator generator;
+    UIDGenerator::Scope scope(generator);
+    EXPECT_EQ(UIDGenerator::getInstance(), &generator);
+    EXPECT_EQ(UIDGenerator::getInstance()->get(), 1);
+    EXPECT_EQ(UIDGenerator::getInstance()->get(), 2);
+  }
+  EXPECT_EQ(UIDGenerator::getInstance(), global);
+}
+
+TEST(UIDGenerator, concurrent_scopes) {
+  // every thread numbers its translation unit from scratch
+  std::vector<std::vector<int>> ids(4);
+  std::vector<std::thread> threads;
+  for(auto& threadIds : ids) {
+    threads.emplace_back([&threadIds]() {
+      UIDGenerator generator;
+      UIDGenerator::Scope scope(generator);
+      for(int i = 0; i < 1000; ++i)
+        threadIds.push_back(UIDGenerator::getInstance()->get());
+    });
+  }
+  for(auto& thread : threads)
+    thread.join();
+  for(const auto& threadIds : ids) {
+    ASSERT_EQ(threadIds.size(), 1000);
+    EXPECT_EQ(threadIds.front(), 1);
+    EXPECT_EQ(threadIds.back(), 1000);
+  }
+}
+
+TEST(IndexGenerator, scope) {
+  IndexGenerator* global = &IndexGenerator::Instance();
+  {
+    IndexGenerator generator;
+    IndexGenerator::Scope scope(generator);
+    EXPECT_EQ(&IndexGenerator::Instance(), &generator);
+    EXPECT_EQ(IndexGenerator::Instance().getIndex(), 0);
+  }
+  EXPECT_EQ(&IndexGenerator::Instance(), global);
+}
+
+} // namespace
@@ -0,0 +1,144 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Gather bandwidth of a cell to cell reduction (`sum over c > e > c`) on a triangle mesh whose
+// cells are numbered randomly, as is the case for meshes read from files without any particular
+// ordering, and after renumbering it with `reverseCuthillMcKee` and `hilbertOrder`.
+//
+// Usage: DawnBenchmarkMeshRenumbering [<number of quads per side> (default: 1024)]
+
+#include "driver-includes/mesh_renumbering.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int numNbhPerCell = 3;
+
+// nx x ny quads, each split into a lower and an upper triangle
+struct triangle_mesh {
+  int numCells;
+  std::vector<int> ccTable; // numCells x numNbhPerCell
+  std::vector<double> x, y; // centroids
+};
+
+triangle_mesh makeMesh(int nx, int ny) {
+  triangle_mesh mesh;
+  mesh.numCells = 2 * nx * ny;
+  mesh.ccTable.assign(mesh.numCells * numNbhPerCell, DEVICE_MISSING_VALUE);
+  mesh.x.resize(mesh.numCells);
+  mesh.y.resize(mesh.numCells);
+
+  auto cell = [&](int i, int j, int upper) { return 2 * (j * nx + i) + upper; };
+  for(int j = 0; j < ny; ++j) {
+    for(int i = 0; i < nx; ++i) {
+      int* lower = &mesh.ccTable[cell(i, j, 0) * numNbhPerCell];
+      lower[0] = cell(i, j, 1);
+      if(i > 0)
+        lower[1] = cell(i - 1, j, 1);
+      if(j > 0)
+        lower[2] = cell(i, j - 1, 1);
+      mesh.x[cell(i, j, 0)] = i + 1. / 3.;
+      mesh.y[cell(i, j, 0)] = j + 1. / 3.;
+
+      int* upper = &mesh.ccTable[cell(i, j, 1) * numNbhPerCell];
+      upper[0] = cell(i, j, 0);
+      if(i < nx - 1)
+        upper[1] = cell(i + 1, j, 0);
+      if(j < ny - 1)
+        upper[2] = cell(i, j + 1, 0);
+      mesh.x[cell(i, j, 1)] = i + 2. / 3.;
+      mesh.y[cell(i, j, 1)] = j + 2. / 3.;
+    }
+  }
+  return mesh;
+}
+
+triangle_mesh renumber(const triangle_mesh& mesh, const dawn::element_permutation& p) {
+  triangle_mesh renumbered = mesh;
+  p.renumberTable(mesh.ccTable.data(), renumbered.ccTable.data(), numNbhPerCell, p);
+  p.toNew(mesh.x.data(), renumbered.x.data());
+  p.toNew(mesh.y.data(), renumbered.y.data());
+  return renumbered;
+}
+
+std::vector<std::vector<int>> adjacency(const triangle_mesh& mesh) {
+  std::vector<std::vector<int>> adjacency(mesh.numCells);
+  for(int cell = 0; cell < mesh.numCells; ++cell) {
+    adjacency[cell].assign(mesh.ccTable.begin() + cell * numNbhPerCell,
+                           mesh.ccTable.begin() + (cell + 1) * numNbhPerCell);
+  }
+  return adjacency;
+}
+
+// Best time in seconds of the reduction over `numRepetitions` runs
+double benchmark(const triangle_mesh& mesh, int numRepetitions) {
+  std::vector<double> in(mesh.numCells, 1.), out(mesh.numCells);
+  double best = 1e30;
+  for(int repetition = 0; repetition < numRepetitions; ++repetition) {
+    const auto start = std::chrono::steady_clock::now();
+    for(int cell = 0; cell < mesh.numCells; ++cell) {
+      double sum = 0.;
+      for(int nbh = 0; nbh < numNbhPerCell; ++nbh) {
+        const int nbhIdx = mesh.ccTable[cell * numNbhPerCell + nbh];
+        if(nbhIdx == DEVICE_MISSING_VALUE)
+          continue;
+        sum += in[nbhIdx];
+      }
+      out[cell] = sum;
+    }
+    const auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(end - start).count());
+  }
+  // keep the reduction from being optimized away
+  if(out[mesh.numCells / 2] < 0.)
+    std::printf("unexpected result\n");
+  return best;
+}
+
+void report(const char* name, const triangle_mesh& mesh, double seconds, double reference) {
+  const double gatheredBytes = double(mesh.numCells) * numNbhPerCell * sizeof(double);
+  std::printf("%-24s %10.3f ms %10.2f GB/s gathered %8.2fx\n", name, seconds * 1e3,
+              gatheredBytes / seconds * 1e-9, reference / seconds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const int n = argc > 1 ? std::atoi(argv[1]) : 1024;
+  const int numRepetitions = 10;
+
+  // random numbering of the cells of a structured mesh
+  std::vector<int> shuffle(2 * n * n);
+  for(std::size_t idx = 0; idx < shuffle.size(); ++idx)
+    shuffle[idx] = idx;
+  std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(42));
+  const triangle_mesh mesh = renumber(makeMesh(n, n), dawn::element_permutation(shuffle));
+
+  std::printf("%d cells, %d neighbors per cell\n", mesh.numCells, numNbhPerCell);
+  const double reference = benchmark(mesh, numRepetitions);
+  report("random numbering", mesh, reference, reference);
+
+  const triangle_mesh rcm = renumber(mesh, dawn::reverseCuthillMcKee(adjacency(mesh)));
+  report("reverse Cuthill-McKee", rcm, benchmark(rcm, numRepetitions), reference);
+
+  const triangle_mesh hilbert = renumber(mesh, dawn::hilbertOrder(mesh.x, mesh.y));
+  report("Hilbert curve", hilbert, benchmark(hilbert, numRepetitions), reference);
+  return 0;
+}
@@ -0,0 +1,165 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Time a cell to cell reduction (`out = sum over c > e > c of in`) on a triangle mesh in the form
+// generated by the naive-ico backend, with scalar code and with SIMD code over `width` levels
+// (`--simd-width`). Fields with contiguous levels (atlas) use the vector loads and stores of
+// `simd_load`/`simd_ref`, fields storing each level contiguously (toylib) one access per lane.
+//
+// Usage: DawnBenchmarkUnstructuredSimd [<number of quads per side> (default: 256)]
+//                                      [<number of levels> (default: 80)]
+
+#include "driver-includes/unstructured_simd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using dawn::float_type;
+
+const int numNbhPerCell = 3;
+const int width = 4;
+const int missingValue = -1; // neighbors across the boundary of the mesh
+
+// nx x ny quads, each split into a lower and an upper triangle
+std::vector<int> makeCellToCellTable(int nx, int ny) {
+  std::vector<int> ccTable(2 * nx * ny * numNbhPerCell, missingValue);
+  auto cell = [&](int i, int j, int upper) { return 2 * (j * nx + i) + upper; };
+  for(int j = 0; j < ny; ++j) {
+    for(int i = 0; i < nx; ++i) {
+      int* lower = &ccTable[cell(i, j, 0) * numNbhPerCell];
+      lower[0] = cell(i, j, 1);
+      if(i > 0)
+        lower[1] = cell(i - 1, j, 1);
+      if(j > 0)
+        lower[2] = cell(i, j - 1, 1);
+
+      int* upper = &ccTable[cell(i, j, 1) * numNbhPerCell];
+      upper[0] = cell(i, j, 0);
+      if(i < nx - 1)
+        upper[1] = cell(i + 1, j, 0);
+      if(j < ny - 1)
+        upper[2] = cell(i, j + 1, 0);
+    }
+  }
+  return ccTable;
+}
+
+struct cell_field {
+  int numCells, kSize;
+  bool contiguousLevels;
+  std::vector<float_type> data;
+
+  cell_field(int numCells, int kSize, bool contiguousLevels)
+      : numCells(numCells), kSize(kSize), contiguousLevels(contiguousLevels),
+        data(numCells * kSize) {}
+
+  float_type& operator()(int cell, int k) {
+    return contiguousLevels ? data[cell * kSize + k] : data[k * numCells + cell];
+  }
+};
+
+void reduceScalar(const std::vector<int>& ccTable, cell_field& in, cell_field& out) {
+  for(int k = 0; k <= in.kSize - 1; ++k) {
+    for(int cell = 0; cell < in.numCells; ++cell) {
+      float_type lhs = 0.;
+      for(int nbh = 0; nbh < numNbhPerCell; ++nbh) {
+        const int nbhIdx = ccTable[cell * numNbhPerCell + nbh];
+        if(nbhIdx == missingValue)
+          continue;
+        lhs += in(nbhIdx, k);
+      }
+      out(cell, k) = lhs;
+    }
+  }
+}
+
+void reduceSimd(const std::vector<int>& ccTable, cell_field& in, cell_field& out) {
+  for(int k = 0; k + width - 1 <= in.kSize - 1; k += width) {
+    for(int cell = 0; cell < in.numCells; ++cell) {
+      dawn::float_simd<width> lhs(0.);
+      for(int nbh = 0; nbh < numNbhPerCell; ++nbh) {
+        const int nbhIdx = ccTable[cell * numNbhPerCell + nbh];
+        if(nbhIdx == missingValue)
+          continue;
+        lhs += dawn::simd_load<width>(
+            [&](int lane) -> float_type& { return in(nbhIdx, k + lane); });
+      }
+      dawn::simd_ref<width>([&](int lane) -> float_type& { return out(cell, k + lane); }) = lhs;
+    }
+  }
+  // remaining levels
+  for(int k = in.kSize / width * width; k <= in.kSize - 1; ++k) {
+    for(int cell = 0; cell < in.numCells; ++cell) {
+      float_type lhs = 0.;
+      for(int nbh = 0; nbh < numNbhPerCell; ++nbh) {
+        const int nbhIdx = ccTable[cell * numNbhPerCell + nbh];
+        if(nbhIdx == missingValue)
+          continue;
+        lhs += in(nbhIdx, k);
+      }
+      out(cell, k) = lhs;
+    }
+  }
+}
+
+// Best time in seconds of `reduce` over `numRepetitions` runs
+template <typename Reduce>
+double benchmark(Reduce reduce, const std::vector<int>& ccTable, cell_field& in, cell_field& out,
+                 int numRepetitions) {
+  double best = 1e30;
+  for(int repetition = 0; repetition < numRepetitions; ++repetition) {
+    const auto start = std::chrono::steady_clock::now();
+    reduce(ccTable, in, out);
+    const auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(end - start).count());
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const int n = argc > 1 ? std::atoi(argv[1]) : 256;
+  const int kSize = argc > 2 ? std::atoi(argv[2]) : 80;
+  const int numRepetitions = 10;
+
+  const std::vector<int> ccTable = makeCellToCellTable(n, n);
+  const int numCells = 2 * n * n;
+  std::printf("%d cells, %d levels, %d levels per SIMD iteration\n", numCells, kSize, width);
+
+  for(bool contiguousLevels : {true, false}) {
+    cell_field in(numCells, kSize, contiguousLevels);
+    cell_field scalarOut(numCells, kSize, contiguousLevels);
+    cell_field simdOut(numCells, kSize, contiguousLevels);
+    for(int cell = 0; cell < numCells; ++cell)
+      for(int k = 0; k < kSize; ++k)
+        in(cell, k) = std::sin(cell + 0.1 * k);
+
+    const double scalar = benchmark(reduceScalar, ccTable, in, scalarOut, numRepetitions);
+    const double simd = benchmark(reduceSimd, ccTable, in, simdOut, numRepetitions);
+    if(scalarOut.data != simdOut.data)
+      std::printf("SIMD and scalar results differ\n");
+
+    std::printf("%-20s scalar %10.3f ms, SIMD %10.3f ms %8.2fx\n",
+                contiguousLevels ? "contiguous levels" : "per-lane accesses", scalar * 1e3,
+                simd * 1e3, scalar / simd);
+  }
+  return 0;
+}
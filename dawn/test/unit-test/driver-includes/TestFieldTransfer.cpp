@@ -0,0 +1,181 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "driver-includes/field_transfer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Host-only stand-in for the CUDA allocator. "Asynchronous" copies are deferred until the stream
+// is synchronized, such that reading the staging buffer too early is caught by the tests.
+struct mock_allocator {
+  struct pending_copy {
+    void* dst;
+    const void* src;
+    std::size_t bytes;
+  };
+  using stream_type = std::vector<pending_copy>*;
+
+  static int numDeviceAllocs;
+  static int numHostAllocs;
+  static int numFrees;
+  static int numSyncs;
+
+  static void reset() { numDeviceAllocs = numHostAllocs = numFrees = numSyncs = 0; }
+
+  static void* allocate_device(std::size_t bytes) {
+    numDeviceAllocs++;
+    return std::malloc(bytes);
+  }
+  static void deallocate_device(void* ptr) {
+    numFrees++;
+    std::free(ptr);
+  }
+  static void* allocate_host_pinned(std::size_t bytes) {
+    numHostAllocs++;
+    return std::malloc(bytes);
+  }
+  static void deallocate_host_pinned(void* ptr) {
+    numFrees++;
+    std::free(ptr);
+  }
+  static void copy_to_device_async(void* dst, const void* src, std::size_t bytes,
+                                   stream_type stream) {
+    stream->push_back({dst, src, bytes});
+  }
+  static void copy_to_host_async(void* dst, const void* src, std::size_t bytes,
+                                 stream_type stream) {
+    stream->push_back({dst, src, bytes});
+  }
+  static void synchronize(stream_type stream) {
+    numSyncs++;
+    for(const auto& copy : *stream) {
+      std::memcpy(copy.dst, copy.src, copy.bytes);
+    }
+    stream->clear();
+  }
+};
+int mock_allocator::numDeviceAllocs = 0;
+int mock_allocator::numHostAllocs = 0;
+int mock_allocator::numFrees = 0;
+int mock_allocator::numSyncs = 0;
+
+using buffer_t = dawn::persistent_field_buffer<mock_allocator>;
+
+std::vector<dawn::float_type> iota(std::size_t size, dawn::float_type start) {
+  std::vector<dawn::float_type> vec(size);
+  for(std::size_t i = 0; i < size; ++i) {
+    vec[i] = start + i;
+  }
+  return vec;
+}
+
+TEST(driver_includes_field_transfer, AllocatesOnce) {
+  mock_allocator::reset();
+  std::vector<mock_allocator::pending_copy> stream;
+  const int numElements = 7, kSize = 3;
+
+  buffer_t buf;
+  buf.allocate(numElements, 1, kSize);
+  ASSERT_EQ(buf.num_elements(), numElements * kSize);
+
+  std::vector<dawn::float_type> out(numElements * kSize);
+  for(int timestep = 0; timestep < 5; ++timestep) {
+    auto in = iota(numElements * kSize, timestep * 100.);
+    buf.copy_to_device_async(in.data(), /*doReshape*/ false, &stream);
+    buf.copy_to_host(out.data(), /*doReshape*/ false, &stream);
+    ASSERT_EQ(in, out);
+  }
+  EXPECT_EQ(mock_allocator::numDeviceAllocs, 1);
+  EXPECT_EQ(mock_allocator::numHostAllocs, 1);
+
+  buf.free();
+  EXPECT_EQ(mock_allocator::numFrees, 2);
+  EXPECT_FALSE(buf.is_allocated());
+}
+
+TEST(driver_includes_field_transfer, DenseReshape) {
+  std::vector<mock_allocator::pending_copy> stream;
+  const int numElements = 5, kSize = 4;
+
+  buffer_t buf;
+  buf.allocate(numElements, 1, kSize);
+
+  // host layout: element major, device layout: level major
+  auto in = iota(numElements * kSize, 0.);
+  buf.copy_to_device_async(in.data(), /*doReshape*/ true, &stream);
+  mock_allocator::synchronize(&stream);
+  for(int elIdx = 0; elIdx < numElements; ++elIdx)
+    for(int kLevel = 0; kLevel < kSize; ++kLevel) {
+      ASSERT_EQ(buf.device_ptr()[kLevel * numElements + elIdx], in[elIdx * kSize + kLevel]);
+    }
+
+  std::vector<dawn::float_type> out(numElements * kSize);
+  buf.copy_to_host(out.data(), /*doReshape*/ true, &stream);
+  EXPECT_EQ(in, out);
+  buf.free();
+}
+
+TEST(driver_includes_field_transfer, SparseReshape) {
+  std::vector<mock_allocator::pending_copy> stream;
+  const int numElements = 4, sparseSize = 3, kSize = 2;
+
+  buffer_t buf;
+  buf.allocate(numElements, sparseSize, kSize);
+
+  auto in = iota(numElements * sparseSize * kSize, 0.);
+  buf.copy_to_device_async(in.data(), /*doReshape*/ true, &stream);
+  mock_allocator::synchronize(&stream);
+  for(int elIdx = 0; elIdx < numElements; ++elIdx)
+    for(int kLevel = 0; kLevel < kSize; ++kLevel)
+      for(int sparseIdx = 0; sparseIdx < sparseSize; ++sparseIdx) {
+        ASSERT_EQ(buf.device_ptr()[kLevel * numElements * sparseSize + sparseIdx * numElements +
+                                   elIdx],
+                  in[elIdx * kSize * sparseSize + kLevel * sparseSize + sparseIdx]);
+      }
+
+  std::vector<dawn::float_type> out(in.size());
+  buf.copy_to_host(out.data(), /*doReshape*/ true, &stream);
+  EXPECT_EQ(in, out);
+  buf.free();
+}
+
+TEST(driver_includes_field_transfer, StagingIsNotOverwrittenInFlight) {
+  mock_allocator::reset();
+  std::vector<mock_allocator::pending_copy> stream;
+  const int numElements = 6;
+
+  buffer_t buf;
+  buf.allocate(numElements, 1, 1);
+
+  // the second upload must wait for the first one before reusing the staging buffer
+  auto first = iota(numElements, 0.);
+  auto second = iota(numElements, 10.);
+  buf.copy_to_device_async(first.data(), /*doReshape*/ false, &stream);
+  EXPECT_EQ(mock_allocator::numSyncs, 0);
+  buf.copy_to_device_async(second.data(), /*doReshape*/ false, &stream);
+  EXPECT_EQ(mock_allocator::numSyncs, 1);
+
+  std::vector<dawn::float_type> out(numElements);
+  buf.copy_to_host(out.data(), /*doReshape*/ false, &stream);
+  EXPECT_EQ(second, out);
+  buf.free();
+}
+
+} // namespace
@@ -0,0 +1,132 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "driver-includes/local_halo_exchange.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+using dawn::driver::halo_region;
+
+// 2 x 2 ranks with 4 x 3 interior points, a halo of 2 and 2 vertical levels. Interior points hold
+// their global index, halo points hold -1.
+struct decomposition {
+  static constexpr int xcols = 2, ycols = 2, ni = 4, nj = 3, halo = 2, ksize = 2;
+  static constexpr int isize = ni + 2 * halo, jsize = nj + 2 * halo;
+
+  dawn::driver::local_halo_exchange<double> exchange;
+  std::vector<std::vector<double>> data;
+
+  explicit decomposition(bool periodic)
+      : exchange(xcols, ycols, isize, jsize, halo, periodic),
+        data(xcols * ycols, std::vector<double>(isize * jsize * ksize, -1.)) {
+    for(int rank = 0; rank < exchange.num_ranks(); ++rank) {
+      exchange.register_field(rank, "f", data[rank].data(), {1, isize, isize * jsize}, ksize);
+      for(int k = 0; k < ksize; ++k)
+        for(int j = halo; j < halo + nj; ++j)
+          for(int i = halo; i < halo + ni; ++i) {
+            at(rank, i, j, k) = globalIndex(rank, i, j, k, periodic);
+          }
+    }
+  }
+
+  double& at(int rank, int i, int j, int k) {
+    return data[rank][i + j * isize + k * isize * jsize];
+  }
+
+  // global index of local point (i, j, k) of `rank` or -1 if it is outside the global domain
+  static double globalIndex(int rank, int i, int j, int k, bool periodic) {
+    int gi = (rank % xcols) * ni + i - halo;
+    int gj = (rank / xcols) * nj + j - halo;
+    if(periodic) {
+      gi = (gi + xcols * ni) % (xcols * ni);
+      gj = (gj + ycols * nj) % (ycols * nj);
+    } else if(gi < 0 || gi >= xcols * ni || gj < 0 || gj >= ycols * nj) {
+      return -1.;
+    }
+    return gi + gj * xcols * ni + k * xcols * ni * ycols * nj;
+  }
+
+  // run `regions` of exchanges on all ranks concurrently
+  void run(const std::vector<halo_region>& regions) {
+    std::vector<std::thread> ranks;
+    for(int rank = 0; rank < exchange.num_ranks(); ++rank) {
+      auto hooks = exchange.hooks(rank);
+      ranks.emplace_back([hooks, regions] { hooks.exchange(regions); });
+    }
+    for(auto& rank : ranks) {
+      rank.join();
+    }
+  }
+};
+
+TEST(driver_includes_halo_exchange, Periodic) {
+  decomposition dec(/*periodic*/ true);
+  dec.run({{"f", {{{-2, 2}, {-2, 2}, {0, 0}}}}});
+
+  for(int rank = 0; rank < dec.exchange.num_ranks(); ++rank)
+    for(int k = 0; k < decomposition::ksize; ++k)
+      for(int j = 0; j < decomposition::jsize; ++j)
+        for(int i = 0; i < decomposition::isize; ++i) {
+          ASSERT_EQ(dec.at(rank, i, j, k), decomposition::globalIndex(rank, i, j, k, true))
+              << "rank " << rank << " at (" << i << ", " << j << ", " << k << ")";
+        }
+}
+
+TEST(driver_includes_halo_exchange, NonPeriodic) {
+  decomposition dec(/*periodic*/ false);
+  dec.run({{"f", {{{-1, 1}, {-1, 1}, {0, 0}}}}});
+
+  // rank 0 is the lower left subdomain: only its east and north halos have neighbors
+  const int halo = decomposition::halo;
+  const int ni = decomposition::ni, nj = decomposition::nj;
+  EXPECT_EQ(dec.at(0, halo - 1, halo, 0), -1.);
+  EXPECT_EQ(dec.at(0, halo, halo - 1, 0), -1.);
+  EXPECT_EQ(dec.at(0, halo + ni, halo, 0),
+            decomposition::globalIndex(0, halo + ni, halo, 0, false));
+  EXPECT_EQ(dec.at(0, halo, halo + nj, 1),
+            decomposition::globalIndex(0, halo, halo + nj, 1, false));
+  EXPECT_EQ(dec.at(0, halo + ni, halo + nj, 0),
+            decomposition::globalIndex(0, halo + ni, halo + nj, 0, false));
+}
+
+TEST(driver_includes_halo_exchange, OnlyRequestedRegion) {
+  decomposition dec(/*periodic*/ true);
+  dec.run({{"f", {{{0, 1}, {0, 0}, {0, 0}}}}});
+
+  const int halo = decomposition::halo;
+  const int ni = decomposition::ni;
+  for(int rank = 0; rank < dec.exchange.num_ranks(); ++rank) {
+    // one line in the east is updated ...
+    EXPECT_EQ(dec.at(rank, halo + ni, halo, 0),
+              decomposition::globalIndex(rank, halo + ni, halo, 0, true));
+    // ... but neither the second one, nor the west or the north/south halos
+    EXPECT_EQ(dec.at(rank, halo + ni + 1, halo, 0), -1.);
+    EXPECT_EQ(dec.at(rank, halo - 1, halo, 0), -1.);
+    EXPECT_EQ(dec.at(rank, halo, halo - 1, 0), -1.);
+  }
+}
+
+TEST(driver_includes_halo_exchange, NoHooks) {
+  // stencils without hooks skip the exchange
+  dawn::driver::halo_exchange_hooks hooks;
+  EXPECT_FALSE(hooks);
+  hooks.exchange({{"f", {{{-1, 1}, {0, 0}, {0, 0}}}}});
+}
+
+} // namespace
@@ -0,0 +1,176 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "driver-includes/mesh_renumbering.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Neighbors of the points of a nx x ny grid numbered along `order`
+std::vector<std::vector<int>> gridAdjacency(int nx, int ny, const std::vector<int>& order) {
+  std::vector<int> index(order.size());
+  for(std::size_t idx = 0; idx < order.size(); ++idx)
+    index[order[idx]] = idx;
+
+  std::vector<std::vector<int>> adjacency(nx * ny);
+  for(int j = 0; j < ny; ++j) {
+    for(int i = 0; i < nx; ++i) {
+      auto& neighbors = adjacency[index[j * nx + i]];
+      if(i > 0)
+        neighbors.push_back(index[j * nx + i - 1]);
+      if(i < nx - 1)
+        neighbors.push_back(index[j * nx + i + 1]);
+      if(j > 0)
+        neighbors.push_back(index[(j - 1) * nx + i]);
+      if(j < ny - 1)
+        neighbors.push_back(index[(j + 1) * nx + i]);
+    }
+  }
+  return adjacency;
+}
+
+std::vector<int> shuffled(int size) {
+  std::vector<int> order(size);
+  for(int idx = 0; idx < size; ++idx)
+    order[idx] = idx;
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+  return order;
+}
+
+// Largest distance between the indices of neighbors
+int bandwidth(const std::vector<std::vector<int>>& adjacency, const dawn::element_permutation& p) {
+  int bandwidth = 0;
+  for(std::size_t elem = 0; elem < adjacency.size(); ++elem)
+    for(int nbh : adjacency[elem])
+      bandwidth = std::max(bandwidth, std::abs(p.toNew(elem) - p.toNew(nbh)));
+  return bandwidth;
+}
+
+void expectWithinBlocks(const dawn::element_permutation& p, const std::vector<int>& splitters) {
+  for(int newIdx = 0; newIdx < p.size(); ++newIdx) {
+    const int oldIdx = p.toOld(newIdx);
+    ASSERT_EQ(p.toNew(oldIdx), newIdx);
+    for(int splitter : splitters) {
+      ASSERT_EQ(oldIdx < splitter, newIdx < splitter)
+          << "element " << oldIdx << " moved to " << newIdx << " across " << splitter;
+    }
+  }
+}
+
+TEST(driver_includes_mesh_renumbering, Fields) {
+  const dawn::element_permutation p({2, 0, 1});
+  // two levels per element
+  const std::vector<double> field = {0., 0.5, 1., 1.5, 2., 2.5};
+  std::vector<double> renumbered(field.size()), back(field.size());
+  p.toNew(field.data(), renumbered.data(), 2);
+  EXPECT_EQ(renumbered, (std::vector<double>{2., 2.5, 0., 0.5, 1., 1.5}));
+  p.toOld(renumbered.data(), back.data(), 2);
+  EXPECT_EQ(back, field);
+}
+
+TEST(driver_includes_mesh_renumbering, Tables) {
+  // edges 0..2 with two cells each, cells 0..1
+  const dawn::element_permutation edges({2, 0, 1});
+  const dawn::element_permutation cells({1, 0});
+  const std::vector<int> ecTable = {0, 1, 1, DEVICE_MISSING_VALUE, 0, 1};
+  const std::vector<double> cellField = {10., 20.};
+
+  std::vector<int> renumbered(ecTable.size());
+  edges.renumberTable(ecTable.data(), renumbered.data(), 2, cells);
+  std::vector<double> renumberedCellField(cellField.size());
+  cells.toNew(cellField.data(), renumberedCellField.data());
+
+  // the renumbered table gathers the same values
+  for(int edge = 0; edge < 3; ++edge) {
+    for(int nbh = 0; nbh < 2; ++nbh) {
+      const int cell = ecTable[edge * 2 + nbh];
+      const int renumberedCell = renumbered[edges.toNew(edge) * 2 + nbh];
+      if(cell == DEVICE_MISSING_VALUE) {
+        EXPECT_EQ(renumberedCell, DEVICE_MISSING_VALUE);
+      } else {
+        EXPECT_EQ(renumberedCellField[renumberedCell], cellField[cell]);
+      }
+    }
+  }
+
+  // same for neighbor-major tables
+  std::vector<int> neighborMajor(ecTable.size()), renumberedNeighborMajor(ecTable.size());
+  for(int edge = 0; edge < 3; ++edge)
+    for(int nbh = 0; nbh < 2; ++nbh)
+      neighborMajor[nbh * 3 + edge] = ecTable[edge * 2 + nbh];
+  edges.renumberTable(neighborMajor.data(), renumberedNeighborMajor.data(), 2, cells,
+                      dawn::nbh_table_layout::neighbor_major);
+  for(int edge = 0; edge < 3; ++edge)
+    for(int nbh = 0; nbh < 2; ++nbh)
+      EXPECT_EQ(renumberedNeighborMajor[nbh * 3 + edge], renumbered[edge * 2 + nbh]);
+}
+
+TEST(driver_includes_mesh_renumbering, ReverseCuthillMcKee) {
+  const int nx = 20, ny = 30;
+  const auto adjacency = gridAdjacency(nx, ny, shuffled(nx * ny));
+
+  const auto p = dawn::reverseCuthillMcKee(adjacency);
+  expectWithinBlocks(p, {});
+  EXPECT_GT(bandwidth(adjacency, dawn::element_permutation::identity(nx * ny)), 4 * nx);
+  // a breadth-first traversal of the grid numbers it by diagonals
+  EXPECT_LE(bandwidth(adjacency, p), 2 * nx);
+}
+
+TEST(driver_includes_mesh_renumbering, ReverseCuthillMcKeeSubdomains) {
+  const int nx = 20, ny = 30;
+  const auto adjacency = gridAdjacency(nx, ny, shuffled(nx * ny));
+  const std::vector<int> splitters = {17, 100, 450};
+  expectWithinBlocks(dawn::reverseCuthillMcKee(adjacency, splitters), splitters);
+}
+
+TEST(driver_includes_mesh_renumbering, Hilbert) {
+  const int n = 16;
+  const std::vector<int> order = shuffled(n * n);
+  std::vector<double> x(n * n), y(n * n);
+  for(int idx = 0; idx < n * n; ++idx) {
+    x[idx] = order[idx] % n;
+    y[idx] = order[idx] / n;
+  }
+
+  const auto p = dawn::hilbertOrder(x, y);
+  expectWithinBlocks(p, {});
+  // consecutive points along a Hilbert curve are neighbors on the grid
+  for(int newIdx = 1; newIdx < n * n; ++newIdx) {
+    const int prev = p.toOld(newIdx - 1), next = p.toOld(newIdx);
+    EXPECT_EQ(std::abs(x[prev] - x[next]) + std::abs(y[prev] - y[next]), 1.) << "at " << newIdx;
+  }
+
+  const std::vector<int> splitters = {5, 128};
+  expectWithinBlocks(dawn::hilbertOrder(x, y, splitters), splitters);
+}
+
+TEST(driver_includes_mesh_renumbering, DomainSplitters) {
+  dawn::unstructured_domain domain;
+  domain.set_splitter_index({dawn::LocationType::Cells, dawn::UnstructuredSubdomain::Interior, 0},
+                            40);
+  domain.set_splitter_index(
+      {dawn::LocationType::Cells, dawn::UnstructuredSubdomain::LateralBoundary, 1}, 10);
+  domain.set_splitter_index({dawn::LocationType::Cells, dawn::UnstructuredSubdomain::Halo, 0}, 90);
+  domain.set_splitter_index({dawn::LocationType::Edges, dawn::UnstructuredSubdomain::Halo, 0}, 7);
+  EXPECT_EQ(domain.splitter_indices(dawn::LocationType::Cells), (std::vector<int>{10, 40, 90}));
+  EXPECT_EQ(domain.splitter_indices(dawn::LocationType::Vertices), std::vector<int>{});
+}
+
+} // namespace
@@ -0,0 +1,194 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "driver-includes/nbh_table.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+namespace nbh_table_test {
+
+// Minimal mesh library with `numElements` elements of each location type. Element `idx` has
+// `idx % 4` neighbors along any chain, namely idx + 1, idx + 2, ...
+struct testTag {};
+struct test_mesh {
+  int numElements;
+};
+test_mesh meshType(testTag);
+int indexType(testTag);
+
+std::vector<int> getElements(const test_mesh& mesh) {
+  std::vector<int> elements(mesh.numElements);
+  for(int idx = 0; idx < mesh.numElements; ++idx)
+    elements[idx] = idx;
+  return elements;
+}
+std::vector<int> getCells(testTag, const test_mesh& mesh) { return getElements(mesh); }
+std::vector<int> getEdges(testTag, const test_mesh& mesh) { return getElements(mesh); }
+std::vector<int> getVertices(testTag, const test_mesh& mesh) { return getElements(mesh); }
+std::vector<int> getNeighbors(testTag, const test_mesh& mesh,
+                              const std::vector<dawn::LocationType>& /*chain*/, int idx,
+                              bool includeCenter = false) {
+  std::vector<int> neighbors;
+  if(includeCenter)
+    neighbors.push_back(idx);
+  for(int nbh = 1; nbh <= idx % 4; ++nbh)
+    neighbors.push_back((idx + nbh) % mesh.numElements);
+  return neighbors;
+}
+int getNeighbors(testTag, const test_mesh& mesh, const std::vector<dawn::LocationType>& chain,
+                 int idx, bool includeCenter, int* neighbors, int maxNeighbors, int stride = 1) {
+  int size = 0;
+  for(int nbh : getNeighbors(testTag{}, mesh, chain, idx, includeCenter))
+    if(size < maxNeighbors)
+      neighbors[size++ * stride] = nbh;
+  return size;
+}
+
+} // namespace nbh_table_test
+
+namespace {
+
+using nbh_table_test::test_mesh;
+using nbh_table_test::testTag;
+
+const std::vector<dawn::LocationType> chain = {dawn::LocationType::Edges,
+                                               dawn::LocationType::Cells};
+
+std::vector<int> fillTable(const test_mesh& mesh, int numNbhPerElement, bool includeCenter,
+                           dawn::nbh_table_layout layout = dawn::nbh_table_layout::element_major) {
+  std::vector<int> table(mesh.numElements * numNbhPerElement, 42);
+  dawn::fillNbhTable<testTag>(mesh, chain, mesh.numElements, numNbhPerElement, table.data(),
+                              includeCenter, layout);
+  return table;
+}
+
+TEST(driver_includes_nbh_table, ParallelChunks) {
+  const std::size_t size = 100000;
+  std::vector<int> visited(size, 0);
+  dawn::parallel_chunks(
+      size,
+      [&](std::size_t begin, std::size_t end) {
+        for(std::size_t idx = begin; idx != end; ++idx)
+          ++visited[idx];
+      },
+      7);
+  for(std::size_t idx = 0; idx < size; ++idx) {
+    ASSERT_EQ(visited[idx], 1) << "at " << idx;
+  }
+}
+
+TEST(driver_includes_nbh_table, Fill) {
+  // large enough to be filled by several threads
+  const test_mesh mesh{50000};
+  const std::vector<int> table = fillTable(mesh, 3, false);
+
+  for(int idx = 0; idx < mesh.numElements; ++idx) {
+    for(int nbh = 0; nbh < 3; ++nbh) {
+      const int expected =
+          nbh < idx % 4 ? (idx + nbh + 1) % mesh.numElements : DEVICE_MISSING_VALUE;
+      ASSERT_EQ(table[idx * 3 + nbh], expected) << "element " << idx << ", neighbor " << nbh;
+    }
+  }
+}
+
+TEST(driver_includes_nbh_table, FillWithCenter) {
+  const test_mesh mesh{8};
+  const std::vector<int> table = fillTable(mesh, 2, true);
+  EXPECT_EQ(table[0 * 2], 0);
+  EXPECT_EQ(table[0 * 2 + 1], DEVICE_MISSING_VALUE);
+  EXPECT_EQ(table[5 * 2], 5);
+  EXPECT_EQ(table[5 * 2 + 1], 6);
+}
+
+TEST(driver_includes_nbh_table, FillNeighborMajor) {
+  const test_mesh mesh{50000};
+  const int numNbhPerElement = 3;
+  const std::vector<int> elementMajor = fillTable(mesh, numNbhPerElement, true);
+  const std::vector<int> neighborMajor =
+      fillTable(mesh, numNbhPerElement, true, dawn::nbh_table_layout::neighbor_major);
+
+  // same index arithmetic as the kernels generated with and without -neighbor-major-tables
+  const int tableStride = mesh.numElements;
+  for(int pidx = 0; pidx < mesh.numElements; ++pidx) {
+    for(int nbhIter = 0; nbhIter < numNbhPerElement; ++nbhIter) {
+      ASSERT_EQ(neighborMajor[nbhIter * tableStride + pidx],
+                elementMajor[pidx * numNbhPerElement + nbhIter])
+          << "element " << pidx << ", neighbor " << nbhIter;
+    }
+  }
+}
+
+TEST(driver_includes_nbh_table, Fingerprint) {
+  EXPECT_EQ(dawn::meshFingerprint<testTag>(test_mesh{10}),
+            dawn::meshFingerprint<testTag>(test_mesh{10}));
+  EXPECT_NE(dawn::meshFingerprint<testTag>(test_mesh{10}),
+            dawn::meshFingerprint<testTag>(test_mesh{11}));
+}
+
+class driver_includes_nbh_table_cache : public ::testing::Test {
+protected:
+  std::string directory_;
+
+  void SetUp() override {
+    char directory[] = "/tmp/dawn_nbh_table_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+    directory_ = directory;
+  }
+  void TearDown() override { std::system(("rm -rf " + directory_).c_str()); }
+};
+
+TEST_F(driver_includes_nbh_table_cache, RoundTrip) {
+  const test_mesh mesh{100};
+  const std::vector<int> table = fillTable(mesh, 3, false);
+  const dawn::UnstructuredIterationSpace space{chain, false};
+
+  dawn::nbh_table_cache cache(directory_, dawn::meshFingerprint<testTag>(mesh));
+  EXPECT_FALSE(cache.load(space, mesh.numElements, 3));
+  ASSERT_TRUE(cache.store(space, table.data(), mesh.numElements, 3));
+
+  auto cachedTable = cache.load(space, mesh.numElements, 3);
+  ASSERT_TRUE(cachedTable);
+  EXPECT_EQ(std::vector<int>(cachedTable.data(), cachedTable.data() + table.size()), table);
+}
+
+TEST_F(driver_includes_nbh_table_cache, Keys) {
+  const test_mesh mesh{100};
+  const std::vector<int> table = fillTable(mesh, 3, false);
+  const dawn::UnstructuredIterationSpace space{chain, false};
+
+  dawn::nbh_table_cache cache(directory_, 1);
+  ASSERT_TRUE(cache.store(space, table.data(), mesh.numElements, 3));
+
+  // different iteration space
+  EXPECT_FALSE(cache.load(dawn::UnstructuredIterationSpace{chain, true}, mesh.numElements, 3));
+  // different size
+  EXPECT_FALSE(cache.load(space, mesh.numElements, 4));
+  // different layout
+  EXPECT_FALSE(cache.load(space, mesh.numElements, 3, dawn::nbh_table_layout::neighbor_major));
+  EXPECT_NE(cache.path(space), cache.path(space, dawn::nbh_table_layout::neighbor_major));
+  // different mesh
+  EXPECT_FALSE(dawn::nbh_table_cache(directory_, 2).load(space, mesh.numElements, 3));
+  EXPECT_NE(cache.path(space), dawn::nbh_table_cache(directory_, 2).path(space));
+}
+
+TEST_F(driver_includes_nbh_table_cache, UnwritableDirectory) {
+  const std::vector<int> table(10, 0);
+  dawn::nbh_table_cache cache(directory_ + "/does/not/exist", 1);
+  EXPECT_FALSE(cache.store(dawn::UnstructuredIterationSpace{chain, false}, table.data(), 5, 2));
+}
+
+} // namespace
@@ -0,0 +1,68 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "driver-includes/padded_field.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+TEST(driver_includes_padded_field, PaddedSize) {
+  EXPECT_EQ(dawn::padded_size(0, 32), 0);
+  EXPECT_EQ(dawn::padded_size(1, 32), 32);
+  EXPECT_EQ(dawn::padded_size(32, 32), 32);
+  EXPECT_EQ(dawn::padded_size(33, 32), 64);
+  EXPECT_EQ(dawn::padded_size(33, 1), 33);
+  EXPECT_EQ(dawn::padded_size(33, 0), 33);
+}
+
+TEST(driver_includes_padded_field, AlignedLevels) {
+  for(std::size_t alignment : {64, 128}) {
+    dawn::padded_field<double> field(100, 5, 1, 16, alignment);
+    EXPECT_EQ(field.stride(), 112);
+    EXPECT_EQ(field.size(), 112u * 5);
+    for(int k = 0; k < field.kSize(); ++k) {
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&field(0, k)) % alignment, 0u) << "level " << k;
+    }
+  }
+}
+
+TEST(driver_includes_padded_field, Layout) {
+  dawn::padded_field<float> field(10, 3, 2, 32);
+  EXPECT_EQ(field.stride(), 32);
+  for(int k = 0; k < 3; ++k)
+    for(int sparse = 0; sparse < 2; ++sparse)
+      for(int elem = 0; elem < 10; ++elem)
+        field(elem, sparse, k) = 100 * k + 10 * sparse + elem;
+
+  // levels, sparse entries and elements from slowest to fastest varying
+  EXPECT_EQ(field.data()[(2 * 2 + 1) * 32 + 7], 217.f);
+  EXPECT_EQ(field.data()[1 * 32 + 3], 13.f);
+  // the padding is zero initialized
+  EXPECT_EQ(field.data()[31], 0.f);
+}
+
+TEST(driver_includes_padded_field, Move) {
+  dawn::padded_field<double> field(8, 2);
+  field(3, 1) = 42.;
+  const double* data = field.data();
+  dawn::padded_field<double> moved = std::move(field);
+  EXPECT_EQ(moved.data(), data);
+  EXPECT_EQ(moved(3, 1), 42.);
+}
+
+} // namespace
@@ -0,0 +1,106 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "driver-includes/unstructured_simd.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+using dawn::float_type;
+
+const int width = 4;
+
+// Levels `k, k + 1, ...` of element `elem` in a field with `stride` values between two levels,
+// i.e. the levels are contiguous for a stride of 1. Counts the calls of the accessor to tell the
+// vector accesses (first and last lane only) from the per-lane ones.
+struct level_access {
+  std::vector<float_type>& data;
+  int elem, k, stride;
+  int& numCalls;
+
+  float_type& operator()(int lane) const {
+    ++numCalls;
+    return data[(k + lane) * stride + elem];
+  }
+};
+
+std::vector<float_type> makeField(int size) {
+  std::vector<float_type> data(size);
+  for(int idx = 0; idx < size; ++idx)
+    data[idx] = idx;
+  return data;
+}
+
+TEST(driver_includes_unstructured_simd, LoadContiguous) {
+  auto data = makeField(16);
+  int numCalls = 0;
+  const auto value = dawn::simd_load<width>(level_access{data, 0, 3, 1, numCalls});
+  for(int lane = 0; lane < width; ++lane)
+    EXPECT_EQ(value[lane], float_type(3 + lane)) << "lane " << lane;
+  EXPECT_EQ(numCalls, 2);
+}
+
+TEST(driver_includes_unstructured_simd, LoadPerLane) {
+  auto data = makeField(5 * 8);
+  int numCalls = 0;
+  const auto value = dawn::simd_load<width>(level_access{data, 2, 1, 5, numCalls});
+  for(int lane = 0; lane < width; ++lane)
+    EXPECT_EQ(value[lane], float_type((1 + lane) * 5 + 2)) << "lane " << lane;
+  EXPECT_EQ(numCalls, 2 + width);
+}
+
+TEST(driver_includes_unstructured_simd, StoreContiguous) {
+  auto data = makeField(16);
+  int numCalls = 0;
+  dawn::simd_ref<width>(level_access{data, 0, 3, 1, numCalls}) = dawn::float_simd<width>(-1);
+  for(int idx = 0; idx < 16; ++idx)
+    EXPECT_EQ(data[idx], idx >= 3 && idx < 3 + width ? float_type(-1) : float_type(idx))
+        << "index " << idx;
+  EXPECT_EQ(numCalls, 2);
+}
+
+TEST(driver_includes_unstructured_simd, StorePerLane) {
+  auto data = makeField(5 * 8);
+  int numCalls = 0;
+  dawn::simd_ref<width>(level_access{data, 2, 1, 5, numCalls}) = dawn::float_simd<width>(-1);
+  // only the element itself is written on each level
+  for(int idx = 0; idx < 5 * 8; ++idx) {
+    const int k = idx / 5, elem = idx % 5;
+    EXPECT_EQ(data[idx], elem == 2 && k >= 1 && k < 1 + width ? float_type(-1) : float_type(idx))
+        << "index " << idx;
+  }
+  EXPECT_EQ(numCalls, 2 + width);
+}
+
+TEST(driver_includes_unstructured_simd, CompoundAssignment) {
+  for(int stride : {1, 5}) {
+    auto data = makeField(stride * 8);
+    int numCalls = 0;
+    level_access access{data, 0, 2, stride, numCalls};
+    dawn::simd_ref<width>(access) += dawn::float_simd<width>(1);
+    dawn::simd_ref<width>(access) *= dawn::float_simd<width>(2);
+    dawn::simd_ref<width>(access) -= dawn::float_simd<width>(4);
+    dawn::simd_ref<width>(access) /= dawn::float_simd<width>(2);
+    for(int lane = 0; lane < width; ++lane) {
+      const float_type initial = (2 + lane) * stride;
+      EXPECT_EQ(access(lane), ((initial + 1) * 2 - 4) / 2)
+          << "stride " << stride << ", lane " << lane;
+    }
+  }
+}
+
+} // namespace
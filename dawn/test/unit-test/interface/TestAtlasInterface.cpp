@@ -273,4 +273,40 @@ TEST_F(TestAtlasInterface, Intp) {
   ASSERT_TRUE(nbhsValidAndEqual(intpLoRef, intpLo));
   ASSERT_TRUE(nbhsValidAndEqual(intpHiRef, intpHi));
 }
-} // namespace
\ No newline at end of file
+
+TEST_F(TestAtlasInterface, NeighborsIntoBuffer) {
+  // same neighbors in the same order as the allocating version, along chains starting and passing
+  // through all location types, with and without the center
+  using dawn::LocationType;
+  const std::vector<std::vector<LocationType>> chains{
+      {LocationType::Edges, LocationType::Cells, LocationType::Vertices},
+      {LocationType::Vertices, LocationType::Cells, LocationType::Edges},
+      {LocationType::Cells, LocationType::Edges, LocationType::Cells, LocationType::Edges,
+       LocationType::Cells},
+      {LocationType::Vertices, LocationType::Edges, LocationType::Vertices}};
+  for(const auto& chain : chains) {
+    for(bool includeCenter : {false, true}) {
+      const std::vector<int> expected = atlasInterface::getNeighbors(
+          atlasInterface::atlasTag{}, getMesh(), chain, testIdx(), includeCenter);
+
+      // element-major row, large enough for all neighbors
+      std::vector<int> row(expected.size() + 2, -1);
+      const int numNbh =
+          atlasInterface::getNeighbors(atlasInterface::atlasTag{}, getMesh(), chain, testIdx(),
+                                       includeCenter, row.data(), int(row.size()));
+      ASSERT_EQ(numNbh, int(expected.size()));
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), row.begin()));
+
+      // strided column, truncated to the first two neighbors
+      const int stride = 3;
+      std::vector<int> column(2 * stride, -1);
+      const int numTruncated =
+          atlasInterface::getNeighbors(atlasInterface::atlasTag{}, getMesh(), chain, testIdx(),
+                                       includeCenter, column.data(), 2, stride);
+      ASSERT_EQ(numTruncated, std::min(2, int(expected.size())));
+      for(int nbh = 0; nbh < numTruncated; ++nbh)
+        EXPECT_EQ(column[nbh * stride], expected[nbh]);
+    }
+  }
+}
+} // namespace
@@ -15,22 +15,224 @@
 //===------------------------------------------------------------------------------------------===//
 
 #include "gtclang/Driver/Driver.h"
+#include "dawn/Support/IndexGenerator.h"
 #include "dawn/Support/Logger.h"
+#include "dawn/Support/UIDGenerator.h"
 #include "gtclang/Driver/CompilerInstance.h"
 #include "gtclang/Driver/OptionsParser.h"
 #include "gtclang/Frontend/GTClangASTAction.h"
 #include "gtclang/Frontend/GTClangContext.h"
 #include "gtclang/Frontend/GTClangIncludeChecker.h"
-#include "gtclang/Frontend/GTClangPreprocessorAction.h"
+#include "gtclang/Frontend/GTClangPreprocessor.h"
+#include "gtclang/Support/Config.h"
 #include "gtclang/Support/Logger.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 namespace gtclang {
 
+namespace {
+
+/// @brief Sets the formatters of the dawn loggers to the gtclang ones and restores the previous
+/// formatters on destruction
+class GTClangLogFormatters : public dawn::NonCopyable {
+  dawn::Logger::MessageFormatter infoMessageFormatter_;
+  dawn::Logger::MessageFormatter warnMessageFormatter_;
+  dawn::Logger::MessageFormatter errorMessageFormatter_;
+  dawn::Logger::DiagnosticFormatter infoDiagnosticFormatter_;
+  dawn::Logger::DiagnosticFormatter warnDiagnosticFormatter_;
+  dawn::Logger::DiagnosticFormatter errorDiagnosticFormatter_;
+
+public:
+  GTClangLogFormatters()
+      : infoMessageFormatter_(dawn::log::info.messageFormatter()),
+        warnMessageFormatter_(dawn::log::warn.messageFormatter()),
+        errorMessageFormatter_(dawn::log::error.messageFormatter()),
+        infoDiagnosticFormatter_(dawn::log::info.diagnosticFormatter()),
+        warnDiagnosticFormatter_(dawn::log::warn.diagnosticFormatter()),
+        errorDiagnosticFormatter_(dawn::log::error.diagnosticFormatter()) {
+    dawn::log::info.messageFormatter(makeGTClangMessageFormatter("[INFO]"));
+    dawn::log::warn.messageFormatter(makeGTClangMessageFormatter("[WARNING]"));
+    dawn::log::error.messageFormatter(makeGTClangMessageFormatter("[ERROR]"));
+
+    dawn::log::info.diagnosticFormatter(makeGTClangDiagnosticFormatter("[INFO]"));
+    dawn::log::warn.diagnosticFormatter(makeGTClangDiagnosticFormatter("[WARNING]"));
+    dawn::log::error.diagnosticFormatter(makeGTClangDiagnosticFormatter("[ERROR]"));
+  }
+
+  ~GTClangLogFormatters() {
+    dawn::log::info.messageFormatter(infoMessageFormatter_);
+    dawn::log::warn.messageFormatter(warnMessageFormatter_);
+    dawn::log::error.messageFormatter(errorMessageFormatter_);
+
+    dawn::log::info.diagnosticFormatter(infoDiagnosticFormatter_);
+    dawn::log::warn.diagnosticFormatter(warnDiagnosticFormatter_);
+    dawn::log::error.diagnosticFormatter(errorDiagnosticFormatter_);
+  }
+};
+
+/// @brief Run the AST action, preceded by the preprocessor action if needed, of gtclang on the
+/// input file `clangArgs[1]`
+/// @returns `0` on success, `1` otherwise
+int compile(GTClangContext* context, llvm::SmallVectorImpl<const char*>& clangArgs,
+            std::shared_ptr<dawn::SIR>& SIR) {
+  GTClangIncludeChecker includeChecker;
+  bool runPreprocessor = false;
+  if(clangArgs.size() > 1) {
+    includeChecker.Update(clangArgs[1]);
+    if(auto file = llvm::MemoryBuffer::getFile(clangArgs[1]))
+      runPreprocessor = needsPreprocessorPass((*file)->getBuffer());
+  }
+
+  // Create GTClang
+  std::unique_ptr<clang::CompilerInstance> GTClang(createCompilerInstance(clangArgs));
+
+  int ret = 0;
+  if(GTClang) {
+    if(runPreprocessor) {
+      std::unique_ptr<clang::FrontendAction> PPAction(new GTClangPreprocessorAction(context));
+      ret |= !GTClang->ExecuteAction(*PPAction);
+    }
+
+    if(ret == 0) {
+      std::unique_ptr<GTClangASTAction> ASTAction(new GTClangASTAction(context, !runPreprocessor));
+      ret |= !GTClang->ExecuteAction(*ASTAction);
+      SIR = ASTAction->getSIR();
+    }
+    DAWN_LOG(INFO) << "Compilation finished " << (ret ? "with errors" : "successfully");
+  }
+
+  includeChecker.Restore();
+  return ret;
+}
+
+/// @brief Is `arg`, forwarded to clang, a C++ source file?
+bool isInputFile(llvm::StringRef arg) {
+  if(arg.startswith("-"))
+    return false;
+  llvm::StringRef extension = llvm::sys::path::extension(arg);
+  return extension == ".cpp" || extension == ".cc" || extension == ".cxx" || extension == ".C";
+}
+
+/// @brief Path of the DSL definitions `gtclang_dsl_defs/gtclang_dsl.hpp` in the DSL include paths
+/// @returns Empty string if the DSL definitions were not found
+std::string findDSLHeader() {
+  llvm::SmallVector<llvm::StringRef, 2> DSLIncludes;
+  llvm::StringRef(GTCLANG_DSL_INCLUDES).split(DSLIncludes, ';');
+  for(const auto& path : DSLIncludes) {
+    llvm::SmallString<256> header(path);
+    llvm::sys::path::append(header, "gtclang_dsl_defs", "gtclang_dsl.hpp");
+    if(llvm::sys::fs::exists(header))
+      return header.str().str();
+  }
+  return "";
+}
+
+/// @brief Precompile the DSL definitions to `PCHFile` with the clang arguments `commonArgs`, which
+/// must be the same as the ones of the input files using the precompiled header
+bool buildDSLPCH(const char* programName, const llvm::SmallVectorImpl<const char*>& commonArgs,
+                 const std::string& PCHFile) {
+  const std::string header = findDSLHeader();
+  if(header.empty())
+    return false;
+
+  llvm::SmallVector<const char*, 16> clangArgs{programName, "-x", "c++-header", header.c_str()};
+  clangArgs.append(commonArgs.begin(), commonArgs.end());
+
+  std::unique_ptr<clang::CompilerInstance> GTClang(createCompilerInstance(clangArgs));
+  if(!GTClang)
+    return false;
+  GTClang->getFrontendOpts().OutputFile = PCHFile;
+
+  DAWN_LOG(INFO) << "Precompiling DSL definitions " << header << " to " << PCHFile;
+  clang::GeneratePCHAction PCHAction;
+  return GTClang->ExecuteAction(PCHAction);
+}
+
+/// @brief Compile each of the `inputFiles` to `<OutputDir>/<name>_gen.cpp`, in parallel
+///
+/// The clang startup and the parsing of the DSL definitions, which dominate the compile time of
+/// small DSL files, are paid once: the DSL definitions are precompiled and every worker thread
+/// compiles the next pending file with its own compiler instance and `GTClangContext`.
+///
+/// @returns `0` if all files were compiled successfully, `1` otherwise
+int runBatch(const char* programName, const Options& options,
+             const std::vector<std::string>& inputFiles,
+             const llvm::SmallVectorImpl<const char*>& commonArgs) {
+  llvm::SmallString<128> PCHFile;
+  if(options.DSLPCH) {
+    if(llvm::sys::fs::createTemporaryFile("gtclang_dsl", "pch", PCHFile) ||
+       !buildDSLPCH(programName, commonArgs, PCHFile.str().str())) {
+      DAWN_LOG(WARNING) << "Failed to precompile the DSL definitions, parsing them for every file";
+      llvm::sys::fs::remove(PCHFile);
+      PCHFile.clear();
+    }
+  }
+
+  const std::size_t numThreads = std::min<std::size_t>(
+      inputFiles.size(),
+      options.Jobs > 0 ? options.Jobs : std::max(1u, std::thread::hardware_concurrency()));
+  DAWN_LOG(INFO) << "Compiling " << inputFiles.size() << " files with " << numThreads << " threads";
+
+  std::atomic<std::size_t> nextFile{0};
+  std::atomic<int> ret{0};
+  auto worker = [&]() {
+    for(std::size_t idx = nextFile++; idx < inputFiles.size(); idx = nextFile++) {
+      const std::string& inputFile = inputFiles[idx];
+
+      // Number the IR of every file from scratch, as if it was compiled on its own. The generators
+      // are owned by the file and installed for this thread while it is compiled.
+      dawn::UIDGenerator uidGenerator;
+      dawn::UIDGenerator::Scope uidScope(uidGenerator);
+      dawn::IndexGenerator indexGenerator;
+      dawn::IndexGenerator::Scope indexScope(indexGenerator);
+
+      auto context = std::make_unique<GTClangContext>();
+      context->getOptions() = options;
+      llvm::SmallString<256> outputFile(options.OutputDir);
+      llvm::sys::path::append(outputFile, llvm::sys::path::stem(inputFile) + "_gen.cpp");
+      context->getOptions().OutputFile = outputFile.str().str();
+
+      llvm::SmallVector<const char*, 16> clangArgs{programName, inputFile.c_str()};
+      clangArgs.append(commonArgs.begin(), commonArgs.end());
+      if(!PCHFile.empty()) {
+        clangArgs.push_back("-include-pch");
+        clangArgs.push_back(PCHFile.c_str());
+      }
+
+      std::shared_ptr<dawn::SIR> SIR;
+      const int fileRet = compile(context.get(), clangArgs, SIR);
+      if(fileRet)
+        DAWN_LOG(ERROR) << "Failed to compile " << inputFile;
+      ret |= fileRet;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for(std::size_t i = 1; i < numThreads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for(auto& thread : threads)
+    thread.join();
+
+  if(!PCHFile.empty())
+    llvm::sys::fs::remove(PCHFile);
+  return ret;
+}
+
+} // anonymous namespace
+
 bool Driver::isInitialized = false;
 
 ReturnValue Driver::run(const llvm::SmallVectorImpl<const char*>& args) {
@@ -58,51 +260,27 @@ ReturnValue Driver::run(const llvm::SmallVectorImpl<const char*>& args) {
     return ReturnValue{1, returnSIR};
 
   // Save existing formatter and set to gtclang
-  auto infoMessageFormatter = dawn::log::info.messageFormatter();
-  auto warnMessageFormatter = dawn::log::warn.messageFormatter();
-  auto errorMessageFormatter = dawn::log::error.messageFormatter();
-  dawn::log::info.messageFormatter(makeGTClangMessageFormatter("[INFO]"));
-  dawn::log::warn.messageFormatter(makeGTClangMessageFormatter("[WARNING]"));
-  dawn::log::error.messageFormatter(makeGTClangMessageFormatter("[ERROR]"));
-
-  auto infoDiagnosticFormatter = dawn::log::info.diagnosticFormatter();
-  auto warnDiagnosticFormatter = dawn::log::warn.diagnosticFormatter();
-  auto errorDiagnosticFormatter = dawn::log::error.diagnosticFormatter();
-  dawn::log::info.diagnosticFormatter(makeGTClangDiagnosticFormatter("[INFO]"));
-  dawn::log::warn.diagnosticFormatter(makeGTClangDiagnosticFormatter("[WARNING]"));
-  dawn::log::error.diagnosticFormatter(makeGTClangDiagnosticFormatter("[ERROR]"));
-
-  GTClangIncludeChecker includeChecker;
-  if(clangArgs.size() > 1)
-    includeChecker.Update(clangArgs[1]);
-
-  // Create GTClang
-  std::unique_ptr<clang::CompilerInstance> GTClang(createCompilerInstance(clangArgs));
-
-  int ret = 0;
-  if(GTClang) {
-    std::unique_ptr<clang::FrontendAction> PPAction(new GTClangPreprocessorAction(context.get()));
-    ret |= !GTClang->ExecuteAction(*PPAction);
-
-    if(ret == 0) {
-      std::unique_ptr<GTClangASTAction> ASTAction(new GTClangASTAction(context.get()));
-      ret |= !GTClang->ExecuteAction(*ASTAction);
-      returnSIR = ASTAction->getSIR();
+  GTClangLogFormatters formatters;
+
+  // Several input files are compiled in batch mode
+  std::vector<std::string> inputFiles;
+  llvm::SmallVector<const char*, 16> commonArgs;
+  for(std::size_t i = 1; i < clangArgs.size(); ++i) {
+    if(isInputFile(clangArgs[i]))
+      inputFiles.push_back(clangArgs[i]);
+    else
+      commonArgs.push_back(clangArgs[i]);
+  }
+  if(inputFiles.size() > 1) {
+    if(!context->getOptions().OutputFile.empty()) {
+      DAWN_LOG(ERROR) << "-o cannot be used with several input files, use --output-dir";
+      return ReturnValue{1, returnSIR};
     }
-    DAWN_LOG(INFO) << "Compilation finished " << (ret ? "with errors" : "successfully");
+    return ReturnValue{runBatch(clangArgs[0], context->getOptions(), inputFiles, commonArgs),
+                       returnSIR};
   }
 
-  includeChecker.Restore();
-
-  // Reset formatters
-  dawn::log::info.messageFormatter(infoMessageFormatter);
-  dawn::log::warn.messageFormatter(warnMessageFormatter);
-  dawn::log::error.messageFormatter(errorMessageFormatter);
-
-  dawn::log::info.diagnosticFormatter(infoDiagnosticFormatter);
-  dawn::log::warn.diagnosticFormatter(warnDiagnosticFormatter);
-  dawn::log::error.diagnosticFormatter(errorDiagnosticFormatter);
-
+  int ret = compile(context.get(), clangArgs, returnSIR);
   return ReturnValue{ret, returnSIR};
 }
 
@@ -124,56 +302,11 @@ std::shared_ptr<dawn::SIR> run(const std::string& fileName, const ParseOptions&
   clangArgs.push_back(fileName.c_str());
 
   // Save existing formatter and set to gtclang
-  auto infoMessageFormatter = dawn::log::info.messageFormatter();
-  auto warnMessageFormatter = dawn::log::warn.messageFormatter();
-  auto errorMessageFormatter = dawn::log::error.messageFormatter();
-  dawn::log::info.messageFormatter(makeGTClangMessageFormatter("[INFO]"));
-  dawn::log::warn.messageFormatter(makeGTClangMessageFormatter("[WARNING]"));
-  dawn::log::error.messageFormatter(makeGTClangMessageFormatter("[ERROR]"));
-
-  auto infoDiagnosticFormatter = dawn::log::info.diagnosticFormatter();
-  auto warnDiagnosticFormatter = dawn::log::warn.diagnosticFormatter();
-  auto errorDiagnosticFormatter = dawn::log::error.diagnosticFormatter();
-  dawn::log::info.diagnosticFormatter(makeGTClangDiagnosticFormatter("[INFO]"));
-  dawn::log::warn.diagnosticFormatter(makeGTClangDiagnosticFormatter("[WARNING]"));
-  dawn::log::error.diagnosticFormatter(makeGTClangDiagnosticFormatter("[ERROR]"));
-
-  gtclang::GTClangIncludeChecker includeChecker;
-  if(clangArgs.size() > 1)
-    includeChecker.Update(clangArgs[1]);
-
-  // Create GTClang
-  std::unique_ptr<clang::CompilerInstance> GTClang(gtclang::createCompilerInstance(clangArgs));
+  GTClangLogFormatters formatters;
 
   // Create SIR as return value
   std::shared_ptr<dawn::SIR> stencilIR = nullptr;
-
-  int ret = 0;
-  if(GTClang) {
-    std::unique_ptr<clang::FrontendAction> PPAction(
-        new gtclang::GTClangPreprocessorAction(context.get()));
-    ret |= !GTClang->ExecuteAction(*PPAction);
-
-    if(ret == 0) {
-      std::unique_ptr<gtclang::GTClangASTAction> ASTAction(
-          new gtclang::GTClangASTAction(context.get()));
-      ret |= !GTClang->ExecuteAction(*ASTAction);
-      stencilIR = ASTAction->getSIR();
-    }
-    DAWN_LOG(INFO) << "Compilation finished " << (ret ? "with errors" : "successfully");
-  }
-
-  includeChecker.Restore();
-
-  // Reset formatters
-  dawn::log::info.messageFormatter(infoMessageFormatter);
-  dawn::log::warn.messageFormatter(warnMessageFormatter);
-  dawn::log::error.messageFormatter(errorMessageFormatter);
-
-  dawn::log::info.diagnosticFormatter(infoDiagnosticFormatter);
-  dawn::log::warn.diagnosticFormatter(warnDiagnosticFormatter);
-  dawn::log::error.diagnosticFormatter(errorDiagnosticFormatter);
-
+  compile(context.get(), clangArgs, stencilIR);
   return stencilIR;
 }
 
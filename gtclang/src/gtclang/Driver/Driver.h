@@ -38,6 +38,10 @@ struct ReturnValue {
 struct Driver : public dawn::NonCopyable {
 
   /// @brief Run gtclang on the given arguments
+  ///
+  /// If several input files are given, they are compiled in parallel (see `--jobs`) to
+  /// `<OutputDir>/<name>_gen.cpp`, sharing a precompiled header of the DSL definitions (see
+  /// `-fdsl-pch`). No SIR is returned in that case.
   /// @returns The Stencil Intermediate Representation and an integer that is `0` on success, `1`
   /// otherwise
   static ReturnValue run(const llvm::SmallVectorImpl<const char*>& args);
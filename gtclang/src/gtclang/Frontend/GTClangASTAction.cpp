@@ -16,12 +16,27 @@
 
 #include "gtclang/Frontend/GTClangASTAction.h"
 #include "gtclang/Frontend/GTClangASTConsumer.h"
+#include "gtclang/Frontend/GTClangPreprocessor.h"
 #include "gtclang/Support/Logger.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Pragma.h"
+#include "clang/Lex/Preprocessor.h"
 
 namespace gtclang {
 
-GTClangASTAction::GTClangASTAction(GTClangContext* context) : context_(context) {}
+GTClangASTAction::GTClangASTAction(GTClangContext* context, bool rewriteMainFile)
+    : context_(context), rewriteMainFile_(rewriteMainFile) {}
+
+bool GTClangASTAction::BeginSourceFileAction(clang::CompilerInstance& compiler) {
+  // The pragmas were already applied when the main file was rewritten
+  compiler.getPreprocessor().AddPragmaHandler(new clang::EmptyPragmaHandler("gtclang"));
+
+  if(!rewriteMainFile_)
+    return true;
+
+  context_->startPhase("Preprocessing");
+  return preprocessMainFile(compiler, context_);
+}
 
 std::unique_ptr<clang::ASTConsumer>
 GTClangASTAction::CreateASTConsumer(clang::CompilerInstance& compiler, llvm::StringRef file) {
@@ -29,6 +44,13 @@ GTClangASTAction::CreateASTConsumer(clang::CompilerInstance& compiler, llvm::Str
   return std::make_unique<GTClangASTConsumer>(context_, file, this);
 }
 
+void GTClangASTAction::ExecuteAction() {
+  // The AST consumer moves on to the next phases once the translation unit is parsed
+  context_->startPhase("Parsing");
+  clang::ASTFrontendAction::ExecuteAction();
+  context_->stopPhase();
+}
+
 void GTClangASTAction::setSIR(std::shared_ptr<dawn::SIR> sir) { sir_ = sir; }
 
 std::shared_ptr<dawn::SIR> GTClangASTAction::getSIR() const { return sir_; }
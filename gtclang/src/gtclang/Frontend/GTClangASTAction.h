@@ -29,15 +29,25 @@ class GTClangContext;
 /// @ingroup frontend
 class GTClangASTAction : public clang::ASTFrontendAction {
   GTClangContext* context_;
+  bool rewriteMainFile_;
 
 public:
-  GTClangASTAction(GTClangContext* context);
+  /// @brief If `rewriteMainFile` is false, the main file was already rewritten by
+  /// `GTClangPreprocessorAction`
+  GTClangASTAction(GTClangContext* context, bool rewriteMainFile = true);
   virtual ~GTClangASTAction() {}
 
+  /// @brief Replace the enhanced with the pure gridtools clang DSL in the main file before it is
+  /// parsed (see `preprocessMainFile`) and ignore the `#pragma gtclang`
+  virtual bool BeginSourceFileAction(clang::CompilerInstance& compiler) override;
+
   /// @brief Create the AST consumer to read the AST
   virtual std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance& compiler,
                                                                 llvm::StringRef file) override;
 
+  /// @brief Parse the translation unit and hand it to the AST consumer
+  virtual void ExecuteAction() override;
+
   /// @brief catch the SIR from the ASTConsumer to use it afterwards
   void setSIR(std::shared_ptr<dawn::SIR> sir);
 
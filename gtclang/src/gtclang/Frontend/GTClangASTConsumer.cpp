@@ -76,6 +76,7 @@ void GTClangASTConsumer::HandleTranslationUnit(clang::ASTContext& ASTContext) {
   if(!context_->hasDiagnostics())
     context_->setDiagnostics(&ASTContext.getDiagnostics());
 
+  context_->startPhase("SIR generation");
   DAWN_LOG(INFO) << "Parsing translation unit... ";
 
   clang::TranslationUnitDecl* TU = ASTContext.getTranslationUnitDecl();
@@ -128,6 +129,7 @@ void GTClangASTConsumer::HandleTranslationUnit(clang::ASTContext& ASTContext) {
     return;
 
   // Compile the SIR using Dawn
+  context_->startPhase("Dawn");
   std::list<dawn::PassGroup> passGroup;
 
   if(context_->getOptions().SSA)
@@ -136,6 +138,12 @@ void GTClangASTConsumer::HandleTranslationUnit(clang::ASTContext& ASTContext) {
   if(context_->getOptions().PrintStencilGraph)
     passGroup.push_back(dawn::PassGroup::PrintStencilGraph);
 
+  if(context_->getOptions().ConstantFolding)
+    passGroup.push_back(dawn::PassGroup::ConstantFolding);
+
+  if(context_->getOptions().StencilFusion)
+    passGroup.push_back(dawn::PassGroup::StencilFusion);
+
   if(context_->getOptions().SetStageName || context_->getOptions().DefaultOptimization)
     passGroup.push_back(dawn::PassGroup::SetStageName);
 
@@ -145,6 +153,18 @@ void GTClangASTConsumer::HandleTranslationUnit(clang::ASTContext& ASTContext) {
   if(context_->getOptions().MergeStages || context_->getOptions().DefaultOptimization)
     passGroup.push_back(dawn::PassGroup::StageMerger);
 
+  if(context_->getOptions().StageFusion)
+    passGroup.push_back(dawn::PassGroup::StageFusion);
+
+  if(context_->getOptions().CommonSubexpressionElimination)
+    passGroup.push_back(dawn::PassGroup::CommonSubexpressionElimination);
+
+  if(context_->getOptions().ReductionFusion)
+    passGroup.push_back(dawn::PassGroup::ReductionFusion);
+
+  if(context_->getOptions().LoopInvariantCodeMotion)
+    passGroup.push_back(dawn::PassGroup::LoopInvariantCodeMotion);
+
   if(std::any_of(SIR->Stencils.begin(), SIR->Stencils.end(),
                  [](const std::shared_ptr<dawn::sir::Stencil>& stencilPtr) {
                    return stencilPtr->Attributes.has(dawn::ast::Attr::Kind::MergeTemporaries);
@@ -180,6 +200,9 @@ void GTClangASTConsumer::HandleTranslationUnit(clang::ASTContext& ASTContext) {
   if(context_->getOptions().MultiStageMerger)
     passGroup.push_back(dawn::PassGroup::MultiStageMerger);
 
+  if(context_->getOptions().TemporaryDimensionReduction)
+    passGroup.push_back(dawn::PassGroup::TemporaryDimensionReduction);
+
   // if nothing is passed, we fill the group with the default if no-optimization is not specified
   if(!context_->getOptions().DisableOptimization && passGroup.size() == 0)
     passGroup = dawn::defaultPassGroups();
@@ -240,6 +263,8 @@ void GTClangASTConsumer::HandleTranslationUnit(clang::ASTContext& ASTContext) {
       stencilInstantiationMap, dawn::codegen::parseBackendString(context_->getOptions().Backend),
       codegenOptions);
 
+  context_->startPhase("Output");
+
   // Create new in-memory FS
   llvm::IntrusiveRefCntPtr<clang_compat::llvm::vfs::InMemoryFileSystem> memFS(
       new clang_compat::llvm::vfs::InMemoryFileSystem);
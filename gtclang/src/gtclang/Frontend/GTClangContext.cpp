@@ -22,7 +22,13 @@ namespace gtclang {
 
 GTClangContext::GTClangContext()
     : options_(std::make_unique<Options>()), diagnostics_(nullptr), astContext_(nullptr),
-      useDawn_(true) {}
+      useDawn_(true), currentPhase_(nullptr) {}
+
+GTClangContext::~GTClangContext() {
+  stopPhase();
+  // Destroying the timers before their group prints the report
+  phaseTimers_.clear();
+}
 
 bool& GTClangContext::useDawn() { return useDawn_; }
 
@@ -99,4 +105,25 @@ void GTClangContext::setStencilAttribute(const std::string& name, dawn::ast::Att
   stencilNameToAttributeMap_.emplace(name, attr);
 }
 
+void GTClangContext::startPhase(llvm::StringRef phase) {
+  stopPhase();
+  if(!getOptions().ReportTimes)
+    return;
+
+  if(!timerGroup_)
+    timerGroup_ = std::make_unique<llvm::TimerGroup>("gtclang", "gtclang frontend");
+  auto& timer = phaseTimers_[phase];
+  if(!timer)
+    timer = std::make_unique<llvm::Timer>(phase, phase, *timerGroup_);
+  timer->startTimer();
+  currentPhase_ = timer.get();
+}
+
+void GTClangContext::stopPhase() {
+  if(currentPhase_) {
+    currentPhase_->stopTimer();
+    currentPhase_ = nullptr;
+  }
+}
+
 } // namespace gtclang
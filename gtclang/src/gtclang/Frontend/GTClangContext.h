@@ -21,6 +21,8 @@
 #include "dawn/Support/NonCopyable.h"
 #include "gtclang/Driver/Options.h"
 #include "gtclang/Frontend/Diagnostics.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Timer.h"
 #include <memory>
 #include <unordered_map>
 
@@ -44,8 +46,14 @@ class GTClangContext : dawn::NonCopyable {
 
   bool useDawn_;
 
+  // Timers of the phases of the frontend (only used with `-freport-times`)
+  std::unique_ptr<llvm::TimerGroup> timerGroup_;
+  llvm::StringMap<std::unique_ptr<llvm::Timer>> phaseTimers_;
+  llvm::Timer* currentPhase_;
+
 public:
   GTClangContext();
+  ~GTClangContext();
 
   /// @name Get/Set useDawn boolean
   /// @{
@@ -96,6 +104,15 @@ public:
   dawn::ast::Attr getStencilAttribute(const std::string& name) const;
   void setStencilAttribute(const std::string& name, dawn::ast::Attr attr);
   /// @}
+
+  /// @brief Start/Stop timing a phase of the frontend (e.g "Parsing")
+  ///
+  /// Starting a phase stops the current one. Phases are only timed with `-freport-times`, their
+  /// times are reported to stderr once the context is destroyed.
+  /// @{
+  void startPhase(llvm::StringRef phase);
+  void stopPhase();
+  /// @}
 };
 
 } // namespace gtclang
@@ -14,10 +14,11 @@
 //
 //===------------------------------------------------------------------------------------------===//
 
-#include "gtclang/Frontend/GTClangPreprocessorAction.h"
+#include "gtclang/Frontend/GTClangPreprocessor.h"
 #include "dawn/Support/Assert.h"
 #include "dawn/Support/Format.h"
 #include "gtclang/Frontend/GTClangContext.h"
+#include "gtclang/Support/ClangCompat/Pragma.h"
 #include "gtclang/Support/Logger.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Lex/Preprocessor.h"
@@ -25,6 +26,7 @@
 #include "clang/Tooling/Core/Replacement.h"
 #include "llvm/ADT/StringRef.h"
 
+#include <algorithm>
 #include <iostream>
 #include <unordered_set>
 #include <vector>
@@ -47,6 +49,24 @@ bool is_last(Iter iter, const Cont& cont) {
   return (iter != cont.end()) && (std::next(iter) == cont.end());
 }
 
+/// @brief Attribute of the `#pragma gtclang` clause `clause`
+/// @returns `false` if the clause is unknown
+bool getPragmaClauseAttribute(llvm::StringRef clause, dawn::ast::Attr::Kind& kind) {
+  if(clause == "no_codegen")
+    kind = dawn::ast::Attr::Kind::NoCodeGen;
+  else if(clause == "merge_stages")
+    kind = dawn::ast::Attr::Kind::MergeStages;
+  else if(clause == "merge_do_methods")
+    kind = dawn::ast::Attr::Kind::MergeDoMethods;
+  else if(clause == "merge_temporaries")
+    kind = dawn::ast::Attr::Kind::MergeTemporaries;
+  else if(clause == "use_kcaches")
+    kind = dawn::ast::Attr::Kind::UseKCaches;
+  else
+    return false;
+  return true;
+}
+
 /// @brief Lex the source file and generate replacements for the enhanced gridtools clang DSL
 class GTClangLexer {
   clang::CompilerInstance& compiler_;
@@ -54,6 +74,9 @@ class GTClangLexer {
   clang::DiagnosticsEngine& diag_;
   clang::SourceManager& SM_;
 
+  /// Lex the main file through the preprocessor instead of raw lexing it
+  bool preprocessed_;
+
   bool done_;
   bool hasError_;
 
@@ -66,10 +89,49 @@ class GTClangLexer {
   /// The current token
   clang::Token token_;
 
+  /// Tokens of the main file (without preprocessor directives), terminated by `eof`, and the
+  /// position of the token following `token_`
+  std::vector<clang::Token> tokens_;
+  std::size_t nextToken_;
+
   /// Vector of replacements which need to be applied to the current source file to make it valid
   /// C++ code
   std::vector<clang::tooling::Replacement> replacements_;
 
+  /// A `#pragma gtclang CLAUSE_1 [, ... CLAUSE_N]` which applies to the stencil or stencil function
+  /// declared by the tokens following `tokens_[NextToken]`
+  struct Pragma {
+    clang::SourceLocation Loc;
+    dawn::ast::Attr Attributes;
+    std::string Clause;
+    std::size_t NextToken;
+  };
+  std::vector<Pragma> pragmas_;
+
+  /// @brief Registers the `#pragma gtclang` and `_Pragma("gtclang ...")` seen by the preprocessor
+  class PragmaHandler : public clang::PragmaHandler {
+    GTClangLexer& lexer_;
+
+  public:
+    PragmaHandler(GTClangLexer& lexer) : clang::PragmaHandler("gtclang"), lexer_(lexer) {}
+
+    void HandlePragma(clang::Preprocessor& PP, clang_compat::PragmaIntroducer,
+                      clang::Token& firstToken) override {
+      llvm::SmallVector<clang::Token, 8> clauses;
+      clang::Token token;
+      PP.Lex(token);
+      while(token.isNot(clang::tok::eod) && token.isNot(clang::tok::eof)) {
+        clauses.push_back(token);
+        PP.Lex(token);
+      }
+
+      // Only the pragmas expanded in the main file apply to its stencils
+      const clang::SourceManager& SM = PP.getSourceManager();
+      if(SM.isInMainFile(SM.getExpansionLoc(firstToken.getLocation())))
+        lexer_.registerPragma(firstToken.getLocation(), clauses);
+    }
+  };
+
   /// Replacements which need more context before they can be registered (currently only used to
   /// determine the return-type of Do methods)
   std::stack<std::pair<clang::SourceLocation, clang::SourceLocation>> replacementCandiates_;
@@ -100,31 +162,119 @@ private:
   /// @brief Check if an error has occured
   bool hasError() const { return diag_.hasErrorOccurred() || hasError_; }
 
-  /// @brief Lex until we find a token in the main-file
-  /// @returns `true` on success
-  bool lexNext() {
-    if(done_ || hasError())
-      return false;
+  /// @brief Lex the main file into `tokens_`
+  ///
+  /// By default only the main file is raw lexed, the included headers are neither entered nor
+  /// preprocessed, which leaves the (single) preprocessing of the translation unit to the parser.
+  /// Directives other than `#pragma gtclang` are skipped while identifiers are resolved to
+  /// keywords, as the preprocessor would. Main files with conditional directives or `_Pragma` are
+  /// lexed by the preprocessor (see `needsPreprocessorPass`): the tokens of the disabled branches
+  /// are skipped and the pragmas built by macros are seen.
+  void lexMainFile() {
+    using namespace clang;
 
-    do {
-      PP_.Lex(token_);
+    tokens_.clear();
+    nextToken_ = 0;
+    pragmas_.clear();
 
-      if(token_.is(clang::tok::eof) || hasError()) {
-        done_ = true;
-        return false;
+    Token token;
+    if(preprocessed_) {
+      PragmaHandler pragmaHandler(*this);
+      PP_.AddPragmaHandler(&pragmaHandler);
+
+      PP_.Lex(token);
+      while(token.isNot(tok::eof)) {
+        if(SM_.getFileID(token.getLocation()) == SM_.getMainFileID())
+          tokens_.push_back(token);
+        PP_.Lex(token);
       }
+      tokens_.push_back(token);
 
-      if(SM_.getFileID(token_.getLocation()) == SM_.getMainFileID())
-        return true;
+      PP_.RemovePragmaHandler(&pragmaHandler);
+      return;
+    }
 
-    } while(true);
-    return false;
+    const llvm::MemoryBuffer* fromFile = SM_.getBuffer(SM_.getMainFileID());
+    clang::Lexer rawLexer(SM_.getMainFileID(), fromFile, SM_, PP_.getLangOpts());
+
+    rawLexer.LexFromRawLexer(token);
+    while(token.isNot(tok::eof)) {
+      if(token.is(tok::hash) && token.isAtStartOfLine()) {
+        llvm::SmallVector<Token, 8> directive;
+        rawLexer.LexFromRawLexer(token);
+        while(token.isNot(tok::eof) && !token.isAtStartOfLine()) {
+          directive.push_back(token);
+          rawLexer.LexFromRawLexer(token);
+        }
+
+        if(directive.size() > 1 && directive[0].is(tok::raw_identifier) &&
+           directive[0].getRawIdentifier() == "pragma" && directive[1].is(tok::raw_identifier) &&
+           directive[1].getRawIdentifier() == "gtclang")
+          registerPragma(directive[1].getLocation(), llvm::makeArrayRef(directive).drop_front(2));
+        continue;
+      }
+
+      if(token.is(tok::raw_identifier))
+        PP_.LookUpIdentifierInfo(token);
+      tokens_.push_back(token);
+      rawLexer.LexFromRawLexer(token);
+    }
+    tokens_.push_back(token);
+  }
+
+  /// @brief Register the pragma `#pragma gtclang CLAUSE_1 [, ... CLAUSE_N]` located at `loc`, which
+  /// applies to the declaration following the last lexed token
+  void registerPragma(clang::SourceLocation loc, llvm::ArrayRef<clang::Token> clauses) {
+    Pragma pragma{loc, dawn::ast::Attr(), "", tokens_.size()};
+
+    for(std::size_t i = 0; i < clauses.size() && clauses[i].isAnyIdentifier(); i += 2) {
+      pragma.Clause = PP_.getSpelling(clauses[i]);
+
+      dawn::ast::Attr::Kind kind;
+      if(!getPragmaClauseAttribute(pragma.Clause, kind)) {
+        // We don't know this pragma, issue a warning about unknown gtclang pragma
+        Diagnostics::reportRaw(
+            diag_, loc, clang::DiagnosticIDs::Warning,
+            dawn::format("invalid clause '%s' for '#pragma gtclang'", pragma.Clause));
+        return;
+      }
+      pragma.Attributes.set(kind);
+
+      // The clause is followed by a ',' we have to parse more clauses!
+      if(i + 1 < clauses.size() && clauses[i + 1].isNot(clang::tok::comma))
+        break;
+    }
+
+    if(!pragma.Clause.empty())
+      pragmas_.push_back(pragma);
+  }
+
+  /// @brief Lex the next token into `token_`
+  void lex() { token_ = tokens_[std::min(nextToken_++, tokens_.size() - 1)]; }
+
+  /// @brief Peek the `N`-th token after `token_` (`0` being the next one) without consuming it
+  const clang::Token& lookAhead(unsigned N) const {
+    return tokens_[std::min(nextToken_ + N, tokens_.size() - 1)];
+  }
+
+  /// @brief Lex the next token
+  /// @returns `true` on success
+  bool lexNext() {
+    if(done_ || hasError())
+      return false;
+
+    lex();
+    if(token_.is(clang::tok::eof) || hasError()) {
+      done_ = true;
+      return false;
+    }
+    return true;
   }
 
   /// @brief Consume `N` tokens from the token stream
   void consumeTokens(unsigned N) {
     while(N--)
-      PP_.Lex(token_);
+      lex();
   }
 
   /// @brief Consume the specified `namespaces` by peeking ahead. `peekedTokens` will be incremented
@@ -133,9 +283,9 @@ private:
   void peekNamespaces(clang::ArrayRef<clang::StringRef> namespaceQualifiers,
                       unsigned& peekedTokens) {
     for(const auto& namespaceQualifier : namespaceQualifiers)
-      if(PP_.LookAhead(peekedTokens).is(clang::tok::identifier) &&
-         PP_.LookAhead(peekedTokens).getIdentifierInfo()->getName() == namespaceQualifier &&
-         PP_.LookAhead(peekedTokens + 1).is(clang::tok::coloncolon))
+      if(lookAhead(peekedTokens).is(clang::tok::identifier) &&
+         lookAhead(peekedTokens).getIdentifierInfo()->getName() == namespaceQualifier &&
+         lookAhead(peekedTokens + 1).is(clang::tok::coloncolon))
         peekedTokens += 2;
   }
 
@@ -153,7 +303,7 @@ private:
 
     while(true) {
       // Peek the next token ...
-      token = PP_.LookAhead(peekedTokens);
+      token = lookAhead(peekedTokens);
 
       if(token.is(tok::eof))
         break;
@@ -250,10 +400,10 @@ private:
 
       // Replace `STORAGE[...]` with `STORAGE(...)` where STORAGE is the name of a storage of the
       // stencil or stencil function
-      if(token_.is(tok::identifier) && PP_.LookAhead(0).is(tok::l_square) &&
+      if(token_.is(tok::identifier) && lookAhead(0).is(tok::l_square) &&
          (storages.count(token_.getIdentifierInfo()->getName().str()) ||
           storagesAllocatedOnTheFly.count(token_.getIdentifierInfo()->getName().str()))) {
-        SourceLocation lSquareLoc = PP_.LookAhead(0).getLocation();
+        SourceLocation lSquareLoc = lookAhead(0).getLocation();
         unsigned peekedTokens = 1;
 
         // If we do not find a matching `]` there is def. something fishy.
@@ -264,7 +414,7 @@ private:
                   "unbalanced brace ']' detected in storage access '%s' in Do-Method of %s '%s'",
                   token_.getIdentifierInfo()->getName().str(), toString(stencilKind), name));
         } else {
-          SourceLocation rSquareLoc = PP_.LookAhead(peekedTokens).getLocation();
+          SourceLocation rSquareLoc = lookAhead(peekedTokens).getLocation();
 
           // Replace `[` and `]` with `(` and `)`
           registerReplacement(lSquareLoc, lSquareLoc, "(");
@@ -278,7 +428,7 @@ private:
         unsigned peekedTokens = 0;
 
         // Check for '('
-        if(!PP_.LookAhead(peekedTokens++).is(tok::l_paren))
+        if(!lookAhead(peekedTokens++).is(tok::l_paren))
           continue;
 
         // Check for 'ARG_1' until ','
@@ -294,7 +444,7 @@ private:
         if(!peekAndAccumulateUntil(tok::r_paren, peekedTokens, Arg2))
           continue;
 
-        registerReplacement(token_.getLocation(), PP_.LookAhead(peekedTokens).getLocation(),
+        registerReplacement(token_.getLocation(), lookAhead(peekedTokens).getLocation(),
                             dawn::format("for(auto __k_loopvar__ : {%s, %s})", Arg1, Arg2));
 
         consumeTokens(peekedTokens);
@@ -306,7 +456,7 @@ private:
         unsigned peekedTokens = 0;
         std::string intervalBounds;
         // Check for '('
-        if(!PP_.LookAhead(peekedTokens++).is(tok::l_paren))
+        if(!lookAhead(peekedTokens++).is(tok::l_paren))
           continue;
         if(peekAndAccumulateUntil(tok::r_paren, peekedTokens, intervalBounds)) {
           // Split the comma separated string
@@ -360,7 +510,7 @@ private:
               std::advance(boundIter, 2);
           }
           replacement += "})";
-          registerReplacement(token_.getLocation(), PP_.LookAhead(peekedTokens).getLocation(),
+          registerReplacement(token_.getLocation(), lookAhead(peekedTokens).getLocation(),
                               replacement);
         }
         consumeTokens(peekedTokens);
@@ -401,14 +551,13 @@ private:
             if(storagesStr.find("=") != std::string::npos) {
               llvm::SmallVector<StringRef, 2> accumulatedDeclaration;
               StringRef(storagesStr).split(accumulatedDeclaration, '=');
-              registerReplacement(token_.getLocation(), PP_.LookAhead(peekedTokens).getLocation(),
+              registerReplacement(token_.getLocation(), lookAhead(peekedTokens).getLocation(),
                                   accumulatedDeclaration[0].str() + " = " +
                                       accumulatedDeclaration[1].str() + ";");
               storagesAllocatedOnTheFly.emplace(accumulatedDeclaration[0].str());
             } else {
               storagesAllocatedOnTheFly.emplace(storagesStr);
-              registerReplacement(token_.getLocation(), PP_.LookAhead(peekedTokens).getLocation(),
-                                  "");
+              registerReplacement(token_.getLocation(), lookAhead(peekedTokens).getLocation(), "");
             }
             consumeTokens(peekedTokens);
           }
@@ -472,7 +621,7 @@ private:
         peekNamespaces({"gridtools", "clang"}, peekedTokens);
 
         // Get the token which describes the `storage`
-        const Token& curToken = peekedTokens == 0 ? token_ : PP_.LookAhead(peekedTokens++);
+        const Token& curToken = peekedTokens == 0 ? token_ : lookAhead(peekedTokens++);
 
         if(curToken.is(tok::identifier) &&
            ((curToken.getIdentifierInfo()->getName().find("storage") != std::string::npos) ||
@@ -501,7 +650,7 @@ private:
         }
         if(token_.is(tok::identifier) &&
            token_.getIdentifierInfo()->getName() == "boundary_condition" &&
-           PP_.LookAhead(0).is(tok::l_paren)) {
+           lookAhead(0).is(tok::l_paren)) {
           peekedTokens = 1;
 
           // Accumulate all identifiers up to `;`
@@ -511,12 +660,11 @@ private:
             // this is the first boundary_condition we encounter, store it's location
             if(!bcLocationSet) {
               bcLocationStart = token_.getLocation();
-              bcLocationEnd = PP_.LookAhead(peekedTokens).getLocation();
+              bcLocationEnd = lookAhead(peekedTokens).getLocation();
               bcLocationSet = true;
             } else {
               // after saving the information, we clear its content
-              registerReplacement(token_.getLocation(), PP_.LookAhead(peekedTokens).getLocation(),
-                                  "");
+              registerReplacement(token_.getLocation(), lookAhead(peekedTokens).getLocation(), "");
             }
             consumeTokens(peekedTokens);
           }
@@ -532,11 +680,10 @@ private:
 
       // `void Do(`, `double Do(`
       if((token_.is(tok::kw_void) || token_.is(tok::kw_double) || token_.is(tok::kw_float)) &&
-         PP_.LookAhead(0).is(tok::identifier) &&
-         PP_.LookAhead(0).getIdentifierInfo()->getName() == "Do" &&
-         PP_.LookAhead(1).is(tok::l_paren)) {
+         lookAhead(0).is(tok::identifier) && lookAhead(0).getIdentifierInfo()->getName() == "Do" &&
+         lookAhead(1).is(tok::l_paren)) {
 
-        DoMethodLoc = PP_.LookAhead(0).getLocation();
+        DoMethodLoc = lookAhead(0).getLocation();
         beforeFristDoMethod = token_.getLocation();
         consumeTokens(2);
         DoWasLexed = true;
@@ -545,7 +692,7 @@ private:
 
       // `Do(`
       if(token_.is(tok::identifier) && token_.getIdentifierInfo()->getName() == "Do" &&
-         PP_.LookAhead(0).is(tok::l_paren)) {
+         lookAhead(0).is(tok::l_paren)) {
 
         // Replace with either `double Do` or `void Do`, this will be determined after we lexed
         // the Do-Method body and know if there was a return statement.
@@ -569,7 +716,7 @@ private:
       } else {
         // `Do {`
         if(token_.is(tok::identifier) && token_.getIdentifierInfo()->getName() == "Do" &&
-           PP_.LookAhead(0).is(tok::l_brace)) {
+           lookAhead(0).is(tok::l_brace)) {
           DoMethodLoc = token_.getLocation();
 
           // Replace with either `double Do` or `void Do`, this will be determined after we lexed
@@ -642,24 +789,24 @@ private:
         unsigned peekedTokens = 0;
 
         // Check for `Identifier`
-        if(!PP_.LookAhead(peekedTokens).is(tok::identifier))
+        if(!lookAhead(peekedTokens).is(tok::identifier))
           continue;
-        const Token& identifierToken = PP_.LookAhead(peekedTokens);
+        const Token& identifierToken = lookAhead(peekedTokens);
         peekedTokens++;
 
         // Check for `:`
-        if(!PP_.LookAhead(peekedTokens++).is(tok::colon))
+        if(!lookAhead(peekedTokens++).is(tok::colon))
           continue;
 
         // Check for `public`
-        if(!PP_.LookAhead(peekedTokens++).is(tok::kw_public))
+        if(!lookAhead(peekedTokens++).is(tok::kw_public))
           continue;
 
         // Consume namespace `gridtools` and namespace `clang`
         peekNamespaces({"gridtools", "clang"}, peekedTokens);
 
         // Check for `stencil` or `stencil_function`
-        const Token& tokenStencilKind = PP_.LookAhead(peekedTokens++);
+        const Token& tokenStencilKind = lookAhead(peekedTokens++);
         StencilKind stencilKind = SK_Invalid;
         if(tokenStencilKind.is(tok::identifier)) {
 
@@ -675,7 +822,7 @@ private:
           continue;
 
         // Check for `{`
-        if(!PP_.LookAhead(peekedTokens++).is(tok::l_brace))
+        if(!lookAhead(peekedTokens++).is(tok::l_brace))
           continue;
 
         consumeTokens(peekedTokens);
@@ -699,7 +846,7 @@ private:
         else if(identifierInfo->getName() == "globals") {
 
           // Check for `{`
-          const Token& tokenLBrace = PP_.LookAhead(peekedTokens++);
+          const Token& tokenLBrace = lookAhead(peekedTokens++);
           if(!tokenLBrace.is(tok::l_brace))
             continue;
 
@@ -712,7 +859,7 @@ private:
 
         if(stencilKind != SK_Invalid) {
           // Check for `Identifier`
-          const Token& tokenIdentifier = PP_.LookAhead(peekedTokens++);
+          const Token& tokenIdentifier = lookAhead(peekedTokens++);
           std::string identifier;
           if(tokenIdentifier.is(tok::identifier) && tokenIdentifier.getIdentifierInfo())
             identifier = tokenIdentifier.getIdentifierInfo()->getName();
@@ -720,7 +867,7 @@ private:
             continue;
 
           // Check for `{`
-          const Token& tokenLBrace = PP_.LookAhead(peekedTokens++);
+          const Token& tokenLBrace = lookAhead(peekedTokens++);
           if(!tokenLBrace.is(tok::l_brace))
             continue;
 
@@ -748,150 +895,48 @@ private:
   }
   /// @}
 
-  /// @brief Performs a raw lexing of the source file and lexes
+  /// @brief Apply the lexed pragmas to the stencil or stencil function declared after them
   ///
-  /// `#pragma gtclang CLAUSE_1 [, ... CLAUSE_N]`
-  ///
-  /// Note that there might be cleaner ways of doing this but it is not clear if custom pragmas
-  /// can be parsed in a proper way without hacking Clang. This is fairly efficient though.
-  void tryLexPragmas() {
+  /// We need to know the stencil or stencil_function a pragma applies to, we thus check for
+  ///   `stencil IDENTIFIER`
+  ///   `stencil_function IDENTIFIER`
+  ///   `struct IDENTIFIER`
+  ///   `class IDENTIFIER`
+  void applyPragmas() {
     using namespace clang;
 
-    const llvm::MemoryBuffer* fromFile = SM_.getBuffer(SM_.getMainFileID());
-    clang::Lexer rawLexer(SM_.getMainFileID(), fromFile, SM_, PP_.getLangOpts());
-
-    // Raw lexing does not support lookAheads which makes the lexing slightly cumbersome. We use
-    // state based approach here.
-    enum LexStateKind {
-      Unknown,                 // State is unknown
-      LexedHash,               // Previously lexed a `#`
-      LexedPragma,             // Previously lexed a `pragma
-      LexedGTClang,            // Previously lexed a `gtclang`
-      LexedValidGTClangPragma, // We lexed a valid `#pragma gtclang CLAUSE`, we now
-                               // look for the next stencil or stencil_function it may apply
-    };
-
-    LexStateKind state = Unknown;
-    dawn::ast::Attr curAttribute;
-    SourceLocation curStartLoc;
-    SourceLocation curEndLoc;
-    std::string curClause;
-
-    rawLexer.LexFromRawLexer(token_);
-    while(token_.isNot(tok::eof)) {
-      if(SM_.getFileID(token_.getLocation()) != SM_.getMainFileID())
-        continue;
-
-      switch(state) {
-      case Unknown:
-        // Check for `#`
-        if(token_.is(tok::hash)) {
-          state = LexedHash;
-          curStartLoc = token_.getLocation();
-          curAttribute.clear();
-          curClause.clear();
-        }
-        break;
-      case LexedHash:
-        // Check for `pragma`
-        if(token_.is(tok::raw_identifier) && token_.getRawIdentifier() == "pragma")
-          state = LexedPragma;
-        else
-          state = Unknown;
-        break;
-      case LexedPragma:
-        // Check for `gtclang`
-        if(token_.is(tok::raw_identifier) && token_.getRawIdentifier() == "gtclang")
-          state = LexedGTClang;
-        else
-          state = Unknown;
-        break;
-      case LexedGTClang:
-        // Check for `CLAUSE`
-        if(token_.is(tok::raw_identifier)) {
-          curClause = token_.getRawIdentifier().str();
-
-          if(curClause == "no_codegen")
-            curAttribute.set(dawn::ast::Attr::Kind::NoCodeGen);
-          else if(curClause == "merge_stages")
-            curAttribute.set(dawn::ast::Attr::Kind::MergeStages);
-          else if(curClause == "merge_do_methods")
-            curAttribute.set(dawn::ast::Attr::Kind::MergeDoMethods);
-          else if(curClause == "merge_temporaries")
-            curAttribute.set(dawn::ast::Attr::Kind::MergeTemporaries);
-          else if(curClause == "use_kcaches")
-            curAttribute.set(dawn::ast::Attr::Kind::UseKCaches);
-          else {
-            // We don't know this pragma, issue a warning about unknown gtclang pragma
-            Diagnostics::reportRaw(
-                diag_, curStartLoc, clang::DiagnosticIDs::Warning,
-                dawn::format("invalid clause '%s' for '#pragma gtclang'", curClause));
-            state = Unknown;
-            break;
-          }
-
-          curEndLoc = token_.getLocation();
-          state = LexedValidGTClangPragma;
-
-        } else
-          state = Unknown;
-        break;
-      case LexedValidGTClangPragma:
-
-        // The pragma is followed by a ',' we have to parse more clauses!
-        if(token_.is(tok::comma)) {
-          state = LexedGTClang;
-          break;
-        }
-
-        // We need to know the stencil or stencil_function this pragma applies to, we thus check
-        // for
-        //   `stencil IDENTIFIER`
-        //   `stencil_function IDENTIFIER`
-        //   `struct IDENTIFIER`
-        //   `class IDENTIFIER`
-        if((token_.is(tok::raw_identifier) && (token_.getRawIdentifier() == "stencil" ||
-                                               token_.getRawIdentifier() == "stencil_function")) ||
-           token_.is(tok::kw_class) || token_.is(tok::kw_struct)) {
-
-          // Lex next token to get the `IDENTIFIER`
-          rawLexer.LexFromRawLexer(token_);
-          if(token_.is(tok::eof))
-            continue;
+    for(const Pragma& pragma : pragmas_) {
+      const Token& declToken = tokens_[std::min(pragma.NextToken, tokens_.size() - 1)];
+      const Token& nameToken = tokens_[std::min(pragma.NextToken + 1, tokens_.size() - 1)];
 
-          if(token_.is(tok::raw_identifier)) {
-            std::string curIdentifer = token_.getRawIdentifier().str();
-
-            // Register the attribute and remove the pragma
-            attributeMap_.emplace(curIdentifer, curAttribute);
-            registerReplacement(curStartLoc, curEndLoc, "");
-          }
-        } else {
-          Diagnostics::reportRaw(
-              diag_, token_.getLocation(), clang::DiagnosticIDs::Error,
-              dawn::format("statement after '#pragma gtclang %s' must be a stencil declaration",
-                           curClause));
-        }
-
-        // We finished or failed to lex the pragma, start over again
-        state = Unknown;
-      };
-
-      rawLexer.LexFromRawLexer(token_);
+      if((declToken.is(tok::identifier) &&
+          (declToken.getIdentifierInfo()->getName() == "stencil" ||
+           declToken.getIdentifierInfo()->getName() == "stencil_function")) ||
+         declToken.is(tok::kw_class) || declToken.is(tok::kw_struct)) {
+        if(nameToken.is(tok::identifier))
+          attributeMap_.emplace(nameToken.getIdentifierInfo()->getName().str(), pragma.Attributes);
+      } else {
+        Diagnostics::reportRaw(
+            diag_, declToken.getLocation(), clang::DiagnosticIDs::Error,
+            dawn::format("statement after '#pragma gtclang %s' must be a stencil declaration",
+                         pragma.Clause));
+      }
     }
   }
 
 public:
-  GTClangLexer(clang::CompilerInstance& compiler)
+  GTClangLexer(clang::CompilerInstance& compiler, bool preprocessed)
       : compiler_(compiler), PP_(compiler_.getPreprocessor()), diag_(compiler_.getDiagnostics()),
-        SM_(compiler_.getSourceManager()), done_(false), hasError_(false), hasGlobals_(false) {}
+        SM_(compiler_.getSourceManager()), preprocessed_(preprocessed), done_(false),
+        hasError_(false), hasGlobals_(false), nextToken_(0) {}
 
   /// @brief Compute the vector of replacements
   void computeReplacements() {
     done_ = false;
     attributeMap_.clear();
     hasGlobals_ = false;
-    tryLexPragmas();
+    lexMainFile();
+    applyPragmas();
     tryLexStencils();
   }
 
@@ -904,32 +949,22 @@ public:
   const std::vector<clang::tooling::Replacement>& getReplacements() const { return replacements_; }
 };
 
-} // namespace
-
-GTClangPreprocessorAction::GTClangPreprocessorAction(GTClangContext* context) : context_(context) {}
-
-void GTClangPreprocessorAction::ExecuteAction() {
+/// @brief Replace the main file of `compiler` by the code rewritten by `lexer`
+///
+/// If `createFileID` is true, the main file gets a new file ID as it was already entered in the
+/// source manager with the original code.
+void rewriteMainFile(clang::CompilerInstance& compiler, GTClangContext* context,
+                     const GTClangLexer& lexer, bool createFileID) {
   using namespace clang;
 
-  DAWN_LOG(INFO) << "Start preprocessing ...";
-
-  CompilerInstance& compiler = getCompilerInstance();
   SourceManager& SM = compiler.getSourceManager();
-  Preprocessor& PP = compiler.getPreprocessor();
 
-  PP.EnterMainSourceFile();
-  compiler.getDiagnosticClient().BeginSourceFile(compiler.getLangOpts(), &PP);
-
-  GTClangLexer lexer(compiler);
-  lexer.computeReplacements();
-
-  compiler.getDiagnosticClient().EndSourceFile();
-
-  if(compiler.getDiagnostics().hasErrorOccurred())
-    return;
+  // Set the attributes
+  for(const auto& nameAttrPair : lexer.getAttributeMap())
+    context->setStencilAttribute(nameAttrPair.first, nameAttrPair.second);
 
-  bool ReportPassPreprocessor = context_->getOptions().ReportPassPreprocessor;
-  bool DumpPP = context_->getOptions().DumpPP;
+  bool ReportPassPreprocessor = context->getOptions().ReportPassPreprocessor;
+  bool DumpPP = context->getOptions().DumpPP;
 
   std::string PPCode;
   if(!lexer.getReplacements().empty()) {
@@ -943,14 +978,13 @@ void GTClangPreprocessorAction::ExecuteAction() {
     rewriter.getEditBuffer(SM.getMainFileID()).write(os);
     os.flush();
 
-    // Replace the code of the main-file
-    SM.overrideFileContents(SM.getFileEntryForID(SM.getMainFileID()),
-                            llvm::MemoryBuffer::getMemBufferCopy(PPCode.data()));
-
-    // Set the attributes
-    for(const auto& nameAttrPair : lexer.getAttributeMap())
-      context_->setStencilAttribute(nameAttrPair.first, nameAttrPair.second);
-
+    // Replace the code of the main-file. The main-file keeps its file entry, which names the
+    // generated file, but needs a new file ID if it was already entered as the size of its code
+    // changed.
+    const FileEntry* mainFile = SM.getFileEntryForID(SM.getMainFileID());
+    SM.overrideFileContents(mainFile, llvm::MemoryBuffer::getMemBufferCopy(PPCode.data()));
+    if(createFileID)
+      SM.setMainFileID(SM.createFileID(mainFile, SourceLocation(), SrcMgr::C_User));
   } else if(DumpPP || ReportPassPreprocessor) {
     PPCode = SM.getBufferData(SM.getMainFileID()).str();
   }
@@ -980,6 +1014,74 @@ void GTClangPreprocessorAction::ExecuteAction() {
       std::cout << (i + 1) << ": " << line.str() << "\n\n";
     }
   }
+}
+
+} // namespace
+
+bool needsPreprocessorPass(llvm::StringRef code) {
+  using namespace clang;
+
+  LangOptions langOpts;
+  langOpts.CPlusPlus = true;
+  Lexer rawLexer(SourceLocation(), langOpts, code.begin(), code.begin(), code.end());
+
+  Token token;
+  rawLexer.LexFromRawLexer(token);
+  while(token.isNot(tok::eof)) {
+    if(token.is(tok::raw_identifier) && token.getRawIdentifier() == "_Pragma")
+      return true;
+
+    if(token.is(tok::hash) && token.isAtStartOfLine()) {
+      rawLexer.LexFromRawLexer(token);
+      if(token.is(tok::raw_identifier)) {
+        StringRef directive = token.getRawIdentifier();
+        if(directive == "if" || directive == "ifdef" || directive == "ifndef" ||
+           directive == "elif" || directive == "else")
+          return true;
+      }
+      continue;
+    }
+    rawLexer.LexFromRawLexer(token);
+  }
+  return false;
+}
+
+bool preprocessMainFile(clang::CompilerInstance& compiler, GTClangContext* context) {
+  DAWN_LOG(INFO) << "Start preprocessing ...";
+
+  GTClangLexer lexer(compiler, false);
+  lexer.computeReplacements();
+
+  if(compiler.getDiagnostics().hasErrorOccurred())
+    return false;
+
+  rewriteMainFile(compiler, context, lexer, true);
+
+  DAWN_LOG(INFO) << "Done preprocessing";
+  return true;
+}
+
+GTClangPreprocessorAction::GTClangPreprocessorAction(GTClangContext* context) : context_(context) {}
+
+void GTClangPreprocessorAction::ExecuteAction() {
+  DAWN_LOG(INFO) << "Start preprocessing ...";
+  context_->startPhase("Preprocessing");
+
+  clang::CompilerInstance& compiler = getCompilerInstance();
+  clang::Preprocessor& PP = compiler.getPreprocessor();
+
+  PP.EnterMainSourceFile();
+  compiler.getDiagnosticClient().BeginSourceFile(compiler.getLangOpts(), &PP);
+
+  GTClangLexer lexer(compiler, true);
+  lexer.computeReplacements();
+
+  compiler.getDiagnosticClient().EndSourceFile();
+
+  if(compiler.getDiagnostics().hasErrorOccurred())
+    return;
+
+  rewriteMainFile(compiler, context_, lexer, false);
 
   DAWN_LOG(INFO) << "Done preprocessing";
 }
@@ -0,0 +1,63 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                         _       _
+//                        | |     | |
+//                    __ _| |_ ___| | __ _ _ __   __ _
+//                   / _` | __/ __| |/ _` | '_ \ / _` |
+//                  | (_| | || (__| | (_| | | | | (_| |
+//                   \__, |\__\___|_|\__,_|_| |_|\__, | - GridTools Clang DSL
+//                    __/ |                       __/ |
+//                   |___/                       |___/
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef GTCLANG_FRONTEND_PREPROCESSOR_H
+#define GTCLANG_FRONTEND_PREPROCESSOR_H
+
+#include "clang/Frontend/FrontendActions.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace gtclang {
+
+class GTClangContext;
+
+/// @brief Check if the main file `code` has to be preprocessed by `GTClangPreprocessorAction`
+/// instead of `preprocessMainFile`
+///
+/// Raw lexing can't tell the disabled branches of conditional directives (`#if`, `#ifdef`, ...)
+/// apart and doesn't see the pragmas built by macros (`_Pragma`).
+/// @ingroup frontend
+bool needsPreprocessorPass(llvm::StringRef code);
+
+/// @brief Replace the enhanced with the pure gridtools clang DSL in the main file of `compiler`
+///
+/// The main file is raw lexed (the included headers are not preprocessed) and replaced in memory by
+/// the rewritten code before the translation unit is parsed, which is thus lexed and parsed only
+/// once. Must be called after the main file was entered in the source manager and before parsing,
+/// i.e. in `clang::FrontendAction::BeginSourceFileAction`.
+///
+/// @returns `false` if errors occurred
+/// @ingroup frontend
+bool preprocessMainFile(clang::CompilerInstance& compiler, GTClangContext* context);
+
+/// @brief Replace the enhanced with the pure gridtools clang DSL in the main file, which is lexed
+/// by the preprocessor over the whole translation unit
+///
+/// Used for the main files which need it (see `needsPreprocessorPass`), before the AST action.
+/// @ingroup frontend
+class GTClangPreprocessorAction : public clang::PreprocessOnlyAction {
+  GTClangContext* context_;
+
+public:
+  GTClangPreprocessorAction(GTClangContext* context);
+
+protected:
+  void ExecuteAction() override;
+};
+
+} // namespace gtclang
+
+#endif
@@ -14,27 +14,18 @@
 //
 //===------------------------------------------------------------------------------------------===//
 
-#ifndef GTCLANG_FRONTEND_PREPROCESSORACTION_H
-#define GTCLANG_FRONTEND_PREPROCESSORACTION_H
+#ifndef GTCLANG_SUPPORT_CLANGCOMPAT_PRAGMA_H
+#define GTCLANG_SUPPORT_CLANGCOMPAT_PRAGMA_H
 
-#include "clang/Frontend/FrontendActions.h"
-
-namespace gtclang {
-
-class GTClangContext;
-
-/// @brief Preprocessor-only action which replaces the enhanced with the pure gridtools clang DSL
-/// @ingroup frontend
-class GTClangPreprocessorAction : public clang::PreprocessOnlyAction {
-  GTClangContext* context_;
-
-public:
-  GTClangPreprocessorAction(GTClangContext* context);
-
-protected:
-  void ExecuteAction();
-};
-
-} // namespace gtclang
+#include "clang/Basic/Version.h"
+#include "clang/Lex/Pragma.h"
 
+namespace gtclang::clang_compat {
+#if CLANG_VERSION_MAJOR < 9
+using PragmaIntroducer = ::clang::PragmaIntroducerKind;
+#else
+using PragmaIntroducer = ::clang::PragmaIntroducer;
 #endif
+} // namespace gtclang::clang_compat
+
+#endif // GTCLANG_SUPPORT_CLANGCOMPAT_PRAGMA_H
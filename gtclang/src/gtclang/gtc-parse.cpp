@@ -22,7 +22,7 @@
 #include "gtclang/Frontend/GTClangASTAction.h"
 #include "gtclang/Frontend/GTClangContext.h"
 #include "gtclang/Frontend/GTClangIncludeChecker.h"
-#include "gtclang/Frontend/GTClangPreprocessorAction.h"
+#include "gtclang/Frontend/GTClangPreprocessor.h"
 #include "gtclang/Support/Logger.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -0,0 +1,33 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                         _       _
+//                        | |     | |
+//                    __ _| |_ ___| | __ _ _ __   __ _
+//                   / _` | __/ __| |/ _` | '_ \ / _` |
+//                  | (_| | || (__| | (_| | | | | (_| |
+//                   \__, |\__\___|_|\__,_|_| |_|\__, | - GridTools Clang DSL
+//                    __/ |                       __/ |
+//                   |___/                       |___/
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// RUN: %gtclang% %file% %dirname%/ThreadsAccess.cpp -write-sir -fno-codegen -jobs=2
+// EXPECTED_FILE: OUTPUT:Threads_gen.sir,ThreadsAccess_gen.sir REFERENCE:../SIR/CopyTest_gen_ref.sir,../SIR/AccessTest_gen_ref.sir IGNORE:filename
+
+#include "gtclang_dsl_defs/gtclang_dsl.hpp"
+
+using namespace gtclang::dsl;
+
+stencil Test {
+  storage field_a, field_b;
+
+  Do {
+    vertical_region(k_start, k_end)
+        field_a = field_b;
+  }
+};
+
+int main() {}
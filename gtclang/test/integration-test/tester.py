@@ -120,6 +120,7 @@ def run_test(content, gtclang_exec, filename, verbose=False, ignore_keys=[]):
             m_runs[0]
             .replace(r"%gtclang%", gtclang_exec)
             .replace(r"%file%", filename)
+            .replace(r"%dirname%", dirname)
             .replace(r"%filename%", basename)
             .split(" ")
         )
@@ -55,6 +55,24 @@ TEST(PreprocessingTest, Include) {
   ASSERT_EQ(sirString1, sirString2);
 }
 
+TEST(PreprocessingTest, Conditional) {
+  auto flags = UnittestEnvironment::getSingleton().getFlagManager().getDefaultFlags();
+  const std::string filename = "input/test_stencil_conditional.cpp";
+  dawn::UIDGenerator::getInstance()->reset();
+  auto [passed, sir] = GTClang::run({filename, "-fno-codegen"}, flags);
+
+  // The stencil in the disabled branch, which can't be rewritten, and its pragma are skipped
+  ASSERT_TRUE(passed);
+  ASSERT_EQ(sir->Stencils.size(), 1);
+
+  // Only the macro-built pragma applies, the one in the disabled branch doesn't
+  const auto& stencil = sir->Stencils[0];
+  EXPECT_EQ(stencil->Name, "stencil_enabled");
+  EXPECT_TRUE(stencil->Attributes.has(dawn::ast::Attr::Kind::MergeStages));
+  EXPECT_FALSE(stencil->Attributes.has(dawn::ast::Attr::Kind::UseKCaches));
+  EXPECT_FALSE(stencil->Attributes.has(dawn::ast::Attr::Kind::NoCodeGen));
+}
+
 using LevelKind = dawn::ast::Interval::LevelKind;
 using Interval = dawn::ast::Interval;
 
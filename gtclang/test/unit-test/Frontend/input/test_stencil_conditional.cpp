@@ -0,0 +1,25 @@
+#include "gtclang_dsl_defs/gtclang_dsl.hpp"
+using namespace gtclang::dsl;
+
+#define MERGE_STAGES _Pragma("gtclang merge_stages")
+
+#ifdef USE_KCACHES
+#pragma gtclang use_kcaches
+#endif
+MERGE_STAGES
+stencil stencil_enabled {
+  storage in, out;
+  void Do() {
+    vertical_region(k_start, k_end) { out = in + 1; }
+  }
+};
+
+#if 0
+#pragma gtclang no_codegen
+stencil stencil_disabled {
+  storage in, out;
+  void Do() {
+    vertical_region(k_start, k_end) { out = in[i + 1; }
+  }
+};
+#endif